@@ -0,0 +1,81 @@
+`timescale 1ns / 1ps
+
+// Two-master arbiter in front of the external memory burst port.
+//
+// Burst memory protocol (caches -> external memory):
+//   - A master raises mem_req with mem_we and a line-aligned mem_addr and
+//     holds all three until mem_done.
+//   - Write bursts: mem_wdata carries the current beat; the memory takes it
+//     on every cycle with mem_wready and the master then moves to the next.
+//   - Read bursts: each beat arrives with mem_rvalid/mem_rdata.
+//   - mem_done marks the last beat (together with its wready/rvalid); the
+//     master drops mem_req (or starts a new burst) after that.
+//   - Every burst is one whole cache line (LINE_WORDS beats).
+//
+// m0 (D-cache) wins a tie over m1 (I-cache); the winner keeps the port
+// until its mem_done. An idle port is granted in the same cycle.
+module burst_arbiter (
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Master 0 (D-cache)
+    input  wire        m0_req,
+    input  wire        m0_we,
+    input  wire [31:0] m0_addr,
+    input  wire [31:0] m0_wdata,
+    output wire        m0_wready,
+    output wire        m0_rvalid,
+    output wire [31:0] m0_rdata,
+    output wire        m0_done,
+
+    // Master 1 (I-cache)
+    input  wire        m1_req,
+    input  wire        m1_we,
+    input  wire [31:0] m1_addr,
+    input  wire [31:0] m1_wdata,
+    output wire        m1_wready,
+    output wire        m1_rvalid,
+    output wire [31:0] m1_rdata,
+    output wire        m1_done,
+
+    // Memory
+    output wire        s_req,
+    output wire        s_we,
+    output wire [31:0] s_addr,
+    output wire [31:0] s_wdata,
+    input  wire        s_wready,
+    input  wire        s_rvalid,
+    input  wire [31:0] s_rdata,
+    input  wire        s_done
+);
+    reg busy;       // a burst is in progress
+    reg owner;      // which master owns it
+
+    wire sel = busy ? owner : !m0_req;
+
+    assign s_req   = busy || m0_req || m1_req;
+    assign s_we    = sel ? m1_we    : m0_we;
+    assign s_addr  = sel ? m1_addr  : m0_addr;
+    assign s_wdata = sel ? m1_wdata : m0_wdata;
+
+    assign m0_wready = s_wready && !sel;
+    assign m0_rvalid = s_rvalid && !sel;
+    assign m0_done   = s_done   && !sel;
+    assign m1_wready = s_wready &&  sel;
+    assign m1_rvalid = s_rvalid &&  sel;
+    assign m1_done   = s_done   &&  sel;
+    assign m0_rdata  = s_rdata;
+    assign m1_rdata  = s_rdata;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            busy  <= 1'b0;
+            owner <= 1'b0;
+        end else if (s_done) begin
+            busy <= 1'b0;
+        end else if (!busy && s_req) begin
+            busy  <= 1'b1;
+            owner <= sel;
+        end
+    end
+endmodule
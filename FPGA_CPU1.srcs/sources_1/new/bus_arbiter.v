@@ -0,0 +1,124 @@
+`timescale 1ns / 1ps
+
+// Two-master arbiter in front of one data-bus slave.
+//
+// Data bus protocol (core data port, DMA, every data slave):
+//   - A master drives req for ONE cycle with addr/we/be/wdata; the request is
+//     accepted at that clock edge. Masters never see back-pressure.
+//   - The response is a one-cycle ack (+ rdata for reads) in a LATER cycle.
+//     A slave inserts wait states simply by acking later.
+//   - One outstanding request per master; the next req may be driven in the
+//     same cycle as the previous ack.
+//   - Slaves must drive ack from registers (never combinationally from req),
+//     the core derives its next request from this cycle's ack.
+//
+// A request that cannot go to the slave in the cycle it arrives (slave busy,
+// or the other master won) is parked here and issued as soon as possible.
+// Contention is resolved round-robin so neither master can starve the other.
+module bus_arbiter (
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Master 0
+    input  wire        m0_req,
+    input  wire [31:0] m0_addr,
+    input  wire        m0_we,
+    input  wire [3:0]  m0_be,
+    input  wire [31:0] m0_wdata,
+    output wire [31:0] m0_rdata,
+    output wire        m0_ack,
+
+    // Master 1
+    input  wire        m1_req,
+    input  wire [31:0] m1_addr,
+    input  wire        m1_we,
+    input  wire [3:0]  m1_be,
+    input  wire [31:0] m1_wdata,
+    output wire [31:0] m1_rdata,
+    output wire        m1_ack,
+
+    // Slave
+    output wire        s_req,
+    output wire [31:0] s_addr,
+    output wire        s_we,
+    output wire [3:0]  s_be,
+    output wire [31:0] s_wdata,
+    input  wire [31:0] s_rdata,
+    input  wire        s_ack
+);
+    // Parked requests
+    reg        p0_valid, p1_valid;
+    reg [31:0] p0_addr,  p1_addr;
+    reg        p0_we,    p1_we;
+    reg [3:0]  p0_be,    p1_be;
+    reg [31:0] p0_wdata, p1_wdata;
+
+    reg busy;       // a request is at the slave, waiting for s_ack
+    reg owner;      // which master that request belongs to
+    reg prefer_m1;  // round-robin: m1 wins the next tie
+
+    wire slave_free = !busy || s_ack;
+    wire want0 = p0_valid || m0_req;
+    wire want1 = p1_valid || m1_req;
+    wire grant1 = slave_free && want1 && (!want0 || prefer_m1);
+    wire grant0 = slave_free && want0 && !grant1;
+
+    // A parked request is older than a live one, so it goes first
+    wire [31:0] r0_addr  = p0_valid ? p0_addr  : m0_addr;
+    wire        r0_we    = p0_valid ? p0_we    : m0_we;
+    wire [3:0]  r0_be    = p0_valid ? p0_be    : m0_be;
+    wire [31:0] r0_wdata = p0_valid ? p0_wdata : m0_wdata;
+    wire [31:0] r1_addr  = p1_valid ? p1_addr  : m1_addr;
+    wire        r1_we    = p1_valid ? p1_we    : m1_we;
+    wire [3:0]  r1_be    = p1_valid ? p1_be    : m1_be;
+    wire [31:0] r1_wdata = p1_valid ? p1_wdata : m1_wdata;
+
+    assign s_req   = grant0 | grant1;
+    assign s_addr  = grant1 ? r1_addr  : r0_addr;
+    assign s_we    = grant1 ? r1_we    : r0_we;
+    assign s_be    = grant1 ? r1_be    : r0_be;
+    assign s_wdata = grant1 ? r1_wdata : r0_wdata;
+
+    assign m0_ack   = s_ack && busy && !owner;
+    assign m1_ack   = s_ack && busy &&  owner;
+    assign m0_rdata = s_rdata;
+    assign m1_rdata = s_rdata;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            p0_valid  <= 1'b0;
+            p1_valid  <= 1'b0;
+            busy      <= 1'b0;
+            owner     <= 1'b0;
+            prefer_m1 <= 1'b0;
+        end else begin
+            if (grant0)
+                p0_valid <= 1'b0;
+            else if (m0_req) begin
+                p0_valid <= 1'b1;
+                p0_addr  <= m0_addr;
+                p0_we    <= m0_we;
+                p0_be    <= m0_be;
+                p0_wdata <= m0_wdata;
+            end
+
+            if (grant1)
+                p1_valid <= 1'b0;
+            else if (m1_req) begin
+                p1_valid <= 1'b1;
+                p1_addr  <= m1_addr;
+                p1_we    <= m1_we;
+                p1_be    <= m1_be;
+                p1_wdata <= m1_wdata;
+            end
+
+            if (s_req) begin
+                busy      <= 1'b1;
+                owner     <= grant1;
+                prefer_m1 <= grant0;
+            end else if (s_ack) begin
+                busy <= 1'b0;
+            end
+        end
+    end
+endmodule
@@ -0,0 +1,255 @@
+`timescale 1ns / 1ps
+
+// System bus crossbar.
+//
+// Regions are decoded on addr[31:28] (bases come from memmap.vh):
+//   ITCM_BASE  code TCM   - fetch port A, data port B
+//   DTCM_BASE  data TCM, its first DTCM_WORDS words only (the BRAM need not
+//              be a power of two; the rest of the region is unmapped)
+//   IO_BASE    peripherals (one slave; devices decode their own registers)
+//   EXT_BASE   external memory, through the I-cache (fetch) and D-cache (data)
+//   FLASH_BASE QSPI flash, read-only, through qspi_xip's line cache
+// Anything else is unmapped: data reads return 0 and writes are dropped,
+// fetches return "jal x0, 0" so a runaway core parks on the bad PC.
+//
+// Instruction side (one master, the core fetch port): level ack - i_rdata
+// holds the word for the most recent accepted i_req until the next one, and
+// i_ack says it is valid. A new i_req may supersede one still in flight.
+// The TCM answers every fetch on the next cycle; the I-cache and the flash
+// controller hold i_ack low while they refill.
+//
+// Data side: two masters (d0 = core, d1 = DMA/spare) share every data slave
+// through a bus_arbiter; see bus_arbiter.v for the req/ack protocol. Each
+// master has one outstanding request, so its response is just the OR of the
+// slave acks routed back to it.
+module bus_xbar (
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Instruction master
+    input  wire        i_req,
+    input  wire [31:0] i_addr,
+    output wire [31:0] i_rdata,
+    output wire        i_ack,
+
+    // Data master 0 (core)
+    input  wire        d0_req,
+    input  wire [31:0] d0_addr,
+    input  wire        d0_we,
+    input  wire [3:0]  d0_be,
+    input  wire [31:0] d0_wdata,
+    output wire [31:0] d0_rdata,
+    output wire        d0_ack,
+
+    // Data master 1 (tie req low when unused)
+    input  wire        d1_req,
+    input  wire [31:0] d1_addr,
+    input  wire        d1_we,
+    input  wire [3:0]  d1_be,
+    input  wire [31:0] d1_wdata,
+    output wire [31:0] d1_rdata,
+    output wire        d1_ack,
+
+    // ITCM fetch port (registered read, never waits)
+    output wire        itcm_i_req,
+    output wire [31:0] itcm_i_addr,
+    input  wire [31:0] itcm_i_rdata,
+
+    // ITCM data port
+    output wire        itcm_d_req,
+    output wire [31:0] itcm_d_addr,
+    output wire        itcm_d_we,
+    output wire [3:0]  itcm_d_be,
+    output wire [31:0] itcm_d_wdata,
+    input  wire [31:0] itcm_d_rdata,
+    input  wire        itcm_d_ack,
+
+    // DTCM
+    output wire        dtcm_req,
+    output wire [31:0] dtcm_addr,
+    output wire        dtcm_we,
+    output wire [3:0]  dtcm_be,
+    output wire [31:0] dtcm_wdata,
+    input  wire [31:0] dtcm_rdata,
+    input  wire        dtcm_ack,
+
+    // Peripheral region
+    output wire        io_req,
+    output wire [31:0] io_addr,
+    output wire        io_we,
+    output wire [3:0]  io_be,
+    output wire [31:0] io_wdata,
+    input  wire [31:0] io_rdata,
+    input  wire        io_ack,
+
+    // External memory: I-cache
+    output wire        ext_i_req,
+    output wire [31:0] ext_i_addr,
+    input  wire [31:0] ext_i_rdata,
+    input  wire        ext_i_ack,
+
+    // External memory: D-cache
+    output wire        ext_d_req,
+    output wire [31:0] ext_d_addr,
+    output wire        ext_d_we,
+    output wire [3:0]  ext_d_be,
+    output wire [31:0] ext_d_wdata,
+    input  wire [31:0] ext_d_rdata,
+    input  wire        ext_d_ack,
+
+    // QSPI flash: fetch port (level ack) and data port
+    output wire        flash_i_req,
+    output wire [31:0] flash_i_addr,
+    input  wire [31:0] flash_i_rdata,
+    input  wire        flash_i_ack,
+    output wire        flash_d_req,
+    output wire [31:0] flash_d_addr,
+    output wire        flash_d_we,
+    output wire [3:0]  flash_d_be,
+    output wire [31:0] flash_d_wdata,
+    input  wire [31:0] flash_d_rdata,
+    input  wire        flash_d_ack
+);
+    `include "memmap.vh"
+
+    localparam [3:0]  REGION_ITCM   = ITCM_BASE[31:28];
+    localparam [3:0]  REGION_DTCM   = DTCM_BASE[31:28];
+    localparam [3:0]  REGION_IO     = IO_BASE[31:28];
+    localparam [3:0]  REGION_EXT    = EXT_BASE[31:28];
+    localparam [3:0]  REGION_FLASH  = FLASH_BASE[31:28];
+    localparam [27:0] DTCM_BYTES    = DTCM_WORDS * 4;
+    localparam [31:0] INSN_JAL_SELF = 32'h0000_006F;   // jal x0, 0
+
+    // ------------------------------------------------------------
+    // Instruction side
+    // ------------------------------------------------------------
+    wire i_hit_itcm = (i_addr[31:28] == REGION_ITCM);
+    wire i_hit_ext  = (i_addr[31:28] == REGION_EXT);
+    wire i_hit_fl   = (i_addr[31:28] == REGION_FLASH);
+    reg  i_sel_itcm;    // slave that owns the current fetch response
+    reg  i_sel_ext;
+    reg  i_sel_fl;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            i_sel_itcm <= 1'b1;
+            i_sel_ext  <= 1'b0;
+            i_sel_fl   <= 1'b0;
+        end else if (i_req) begin
+            i_sel_itcm <= i_hit_itcm;
+            i_sel_ext  <= i_hit_ext;
+            i_sel_fl   <= i_hit_fl;
+        end
+    end
+
+    assign itcm_i_req  = i_req && i_hit_itcm;
+    assign itcm_i_addr = i_addr;
+    assign ext_i_req   = i_req && i_hit_ext;
+    assign ext_i_addr  = i_addr;
+    assign flash_i_req  = i_req && i_hit_fl;
+    assign flash_i_addr = i_addr;
+    assign i_rdata     = i_sel_itcm ? itcm_i_rdata  :
+                         i_sel_ext  ? ext_i_rdata   :
+                         i_sel_fl   ? flash_i_rdata :
+                                      INSN_JAL_SELF;
+    assign i_ack       = i_sel_ext ? ext_i_ack   :
+                         i_sel_fl  ? flash_i_ack :
+                                     1'b1;
+
+    // ------------------------------------------------------------
+    // Data side: region decode per master
+    // ------------------------------------------------------------
+    wire d0_itcm = (d0_addr[31:28] == REGION_ITCM);
+    wire d0_dtcm = (d0_addr[31:28] == REGION_DTCM) && (d0_addr[27:0] < DTCM_BYTES);
+    wire d0_io   = (d0_addr[31:28] == REGION_IO);
+    wire d0_ext  = (d0_addr[31:28] == REGION_EXT);
+    wire d0_fl   = (d0_addr[31:28] == REGION_FLASH);
+    wire d1_itcm = (d1_addr[31:28] == REGION_ITCM);
+    wire d1_dtcm = (d1_addr[31:28] == REGION_DTCM) && (d1_addr[27:0] < DTCM_BYTES);
+    wire d1_io   = (d1_addr[31:28] == REGION_IO);
+    wire d1_ext  = (d1_addr[31:28] == REGION_EXT);
+    wire d1_fl   = (d1_addr[31:28] == REGION_FLASH);
+
+    wire [31:0] itcm_r0, itcm_r1, dtcm_r0, dtcm_r1, io_r0, io_r1, ext_r0, ext_r1, fl_r0, fl_r1;
+    wire        itcm_a0, itcm_a1, dtcm_a0, dtcm_a1, io_a0, io_a1, ext_a0, ext_a1, fl_a0, fl_a1;
+
+    bus_arbiter u_arb_itcm (
+        .clk(clk), .rst_n(rst_n),
+        .m0_req(d0_req && d0_itcm), .m0_addr(d0_addr), .m0_we(d0_we), .m0_be(d0_be),
+        .m0_wdata(d0_wdata), .m0_rdata(itcm_r0), .m0_ack(itcm_a0),
+        .m1_req(d1_req && d1_itcm), .m1_addr(d1_addr), .m1_we(d1_we), .m1_be(d1_be),
+        .m1_wdata(d1_wdata), .m1_rdata(itcm_r1), .m1_ack(itcm_a1),
+        .s_req(itcm_d_req), .s_addr(itcm_d_addr), .s_we(itcm_d_we), .s_be(itcm_d_be),
+        .s_wdata(itcm_d_wdata), .s_rdata(itcm_d_rdata), .s_ack(itcm_d_ack)
+    );
+
+    bus_arbiter u_arb_dtcm (
+        .clk(clk), .rst_n(rst_n),
+        .m0_req(d0_req && d0_dtcm), .m0_addr(d0_addr), .m0_we(d0_we), .m0_be(d0_be),
+        .m0_wdata(d0_wdata), .m0_rdata(dtcm_r0), .m0_ack(dtcm_a0),
+        .m1_req(d1_req && d1_dtcm), .m1_addr(d1_addr), .m1_we(d1_we), .m1_be(d1_be),
+        .m1_wdata(d1_wdata), .m1_rdata(dtcm_r1), .m1_ack(dtcm_a1),
+        .s_req(dtcm_req), .s_addr(dtcm_addr), .s_we(dtcm_we), .s_be(dtcm_be),
+        .s_wdata(dtcm_wdata), .s_rdata(dtcm_rdata), .s_ack(dtcm_ack)
+    );
+
+    bus_arbiter u_arb_io (
+        .clk(clk), .rst_n(rst_n),
+        .m0_req(d0_req && d0_io), .m0_addr(d0_addr), .m0_we(d0_we), .m0_be(d0_be),
+        .m0_wdata(d0_wdata), .m0_rdata(io_r0), .m0_ack(io_a0),
+        .m1_req(d1_req && d1_io), .m1_addr(d1_addr), .m1_we(d1_we), .m1_be(d1_be),
+        .m1_wdata(d1_wdata), .m1_rdata(io_r1), .m1_ack(io_a1),
+        .s_req(io_req), .s_addr(io_addr), .s_we(io_we), .s_be(io_be),
+        .s_wdata(io_wdata), .s_rdata(io_rdata), .s_ack(io_ack)
+    );
+
+    bus_arbiter u_arb_ext (
+        .clk(clk), .rst_n(rst_n),
+        .m0_req(d0_req && d0_ext), .m0_addr(d0_addr), .m0_we(d0_we), .m0_be(d0_be),
+        .m0_wdata(d0_wdata), .m0_rdata(ext_r0), .m0_ack(ext_a0),
+        .m1_req(d1_req && d1_ext), .m1_addr(d1_addr), .m1_we(d1_we), .m1_be(d1_be),
+        .m1_wdata(d1_wdata), .m1_rdata(ext_r1), .m1_ack(ext_a1),
+        .s_req(ext_d_req), .s_addr(ext_d_addr), .s_we(ext_d_we), .s_be(ext_d_be),
+        .s_wdata(ext_d_wdata), .s_rdata(ext_d_rdata), .s_ack(ext_d_ack)
+    );
+
+    bus_arbiter u_arb_flash (
+        .clk(clk), .rst_n(rst_n),
+        .m0_req(d0_req && d0_fl), .m0_addr(d0_addr), .m0_we(d0_we), .m0_be(d0_be),
+        .m0_wdata(d0_wdata), .m0_rdata(fl_r0), .m0_ack(fl_a0),
+        .m1_req(d1_req && d1_fl), .m1_addr(d1_addr), .m1_we(d1_we), .m1_be(d1_be),
+        .m1_wdata(d1_wdata), .m1_rdata(fl_r1), .m1_ack(fl_a1),
+        .s_req(flash_d_req), .s_addr(flash_d_addr), .s_we(flash_d_we), .s_be(flash_d_be),
+        .s_wdata(flash_d_wdata), .s_rdata(flash_d_rdata), .s_ack(flash_d_ack)
+    );
+
+    // Unmapped accesses: ack next cycle, read as zero
+    reg d0_none_ack, d1_none_ack;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            d0_none_ack <= 1'b0;
+            d1_none_ack <= 1'b0;
+        end else begin
+            d0_none_ack <= d0_req && !(d0_itcm | d0_dtcm | d0_io | d0_ext | d0_fl);
+            d1_none_ack <= d1_req && !(d1_itcm | d1_dtcm | d1_io | d1_ext | d1_fl);
+        end
+    end
+
+    // ------------------------------------------------------------
+    // Responses
+    // ------------------------------------------------------------
+    assign d0_ack   = itcm_a0 | dtcm_a0 | io_a0 | ext_a0 | fl_a0 | d0_none_ack;
+    assign d0_rdata = itcm_a0 ? itcm_r0 :
+                      dtcm_a0 ? dtcm_r0 :
+                      io_a0   ? io_r0   :
+                      ext_a0  ? ext_r0  :
+                      fl_a0   ? fl_r0   :
+                                32'b0;
+    assign d1_ack   = itcm_a1 | dtcm_a1 | io_a1 | ext_a1 | fl_a1 | d1_none_ack;
+    assign d1_rdata = itcm_a1 ? itcm_r1 :
+                      dtcm_a1 ? dtcm_r1 :
+                      io_a1   ? io_r1   :
+                      ext_a1  ? ext_r1  :
+                      fl_a1   ? fl_r1   :
+                                32'b0;
+endmodule
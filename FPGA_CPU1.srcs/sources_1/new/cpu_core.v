@@ -4,23 +4,65 @@
 module cpu_core (
     input  wire        clk,
     input  wire        rst_n,
-    input  wire        step_pulse,   // external hold (e.g., UART busy)
-    input  wire        irq_i,   // external interrupt request (level)
+    input  wire        step_pulse,   // external hold (debug single-step), tie high to run
+    input  wire        irq_i,   // machine external interrupt (level, MEIP)
     output wire [31:0] pc_o,
 
-    // instruction + data memory
-    input  wire [31:0] instr_i,
+    // Instruction bus (see bus_xbar.v): i_rdata holds the word for the last
+    // accepted i_req while i_ack is high
+    output wire        i_req,
+    output wire [31:0] i_addr,
+    input  wire [31:0] i_rdata,
+    input  wire        i_ack,
+
+    // Data bus (see bus_arbiter.v): request issued as the load/store enters
+    // MEM, MEM waits for the one-cycle ack
+    output wire        d_req,
     output wire [31:0] d_addr,
-    output wire [31:0] d_wdata,
-    input  wire [31:0] d_rdata,
     output wire        d_we,
+    output wire [3:0]  d_be,
+    output wire [31:0] d_wdata,      // store data, replicated into byte lanes
+    input  wire [31:0] d_rdata,
+    input  wire        d_ack,
+
+    // Cache maintenance: a fence / fence.i in ID raises fence_req_o and
+    // stalls until fence_done_i (tie high when there are no caches)
+    output wire        fence_req_o,
+    output wire        fence_i_o,
+    input  wire        fence_done_i,
+
+    // Low word of the CLINT mtime, for the timer peripheral
+    output wire [31:0] mtime_o,
 
     // debug/IO
     output wire [31:0] wb_value,
     output wire        is_sw_o,
     output wire        is_sh_o,
     output wire        is_sb_o,
-    output wire [31:0] rs2_val_o
+    output wire [31:0] rs2_val_o,
+
+    // RVFI retirement trace (RISC-V Formal Interface naming): one record per
+    // retired instruction, in program order, with rvfi_valid high for the
+    // cycle after MEM/WB completes it. Observation only - nothing in the
+    // core reads it, so leaving these open costs no logic.
+    output reg         rvfi_valid,
+    output reg  [63:0] rvfi_order,
+    output reg  [31:0] rvfi_insn,
+    output reg         rvfi_trap,       // ecall / ebreak: pc_wdata is the handler
+    output reg         rvfi_intr,       // first instruction of a trap handler
+    output reg  [31:0] rvfi_pc_rdata,
+    output reg  [31:0] rvfi_pc_wdata,
+    output reg  [4:0]  rvfi_rs1_addr,   // 0 when the format has no rs1 / rs2
+    output reg  [4:0]  rvfi_rs2_addr,
+    output reg  [31:0] rvfi_rs1_rdata,
+    output reg  [31:0] rvfi_rs2_rdata,
+    output reg  [4:0]  rvfi_rd_addr,    // 0 when nothing is written
+    output reg  [31:0] rvfi_rd_wdata,
+    output reg  [31:0] rvfi_mem_addr,   // word address; masks select the lanes
+    output reg  [3:0]  rvfi_mem_rmask,
+    output reg  [3:0]  rvfi_mem_wmask,
+    output reg  [31:0] rvfi_mem_rdata,  // whole word, before lane extraction
+    output reg  [31:0] rvfi_mem_wdata   // lane-replicated, as on d_wdata
 );
 
     // ------------------------------------------------------------
@@ -40,13 +82,15 @@ module cpu_core (
     wire branch_flag_ex;
 
 
-    // PC held by external hold (step_pulse) OR internal pipeline stall
+    // PC held by a data-bus wait (core_step low) OR internal pipeline stall.
+    // A redirect still wins over a stall: a fetch wait can overlap a taken branch.
     wire [31:0] pc;
     wire pc_stall;  // Forward declaration, assigned after pipeline_stall is defined
+    wire core_step; // step_pulse && !mem_wait, assigned in the MEM/WB section
     pc_reg u_pc (
         .clk          (clk),
         .rst_n        (rst_n),
-        .pc_en        (step_pulse && !pc_stall),
+        .pc_en        (core_step && (!pc_stall || flush_pipeline)),
         .branch_flag  (branch_flag),
         .branch_target(branch_target),
         .pc           (pc)
@@ -55,6 +99,7 @@ module cpu_core (
 
     // IF/ID latch
     wire [31:0] id_pc;
+    wire        id_valid;
     wire [31:0] id_inst;
     wire hold_ifid;
     wire flush_ifid;
@@ -163,11 +208,17 @@ module cpu_core (
         .hold(hold_ifid),
         .flush(flush_ifid),
         .if_pc(pc),
-        .if_inst(instr_i),
         .id_pc(id_pc),
-        .id_inst(id_inst)
+        .id_valid(id_valid)
     );
 
+    // The fetch slave's response IS the IF/ID instruction latch: it only
+    // advances with i_req, and flushed or not-yet-returned slots decode as 0.
+    // No fetch is issued on a redirect edge (pc is still the wrong path).
+    assign id_inst = (id_valid && i_ack) ? i_rdata : 32'b0;
+    assign i_req   = ~hold_ifid && !flush_pipeline;
+    assign i_addr  = pc;
+
     // ------------------------------------------------------------
     // Register File + forwarding
     // ------------------------------------------------------------
@@ -311,10 +362,23 @@ module cpu_core (
     // MRET hazard: mret reads mepc, but previous CSR instruction is writing to mepc
     wire mret_mepc_hazard = is_mret && ex_is_csr && (ex_csr_addr == 12'h341) && csr_write_pending;
 
-    wire pipeline_stall = load_use_hazard | csr_hazard | csr_rd_hazard | mret_mepc_hazard;
+    // Fetch wait: the ID slot is valid but its instruction has not returned yet
+    wire fetch_wait = id_valid && !i_ack;
+
+    // Fence wait: earlier accesses are done (MEM not waiting), caches are
+    // cleaned (and invalidated for fence.i) while the fence sits in ID
+    wire is_fence_i = is_fence && (funct3 == 3'b001);
+    assign fence_req_o = is_fence && core_step && !branch_flag_ex;
+    assign fence_i_o   = is_fence_i;
+    wire fence_wait = fence_req_o && !fence_done_i;
+
+    wire pipeline_stall = load_use_hazard | csr_hazard | csr_rd_hazard | mret_mepc_hazard |
+                          fetch_wait | fence_wait;
     assign pc_stall = pipeline_stall;  // Hold PC during stall
-    wire hold_idex = ~step_pulse;  // Normal hold behavior
-    wire bubble_idex = branch_flag_ex | pipeline_stall;  // Bubble inserts NOP, but EX still completes!
+    wire hold_idex = ~core_step;  // Data-bus wait freezes MEM and everything behind it
+    // Bubble inserts NOP, but EX still completes! Any redirect squashes the ID
+    // instruction (a trapped/interrupted instruction must not execute).
+    wire bubble_idex = flush_pipeline | pipeline_stall;
 
     id_ex u_idex(
         .clk(clk),
@@ -498,6 +562,7 @@ module cpu_core (
     end
 
     assign clint_mtip = (clint_mtime >= clint_mtimecmp);
+    assign mtime_o    = clint_mtime[31:0];
 
     // ------------------------------------------------------------
     // CSR / trap logic (supports CSR instructions + MMIO window)
@@ -530,12 +595,15 @@ module cpu_core (
     reg [31:0] csr_mip;
     reg [31:0] csr_mscratch;
 
-    wire timer_irq_level = clint_mtip | irq_i;
-    wire [31:0] csr_mip_effective = {csr_mip[31:8], timer_irq_level, csr_mip[6:0]};
+    wire timer_irq_level = clint_mtip;
+    wire ext_irq_level   = irq_i;
+    wire [31:0] csr_mip_effective = {csr_mip[31:12], ext_irq_level, csr_mip[10:8],
+                                     timer_irq_level, csr_mip[6:0]};
 
     wire csr_mstatus_mie  = csr_mstatus[3];
     wire csr_mstatus_mpie = csr_mstatus[7];
     wire csr_mie_mtie     = csr_mie[7];
+    wire csr_mie_meie     = csr_mie[11];
 
     // Detect mret instruction
     wire is_mret = (id_inst == 32'h30200073);
@@ -545,9 +613,16 @@ module cpu_core (
     wire system_op_in_pipeline = ex_is_csr | is_ecall | is_ebreak | is_mret;
     
     // Trap detection in ID stage - BLOCK during system ops!
-    wire irq_take    = timer_irq_level && csr_mstatus_mie && csr_mie_mtie && !system_op_in_pipeline;
-    wire ecall_take  = is_ecall;
-    wire ebreak_take = is_ebreak;  // BUG FIX: ebreak was not being trapped!
+    // ID-stage events only fire when the pipeline actually advances (no data-bus
+    // wait) and ID is not on the wrong path of a branch resolving in EX.
+    wire id_event_ok = core_step && !branch_flag_ex;
+    // External beats timer when both are pending (privileged spec order)
+    wire ext_irq_en   = ext_irq_level && csr_mie_meie;
+    wire timer_irq_en = timer_irq_level && csr_mie_mtie;
+    wire irq_take    = (ext_irq_en | timer_irq_en) && csr_mstatus_mie && !system_op_in_pipeline &&
+                       id_event_ok;
+    wire ecall_take  = is_ecall && id_event_ok;
+    wire ebreak_take = is_ebreak && id_event_ok;  // BUG FIX: ebreak was not being trapped!
     wire trap_take   = irq_take | ecall_take | ebreak_take;
 
     wire [31:0] branch_target_trap = csr_mtvec;
@@ -555,8 +630,10 @@ module cpu_core (
 
     wire branch_flush = branch_flag_ex;
     wire trap_flush   = trap_take;
-    wire mret_flush   = is_mret && !mret_mepc_hazard;  // Don't flush during mepc hazard stall
-    assign flush_pipeline = branch_flush | trap_flush | misaligned_trap | mret_flush;
+    wire mret_flush   = is_mret && !mret_mepc_hazard && id_event_ok;  // Don't flush during mepc hazard stall
+    // fence.i refetches everything after it (the next word may be stale)
+    wire fence_i_flush = is_fence_i && fence_done_i && id_event_ok;
+    assign flush_pipeline = branch_flush | trap_flush | misaligned_trap | mret_flush | fence_i_flush;
 
     assign branch_flag = flush_pipeline;
     assign branch_target =
@@ -564,9 +641,10 @@ module cpu_core (
         trap_flush      ? branch_target_trap :
         mret_flush      ? branch_target_mret :
         branch_flush    ? branch_target_ex :
+        fence_i_flush   ? id_pc + 32'd4 :
                           32'b0;
 
-    assign hold_ifid  = ~step_pulse | pipeline_stall;
+    assign hold_ifid  = ~core_step | pipeline_stall;
     assign flush_ifid = flush_pipeline;
 
     // Track trap/branch flush for cancelling register writes (like srv32's wb_trap_nop)
@@ -575,7 +653,7 @@ module cpu_core (
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n)
             trap_wb_cancel <= 1'b0;
-        else if (step_pulse)
+        else if (core_step)
             trap_wb_cancel <= flush_pipeline;  // Cancel WB after any pipeline flush
     end
 
@@ -669,17 +747,19 @@ module cpu_core (
                 csr_mstatus[7]  <= csr_mstatus_mie;
                 csr_mstatus[3]  <= 1'b0;
             end else if (trap_take) begin
-                // For interrupts: save the PC being fetched (will resume there after handler)
+                // For interrupts: save the oldest instruction not yet executed -
+                // the ID instruction (squashed by the trap), or if ID is empty
+                // after a flush, the PC being fetched.
                 // BUG FIX: id_pc is STALE after pipeline flush (like mret)!
                 // For ecall/ebreak: save PC of the instruction itself (id_pc)
-                csr_mepc        <= irq_take ? pc : id_pc;
-                // mcause: 0x80000007=timer, 0x0B=ecall, 0x03=ebreak
-                csr_mcause      <= irq_take    ? 32'h80000007 : 
-                                   ebreak_take ? 32'h00000003 : 32'h0000000B;
-                csr_mip[7]      <= irq_i;
+                csr_mepc        <= (irq_take && !id_valid) ? pc : id_pc;
+                // mcause: 0x8000000B=external, 0x80000007=timer, 0x0B=ecall, 0x03=ebreak
+                csr_mcause      <= (irq_take && ext_irq_en) ? 32'h8000000B :
+                                   irq_take                 ? 32'h80000007 :
+                                   ebreak_take              ? 32'h00000003 : 32'h0000000B;
                 csr_mstatus[7]  <= csr_mstatus_mie; // MPIE <= MIE
                 csr_mstatus[3]  <= 1'b0;            // MIE  <= 0
-            end else if (is_mret && !mret_mepc_hazard) begin
+            end else if (mret_flush) begin
                 // mret restore - ONLY if no trap is being taken (else clause!)
                 csr_mstatus[3] <= csr_mstatus_mpie; // MIE <= MPIE
                 csr_mstatus[7] <= 1'b1;             // MPIE <= 1
@@ -693,7 +773,8 @@ module cpu_core (
                     CSR_NUM_MSCRATCH: csr_mscratch <= csr_instr_wdata;
                     CSR_NUM_MEPC:     csr_mepc     <= csr_instr_wdata;
                     CSR_NUM_MCAUSE:   csr_mcause   <= csr_instr_wdata;
-                    CSR_NUM_MIP:      csr_mip      <= {csr_instr_wdata[31:8], 1'b0, csr_instr_wdata[6:0]};
+                    CSR_NUM_MIP:      csr_mip      <= {csr_instr_wdata[31:12], 1'b0, csr_instr_wdata[10:8],
+                                                       1'b0, csr_instr_wdata[6:0]};
                     default: ;
                 endcase
             end
@@ -710,14 +791,44 @@ module cpu_core (
     end
 
     // ------------------------------------------------------------
-    // MEM/WB stage
+    // Data bus request (ID -> MEM edge)
     // ------------------------------------------------------------
-    assign d_addr  = mem_alu_res;
-    assign d_wdata = mem_store_data;
+    // Issued from ID so a one-cycle slave (TCM) has the data ready in MEM.
+    // CLINT and the CSR window are core-internal and never go on the bus.
+    wire id_is_load  = is_lb | is_lh | is_lw | is_lbu | is_lhu;
+    wire id_is_store = is_sb | is_sh | is_sw;
+    wire id_addr_internal =
+        (addr_calc == CLINT_MTIME_LO)    || (addr_calc == CLINT_MTIME_HI)   ||
+        (addr_calc == CLINT_MTIMECMP_LO) || (addr_calc == CLINT_MTIMECMP_HI) ||
+        (addr_calc == CSR_MTVEC_ADDR)    || (addr_calc == CSR_MSTATUS_ADDR) ||
+        (addr_calc == CSR_MEPC_ADDR)     || (addr_calc == CSR_MCAUSE_ADDR);
+
+    assign d_req   = core_step && !bubble_idex && (id_is_load | id_is_store) && !id_addr_internal;
+    assign d_addr  = addr_calc;
+    assign d_we    = d_req && id_is_store;
+    // Store lane steering: replicate sub-word data so the byte enables pick it up
+    assign d_be    = is_sw ? 4'b1111 :
+                     is_sh ? (addr_calc[1] ? 4'b1100 : 4'b0011) :
+                     is_sb ? (4'b0001 << addr_calc[1:0]) :
+                             4'b1111;
+    assign d_wdata = is_sh ? {2{op2[15:0]}} :
+                     is_sb ? {4{op2[7:0]}}  :
+                             op2;
+
+    // MEM holds its load/store until the slave acks; nothing else moves meanwhile
+    reg mem_bus_pending;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n)
+            mem_bus_pending <= 1'b0;
+        else if (core_step)
+            mem_bus_pending <= d_req;
+    end
+    wire mem_wait = mem_bus_pending && !d_ack;
+    assign core_step = step_pulse && !mem_wait;
 
-    // Mask data memory writes when hitting CSR addresses or during trap flush
-    wire csr_write = mem_is_sw && (mem_alu_res==CSR_MTVEC_ADDR || mem_alu_res==CSR_MSTATUS_ADDR || mem_alu_res==CSR_MEPC_ADDR || mem_alu_res==CSR_MCAUSE_ADDR);
-    assign d_we    = step_pulse ? ((mem_is_sb | mem_is_sh | mem_is_sw) && ~csr_write && ~clint_write_any && ~misaligned_trap && ~trap_wb_cancel) : 1'b0;
+    // ------------------------------------------------------------
+    // MEM/WB stage
+    // ------------------------------------------------------------
 
     assign is_sw_o = mem_is_sw;
     assign is_sh_o = mem_is_sh;
@@ -752,8 +863,135 @@ module cpu_core (
                              mem_alu_res;
 
     assign wb_value = wb_value_pre;
-    assign wb_we   = mem_we && !trap_wb_cancel;  // Cancel writes after trap/branch flush
+    assign wb_we   = mem_we && !trap_wb_cancel && !mem_wait;  // Cancel writes after trap/branch flush
     assign wb_rd   = mem_rd;
     assign wb_wdata= wb_value_pre;
 
+    // ------------------------------------------------------------
+    // RVFI retirement trace
+    // ------------------------------------------------------------
+    // A shadow of the ID/EX latch follows each instruction into MEM/WB, where
+    // it retires on the step that completes it. Squashed ID slots (stall
+    // bubbles, wrong path behind a taken branch, the instruction an interrupt
+    // displaces) never enter it. ecall / ebreak / mret / fence.i redirect from
+    // ID and bubble themselves out of ID/EX, so they enter the shadow alone
+    // and retire from the otherwise empty slot one step later - still in
+    // order, and ahead of the first instruction fetched after the redirect.
+    wire [6:0] id_opcode   = id_inst[6:0];
+    wire       id_uses_rs1 = (id_opcode == 7'b0010011) || (id_opcode == 7'b0110011) ||
+                             (id_opcode == 7'b0000011) || (id_opcode == 7'b0100011) ||
+                             (id_opcode == 7'b1100011) || (id_opcode == 7'b1100111) ||
+                             (is_csr_op && !csr_funct3[2]);
+    wire       id_uses_rs2 = (id_opcode == 7'b0110011) || (id_opcode == 7'b0100011) ||
+                             (id_opcode == 7'b1100011);
+
+    wire id_to_ex      = core_step && !bubble_idex && id_valid;
+    wire id_sys_retire = (ecall_take | ebreak_take | mret_flush | fence_i_flush) && !irq_take;
+
+    reg        rvfi_ex_valid;
+    reg        rvfi_ex_sys;         // retired from ID by its own redirect
+    reg        rvfi_ex_trap;
+    reg        rvfi_ex_intr;
+    reg [31:0] rvfi_ex_insn;
+    reg [31:0] rvfi_ex_pc;
+    reg [31:0] rvfi_ex_next_pc;     // redirect target of a system instruction
+    reg [4:0]  rvfi_ex_rs1;
+    reg [4:0]  rvfi_ex_rs2;
+    reg        rvfi_handler_next;   // a trap was entered: next to retire is the handler's first
+    reg [63:0] rvfi_count;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rvfi_ex_valid     <= 1'b0;
+            rvfi_ex_sys       <= 1'b0;
+            rvfi_ex_trap      <= 1'b0;
+            rvfi_ex_intr      <= 1'b0;
+            rvfi_ex_insn      <= 32'b0;
+            rvfi_ex_pc        <= 32'b0;
+            rvfi_ex_next_pc   <= 32'b0;
+            rvfi_ex_rs1       <= 5'b0;
+            rvfi_ex_rs2       <= 5'b0;
+            rvfi_handler_next <= 1'b0;
+        end else if (core_step) begin   // moves with ID/EX (hold_idex)
+            rvfi_ex_valid   <= id_to_ex | id_sys_retire;
+            rvfi_ex_sys     <= id_sys_retire;
+            rvfi_ex_trap    <= ecall_take | ebreak_take;
+            rvfi_ex_intr    <= rvfi_handler_next;
+            rvfi_ex_insn    <= id_inst;
+            rvfi_ex_pc      <= id_pc;
+            rvfi_ex_next_pc <= branch_target;
+            rvfi_ex_rs1     <= (id_sys_retire || !id_uses_rs1) ? 5'b0 : rs1;
+            rvfi_ex_rs2     <= (id_sys_retire || !id_uses_rs2) ? 5'b0 : rs2;
+            if (trap_take)
+                rvfi_handler_next <= 1'b1;
+            else if (id_to_ex | id_sys_retire)
+                rvfi_handler_next <= 1'b0;
+        end
+    end
+
+    // trap_wb_cancel marks the slot behind a flush, which only ever holds a
+    // bubble or the system instruction that caused the flush
+    wire rvfi_retire = rvfi_ex_valid && core_step && (rvfi_ex_sys || !trap_wb_cancel);
+
+    wire [3:0] rvfi_lanes =
+        (mem_is_lw | mem_is_sw)              ? 4'b1111 :
+        (mem_is_lh | mem_is_lhu | mem_is_sh) ? (mem_alu_res[1] ? 4'b1100 : 4'b0011) :
+                                               (4'b0001 << mem_alu_res[1:0]);
+    wire       rvfi_is_store = mem_is_sb | mem_is_sh | mem_is_sw;
+    wire       rvfi_rd_we    = mem_we && (mem_rd != 5'b0);
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            rvfi_valid     <= 1'b0;
+            rvfi_order     <= 64'b0;
+            rvfi_count     <= 64'b0;
+            rvfi_insn      <= 32'b0;
+            rvfi_trap      <= 1'b0;
+            rvfi_intr      <= 1'b0;
+            rvfi_pc_rdata  <= 32'b0;
+            rvfi_pc_wdata  <= 32'b0;
+            rvfi_rs1_addr  <= 5'b0;
+            rvfi_rs2_addr  <= 5'b0;
+            rvfi_rs1_rdata <= 32'b0;
+            rvfi_rs2_rdata <= 32'b0;
+            rvfi_rd_addr   <= 5'b0;
+            rvfi_rd_wdata  <= 32'b0;
+            rvfi_mem_addr  <= 32'b0;
+            rvfi_mem_rmask <= 4'b0;
+            rvfi_mem_wmask <= 4'b0;
+            rvfi_mem_rdata <= 32'b0;
+            rvfi_mem_wdata <= 32'b0;
+        end else begin
+            rvfi_valid <= rvfi_retire;
+            if (rvfi_retire) begin
+                rvfi_order     <= rvfi_count;
+                rvfi_count     <= rvfi_count + 64'd1;
+                rvfi_insn      <= rvfi_ex_insn;
+                rvfi_trap      <= rvfi_ex_trap;
+                rvfi_intr      <= rvfi_ex_intr;
+                rvfi_pc_rdata  <= rvfi_ex_pc;
+                rvfi_pc_wdata  <= rvfi_ex_sys    ? rvfi_ex_next_pc  :
+                                  branch_flag_ex ? branch_target_ex :
+                                                   rvfi_ex_pc + 32'd4;
+                rvfi_rs1_addr  <= rvfi_ex_rs1;
+                rvfi_rs2_addr  <= rvfi_ex_rs2;
+                rvfi_rs1_rdata <= (rvfi_ex_rs1 != 5'b0) ? ex_op1 : 32'b0;
+                rvfi_rs2_rdata <= (rvfi_ex_rs2 != 5'b0) ? ex_op2 : 32'b0;
+                rvfi_rd_addr   <= rvfi_rd_we ? mem_rd   : 5'b0;
+                rvfi_rd_wdata  <= rvfi_rd_we ? wb_wdata : 32'b0;
+                rvfi_mem_addr  <= (ex_is_load | rvfi_is_store) ? {mem_alu_res[31:2], 2'b00} : 32'b0;
+                rvfi_mem_rmask <= ex_is_load    ? rvfi_lanes : 4'b0;
+                rvfi_mem_wmask <= rvfi_is_store ? rvfi_lanes : 4'b0;
+                rvfi_mem_rdata <= !ex_is_load     ? 32'b0           :
+                                  clint_read       ? clint_read_data :
+                                  wb_from_csr_mmio ? csr_mmio_read   :
+                                                     d_rdata;
+                rvfi_mem_wdata <= !rvfi_is_store ? 32'b0 :
+                                  mem_is_sh      ? {2{mem_store_data[15:0]}} :
+                                  mem_is_sb      ? {4{mem_store_data[7:0]}}  :
+                                                   mem_store_data;
+            end
+        end
+    end
+
 endmodule
@@ -1,76 +1,111 @@
 `timescale 1ns / 1ps
 
-module cpu_top (
+module cpu_top #(
+    // Stores queued between the core and the bus
+    parameter integer STORE_BUF_DEPTH  = 4,
+    // Caches in front of the external memory region (EXT_BASE)
+    parameter integer CACHE_WAYS       = 2,
+    parameter integer CACHE_SETS       = 64,
+    parameter integer CACHE_LINE_WORDS = 8,
+    // External memory: behavioural model until a DDR controller is added
+    parameter integer DDR_SIM_WORDS    = 1 << 20,
+    parameter integer DDR_LATENCY      = 20,
+    parameter         DDR_INIT_FILE    = "",
+    // UART receive FIFO
+    parameter integer UART_RX_FIFO_DEPTH = 64,
+    // DMA controller on data master d1
+    parameter integer DMA_CHANNELS     = 4,
+    parameter integer DMA_BURST        = 4,
+    // Compare/capture/PWM channels on mtime
+    parameter integer TIMER_CHANNELS   = 4,
+    // Mailbox (word FIFO, ISR -> task)
+    parameter integer MBOX_DEPTH       = 64,
+    // QSPI flash (XIP). FLASH_MODEL = 1 puts a behavioural flash on the
+    // qspi_* nets for simulation; the board build sets 0 and wires the pins.
+    parameter integer QSPI_LINES       = 16,
+    parameter integer QSPI_DUMMY_CLKS  = 6,
+    parameter integer FLASH_MODEL      = 1,
+    parameter integer FLASH_SIM_WORDS  = 1 << 16,
+    parameter         FLASH_INIT_FILE  = "",
+    // Simulation-only console / test finisher at SIM_BASE (sim_ctrl.v)
+    parameter integer SIM_CTRL         = 0
+)(
     input  wire        clk100,
     input  wire        rst_n,      // active-low reset (map to BTN1 if desired)
-    input  wire        btn0,       // unused (kept for compatibility)
-    input  wire [1:0]  sw,         // unused (kept for compatibility)
-    output wire [3:0]  led,
+    input  wire        btn0,       // GPIO 4, timer capture input 1
+    input  wire [1:0]  sw,         // GPIO 6:5, timer capture inputs 3:2
+    output wire [3:0]  led,        // GPIO 3:0 when set as outputs
     output wire        uart_tx,
-    input  wire        uart_rx
+    input  wire        uart_rx,
+    output wire        qspi_cs_n,
+    output wire        qspi_sck,
+    inout  wire [3:0]  qspi_dq
 );
-    // ROM (128 KB, 32768 words)
-    reg [31:0] instr_mem[0:32767];
-
-    // Data RAM (128 KB, 32768 words)
-    localparam integer DATA_WORDS = 32768;
-    reg [31:0] data_mem[0:DATA_WORDS-1];
+    // Memory map (ITCM/DTCM bases + sizes) - generated by firmware/memmap.py
+    `include "memmap.vh"
 
     integer i;
     initial begin
-        // Initialize ALL memory to 0 first (prevents X in simulation)
-        for (i = 0; i < 32768; i = i + 1) begin
-            instr_mem[i] = 32'h00000013;  // NOP instruction
-            data_mem[i] = 32'h0;
-        end
-        
         // Initialize UART FIFO to 0
         for (i = 0; i < UART_FIFO_DEPTH; i = i + 1) begin
             uart_fifo[i] = 8'h0;
         end
-        
-        // Try to load firmware from multiple possible paths
-        $readmemh("instr_mem.vh", instr_mem);
-        
-        // Copy code to data memory (unified memory model)
-        for (i = 0; i < DATA_WORDS; i = i + 1)
-            data_mem[i] = instr_mem[i];
-            
-        $display("[cpu_top] Memory initialized. instr_mem[0]=0x%08h", instr_mem[0]);
-    end
-
-    reg  [1:0]  instr_fetch_delay;
-
-    always @(posedge clk100 or negedge rst_n) begin
-        if (!rst_n)
-            instr_fetch_delay <= 2'd0;
-        else if (instr_fetch_delay != 2'd2)
-            instr_fetch_delay <= instr_fetch_delay + 1;
     end
 
-    // CPU core wires
+    // CPU core buses
     wire [31:0] pc;
-    wire        instr_ready = (instr_fetch_delay == 2'd2);
-    wire [13:0] instr_idx = instr_ready ? pc[15:2] : 14'd0;
-    wire [31:0] instr = instr_mem[instr_idx];
-    wire [31:0] d_addr, d_wdata;
-    wire [31:0] d_rdata;
-    wire        d_we;
+    wire        i_req, i_ack;
+    wire [31:0] i_addr, i_rdata;
+    wire        d_req, d_we, d_ack;
+    wire [3:0]  d_be;
+    wire [31:0] d_addr, d_wdata, d_rdata;
+    wire        sb_req, sb_we, sb_ack, sb_empty;
+    wire [3:0]  sb_be;
+    wire [31:0] sb_addr, sb_wdata, sb_rdata;
+    wire        dma_req, dma_we, dma_ack;
+    wire [3:0]  dma_be;
+    wire [31:0] dma_addr, dma_wdata, dma_rdata;
     wire        is_sw, is_sh, is_sb;
     wire [31:0] rs2_val;
     wire [31:0] wb_value;
 
-    localparam [31:0] UART_TX_ADDR     = 32'hFFFF_FFF0;
-    localparam [31:0] UART_STATUS_ADDR = 32'hFFFF_FFF4;
-    localparam [31:0] UART_RX_ADDR     = 32'hFFFF_FFF8;
-    localparam [31:0] RAM_BASE         = 32'h0000_0000;
-    localparam [31:0] RAM_END          = (DATA_WORDS * 4) - 1;
-    localparam [31:0] CLINT_BASE       = 32'hFFFF_0000;
-    localparam [31:0] CLINT_END        = 32'hFFFF_001F;
-    localparam [31:0] CSR_MTVEC_ADDR   = 32'hFFFF_FFC0;
-    localparam [31:0] CSR_MSTATUS_ADDR = 32'hFFFF_FFC4;
-    localparam [31:0] CSR_MEPC_ADDR    = 32'hFFFF_FFC8;
-    localparam [31:0] CSR_MCAUSE_ADDR  = 32'hFFFF_FFCC;
+    // Slave ports
+    wire        itcm_i_req;
+    wire [31:0] itcm_i_addr, itcm_i_rdata;
+    wire        itcm_d_req, itcm_d_we;
+    wire [3:0]  itcm_d_be;
+    wire [31:0] itcm_d_addr, itcm_d_wdata, itcm_d_rdata;
+    reg         itcm_d_ack;
+    wire        dtcm_req, dtcm_we;
+    wire [3:0]  dtcm_be;
+    wire [31:0] dtcm_addr, dtcm_wdata, dtcm_rdata;
+    reg         dtcm_ack;
+    wire        io_req, io_we;
+    wire [3:0]  io_be;
+    wire [31:0] io_addr, io_wdata;
+    wire [31:0] io_rdata;
+    wire        io_ack;
+    wire        ext_i_req, ext_i_ack;
+    wire [31:0] ext_i_addr, ext_i_rdata;
+    wire        ext_d_req, ext_d_we, ext_d_ack;
+    wire [3:0]  ext_d_be;
+    wire [31:0] ext_d_addr, ext_d_wdata, ext_d_rdata;
+    wire        flash_i_req, flash_i_ack;
+    wire [31:0] flash_i_addr, flash_i_rdata;
+    wire        flash_d_req, flash_d_we, flash_d_ack;
+    wire [3:0]  flash_d_be;
+    wire [31:0] flash_d_addr, flash_d_wdata, flash_d_rdata;
+    wire        fence_req, fence_i;
+
+    // UART registers (UART_BASE from memmap.vh; TX/STATUS/RX keep their
+    // original addresses 0xFFFF_FFF0/4/8)
+    localparam [31:0] UART_CTRL_ADDR   = UART_BASE + 32'h00;
+    localparam [31:0] UART_IRQ_ADDR    = UART_BASE + 32'h04;
+    localparam [31:0] UART_COUNT_ADDR  = UART_BASE + 32'h08;
+    localparam [31:0] UART_BAUD_ADDR   = UART_BASE + 32'h0C;
+    localparam [31:0] UART_TX_ADDR     = UART_BASE + 32'h10;
+    localparam [31:0] UART_STATUS_ADDR = UART_BASE + 32'h14;
+    localparam [31:0] UART_RX_ADDR     = UART_BASE + 32'h18;
     localparam integer UART_FIFO_DEPTH = 256;
 
     (* dont_touch = "true" *) reg [7:0] uart_fifo [0:UART_FIFO_DEPTH-1];
@@ -78,95 +113,587 @@ module cpu_top (
     (* dont_touch = "true" *) reg [7:0] uart_rd_ptr;
     (* dont_touch = "true" *) reg [8:0] uart_fifo_count;
     (* dont_touch = "true" *) reg [7:0] uart_byte;
+    reg  uart_start;
+    wire uart_busy;
 
-    // Data RAM read
-    wire [13:0] data_idx = d_addr[15:2];
-    wire is_uart_tx      = (d_addr == UART_TX_ADDR);
-    wire is_uart_status  = (d_addr == UART_STATUS_ADDR);
-    wire mem_sel = ~(is_uart_tx | is_uart_status);
-    wire ram_access = (d_addr >= RAM_BASE) && (d_addr <= RAM_END);
-    wire clint_access = (d_addr >= CLINT_BASE) && (d_addr <= CLINT_END);
-    wire csr_mmio_access =
-        (d_addr == CSR_MTVEC_ADDR) ||
-        (d_addr == CSR_MSTATUS_ADDR) ||
-        (d_addr == CSR_MEPC_ADDR) ||
-        (d_addr == CSR_MCAUSE_ADDR);
     wire uart_fifo_empty = (uart_fifo_count == 0);
     wire uart_fifo_full  = (uart_fifo_count == UART_FIFO_DEPTH);
-    
-    // UART RX handling - latch received data until CPU reads it
-    reg [7:0] rx_data_reg;
-    reg       rx_data_valid;
-    wire is_uart_rx = (d_addr == UART_RX_ADDR);
-    wire uart_rx_read = is_uart_rx && !d_we;  // CPU reading RX register
-    
+
+    // Core stores are queued here and drained in idle data cycles
+    store_buffer #(
+        .DEPTH(STORE_BUF_DEPTH)
+    ) u_sbuf (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .s_req(d_req), .s_addr(d_addr), .s_we(d_we), .s_be(d_be),
+        .s_wdata(d_wdata), .s_rdata(d_rdata), .s_ack(d_ack),
+        .m_req(sb_req), .m_addr(sb_addr), .m_we(sb_we), .m_be(sb_be),
+        .m_wdata(sb_wdata), .m_rdata(sb_rdata), .m_ack(sb_ack),
+        .empty(sb_empty)
+    );
+
+    // System bus: region decode + per-slave arbitration (d1 = DMA)
+    bus_xbar u_xbar (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .i_req(i_req), .i_addr(i_addr), .i_rdata(i_rdata), .i_ack(i_ack),
+        .d0_req(sb_req), .d0_addr(sb_addr), .d0_we(sb_we), .d0_be(sb_be),
+        .d0_wdata(sb_wdata), .d0_rdata(sb_rdata), .d0_ack(sb_ack),
+        .d1_req(dma_req), .d1_addr(dma_addr), .d1_we(dma_we), .d1_be(dma_be),
+        .d1_wdata(dma_wdata), .d1_rdata(dma_rdata), .d1_ack(dma_ack),
+        .itcm_i_req(itcm_i_req), .itcm_i_addr(itcm_i_addr), .itcm_i_rdata(itcm_i_rdata),
+        .itcm_d_req(itcm_d_req), .itcm_d_addr(itcm_d_addr), .itcm_d_we(itcm_d_we),
+        .itcm_d_be(itcm_d_be), .itcm_d_wdata(itcm_d_wdata), .itcm_d_rdata(itcm_d_rdata),
+        .itcm_d_ack(itcm_d_ack),
+        .dtcm_req(dtcm_req), .dtcm_addr(dtcm_addr), .dtcm_we(dtcm_we), .dtcm_be(dtcm_be),
+        .dtcm_wdata(dtcm_wdata), .dtcm_rdata(dtcm_rdata), .dtcm_ack(dtcm_ack),
+        .io_req(io_req), .io_addr(io_addr), .io_we(io_we), .io_be(io_be),
+        .io_wdata(io_wdata), .io_rdata(io_rdata), .io_ack(io_ack),
+        .ext_i_req(ext_i_req), .ext_i_addr(ext_i_addr), .ext_i_rdata(ext_i_rdata),
+        .ext_i_ack(ext_i_ack),
+        .ext_d_req(ext_d_req), .ext_d_addr(ext_d_addr), .ext_d_we(ext_d_we),
+        .ext_d_be(ext_d_be), .ext_d_wdata(ext_d_wdata), .ext_d_rdata(ext_d_rdata),
+        .ext_d_ack(ext_d_ack),
+        .flash_i_req(flash_i_req), .flash_i_addr(flash_i_addr),
+        .flash_i_rdata(flash_i_rdata), .flash_i_ack(flash_i_ack),
+        .flash_d_req(flash_d_req), .flash_d_addr(flash_d_addr), .flash_d_we(flash_d_we),
+        .flash_d_be(flash_d_be), .flash_d_wdata(flash_d_wdata),
+        .flash_d_rdata(flash_d_rdata), .flash_d_ack(flash_d_ack)
+    );
+
+    // TCMs answer every request on the next cycle (no wait states)
     always @(posedge clk100 or negedge rst_n) begin
         if (!rst_n) begin
-            rx_data_reg <= 8'd0;
-            rx_data_valid <= 1'b0;
+            itcm_d_ack <= 1'b0;
+            dtcm_ack   <= 1'b0;
         end else begin
-            if (rx_valid) begin
-                // New byte received from UART
-                rx_data_reg <= rx_data;
-                rx_data_valid <= 1'b1;
-            end else if (uart_rx_read) begin
-                // CPU read the byte, clear valid flag
-                rx_data_valid <= 1'b0;
-            end
+            itcm_d_ack <= itcm_d_req;
+            dtcm_ack   <= dtcm_req;
         end
     end
-    
-    // Status register: bit 0 = TX busy, bit 1 = TX FIFO full, bit 2 = RX valid
-    wire [31:0] uart_status = {29'b0, rx_data_valid, uart_fifo_full, uart_busy};
-    
-    assign d_rdata =
+
+    // ITCM: code + rodata + .data image. Port A = fetch, port B = load/store
+    // (port B also lets the bootloader write code that fetch then executes)
+    dp_bram #(
+        .WORDS(ITCM_WORDS),
+        .ADDR_BITS(ITCM_ADDR_BITS),
+        .INIT_FILE("instr_mem.vh"),
+        .FILL(32'h0)                // as the padded image / the ISS
+    ) u_itcm (
+        .clk(clk100),
+        .a_en(itcm_i_req),
+        .a_we(4'b0000),
+        .a_addr(itcm_i_addr[ITCM_ADDR_BITS+1:2]),
+        .a_din(32'b0),
+        .a_dout(itcm_i_rdata),
+        .b_en(itcm_d_req),
+        .b_we(itcm_d_we ? itcm_d_be : 4'b0000),
+        .b_addr(itcm_d_addr[ITCM_ADDR_BITS+1:2]),
+        .b_din(itcm_d_wdata),
+        .b_dout(itcm_d_rdata)
+    );
+
+    // DTCM: .data/.bss/heap/stack, data port only (port A unused)
+    dp_bram #(
+        .WORDS(DTCM_WORDS),
+        .ADDR_BITS(DTCM_ADDR_BITS),
+        .INIT_FILE("")
+    ) u_dtcm (
+        .clk(clk100),
+        .a_en(1'b0),
+        .a_we(4'b0000),
+        .a_addr({DTCM_ADDR_BITS{1'b0}}),
+        .a_din(32'b0),
+        .a_dout(),
+        .b_en(dtcm_req),
+        .b_we(dtcm_we ? dtcm_be : 4'b0000),
+        .b_addr(dtcm_addr[DTCM_ADDR_BITS+1:2]),
+        .b_din(dtcm_wdata),
+        .b_dout(dtcm_rdata)
+    );
+
+    // ------------------------------------------------------------
+    // External memory: I-cache + D-cache share one burst port
+    // ------------------------------------------------------------
+    wire        ic_mem_req, ic_mem_we, ic_mem_wready, ic_mem_rvalid, ic_mem_done;
+    wire [31:0] ic_mem_addr, ic_mem_wdata, ic_mem_rdata;
+    wire        dc_mem_req, dc_mem_we, dc_mem_wready, dc_mem_rvalid, dc_mem_done;
+    wire [31:0] dc_mem_addr, dc_mem_wdata, dc_mem_rdata;
+    wire        ddr_req, ddr_we, ddr_wready, ddr_rvalid, ddr_done;
+    wire [31:0] ddr_addr, ddr_wdata, ddr_rdata;
+    wire        dc_flush_done, ic_inv_done;
+
+    // fence: drain the store buffer, then clean the D-cache.
+    // fence.i: also drop the I-cache afterwards.
+    wire dc_flush_req = fence_req && sb_empty;
+    wire fence_done   = dc_flush_done && (!fence_i || ic_inv_done);
+
+    icache #(
+        .WAYS(CACHE_WAYS),
+        .SETS(CACHE_SETS),
+        .LINE_WORDS(CACHE_LINE_WORDS)
+    ) u_icache (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .i_req(ext_i_req),
+        .i_addr(ext_i_addr),
+        .i_rdata(ext_i_rdata),
+        .i_ack(ext_i_ack),
+        .inv_req(dc_flush_req && fence_i && dc_flush_done),
+        .inv_done(ic_inv_done),
+        .mem_req(ic_mem_req),
+        .mem_we(ic_mem_we),
+        .mem_addr(ic_mem_addr),
+        .mem_wdata(ic_mem_wdata),
+        .mem_wready(ic_mem_wready),
+        .mem_rvalid(ic_mem_rvalid),
+        .mem_rdata(ic_mem_rdata),
+        .mem_done(ic_mem_done)
+    );
+
+    dcache #(
+        .WAYS(CACHE_WAYS),
+        .SETS(CACHE_SETS),
+        .LINE_WORDS(CACHE_LINE_WORDS)
+    ) u_dcache (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .s_req(ext_d_req),
+        .s_addr(ext_d_addr),
+        .s_we(ext_d_we),
+        .s_be(ext_d_be),
+        .s_wdata(ext_d_wdata),
+        .s_rdata(ext_d_rdata),
+        .s_ack(ext_d_ack),
+        .flush_req(dc_flush_req),
+        .flush_done(dc_flush_done),
+        .mem_req(dc_mem_req),
+        .mem_we(dc_mem_we),
+        .mem_addr(dc_mem_addr),
+        .mem_wdata(dc_mem_wdata),
+        .mem_wready(dc_mem_wready),
+        .mem_rvalid(dc_mem_rvalid),
+        .mem_rdata(dc_mem_rdata),
+        .mem_done(dc_mem_done)
+    );
+
+    burst_arbiter u_burst_arb (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .m0_req(dc_mem_req), .m0_we(dc_mem_we), .m0_addr(dc_mem_addr),
+        .m0_wdata(dc_mem_wdata), .m0_wready(dc_mem_wready), .m0_rvalid(dc_mem_rvalid),
+        .m0_rdata(dc_mem_rdata), .m0_done(dc_mem_done),
+        .m1_req(ic_mem_req), .m1_we(ic_mem_we), .m1_addr(ic_mem_addr),
+        .m1_wdata(ic_mem_wdata), .m1_wready(ic_mem_wready), .m1_rvalid(ic_mem_rvalid),
+        .m1_rdata(ic_mem_rdata), .m1_done(ic_mem_done),
+        .s_req(ddr_req), .s_we(ddr_we), .s_addr(ddr_addr), .s_wdata(ddr_wdata),
+        .s_wready(ddr_wready), .s_rvalid(ddr_rvalid), .s_rdata(ddr_rdata), .s_done(ddr_done)
+    );
+
+    ddr_model #(
+        .WORDS(DDR_SIM_WORDS),
+        .LATENCY(DDR_LATENCY),
+        .LINE_WORDS(CACHE_LINE_WORDS),
+        .INIT_FILE(DDR_INIT_FILE)
+    ) u_ddr (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .mem_req(ddr_req),
+        .mem_we(ddr_we),
+        .mem_addr(ddr_addr),
+        .mem_wdata(ddr_wdata),
+        .mem_wready(ddr_wready),
+        .mem_rvalid(ddr_rvalid),
+        .mem_rdata(ddr_rdata),
+        .mem_done(ddr_done)
+    );
+
+    // ------------------------------------------------------------
+    // IO region. The request is latched, then completes (ack) in the first
+    // cycle its device is ready; register side effects happen on that ack
+    // edge. A TX write while the FIFO is full waits here instead of being
+    // dropped. Unknown IO addresses read as 0.
+    // ------------------------------------------------------------
+    reg        io_busy;
+    reg [31:0] io_addr_q, io_wdata_q;
+    reg        io_we_q;
+    reg [3:0]  io_be_q;
+
+    always @(posedge clk100 or negedge rst_n) begin
+        if (!rst_n) begin
+            io_busy    <= 1'b0;
+            io_addr_q  <= 32'b0;
+            io_wdata_q <= 32'b0;
+            io_we_q    <= 1'b0;
+            io_be_q    <= 4'b0;
+        end else if (io_req) begin
+            io_busy    <= 1'b1;
+            io_addr_q  <= io_addr;
+            io_wdata_q <= io_wdata;
+            io_we_q    <= io_we;
+            io_be_q    <= io_be;
+        end else if (io_ack) begin
+            io_busy    <= 1'b0;
+        end
+    end
+
+    wire is_uart_tx      = (io_addr_q == UART_TX_ADDR);
+    wire is_uart_status  = (io_addr_q == UART_STATUS_ADDR);
+    wire is_uart_rx      = (io_addr_q == UART_RX_ADDR);
+    wire is_uart_ctrl    = (io_addr_q == UART_CTRL_ADDR);
+    wire is_uart_irq     = (io_addr_q == UART_IRQ_ADDR);
+    wire is_uart_count   = (io_addr_q == UART_COUNT_ADDR);
+    wire is_uart_baud    = (io_addr_q == UART_BAUD_ADDR);
+    wire is_irqc         = (io_addr_q[31:8] == IRQC_BASE[31:8]);
+    wire is_dma          = (io_addr_q[31:8] == DMA_BASE[31:8]);
+    wire is_timer        = (io_addr_q[31:8] == TIMER_BASE[31:8]);
+    wire is_qspi         = (io_addr_q[31:8] == QSPI_BASE[31:8]);
+    wire is_crc          = (io_addr_q[31:8] == CRC_BASE[31:8]);
+    wire is_mbox         = (io_addr_q[31:8] == MBOX_BASE[31:8]);
+    wire is_sema         = (io_addr_q[31:8] == SEMA_BASE[31:8]);
+    wire is_gpio         = (io_addr_q[31:8] == GPIO_BASE[31:8]);
+    wire is_sim          = (io_addr_q[31:8] == SIM_BASE[31:8]);
+    wire uart_tx_wait    = io_we_q && is_uart_tx && uart_fifo_full;
+    assign io_ack        = io_busy && !uart_tx_wait;
+    wire io_wr           = io_ack && io_we_q;
+
+    // ------------------------------------------------------------
+    // UART RX: FIFO + error flags + interrupt, TX FIFO low watermark
+    //   CTRL   [0] irq when COUNT >= threshold, [1] irq on idle timeout,
+    //          [2] irq on overrun/framing error, [3] irq on TX low water,
+    //          [15:8] threshold, [23:16] idle timeout in bit periods,
+    //          [31:24] TX low watermark (TX FIFO bytes <= this)
+    //   IRQ    [0] threshold reached, [1] idle timeout, [2] overrun,
+    //          [3] framing error, [4] TX low water; write 1 to [2]/[3]
+    //          to clear
+    //   COUNT  [15:0] RX FIFO bytes, [31:16] TX FIFO bytes
+    //   BAUD   [19:0] bit period in clocks * 16 (4 fractional bits), shared
+    //          by RX and TX; reset value UART_DIV (memmap.py). Change it
+    //          only with both directions idle.
+    // Reading RX pops the FIFO (returns 0 when empty).
+    // ------------------------------------------------------------
+    reg [19:0] uart_baud;
+
+    always @(posedge clk100 or negedge rst_n) begin
+        if (!rst_n)
+            uart_baud <= UART_DIV;
+        else if (io_wr && is_uart_baud && io_wdata_q[19:4] >= 16'd4)
+            uart_baud <= io_wdata_q[19:0];
+    end
+
+    // UART receiver -> u_rx_fifo
+    wire [7:0] rx_data;
+    wire       rx_valid;
+    wire       rx_ferr;
+    uart_rx #(
+        .PAYLOAD_BITS(8)
+    ) U_RX (
+        .clk(clk100),
+        .resetn(rst_n),
+        .divisor(uart_baud),
+        .uart_rxd(uart_rx),
+        .uart_rx_en(1'b1),
+        .uart_rx_break(),
+        .uart_rx_valid(rx_valid),
+        .uart_rx_ferr(rx_ferr),
+        .uart_rx_data(rx_data)
+    );
+
+    reg  [31:0] uart_ctrl;
+    wire [7:0]  rxf_head;
+    wire [$clog2(UART_RX_FIFO_DEPTH):0] rxf_count;
+    wire        rxf_empty, rxf_full, rxf_overrun, rxf_ferr, rxf_thr, rxf_timeout;
+    wire uart_rx_read = io_ack && !io_we_q && is_uart_rx;   // CPU reading RX register
+
+    always @(posedge clk100 or negedge rst_n) begin
+        if (!rst_n)
+            uart_ctrl <= 32'h0;
+        else if (io_wr && is_uart_ctrl)
+            uart_ctrl <= io_wdata_q;
+    end
+
+    uart_rx_fifo #(
+        .DEPTH(UART_RX_FIFO_DEPTH)
+    ) u_rx_fifo (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .rx_valid(rx_valid),
+        .rx_data(rx_data),
+        .rx_ferr(rx_ferr),
+        .pop(uart_rx_read),
+        .head(rxf_head),
+        .count(rxf_count),
+        .empty(rxf_empty),
+        .full(rxf_full),
+        .overrun(rxf_overrun),
+        .ferr(rxf_ferr),
+        .clr_overrun(io_wr && is_uart_irq && io_wdata_q[2]),
+        .clr_ferr(io_wr && is_uart_irq && io_wdata_q[3]),
+        .bit_cycles(uart_baud[19:4]),
+        .threshold(uart_ctrl[15:8]),
+        .timeout_bits(uart_ctrl[23:16]),
+        .thr_hit(rxf_thr),
+        .timeout(rxf_timeout)
+    );
+
+    // TX low water: level, the handler refills the FIFO above the mark or
+    // clears CTRL[3] once it has nothing left to send
+    wire       uart_tx_low = (uart_fifo_count <= {1'b0, uart_ctrl[31:24]});
+    wire [4:0] uart_irq_flags = {uart_tx_low, rxf_ferr, rxf_overrun, rxf_timeout, rxf_thr};
+    wire       uart_irq = |(uart_irq_flags & {uart_ctrl[3:2], uart_ctrl[2:0]});
+
+    // Status register: bit 0 = TX busy (also covers the byte just popped
+    // for uart_tx), bit 1 = TX FIFO full, bit 2 = RX data available,
+    // bit 3 = RX overrun, bit 4 = RX framing error, bit 5 = RX FIFO full
+    wire [31:0] uart_status = {26'b0, rxf_full, rxf_ferr, rxf_overrun, !rxf_empty,
+                               uart_fifo_full, uart_busy | uart_start};
+
+    // ------------------------------------------------------------
+    // DMA controller (bus master d1). Request line 1 paces writes to the
+    // UART TX register: one slot of margin because the FIFO count only
+    // moves after the write that was just acked.
+    // ------------------------------------------------------------
+    wire [31:0] dma_regs_rdata;
+    wire        dma_irq;
+
+    dma #(
+        .NCH(DMA_CHANNELS),
+        .BURST(DMA_BURST)
+    ) u_dma (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .wr(io_wr && is_dma),
+        .addr(io_addr_q[7:0]),
+        .wdata(io_wdata_q),
+        .rdata(dma_regs_rdata),
+        .dreq({2'b00, uart_fifo_count < UART_FIFO_DEPTH - 1}),
+        .m_req(dma_req), .m_addr(dma_addr), .m_we(dma_we), .m_be(dma_be),
+        .m_wdata(dma_wdata), .m_rdata(dma_rdata), .m_ack(dma_ack),
+        .irq(dma_irq)
+    );
+
+    // ------------------------------------------------------------
+    // Timer channels on mtime. Capture inputs: 0 = UART RX pin (baud
+    // measurement), 1 = btn0, 2/3 = sw[1:0]. PWM channel 0 drives led[3].
+    // ------------------------------------------------------------
+    wire [31:0] mtime;
+    wire [31:0] timer_rdata;
+    wire [TIMER_CHANNELS-1:0] timer_pwm;
+    wire        timer_irq;
+
+    timer #(
+        .NCH(TIMER_CHANNELS)
+    ) u_timer (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .mtime(mtime),
+        .wr(io_wr && is_timer),
+        .addr(io_addr_q[7:0]),
+        .wdata(io_wdata_q),
+        .rdata(timer_rdata),
+        .cap_in({sw, btn0, uart_rx}),
+        .pwm(timer_pwm),
+        .irq(timer_irq)
+    );
+
+    // ------------------------------------------------------------
+    // QSPI flash, executed in place (FLASH region)
+    // ------------------------------------------------------------
+    wire [31:0] qspi_rdata;
+    wire [3:0]  qspi_dq_o, qspi_dq_oe;
+
+    qspi_xip #(
+        .LINES(QSPI_LINES),
+        .LINE_WORDS(CACHE_LINE_WORDS),
+        .DUMMY_CLKS(QSPI_DUMMY_CLKS)
+    ) u_qspi (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .i_req(flash_i_req), .i_addr(flash_i_addr), .i_rdata(flash_i_rdata),
+        .i_ack(flash_i_ack),
+        .d_req(flash_d_req), .d_addr(flash_d_addr), .d_we(flash_d_we),
+        .d_rdata(flash_d_rdata), .d_ack(flash_d_ack),
+        .wr(io_wr && is_qspi),
+        .addr(io_addr_q[7:0]),
+        .wdata(io_wdata_q),
+        .rdata(qspi_rdata),
+        .sck(qspi_sck),
+        .cs_n(qspi_cs_n),
+        .dq_o(qspi_dq_o),
+        .dq_oe(qspi_dq_oe),
+        .dq_i(qspi_dq)
+    );
+
+    genvar q;
+    generate
+        for (q = 0; q < 4; q = q + 1) begin : g_qspi_dq
+            assign qspi_dq[q] = qspi_dq_oe[q] ? qspi_dq_o[q] : 1'bz;
+        end
+        if (FLASH_MODEL) begin : g_flash_model
+            qspi_flash_model #(
+                .WORDS(FLASH_SIM_WORDS),
+                .DUMMY_CLKS(QSPI_DUMMY_CLKS),
+                .INIT_FILE(FLASH_INIT_FILE)
+            ) u_flash (
+                .sck(qspi_sck),
+                .cs_n(qspi_cs_n),
+                .dq(qspi_dq)
+            );
+        end
+    endgenerate
+
+    // ------------------------------------------------------------
+    // CRC engine (byte enables select the bytes fed)
+    // ------------------------------------------------------------
+    wire [31:0] crc_rdata;
+
+    crc u_crc (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .wr(io_wr && is_crc),
+        .addr(io_addr_q[7:0]),
+        .wdata(io_wdata_q),
+        .be(io_be_q),
+        .rdata(crc_rdata)
+    );
+
+    // ------------------------------------------------------------
+    // Mailbox: reading DATA pops, like the UART RX register
+    // ------------------------------------------------------------
+    wire [31:0] mbox_rdata;
+    wire        mbox_irq;
+
+    mbox #(
+        .DEPTH(MBOX_DEPTH)
+    ) u_mbox (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .wr(io_wr && is_mbox),
+        .rd(io_ack && !io_we_q && is_mbox),
+        .addr(io_addr_q[7:0]),
+        .wdata(io_wdata_q),
+        .rdata(mbox_rdata),
+        .irq(mbox_irq)
+    );
+
+    // ------------------------------------------------------------
+    // Hardware semaphores: reading a lock register is the test-and-set
+    // ------------------------------------------------------------
+    wire [31:0] sema_rdata;
+
+    sema #(
+        .N(32)
+    ) u_sema (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .wr(io_wr && is_sema),
+        .rd(io_ack && !io_we_q && is_sema),
+        .addr(io_addr_q[7:0]),
+        .wdata(io_wdata_q),
+        .rdata(sema_rdata)
+    );
+
+    // ------------------------------------------------------------
+    // GPIO: pins 3:0 = led (GPIO drives an LED once its DIR bit is set,
+    // otherwise it shows its debug function), 4 = btn0, 6:5 = sw[1:0].
+    // The inputs also stay timer capture inputs.
+    // ------------------------------------------------------------
+    wire [31:0] gpio_rdata;
+    wire [6:0]  gpio_o, gpio_oe;
+    wire        gpio_irq;
+    wire [3:0]  led_func;
+
+    gpio #(
+        .W(7),
+        .OUT_MASK(7'b000_1111)
+    ) u_gpio (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .wr(io_wr && is_gpio),
+        .addr(io_addr_q[7:0]),
+        .wdata(io_wdata_q),
+        .rdata(gpio_rdata),
+        .pin_i({sw, btn0, led}),
+        .pin_o(gpio_o),
+        .pin_oe(gpio_oe),
+        .irq(gpio_irq)
+    );
+
+    // ------------------------------------------------------------
+    // Interrupt controller -> core external interrupt
+    // ------------------------------------------------------------
+    wire [31:0] irqc_rdata;
+    wire        ext_irq;
+    wire [7:0]  irq_src;
+
+    assign irq_src[IRQ_UART]  = uart_irq;
+    assign irq_src[IRQ_DMA]   = dma_irq;
+    assign irq_src[IRQ_TIMER] = timer_irq;
+    assign irq_src[IRQ_MBOX]  = mbox_irq;
+    assign irq_src[IRQ_GPIO]  = gpio_irq;
+    assign irq_src[7:5]       = 3'b0;
+
+    irq_ctrl #(
+        .N(8)
+    ) u_irqc (
+        .clk(clk100),
+        .rst_n(rst_n),
+        .src(irq_src),
+        .wr(io_wr && is_irqc),
+        .addr(io_addr_q[7:0]),
+        .wdata(io_wdata_q),
+        .rdata(irqc_rdata),
+        .irq(ext_irq)
+    );
+
+    // ------------------------------------------------------------
+    // Simulation console / finisher (SIM_CTRL = 1 only; reads 0 otherwise)
+    // ------------------------------------------------------------
+    wire [31:0] sim_rdata;
+
+    generate
+        if (SIM_CTRL) begin : g_sim_ctrl
+            sim_ctrl u_sim_ctrl (
+                .clk(clk100),
+                .rst_n(rst_n),
+                .wr(io_wr && is_sim),
+                .addr(io_addr_q[7:0]),
+                .wdata(io_wdata_q),
+                .rdata(sim_rdata),
+                .exit(),
+                .exit_code()
+            );
+        end else begin : g_no_sim_ctrl
+            assign sim_rdata = 32'h0;
+        end
+    endgenerate
+
+    assign io_rdata =
         is_uart_status    ? uart_status :
-        is_uart_rx        ? {24'b0, rx_data_reg} :
-        ram_access        ? data_mem[data_idx] :
-        clint_access      ? 32'h0 :
-        csr_mmio_access   ? 32'h0 :
+        is_uart_rx        ? (rxf_empty ? 32'h0 : {24'b0, rxf_head}) :
+        is_uart_ctrl      ? uart_ctrl :
+        is_uart_irq       ? {27'b0, uart_irq_flags} :
+        is_uart_baud      ? {12'b0, uart_baud} :
+        is_uart_count     ? {7'b0, uart_fifo_count, {(16-$clog2(UART_RX_FIFO_DEPTH)-1){1'b0}}, rxf_count} :
+        is_irqc           ? irqc_rdata :
+        is_dma            ? dma_regs_rdata :
+        is_timer          ? timer_rdata :
+        is_qspi           ? qspi_rdata :
+        is_crc            ? crc_rdata :
+        is_mbox           ? mbox_rdata :
+        is_sema           ? sema_rdata :
+        is_gpio           ? gpio_rdata :
+        is_sim            ? sim_rdata :
         32'h0;
 
     // UART TX handling with FIFO buffering
-    wire uart_busy;
-    reg  uart_start;
-    // CRITICAL: Stall CPU until instr_fetch_delay is complete!
-    // Without this, PC increments while instr_idx is forced to 0,
-    // causing auipc to see wrong id_pc value (4 instead of 0)
-    wire step_pulse = instr_ready;
-    wire write_enable    = d_we;
-    wire write_mem       = write_enable && mem_sel && ram_access;
-    wire uart_mmio_write = d_we && is_uart_tx;
-    wire push_fifo       = uart_mmio_write && !uart_fifo_full;
+    wire uart_mmio_write = io_ack && io_we_q && is_uart_tx;
+    wire push_fifo       = uart_mmio_write;     // io_ack already waited for space
     
     // Pop only when idle and FIFO has data, but NOT while uart_start is still high
     // This prevents double-popping during the 1-cycle gap before uart_tx sees uart_start
     wire pop_fifo        = (!uart_busy) && !uart_fifo_empty && !uart_start;
 
-    // Data RAM writes
-    reg [31:0] w;
-    always @(posedge clk100) begin
-        if (write_mem) begin
-            w = data_mem[data_idx];
-            if (is_sw) begin
-                w = d_wdata;
-            end else if (is_sh) begin
-                case (d_addr[1])
-                    1'b0: w[15:0]  = d_wdata[15:0];
-                    1'b1: w[31:16] = d_wdata[15:0];
-                endcase
-            end else if (is_sb) begin
-                case (d_addr[1:0])
-                    2'b00: w[7:0]   = d_wdata[7:0];
-                    2'b01: w[15:8]  = d_wdata[7:0];
-                    2'b10: w[23:16] = d_wdata[7:0];
-                    2'b11: w[31:24] = d_wdata[7:0];
-                endcase
-            end
-            data_mem[data_idx] <= w;
-        end
-    end
-
     always @(posedge clk100 or negedge rst_n) begin
         if (!rst_n) begin
             uart_start      <= 1'b0;
@@ -178,7 +705,7 @@ module cpu_top (
             uart_start <= 1'b0;
 
             if (push_fifo) begin
-                uart_fifo[uart_wr_ptr] <= d_wdata[7:0];
+                uart_fifo[uart_wr_ptr] <= io_wdata_q[7:0];
                 uart_wr_ptr <= uart_wr_ptr + 1'b1;
             end
 
@@ -196,18 +723,29 @@ module cpu_top (
         end
     end
 
-    // CPU core
+    // CPU core. Memory readiness is now signalled per request over the bus,
+    // so the old global fetch-delay hold (step_pulse) is tied off.
     cpu_core u_cpu (
         .clk(clk100),
         .rst_n(rst_n),
-        .step_pulse(step_pulse),
-        .irq_i(1'b0),
+        .step_pulse(1'b1),
+        .irq_i(ext_irq),
         .pc_o(pc),
-        .instr_i(instr),
+        .i_req(i_req),
+        .i_addr(i_addr),
+        .i_rdata(i_rdata),
+        .i_ack(i_ack),
+        .d_req(d_req),
         .d_addr(d_addr),
+        .d_we(d_we),
+        .d_be(d_be),
         .d_wdata(d_wdata),
         .d_rdata(d_rdata),
-        .d_we(d_we),
+        .d_ack(d_ack),
+        .fence_req_o(fence_req),
+        .fence_i_o(fence_i),
+        .fence_done_i(fence_done),
+        .mtime_o(mtime),
         .wb_value(wb_value),
         .is_sw_o(is_sw),
         .is_sh_o(is_sh),
@@ -215,30 +753,11 @@ module cpu_top (
         .rs2_val_o(rs2_val)
     );
 
-    // UART RX (available for future use)
-    wire [7:0] rx_data;
-    wire       rx_valid;
-    uart_rx #(
-        .CLK_HZ(25_000_000),     // 25 MHz after clock divider (100/4)
-        .BIT_RATE(115200),
-        .PAYLOAD_BITS(8)
-    ) U_RX (
-        .clk(clk100),
-        .resetn(rst_n),
-        .uart_rxd(uart_rx),
-        .uart_rx_en(1'b1),
-        .uart_rx_break(),
-        .uart_rx_valid(rx_valid),
-        .uart_rx_data(rx_data)
-    );
-
     // UART TX direct to the pin (no extra register)
-    uart_tx #(
-        .CLK_FREQ(25_000_000),   // 25 MHz after clock divider (100/4)
-        .BAUD(115200)
-    ) U_TX (
+    uart_tx U_TX (
         .clk(clk100),
         .rst(~rst_n),
+        .divisor(uart_baud),
         .tx_start(uart_start),
         .tx_data(uart_byte),
         .tx(uart_tx),
@@ -254,9 +773,10 @@ module cpu_top (
             heartbeat_ctr <= heartbeat_ctr + 1'b1;
     end
 
-    // LED debug
-    assign led[0] = heartbeat_ctr[25];                 // heartbeat blinker
-    assign led[1] = uart_busy;                        // pulse when UART write occurs
-    assign led[2] = (pc[15:0] != 16'h0000);            // PC running
-    assign led[3] = 1'b0;
+    // LED debug functions, each overridden by GPIO when set as an output
+    assign led_func[0] = heartbeat_ctr[25];            // heartbeat blinker
+    assign led_func[1] = uart_busy;                    // pulse when UART write occurs
+    assign led_func[2] = (pc[15:0] != 16'h0000);       // PC running
+    assign led_func[3] = timer_pwm[0];                 // timer PWM channel 0
+    assign led = (gpio_oe[3:0] & gpio_o[3:0]) | (~gpio_oe[3:0] & led_func);
 endmodule
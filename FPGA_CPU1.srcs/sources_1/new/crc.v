@@ -0,0 +1,94 @@
+`timescale 1ns / 1ps
+
+// CRC engine: one bus write of up to four bytes per cycle.
+//
+// Registers (offsets from CRC_BASE):
+//   0x00 CTRL    [0] polynomial: 0 CRC-32 (IEEE 802.3, as zlib.crc32),
+//                1 CRC-16/CCITT (0x1021, MSB first); a write also loads
+//                STATE with the standard initial value (0xFFFF_FFFF /
+//                0xFFFF) and clears COUNT
+//   0x04 DATA    W: the bytes whose byte enables are set, lowest address
+//                first (sb/sh/sw, DMA word or byte writes to a fixed
+//                destination); reads 0
+//   0x08 STATE   raw CRC register; write to seed or resume a running CRC
+//   0x0C RESULT  RO: finished CRC (CRC-32: ~STATE, CRC-16: STATE[15:0])
+//   0x10 COUNT   bytes fed since the last CTRL write (write sets it)
+//
+// CRC-32 is the reflected form: each byte goes in LSB first, which for a
+// little-endian word is simply bit 0 to bit 31. CRC-16 shifts each byte in
+// MSB first (CCITT-FALSE with the default seed, XMODEM after STATE = 0).
+module crc (
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Register port (IO slave in cpu_top: writes on the ack edge)
+    input  wire        wr,
+    input  wire [7:0]  addr,
+    input  wire [31:0] wdata,
+    input  wire [3:0]  be,
+    output reg  [31:0] rdata
+);
+    localparam [31:0] POLY32_REFL = 32'hEDB8_8320;   // 0x04C11DB7 bit-reversed
+    localparam [15:0] POLY16      = 16'h1021;
+
+    reg        mode;
+    reg [31:0] state;
+    reg [31:0] count;
+
+    function [31:0] crc_next(input [31:0] s, input [31:0] d, input [3:0] en, input m);
+        integer  l, k;
+        reg [31:0] c;
+        begin
+            c = s;
+            for (l = 0; l < 4; l = l + 1) begin
+                if (en[l]) begin
+                    for (k = 0; k < 8; k = k + 1) begin
+                        if (!m)
+                            c = {1'b0, c[31:1]} ^ ((c[0] ^ d[8*l + k]) ? POLY32_REFL : 32'h0);
+                        else
+                            c = {16'h0, c[14:0], 1'b0} ^
+                                ((c[15] ^ d[8*l + 7 - k]) ? {16'h0, POLY16} : 32'h0);
+                    end
+                end
+            end
+            crc_next = c;
+        end
+    endfunction
+
+    function [2:0] bytes_of(input [3:0] en);
+        bytes_of = en[0] + en[1] + en[2] + en[3];
+    endfunction
+
+    always @(*) begin
+        case (addr[7:2])
+            6'h0:    rdata = {31'b0, mode};
+            6'h2:    rdata = state;
+            6'h3:    rdata = mode ? {16'h0, state[15:0]} : ~state;
+            6'h4:    rdata = count;
+            default: rdata = 32'h0;
+        endcase
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            mode  <= 1'b0;
+            state <= 32'hFFFF_FFFF;
+            count <= 32'd0;
+        end else if (wr) begin
+            case (addr[7:2])
+                6'h0: begin
+                    mode  <= wdata[0];
+                    state <= wdata[0] ? 32'h0000_FFFF : 32'hFFFF_FFFF;
+                    count <= 32'd0;
+                end
+                6'h1: begin
+                    state <= crc_next(state, wdata, be, mode);
+                    count <= count + bytes_of(be);
+                end
+                6'h2: state <= wdata;
+                6'h4: count <= wdata;
+                default: ;
+            endcase
+        end
+    end
+endmodule
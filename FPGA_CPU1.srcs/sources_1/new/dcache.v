@@ -0,0 +1,356 @@
+`timescale 1ns / 1ps
+
+// Write-back, write-allocate data cache (direct-mapped or 2-way LRU).
+//
+// CPU side: a data-bus slave (protocol in bus_arbiter.v). A hit acks on the
+// cycle after the request, exactly like a TCM. A miss writes back the dirty
+// victim line, refills the line with one burst, then replays the lookup.
+// Memory side: whole-line bursts (protocol in burst_arbiter.v).
+//
+// flush_req is held high by the core for fence / fence.i: every dirty line
+// is written back (lines stay valid), then flush_done is held until
+// flush_req drops. Requests arriving meanwhile are parked and served after.
+module dcache #(
+    parameter integer WAYS       = 2,     // 1 = direct-mapped, 2 = 2-way LRU
+    parameter integer SETS       = 64,    // power of two, >= 2
+    parameter integer LINE_WORDS = 8      // power of two, >= 2
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // CPU side
+    input  wire        s_req,
+    input  wire [31:0] s_addr,
+    input  wire        s_we,
+    input  wire [3:0]  s_be,
+    input  wire [31:0] s_wdata,
+    output wire [31:0] s_rdata,
+    output wire        s_ack,
+
+    // Cache maintenance
+    input  wire        flush_req,
+    output reg         flush_done,
+
+    // Memory side
+    output wire        mem_req,
+    output wire        mem_we,
+    output wire [31:0] mem_addr,
+    output wire [31:0] mem_wdata,
+    input  wire        mem_wready,
+    input  wire        mem_rvalid,
+    input  wire [31:0] mem_rdata,
+    input  wire        mem_done
+);
+    localparam integer OFF_BITS = $clog2(LINE_WORDS);
+    localparam integer IDX_BITS = $clog2(SETS);
+    localparam integer TAG_BITS = 30 - OFF_BITS - IDX_BITS;
+    localparam integer ROWS     = SETS * LINE_WORDS;
+
+    localparam [2:0] S_IDLE    = 3'd0;
+    localparam [2:0] S_LOOKUP  = 3'd1;   // array data for q_addr is valid
+    localparam [2:0] S_WB_READ = 3'd2;   // copy victim line into line_buf
+    localparam [2:0] S_WB      = 3'd3;   // burst line_buf out
+    localparam [2:0] S_REFILL  = 3'd4;   // burst the missing line in
+    localparam [2:0] S_REPLAY  = 3'd5;   // re-read the arrays for q_addr
+    localparam [2:0] S_FLUSH   = 3'd6;   // scan for dirty lines
+
+    reg [2:0] state;
+
+    // ------------------------------------------------------------
+    // Storage: one data row holds the same word of every way
+    // ------------------------------------------------------------
+    (* ram_style = "block" *)       reg [WAYS*32-1:0]       data_mem [0:ROWS-1];
+    (* ram_style = "distributed" *) reg [WAYS*TAG_BITS-1:0] tag_mem  [0:SETS-1];
+    reg [WAYS*SETS-1:0] valid_r;
+    reg [WAYS*SETS-1:0] dirty_r;
+    reg [SETS-1:0]      lru_r;      // way to replace next (2-way only)
+
+    // Latched request
+    reg [31:0] q_addr, q_wdata;
+    reg        q_we;
+    reg [3:0]  q_be;
+    reg        pend;                // request arrived while the FSM was busy
+
+    wire [OFF_BITS-1:0] q_off = q_addr[OFF_BITS+1:2];
+    wire [IDX_BITS-1:0] q_idx = q_addr[OFF_BITS+IDX_BITS+1:OFF_BITS+2];
+    wire [TAG_BITS-1:0] q_tag = q_addr[31:OFF_BITS+IDX_BITS+2];
+    wire [OFF_BITS-1:0] s_off = s_addr[OFF_BITS+1:2];
+    wire [IDX_BITS-1:0] s_idx = s_addr[OFF_BITS+IDX_BITS+1:OFF_BITS+2];
+
+    // Victim / line being written back
+    reg                 v_way;
+    reg [IDX_BITS-1:0]  v_idx;
+    reg [TAG_BITS-1:0]  v_tag;
+    reg                 wb_for_flush;
+    reg [31:0]          line_buf [0:LINE_WORDS-1];
+    reg [OFF_BITS:0]    cnt;        // WB_READ issue counter / burst beat
+    reg [IDX_BITS-1:0]  fl_set;
+    reg                 fl_way;
+
+    // ------------------------------------------------------------
+    // Data array ports (registered read, byte-lane writes)
+    // ------------------------------------------------------------
+    reg                  rd_en;
+    reg  [OFF_BITS+IDX_BITS-1:0] rd_row;
+    reg                  wr_en;
+    reg  [OFF_BITS+IDX_BITS-1:0] wr_row;
+    reg  [WAYS*32-1:0]   wr_data;
+    reg  [WAYS*4-1:0]    wr_be;
+    reg  [WAYS*32-1:0]   rd_data;
+
+    // A write landing on the row being read in the same cycle is merged in
+    // afterwards (the BRAM returns the old word)
+    reg                  byp;
+    reg  [WAYS*32-1:0]   byp_data;
+    reg  [WAYS*4-1:0]    byp_be;
+
+    always @(posedge clk) begin
+        if (rd_en) begin
+            rd_data  <= data_mem[rd_row];
+            byp      <= wr_en && (wr_row == rd_row);
+            byp_data <= wr_data;
+            byp_be   <= wr_be;
+        end
+    end
+
+    genvar b;
+    wire [WAYS*32-1:0] row_data;
+    generate
+        for (b = 0; b < WAYS*4; b = b + 1) begin : g_byte
+            always @(posedge clk) begin
+                if (wr_en && wr_be[b])
+                    data_mem[wr_row][8*b +: 8] <= wr_data[8*b +: 8];
+            end
+            assign row_data[8*b +: 8] = (byp && byp_be[b]) ? byp_data[8*b +: 8] : rd_data[8*b +: 8];
+        end
+    endgenerate
+
+    // ------------------------------------------------------------
+    // Lookup
+    // ------------------------------------------------------------
+    wire [WAYS*TAG_BITS-1:0] set_tags = tag_mem[q_idx];
+    wire [WAYS-1:0] way_hit;
+    genvar w;
+    generate
+        for (w = 0; w < WAYS; w = w + 1) begin : g_way
+            assign way_hit[w] = valid_r[w*SETS + q_idx] &&
+                                (set_tags[w*TAG_BITS +: TAG_BITS] == q_tag);
+        end
+    endgenerate
+
+    wire hit     = (state == S_LOOKUP) && |way_hit;
+    wire hit_way = (WAYS == 2) ? way_hit[WAYS-1] : 1'b0;
+    wire victim  = (WAYS == 1)                   ? 1'b0 :
+                   !valid_r[q_idx]               ? 1'b0 :
+                   !valid_r[(WAYS-1)*SETS+q_idx] ? 1'b1 :
+                                                   lru_r[q_idx];
+    wire victim_dirty = dirty_r[victim*SETS + q_idx];
+
+    assign s_ack   = hit;
+    assign s_rdata = row_data[hit_way*32 +: 32];
+
+    // A new request can be looked up straight away when nothing else is pending
+    wire accept_now = ((state == S_IDLE) && !pend) || hit;
+
+    // ------------------------------------------------------------
+    // Memory side
+    // ------------------------------------------------------------
+    assign mem_req   = (state == S_WB) || (state == S_REFILL);
+    assign mem_we    = (state == S_WB);
+    assign mem_addr  = (state == S_WB) ? {v_tag, v_idx, {OFF_BITS{1'b0}}, 2'b00}
+                                       : {q_tag, q_idx, {OFF_BITS{1'b0}}, 2'b00};
+    assign mem_wdata = line_buf[cnt[OFF_BITS-1:0]];
+
+    // ------------------------------------------------------------
+    // Array port muxing
+    // ------------------------------------------------------------
+    wire [WAYS*4-1:0] q_be_lanes = q_be;     // zero-extended, shifted to the way
+    wire [WAYS*4-1:0] word_lanes = 4'hF;
+
+    always @(*) begin
+        rd_en   = 1'b0;
+        rd_row  = {q_idx, q_off};
+        wr_en   = 1'b0;
+        wr_row  = {q_idx, q_off};
+        wr_data = {WAYS{q_wdata}};
+        wr_be   = q_be_lanes << (hit_way * 4);
+
+        if (s_req && accept_now) begin
+            rd_en  = 1'b1;
+            rd_row = {s_idx, s_off};
+        end else if (state == S_REPLAY) begin
+            rd_en  = 1'b1;
+        end else if (state == S_WB_READ && cnt < LINE_WORDS) begin
+            rd_en  = 1'b1;
+            rd_row = {v_idx, cnt[OFF_BITS-1:0]};
+        end
+
+        if (hit && q_we) begin
+            wr_en = 1'b1;
+        end else if (state == S_REFILL && mem_rvalid) begin
+            wr_en   = 1'b1;
+            wr_row  = {q_idx, cnt[OFF_BITS-1:0]};
+            wr_data = {WAYS{mem_rdata}};
+            wr_be   = word_lanes << (v_way * 4);
+        end
+    end
+
+    // Tag and line buffer writes (no reset, so they map onto RAM)
+    always @(posedge clk) begin
+        if (state == S_REFILL && mem_done)
+            tag_mem[q_idx][v_way*TAG_BITS +: TAG_BITS] <= q_tag;
+        // WB_READ: read issued for word cnt, data for word cnt-1 arrives now
+        if (state == S_WB_READ && cnt != 0)
+            line_buf[cnt-1] <= rd_data[v_way*32 +: 32];
+    end
+
+    // ------------------------------------------------------------
+    // Statistics (read by the testbenches)
+    // ------------------------------------------------------------
+    reg [31:0] stat_hits, stat_misses, stat_writebacks, stat_miss_cycles;
+    reg        in_miss;
+
+    // ------------------------------------------------------------
+    // Control
+    // ------------------------------------------------------------
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state        <= S_IDLE;
+            valid_r      <= {WAYS*SETS{1'b0}};
+            dirty_r      <= {WAYS*SETS{1'b0}};
+            lru_r        <= {SETS{1'b0}};
+            pend         <= 1'b0;
+            flush_done   <= 1'b0;
+            q_addr       <= 32'b0;
+            q_wdata      <= 32'b0;
+            q_we         <= 1'b0;
+            q_be         <= 4'b0;
+            v_way        <= 1'b0;
+            v_idx        <= {IDX_BITS{1'b0}};
+            v_tag        <= {TAG_BITS{1'b0}};
+            wb_for_flush <= 1'b0;
+            cnt          <= 0;
+            fl_set       <= {IDX_BITS{1'b0}};
+            fl_way       <= 1'b0;
+            in_miss      <= 1'b0;
+            stat_hits        <= 32'd0;
+            stat_misses      <= 32'd0;
+            stat_writebacks  <= 32'd0;
+            stat_miss_cycles <= 32'd0;
+        end else begin
+            if (!flush_req)
+                flush_done <= 1'b0;
+            if (in_miss)
+                stat_miss_cycles <= stat_miss_cycles + 1'b1;
+
+            case (state)
+                S_IDLE: begin
+                    if (pend) begin
+                        state <= S_REPLAY;
+                    end else if (flush_req && !flush_done && !s_req) begin
+                        fl_set <= {IDX_BITS{1'b0}};
+                        fl_way <= 1'b0;
+                        state  <= S_FLUSH;
+                    end
+                end
+
+                S_LOOKUP: begin
+                    if (hit) begin
+                        if (q_we)
+                            dirty_r[hit_way*SETS + q_idx] <= 1'b1;
+                        if (WAYS == 2)
+                            lru_r[q_idx] <= ~hit_way;
+                        if (in_miss)
+                            in_miss <= 1'b0;
+                        else
+                            stat_hits <= stat_hits + 1'b1;
+                        state <= S_IDLE;
+                    end else begin
+                        in_miss     <= 1'b1;
+                        stat_misses <= stat_misses + 1'b1;
+                        v_way <= victim;
+                        v_idx <= q_idx;
+                        v_tag <= set_tags[victim*TAG_BITS +: TAG_BITS];
+                        cnt   <= 0;
+                        if (valid_r[victim*SETS + q_idx] && victim_dirty) begin
+                            wb_for_flush <= 1'b0;
+                            state        <= S_WB_READ;
+                        end else begin
+                            state <= S_REFILL;
+                        end
+                    end
+                end
+
+                S_WB_READ: begin
+                    if (cnt == LINE_WORDS) begin
+                        cnt   <= 0;
+                        state <= S_WB;
+                    end else begin
+                        cnt <= cnt + 1'b1;
+                    end
+                end
+
+                S_WB: begin
+                    if (mem_wready)
+                        cnt <= cnt + 1'b1;
+                    if (mem_done) begin
+                        dirty_r[v_way*SETS + v_idx] <= 1'b0;
+                        stat_writebacks <= stat_writebacks + 1'b1;
+                        cnt   <= 0;
+                        state <= wb_for_flush ? S_FLUSH : S_REFILL;
+                    end
+                end
+
+                S_REFILL: begin
+                    if (mem_rvalid)
+                        cnt <= cnt + 1'b1;
+                    if (mem_done) begin
+                        valid_r[v_way*SETS + q_idx] <= 1'b1;
+                        dirty_r[v_way*SETS + q_idx] <= 1'b0;
+                        if (WAYS == 2)
+                            lru_r[q_idx] <= ~v_way;
+                        state <= S_REPLAY;
+                    end
+                end
+
+                S_REPLAY: begin
+                    pend  <= 1'b0;
+                    state <= S_LOOKUP;
+                end
+
+                S_FLUSH: begin
+                    if (valid_r[fl_way*SETS + fl_set] && dirty_r[fl_way*SETS + fl_set]) begin
+                        v_way        <= fl_way;
+                        v_idx        <= fl_set;
+                        v_tag        <= tag_mem[fl_set][fl_way*TAG_BITS +: TAG_BITS];
+                        wb_for_flush <= 1'b1;
+                        cnt          <= 0;
+                        state        <= S_WB_READ;
+                    end else if (fl_way == WAYS-1 && fl_set == SETS-1) begin
+                        flush_done <= 1'b1;
+                        state      <= S_IDLE;
+                    end else if (fl_way == WAYS-1) begin
+                        fl_way <= 1'b0;
+                        fl_set <= fl_set + 1'b1;
+                    end else begin
+                        fl_way <= 1'b1;
+                    end
+                end
+
+                default: state <= S_IDLE;
+            endcase
+
+            // Request capture (after the case so it wins the state update)
+            if (s_req) begin
+                q_addr  <= s_addr;
+                q_wdata <= s_wdata;
+                q_we    <= s_we;
+                q_be    <= s_be;
+                if (accept_now)
+                    state <= S_LOOKUP;
+                else
+                    pend <= 1'b1;
+            end
+        end
+    end
+endmodule
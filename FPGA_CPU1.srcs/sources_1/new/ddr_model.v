@@ -0,0 +1,99 @@
+`timescale 1ns / 1ps
+
+// Behavioural external memory (stands in for DDR behind a controller).
+//
+// Speaks the burst protocol from burst_arbiter.v. Every burst waits LATENCY
+// cycles (row activate + CAS as seen from the fabric), then moves one word
+// per cycle for LINE_WORDS beats. Addresses wrap modulo WORDS, so a small
+// instance can stand in for the whole region.
+//
+// INIT_FILE (hex, one word per line) preloads the array, e.g. with the
+// firmware's .ext_text image.
+module ddr_model #(
+    parameter integer WORDS      = 1 << 20,   // power of two
+    parameter integer LATENCY    = 20,        // cycles from request to first beat
+    parameter integer LINE_WORDS = 8,         // beats per burst
+    parameter         INIT_FILE  = ""
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    input  wire        mem_req,
+    input  wire        mem_we,
+    input  wire [31:0] mem_addr,
+    input  wire [31:0] mem_wdata,
+    output wire        mem_wready,
+    output wire        mem_rvalid,
+    output wire [31:0] mem_rdata,
+    output wire        mem_done
+);
+    localparam integer AW = $clog2(WORDS);
+    localparam integer BW = $clog2(LINE_WORDS);
+
+    localparam [1:0] S_IDLE  = 2'd0;
+    localparam [1:0] S_WAIT  = 2'd1;
+    localparam [1:0] S_BURST = 2'd2;
+
+    reg [31:0] mem [0:WORDS-1];
+
+    initial begin
+        if (INIT_FILE != "")
+            $readmemh(INIT_FILE, mem);
+    end
+
+    reg [1:0]    state;
+    reg [AW-1:0] base;
+    reg          we;
+    reg [BW-1:0] beat;
+    reg [15:0]   wait_cnt;
+
+    wire [AW-1:0] word = base + beat;
+    wire          last = (beat == LINE_WORDS - 1);
+
+    assign mem_wready = (state == S_BURST) &&  we;
+    assign mem_rvalid = (state == S_BURST) && !we;
+    assign mem_rdata  = mem[word];
+    assign mem_done   = (state == S_BURST) && last;
+
+    always @(posedge clk) begin
+        if (mem_wready)
+            mem[word] <= mem_wdata;
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state    <= S_IDLE;
+            base     <= {AW{1'b0}};
+            we       <= 1'b0;
+            beat     <= {BW{1'b0}};
+            wait_cnt <= 16'd0;
+        end else begin
+            case (state)
+                S_IDLE: begin
+                    if (mem_req) begin
+                        base     <= mem_addr[AW+1:2];
+                        we       <= mem_we;
+                        beat     <= {BW{1'b0}};
+                        wait_cnt <= LATENCY;
+                        state    <= S_WAIT;
+                    end
+                end
+
+                S_WAIT: begin
+                    if (wait_cnt == 0)
+                        state <= S_BURST;
+                    else
+                        wait_cnt <= wait_cnt - 1'b1;
+                end
+
+                S_BURST: begin
+                    beat <= beat + 1'b1;
+                    if (last)
+                        state <= S_IDLE;
+                end
+
+                default: state <= S_IDLE;
+            endcase
+        end
+    end
+endmodule
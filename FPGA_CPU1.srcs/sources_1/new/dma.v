@@ -0,0 +1,313 @@
+`timescale 1ns / 1ps
+
+// DMA controller: NCH channels sharing one data-bus master port (xbar d1).
+//
+// Registers (offsets from DMA_BASE; channel c at c * 0x20):
+//   +0x00 SRC    source address
+//   +0x04 DST    destination address
+//   +0x08 LEN    bytes left (counts down while the channel runs)
+//   +0x0C CFG    [0] SRC fixed, [1] DST fixed, [2] word transfers (32-bit
+//                while LEN >= 4, then bytes; SRC/DST must be word aligned),
+//                [5:4] pace writes by request line (0 = free running,
+//                n = dreq[n-1])
+//   +0x10 NEXT   next descriptor address (0 = end of chain)
+//   +0x14 CTRL   W: [0] start with SRC..NEXT as written, [1] start by
+//                loading the descriptor at NEXT, [2] irq enable, [3] abort
+//                R: [2] irq enable, [8] busy, [9] done, [10] aborting
+//   0x80  DONE   per-channel done flags, write 1 to clear
+//
+// A descriptor is five words in memory, in register order: SRC, DST, LEN,
+// CFG, NEXT. When a transfer finishes with NEXT != 0 the channel loads the
+// descriptor at NEXT and continues; DONE (and the irq, if enabled) is set
+// at the end of the chain. SRC/DST/LEN/CFG/NEXT writes are ignored while
+// the channel is busy. Abort stops the channel once its outstanding bus
+// access (at most one) is acked, even in the middle of a burst or while a
+// paced write waits for its request line; busy stays set until then, and
+// the channel registers keep the values they had at that point.
+//
+// The engine runs one channel at a time, round-robin per burst: up to BURST
+// items are read into a buffer, then written. Reads and writes are issued
+// back to back (the next request goes out in the ack cycle). Bytes are read
+// as whole words and written with a one-hot byte enable and the byte on
+// every lane, so a byte stream to a fixed MMIO data register works.
+module dma #(
+    parameter integer NCH   = 4,            // channels (<= 4)
+    parameter integer BURST = 4             // items per burst
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Register port (IO slave in cpu_top: writes on the ack edge)
+    input  wire        wr,
+    input  wire [7:0]  addr,
+    input  wire [31:0] wdata,
+    output reg  [31:0] rdata,
+
+    // Peripheral request lines for paced channels (level: room for a write)
+    input  wire [2:0]  dreq,
+
+    // Bus master (see bus_arbiter.v for the req/ack protocol)
+    output reg         m_req,
+    output reg  [31:0] m_addr,
+    output reg         m_we,
+    output reg  [3:0]  m_be,
+    output reg  [31:0] m_wdata,
+    input  wire [31:0] m_rdata,
+    input  wire        m_ack,
+
+    output wire        irq
+);
+    localparam integer CW = (NCH > 1) ? $clog2(NCH) : 1;
+    localparam integer BW = $clog2(BURST) + 1;
+
+    localparam [1:0] S_IDLE  = 2'd0;
+    localparam [1:0] S_DESC  = 2'd1;
+    localparam [1:0] S_READ  = 2'd2;
+    localparam [1:0] S_WRITE = 2'd3;
+
+    // Channel state
+    reg [31:0] src  [0:NCH-1];
+    reg [31:0] dst  [0:NCH-1];
+    reg [31:0] len  [0:NCH-1];
+    reg [5:0]  cfg  [0:NCH-1];
+    reg [31:0] next [0:NCH-1];
+    reg [NCH-1:0] busy, done, ie, load_desc, aborting;
+
+    assign irq = |(done & ie);
+
+    // Register read
+    wire [CW-1:0] r_ch = addr[CW+4:5];
+    always @(*) begin
+        rdata = 32'h0;
+        if (addr[7]) begin
+            if (addr[6:2] == 5'd0)
+                rdata = {{(32-NCH){1'b0}}, done};
+        end else if (addr[6:5] < NCH) begin
+            case (addr[4:2])
+                3'd0: rdata = src[r_ch];
+                3'd1: rdata = dst[r_ch];
+                3'd2: rdata = len[r_ch];
+                3'd3: rdata = {26'b0, cfg[r_ch]};
+                3'd4: rdata = next[r_ch];
+                3'd5: rdata = {21'b0, aborting[r_ch], done[r_ch], busy[r_ch], 5'b0,
+                               ie[r_ch], 2'b0};
+                default: rdata = 32'h0;
+            endcase
+        end
+    end
+
+    // ------------------------------------------------------------
+    // Engine
+    // ------------------------------------------------------------
+    reg [1:0]    state;
+    reg [CW-1:0] ch;                 // channel being served
+    reg [CW-1:0] rr;                 // last channel served
+    reg          pend;               // request outstanding
+    reg [1:0]    pend_lane;          // byte lane of an outstanding byte read
+    reg [2:0]    desc_idx, desc_ack;
+    reg [BW-1:0] n_items, issued, acked;
+    reg          word_mode;          // items of this burst are words
+    reg [31:0]   buf_q [0:BURST-1];
+
+    wire can_issue = !pend || m_ack;
+
+    // Round-robin pick of the next busy channel after rr
+    reg          pick_ok;
+    reg [CW-1:0] pick;
+    integer      k;
+    always @(*) begin
+        pick_ok = 1'b0;
+        pick    = {CW{1'b0}};
+        for (k = NCH; k >= 1; k = k - 1)
+            if (busy[(rr + k) % NCH]) begin
+                pick_ok = 1'b1;
+                pick    = (rr + k) % NCH;
+            end
+    end
+
+    // Next burst of the picked channel
+    wire        p_words = cfg[pick][2] && (len[pick] >= 32'd4);
+    wire [31:0] p_items = p_words ? (len[pick] >> 2) : len[pick];
+
+    // Current channel
+    wire [5:0]  c_cfg   = cfg[ch];
+    wire [31:0] c_step  = word_mode ? 32'd4 : 32'd1;
+    wire        paced   = (c_cfg[5:4] != 2'd0);
+    wire        dreq_ok = !paced || dreq[c_cfg[5:4] - 2'd1];
+
+    wire [31:0] rd_word = m_rdata >> {pend_lane, 3'b000};
+
+    integer i;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            for (i = 0; i < NCH; i = i + 1) begin
+                src[i]  <= 32'h0;
+                dst[i]  <= 32'h0;
+                len[i]  <= 32'h0;
+                cfg[i]  <= 6'h0;
+                next[i] <= 32'h0;
+            end
+            busy      <= {NCH{1'b0}};
+            done      <= {NCH{1'b0}};
+            ie        <= {NCH{1'b0}};
+            load_desc <= {NCH{1'b0}};
+            aborting  <= {NCH{1'b0}};
+            state     <= S_IDLE;
+            ch        <= {CW{1'b0}};
+            rr        <= {CW{1'b0}};
+            pend      <= 1'b0;
+            pend_lane <= 2'b0;
+            desc_idx  <= 3'd0;
+            desc_ack  <= 3'd0;
+            n_items   <= {BW{1'b0}};
+            issued    <= {BW{1'b0}};
+            acked     <= {BW{1'b0}};
+            word_mode <= 1'b0;
+            m_req     <= 1'b0;
+            m_addr    <= 32'h0;
+            m_we      <= 1'b0;
+            m_be      <= 4'h0;
+            m_wdata   <= 32'h0;
+        end else begin
+            m_req <= 1'b0;
+            if (m_ack)
+                pend <= 1'b0;
+
+            // Register writes
+            if (wr && addr[7] && addr[6:2] == 5'd0)
+                done <= done & ~wdata[NCH-1:0];
+            if (wr && !addr[7] && addr[6:5] < NCH) begin
+                if (addr[4:2] == 3'd5) begin
+                    ie[r_ch] <= wdata[2];
+                    if (wdata[3]) begin
+                        if (busy[r_ch])
+                            aborting[r_ch] <= 1'b1;     // the engine stops it
+                    end else if (!busy[r_ch] && (wdata[0] || wdata[1])) begin
+                        busy[r_ch]      <= 1'b1;
+                        done[r_ch]      <= 1'b0;
+                        load_desc[r_ch] <= wdata[1];
+                    end
+                end else if (!busy[r_ch]) begin
+                    case (addr[4:2])
+                        3'd0: src[r_ch]  <= wdata;
+                        3'd1: dst[r_ch]  <= wdata;
+                        3'd2: len[r_ch]  <= wdata;
+                        3'd3: cfg[r_ch]  <= wdata[5:0];
+                        3'd4: next[r_ch] <= wdata;
+                        default: ;
+                    endcase
+                end
+            end
+
+            if (state != S_IDLE && aborting[ch]) begin
+                // Leave the channel once nothing is outstanding; the ack of
+                // the last access updates no channel register
+                if (!pend || m_ack) begin
+                    busy[ch]      <= 1'b0;
+                    aborting[ch]  <= 1'b0;
+                    load_desc[ch] <= 1'b0;
+                    state         <= S_IDLE;
+                end
+            end else case (state)
+                S_IDLE: begin
+                    if (pick_ok && !pend) begin
+                        ch <= pick;
+                        rr <= pick;
+                        if (aborting[pick]) begin
+                            busy[pick]      <= 1'b0;
+                            aborting[pick]  <= 1'b0;
+                            load_desc[pick] <= 1'b0;
+                        end else if (load_desc[pick]) begin
+                            desc_idx <= 3'd0;
+                            desc_ack <= 3'd0;
+                            state    <= S_DESC;
+                        end else if (len[pick] == 32'd0) begin
+                            // Transfer finished: follow the chain or complete
+                            if (next[pick] != 32'd0) begin
+                                load_desc[pick] <= 1'b1;
+                            end else begin
+                                busy[pick] <= 1'b0;
+                                done[pick] <= 1'b1;
+                            end
+                        end else begin
+                            word_mode <= p_words;
+                            n_items   <= (p_items > BURST) ? BURST[BW-1:0] : p_items[BW-1:0];
+                            issued    <= {BW{1'b0}};
+                            acked     <= {BW{1'b0}};
+                            state     <= S_READ;
+                        end
+                    end
+                end
+
+                // Five descriptor words from NEXT into the channel registers
+                S_DESC: begin
+                    if (desc_idx != 3'd5 && can_issue) begin
+                        m_req    <= 1'b1;
+                        m_we     <= 1'b0;
+                        m_be     <= 4'b1111;
+                        m_addr   <= {next[ch][31:2], 2'b00} + {desc_idx, 2'b00};
+                        pend     <= 1'b1;
+                        desc_idx <= desc_idx + 1'b1;
+                    end
+                    if (m_ack) begin
+                        case (desc_ack)
+                            3'd0: src[ch]  <= m_rdata;
+                            3'd1: dst[ch]  <= m_rdata;
+                            3'd2: len[ch]  <= m_rdata;
+                            3'd3: cfg[ch]  <= m_rdata[5:0];
+                            default: begin
+                                next[ch]      <= m_rdata;
+                                load_desc[ch] <= 1'b0;
+                                state         <= S_IDLE;
+                            end
+                        endcase
+                        desc_ack <= desc_ack + 1'b1;
+                    end
+                end
+
+                S_READ: begin
+                    if (issued != n_items && can_issue) begin
+                        m_req     <= 1'b1;
+                        m_we      <= 1'b0;
+                        m_be      <= 4'b1111;
+                        m_addr    <= {src[ch][31:2], 2'b00};
+                        pend      <= 1'b1;
+                        pend_lane <= word_mode ? 2'b00 : src[ch][1:0];
+                        issued    <= issued + 1'b1;
+                        if (!c_cfg[0])
+                            src[ch] <= src[ch] + c_step;
+                    end
+                    if (m_ack) begin
+                        buf_q[acked] <= rd_word;
+                        acked        <= acked + 1'b1;
+                        if (acked + 1'b1 == n_items) begin
+                            issued <= {BW{1'b0}};
+                            acked  <= {BW{1'b0}};
+                            state  <= S_WRITE;
+                        end
+                    end
+                end
+
+                S_WRITE: begin
+                    if (issued != n_items && can_issue && dreq_ok) begin
+                        m_req   <= 1'b1;
+                        m_we    <= 1'b1;
+                        m_addr  <= {dst[ch][31:2], 2'b00};
+                        m_be    <= word_mode ? 4'b1111 : (4'b0001 << dst[ch][1:0]);
+                        m_wdata <= word_mode ? buf_q[issued] : {4{buf_q[issued][7:0]}};
+                        pend    <= 1'b1;
+                        issued  <= issued + 1'b1;
+                        if (!c_cfg[1])
+                            dst[ch] <= dst[ch] + c_step;
+                    end
+                    if (m_ack) begin
+                        len[ch] <= len[ch] - c_step;
+                        acked   <= acked + 1'b1;
+                        if (acked + 1'b1 == n_items)
+                            state <= S_IDLE;
+                    end
+                end
+            endcase
+        end
+    end
+endmodule
@@ -0,0 +1,69 @@
+`timescale 1ns / 1ps
+
+// Unified true-dual-port block RAM (synchronous read, byte write enables).
+// Port A = instruction fetch, port B = load/store. Both ports share ONE array,
+// so stores into code (e.g. bootloader upload at 0x1000) are visible to fetch.
+// Written in the Vivado TDP byte-write template so it maps onto RAMB36 tiles.
+module dp_bram #(
+    parameter integer WORDS     = 32768,
+    parameter integer ADDR_BITS = 15,
+    parameter         INIT_FILE = "instr_mem.vh",
+    parameter  [31:0] FILL      = 32'h00000013  // words INIT_FILE leaves out
+)(
+    input  wire                 clk,
+
+    // Port A
+    input  wire                 a_en,
+    input  wire [3:0]           a_we,
+    input  wire [ADDR_BITS-1:0] a_addr,
+    input  wire [31:0]          a_din,
+    output reg  [31:0]          a_dout,
+
+    // Port B
+    input  wire                 b_en,
+    input  wire [3:0]           b_we,
+    input  wire [ADDR_BITS-1:0] b_addr,
+    input  wire [31:0]          b_din,
+    output reg  [31:0]          b_dout
+);
+    (* ram_style = "block" *) reg [31:0] mem [0:WORDS-1];
+
+    integer i;
+    initial begin
+        // Fill first (prevents X in simulation for unloaded words; sparse
+        // @address images only list the words they load)
+        for (i = 0; i < WORDS; i = i + 1)
+            mem[i] = FILL;
+        a_dout = 32'h0;
+        b_dout = 32'h0;
+        if (INIT_FILE != "")
+            $readmemh(INIT_FILE, mem);
+        $display("[dp_bram] Memory initialized. mem[0]=0x%08h", mem[0]);
+    end
+
+    // Byte-lane writes, one always block per port per lane (TDP template)
+    genvar lane;
+    generate
+        for (lane = 0; lane < 4; lane = lane + 1) begin : g_lane
+            always @(posedge clk) begin
+                if (a_en && a_we[lane])
+                    mem[a_addr][8*lane +: 8] <= a_din[8*lane +: 8];
+            end
+            always @(posedge clk) begin
+                if (b_en && b_we[lane])
+                    mem[b_addr][8*lane +: 8] <= b_din[8*lane +: 8];
+            end
+        end
+    endgenerate
+
+    // Registered reads (READ_FIRST)
+    always @(posedge clk) begin
+        if (a_en)
+            a_dout <= mem[a_addr];
+    end
+
+    always @(posedge clk) begin
+        if (b_en)
+            b_dout <= mem[b_addr];
+    end
+endmodule
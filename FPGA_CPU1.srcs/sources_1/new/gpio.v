@@ -0,0 +1,139 @@
+`timescale 1ns / 1ps
+
+// GPIO: W pins with direction, data, debounce and edge/level interrupts.
+// Pins in OUT_MASK can be outputs; on the board they are the LEDs, whose
+// built-in function (cpu_top) shows whenever DIR is 0. The others are
+// input-only and DIR reads 0 for them.
+//
+// Registers (offsets from GPIO_BASE), bit n = pin n:
+//   0x00 IN       RO: pin levels after synchroniser and debounce (outputs
+//                 read back the level on the pin)
+//   0x04 OUT      output data
+//   0x08 DIR      1 = output (GPIO drives the pin)
+//   0x0C SET      W: OUT |= value
+//   0x10 CLR      W: OUT &= ~value
+//   0x14 RISE     irq on a rising edge of IN
+//   0x18 FALL     irq on a falling edge of IN
+//   0x1C HIGH     irq while IN is high
+//   0x20 LOW      irq while IN is low
+//   0x24 EDGES    [W-1:0] rising-edge flags, [16+W-1:16] falling-edge flags
+//                 (set only where RISE / FALL enable them), write 1 to clear
+//   0x28 DB_EN    debounce the pin
+//   0x2C DB_TIME  [19:0] debounce sample period in cycles
+//
+// Debounce: a debounced pin takes a new level once it has been seen on
+// three DB_TIME samples in a row, i.e. after 2-3 x DB_TIME of stable
+// input. Level interrupts stay asserted until the handler disables them
+// or the pin changes.
+module gpio #(
+    parameter integer    W        = 7,          // pins (<= 16)
+    parameter [W-1:0]    OUT_MASK = {W{1'b1}}   // pins that can drive
+)(
+    input  wire         clk,
+    input  wire         rst_n,
+
+    // Register port (IO slave in cpu_top: writes on the ack edge)
+    input  wire         wr,
+    input  wire [7:0]   addr,
+    input  wire [31:0]  wdata,
+    output reg  [31:0]  rdata,
+
+    input  wire [W-1:0] pin_i,
+    output reg  [W-1:0] pin_o,
+    output reg  [W-1:0] pin_oe,
+
+    output wire         irq
+);
+    reg [W-1:0] sync1, sync2, deb, deb_q;
+    reg [W-1:0] rise_en, fall_en, high_en, low_en, db_en;
+    reg [W-1:0] rise_f, fall_f;
+    reg [19:0]  db_time, presc;
+    reg [1:0]   db_cnt [0:W-1];
+
+    wire tick = (presc == 20'd0);
+
+    assign irq = |{rise_f, fall_f, deb & high_en, ~deb & low_en};
+
+    always @(*) begin
+        case (addr[7:2])
+            6'h00:   rdata = deb;
+            6'h01:   rdata = pin_o;
+            6'h02:   rdata = pin_oe;
+            6'h05:   rdata = rise_en;
+            6'h06:   rdata = fall_en;
+            6'h07:   rdata = high_en;
+            6'h08:   rdata = low_en;
+            6'h09:   rdata = {fall_f, 16'h0} | rise_f;
+            6'h0A:   rdata = db_en;
+            6'h0B:   rdata = {12'b0, db_time};
+            default: rdata = 32'h0;
+        endcase
+    end
+
+    integer n;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            sync1   <= {W{1'b0}};
+            sync2   <= {W{1'b0}};
+            deb     <= {W{1'b0}};
+            deb_q   <= {W{1'b0}};
+            presc   <= 20'd0;
+            pin_o   <= {W{1'b0}};
+            pin_oe  <= {W{1'b0}};
+            rise_en <= {W{1'b0}};
+            fall_en <= {W{1'b0}};
+            high_en <= {W{1'b0}};
+            low_en  <= {W{1'b0}};
+            rise_f  <= {W{1'b0}};
+            fall_f  <= {W{1'b0}};
+            db_en   <= {W{1'b0}};
+            db_time <= 20'd0;
+            for (n = 0; n < W; n = n + 1)
+                db_cnt[n] <= 2'd0;
+        end else begin
+            sync1 <= pin_i;
+            sync2 <= sync1;
+            deb_q <= deb;
+            presc <= tick ? db_time : presc - 1'b1;
+
+            for (n = 0; n < W; n = n + 1) begin
+                if (!db_en[n]) begin
+                    deb[n]    <= sync2[n];
+                    db_cnt[n] <= 2'd0;
+                end else if (tick) begin
+                    if (sync2[n] == deb[n]) begin
+                        db_cnt[n] <= 2'd0;
+                    end else if (db_cnt[n] == 2'd2) begin
+                        deb[n]    <= sync2[n];
+                        db_cnt[n] <= 2'd0;
+                    end else begin
+                        db_cnt[n] <= db_cnt[n] + 1'b1;
+                    end
+                end
+            end
+
+            // Edge flags (a W1C in the same cycle loses to a new edge)
+            rise_f <= (wr && addr[7:2] == 6'h09 ? rise_f & ~wdata[W-1:0] : rise_f) |
+                      (deb & ~deb_q & rise_en);
+            fall_f <= (wr && addr[7:2] == 6'h09 ? fall_f & ~wdata[16+W-1:16] : fall_f) |
+                      (~deb & deb_q & fall_en);
+
+            if (wr) begin
+                case (addr[7:2])
+                    6'h01: pin_o   <= wdata[W-1:0];
+                    6'h02: pin_oe  <= wdata[W-1:0] & OUT_MASK;
+                    6'h03: pin_o   <= pin_o | wdata[W-1:0];
+                    6'h04: pin_o   <= pin_o & ~wdata[W-1:0];
+                    6'h05: rise_en <= wdata[W-1:0];
+                    6'h06: fall_en <= wdata[W-1:0];
+                    6'h07: high_en <= wdata[W-1:0];
+                    6'h08: low_en  <= wdata[W-1:0];
+                    6'h0A: db_en   <= wdata[W-1:0];
+                    6'h0B: db_time <= wdata[19:0];
+                    default: ;
+                endcase
+            end
+        end
+    end
+endmodule
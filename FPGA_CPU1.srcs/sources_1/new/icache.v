@@ -0,0 +1,209 @@
+`timescale 1ns / 1ps
+
+// Read-only instruction cache (direct-mapped or 2-way LRU).
+//
+// CPU side: an instruction-bus slave (level ack, see bus_xbar.v). A hit
+// answers on the cycle after the fetch, like the ITCM, and the word stays
+// on i_rdata until the next fetch. A fetch that arrives during a refill
+// replaces the one being served; it is looked up when the refill is done.
+// Memory side: whole-line read bursts (protocol in burst_arbiter.v).
+//
+// inv_req (fence.i, after the D-cache has been cleaned) clears every valid
+// bit; inv_done is held until inv_req drops.
+module icache #(
+    parameter integer WAYS       = 2,     // 1 = direct-mapped, 2 = 2-way LRU
+    parameter integer SETS       = 64,    // power of two, >= 2
+    parameter integer LINE_WORDS = 8      // power of two, >= 2
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // CPU side
+    input  wire        i_req,
+    input  wire [31:0] i_addr,
+    output wire [31:0] i_rdata,
+    output wire        i_ack,
+
+    // Cache maintenance
+    input  wire        inv_req,
+    output reg         inv_done,
+
+    // Memory side (read bursts only)
+    output wire        mem_req,
+    output wire        mem_we,
+    output wire [31:0] mem_addr,
+    output wire [31:0] mem_wdata,
+    input  wire        mem_wready,
+    input  wire        mem_rvalid,
+    input  wire [31:0] mem_rdata,
+    input  wire        mem_done
+);
+    localparam integer OFF_BITS = $clog2(LINE_WORDS);
+    localparam integer IDX_BITS = $clog2(SETS);
+    localparam integer TAG_BITS = 30 - OFF_BITS - IDX_BITS;
+    localparam integer ROWS     = SETS * LINE_WORDS;
+
+    localparam [1:0] S_IDLE   = 2'd0;
+    localparam [1:0] S_LOOKUP = 2'd1;    // array data for q_addr is valid
+    localparam [1:0] S_REFILL = 2'd2;
+    localparam [1:0] S_REPLAY = 2'd3;
+
+    reg [1:0] state;
+
+    (* ram_style = "block" *)       reg [WAYS*32-1:0]       data_mem [0:ROWS-1];
+    (* ram_style = "distributed" *) reg [WAYS*TAG_BITS-1:0] tag_mem  [0:SETS-1];
+    reg [WAYS*SETS-1:0] valid_r;
+    reg [SETS-1:0]      lru_r;
+
+    reg [31:0] q_addr;
+    wire [OFF_BITS-1:0] q_off = q_addr[OFF_BITS+1:2];
+    wire [IDX_BITS-1:0] q_idx = q_addr[OFF_BITS+IDX_BITS+1:OFF_BITS+2];
+    wire [TAG_BITS-1:0] q_tag = q_addr[31:OFF_BITS+IDX_BITS+2];
+
+    // Line being refilled (q_addr may move on while the burst runs)
+    reg [IDX_BITS-1:0] r_idx;
+    reg [TAG_BITS-1:0] r_tag;
+    reg                r_way;
+    reg [OFF_BITS-1:0] beat;
+
+    // ------------------------------------------------------------
+    // Data array (registered read)
+    // ------------------------------------------------------------
+    reg                          rd_en;
+    reg  [OFF_BITS+IDX_BITS-1:0] rd_row;
+    reg  [WAYS*32-1:0]           rd_data;
+
+    always @(*) begin
+        rd_en  = 1'b0;
+        rd_row = {q_idx, q_off};
+        if (i_req && state != S_REFILL) begin
+            rd_en  = 1'b1;
+            rd_row = {i_addr[OFF_BITS+IDX_BITS+1:OFF_BITS+2], i_addr[OFF_BITS+1:2]};
+        end else if (state == S_REPLAY) begin
+            rd_en  = 1'b1;
+        end
+    end
+
+    always @(posedge clk) begin
+        if (rd_en)
+            rd_data <= data_mem[rd_row];
+        if (state == S_REFILL && mem_rvalid)
+            data_mem[{r_idx, beat}][r_way*32 +: 32] <= mem_rdata;
+        if (state == S_REFILL && mem_done)
+            tag_mem[r_idx][r_way*TAG_BITS +: TAG_BITS] <= r_tag;
+    end
+
+    // ------------------------------------------------------------
+    // Lookup
+    // ------------------------------------------------------------
+    wire [WAYS*TAG_BITS-1:0] set_tags = tag_mem[q_idx];
+    wire [WAYS-1:0] way_hit;
+    genvar w;
+    generate
+        for (w = 0; w < WAYS; w = w + 1) begin : g_way
+            assign way_hit[w] = valid_r[w*SETS + q_idx] &&
+                                (set_tags[w*TAG_BITS +: TAG_BITS] == q_tag);
+        end
+    endgenerate
+
+    wire hit     = (state == S_LOOKUP) && |way_hit;
+    wire hit_way = (WAYS == 2) ? way_hit[WAYS-1] : 1'b0;
+    wire victim  = (WAYS == 1)                   ? 1'b0 :
+                   !valid_r[q_idx]               ? 1'b0 :
+                   !valid_r[(WAYS-1)*SETS+q_idx] ? 1'b1 :
+                                                   lru_r[q_idx];
+
+    assign i_ack   = hit;
+    assign i_rdata = rd_data[hit_way*32 +: 32];
+
+    assign mem_req   = (state == S_REFILL);
+    assign mem_we    = 1'b0;
+    assign mem_addr  = {r_tag, r_idx, {OFF_BITS{1'b0}}, 2'b00};
+    assign mem_wdata = 32'b0;
+
+    // ------------------------------------------------------------
+    // Statistics (read by the testbenches)
+    // ------------------------------------------------------------
+    reg [31:0] stat_hits, stat_misses, stat_miss_cycles;
+    reg        in_miss;
+    reg        hit_counted;     // a held hit is counted once
+
+    // ------------------------------------------------------------
+    // Control
+    // ------------------------------------------------------------
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state       <= S_IDLE;
+            valid_r     <= {WAYS*SETS{1'b0}};
+            lru_r       <= {SETS{1'b0}};
+            inv_done    <= 1'b0;
+            q_addr      <= 32'b0;
+            r_idx       <= {IDX_BITS{1'b0}};
+            r_tag       <= {TAG_BITS{1'b0}};
+            r_way       <= 1'b0;
+            beat        <= {OFF_BITS{1'b0}};
+            in_miss     <= 1'b0;
+            hit_counted <= 1'b0;
+            stat_hits        <= 32'd0;
+            stat_misses      <= 32'd0;
+            stat_miss_cycles <= 32'd0;
+        end else begin
+            if (!inv_req)
+                inv_done <= 1'b0;
+            if (in_miss)
+                stat_miss_cycles <= stat_miss_cycles + 1'b1;
+
+            case (state)
+                S_LOOKUP: begin
+                    if (hit) begin
+                        if (WAYS == 2)
+                            lru_r[q_idx] <= ~hit_way;
+                        if (in_miss)
+                            in_miss <= 1'b0;
+                        else if (!hit_counted)
+                            stat_hits <= stat_hits + 1'b1;
+                        hit_counted <= 1'b1;
+                    end else if (!i_req) begin
+                        // Miss (unless already superseded by a new fetch)
+                        in_miss     <= 1'b1;
+                        stat_misses <= stat_misses + 1'b1;
+                        r_idx <= q_idx;
+                        r_tag <= q_tag;
+                        r_way <= victim;
+                        beat  <= {OFF_BITS{1'b0}};
+                        state <= S_REFILL;
+                    end
+                end
+
+                S_REFILL: begin
+                    if (mem_rvalid)
+                        beat <= beat + 1'b1;
+                    if (mem_done) begin
+                        valid_r[r_way*SETS + r_idx] <= 1'b1;
+                        if (WAYS == 2)
+                            lru_r[r_idx] <= ~r_way;
+                        state <= S_REPLAY;
+                    end
+                end
+
+                S_REPLAY: state <= S_LOOKUP;
+
+                default: ;
+            endcase
+
+            // fence.i: drop every line (a refill in flight finishes first)
+            if (inv_req && !inv_done && state != S_REFILL) begin
+                valid_r  <= {WAYS*SETS{1'b0}};
+                inv_done <= 1'b1;
+            end
+
+            // New fetch (during a refill it is replayed once the line is in)
+            if (i_req) begin
+                q_addr      <= i_addr;
+                hit_counted <= 1'b0;
+                if (state != S_REFILL)
+                    state <= S_LOOKUP;
+            end
+        end
+    end
+endmodule
@@ -1,28 +1,29 @@
 `timescale 1ns / 1ps
 
-// Simple IF/ID pipeline latch with branch flush
+// IF/ID pipeline latch with branch flush.
+// The instruction word itself is held by the fetch BRAM output register
+// (port A of dp_bram); this latch only tracks its PC and whether it is valid.
 module if_id(
     input  wire        clk,
     input  wire        rst_n,
     input  wire        hold,       // hold current contents when 1
     input  wire        flush,      // asserted on branch/jump
     input  wire [31:0] if_pc,
-    input  wire [31:0] if_inst,
     output reg  [31:0] id_pc,
-    output reg  [31:0] id_inst
+    output reg         id_valid    // 0 = ID slot is a bubble (reset/flush)
 );
     // Hold has priority over normal advance; flush clears the latch.
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            id_pc   <= 32'b0;
-            id_inst <= 32'b0;
+            id_pc    <= 32'b0;
+            id_valid <= 1'b0;
         end else if (flush) begin
-            id_pc   <= 32'b0;
-            id_inst <= 32'b0;
+            id_pc    <= 32'b0;
+            id_valid <= 1'b0;
         end else if (!hold) begin
-            id_pc   <= if_pc;
-            id_inst <= if_inst;
+            id_pc    <= if_pc;
+            id_valid <= 1'b1;
         end
-        // when hold==1, retain previous id_pc/id_inst
+        // when hold==1, retain previous id_pc/id_valid
     end
 endmodule
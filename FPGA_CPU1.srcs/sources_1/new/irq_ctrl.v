@@ -0,0 +1,48 @@
+`timescale 1ns / 1ps
+
+// Interrupt controller: collects level interrupt lines from the peripherals
+// into the core's machine external interrupt (mip.MEIP / mcause 11).
+//
+// Registers (word offsets from IRQC_BASE):
+//   0x00 PENDING  RO  raw source levels
+//   0x04 ENABLE   RW  per-source enable
+//   0x08 ACTIVE   RO  PENDING & ENABLE (what the handler has to service)
+// Sources are level-sensitive: a handler clears the cause in its device,
+// there is nothing to acknowledge here.
+module irq_ctrl #(
+    parameter integer N = 8                 // number of sources (<= 32)
+)(
+    input  wire         clk,
+    input  wire         rst_n,
+
+    input  wire [N-1:0] src,
+
+    // Register port (IO slave in cpu_top: writes on the ack edge)
+    input  wire         wr,
+    input  wire [7:0]   addr,
+    input  wire [31:0]  wdata,
+    output reg  [31:0]  rdata,
+
+    output wire         irq
+);
+    reg [N-1:0] enable;
+    wire [N-1:0] active = src & enable;
+
+    assign irq = |active;
+
+    always @(*) begin
+        case (addr[7:2])
+            6'h0:    rdata = {{(32-N){1'b0}}, src};
+            6'h1:    rdata = {{(32-N){1'b0}}, enable};
+            6'h2:    rdata = {{(32-N){1'b0}}, active};
+            default: rdata = 32'h0;
+        endcase
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n)
+            enable <= {N{1'b0}};
+        else if (wr && addr[7:2] == 6'h1)
+            enable <= wdata[N-1:0];
+    end
+endmodule
@@ -0,0 +1,87 @@
+`timescale 1ns / 1ps
+
+// Mailbox: a word FIFO between interrupt handlers (or the DMA) and a task.
+// A producer posts a word with a single store; the consumer is woken by
+// the non-empty interrupt and pops words with loads.
+//
+// Registers (offsets from MBOX_BASE):
+//   0x00 DATA    W: push (dropped and OVERFLOW set when full)
+//                R: pop the oldest word (reads 0 and pops nothing when empty)
+//   0x04 COUNT   RO: words in the FIFO
+//   0x08 DEPTH   RO: capacity (DEPTH parameter)
+//   0x0C CTRL    [0] irq while not empty; W [1] flush the FIFO
+//   0x10 STATUS  [0] not empty, [1] full, [2] overflow (write 1 to clear)
+module mbox #(
+    parameter integer DEPTH = 64            // power of two
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Register port (IO slave in cpu_top: reads and writes on the ack edge)
+    input  wire        wr,
+    input  wire        rd,
+    input  wire [7:0]  addr,
+    input  wire [31:0] wdata,
+    output reg  [31:0] rdata,
+
+    output wire        irq
+);
+    localparam integer AW = $clog2(DEPTH);
+
+    reg [31:0]  mem [0:DEPTH-1];
+    reg [AW-1:0] wp, rp;
+    reg [AW:0]  count;
+    reg         ie, ovf;
+
+    wire empty = (count == 0);
+    wire full  = (count == DEPTH);
+    wire flush = wr && addr[7:2] == 6'h3 && wdata[1];
+    wire push  = wr && addr[7:2] == 6'h0 && !full;
+    wire pop   = rd && addr[7:2] == 6'h0 && !empty;
+
+    assign irq = ie && !empty;
+
+    always @(*) begin
+        case (addr[7:2])
+            6'h0:    rdata = empty ? 32'h0 : mem[rp];
+            6'h1:    rdata = {{(31-AW){1'b0}}, count};
+            6'h2:    rdata = DEPTH;
+            6'h3:    rdata = {31'b0, ie};
+            6'h4:    rdata = {29'b0, ovf, full, !empty};
+            default: rdata = 32'h0;
+        endcase
+    end
+
+    always @(posedge clk) begin
+        if (push)
+            mem[wp] <= wdata;
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            wp    <= {AW{1'b0}};
+            rp    <= {AW{1'b0}};
+            count <= {(AW+1){1'b0}};
+            ie    <= 1'b0;
+            ovf   <= 1'b0;
+        end else if (flush) begin
+            wp    <= {AW{1'b0}};
+            rp    <= {AW{1'b0}};
+            count <= {(AW+1){1'b0}};
+            ie    <= wdata[0];
+        end else begin
+            if (push)
+                wp <= wp + 1'b1;
+            if (pop)
+                rp <= rp + 1'b1;
+            count <= count + push - pop;
+
+            if (wr && addr[7:2] == 6'h0 && full)
+                ovf <= 1'b1;
+            if (wr && addr[7:2] == 6'h3)
+                ie <= wdata[0];
+            if (wr && addr[7:2] == 6'h4 && wdata[2])
+                ovf <= 1'b0;
+        end
+    end
+endmodule
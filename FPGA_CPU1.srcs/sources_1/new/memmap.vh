@@ -0,0 +1,28 @@
+// Generated by firmware/memmap.py - do not edit, edit memmap.py instead
+// Included inside cpu_top / bus_xbar (localparams only).
+localparam [31:0]  ITCM_BASE      = 32'h0000_0000;
+localparam integer ITCM_WORDS     = 32768;
+localparam integer ITCM_ADDR_BITS = 15;
+localparam [31:0]  DTCM_BASE      = 32'h1000_0000;
+localparam integer DTCM_WORDS     = 98304;
+localparam integer DTCM_ADDR_BITS = 17;
+localparam [31:0]  EXT_BASE       = 32'h8000_0000;
+localparam [31:0]  FLASH_BASE     = 32'h2000_0000;
+localparam [31:0]  IO_BASE        = 32'hF000_0000;
+localparam integer CLK_HZ         = 25000000;
+localparam [19:0]  UART_DIV       = 20'h00D90;
+localparam [31:0]  IRQC_BASE      = 32'hFFFF_F000;
+localparam [31:0]  DMA_BASE       = 32'hFFFF_F100;
+localparam [31:0]  TIMER_BASE     = 32'hFFFF_F200;
+localparam [31:0]  QSPI_BASE      = 32'hFFFF_F300;
+localparam [31:0]  CRC_BASE       = 32'hFFFF_F400;
+localparam [31:0]  MBOX_BASE      = 32'hFFFF_F500;
+localparam [31:0]  SEMA_BASE      = 32'hFFFF_F600;
+localparam [31:0]  GPIO_BASE      = 32'hFFFF_F700;
+localparam [31:0]  SIM_BASE       = 32'hFFFF_F800;
+localparam [31:0]  UART_BASE      = 32'hFFFF_FFE0;
+localparam integer IRQ_UART       = 0;
+localparam integer IRQ_DMA        = 1;
+localparam integer IRQ_TIMER      = 2;
+localparam integer IRQ_MBOX       = 3;
+localparam integer IRQ_GPIO       = 4;
@@ -0,0 +1,125 @@
+`timescale 1ns / 1ps
+
+// Behavioural quad-SPI NOR flash (simulation only), enough for qspi_xip.v.
+//
+// Understands Fast Read Quad I/O (0xEB): command on DQ0, 24-bit address
+// and mode byte on DQ[3:0], DUMMY_CLKS - 2 more clocks, then data nibbles
+// (high nibble first) from the address on, incrementing, until CS# rises.
+// Mode byte 0xAx would select continuous-read mode; the controller never
+// sends it and the model reports it. Any other command is reported and
+// ignored. Outputs change T_V ns after the falling SCK edge, as on a real
+// part. Addresses wrap modulo WORDS, so a small instance can stand in for
+// the whole 16 MB (an image for offset N*WORDS*4 appears at offset 0).
+//
+// INIT_FILE (hex, one little-endian word per line) preloads the array.
+module qspi_flash_model #(
+    parameter integer WORDS      = 1 << 16,   // power of two
+    parameter integer DUMMY_CLKS = 6,
+    parameter integer T_V        = 6,          // clock-to-output, ns
+    parameter         INIT_FILE  = ""
+)(
+    input  wire       sck,
+    input  wire       cs_n,
+    inout  wire [3:0] dq
+);
+    localparam integer AW = $clog2(WORDS) + 2;  // byte address bits
+
+    reg [31:0] mem [0:WORDS-1];
+
+    localparam integer P_CMD   = 0;
+    localparam integer P_ADDR  = 1;
+    localparam integer P_DUMMY = 2;
+    localparam integer P_DATA  = 3;
+    localparam integer P_IGN   = 4;
+
+    integer    phase, cnt;
+    reg [7:0]  cmd;
+    reg [31:0] addr_mode;
+    reg [AW-1:0] byte_addr;
+    reg        hi_nib;
+    reg [7:0]  cur;
+    reg [3:0]  dq_out;
+    reg        dq_drive;
+
+    initial begin
+        dq_drive = 1'b0;
+        phase    = P_IGN;
+        if (INIT_FILE != "")
+            $readmemh(INIT_FILE, mem);
+    end
+
+    assign dq = dq_drive ? dq_out : 4'bzzzz;
+
+    function [7:0] byte_at(input [AW-1:0] a);
+        reg [31:0] w;
+        begin
+            w       = mem[a[AW-1:2]];
+            byte_at = w >> {a[1:0], 3'b000};
+        end
+    endfunction
+
+    always @(negedge cs_n) begin
+        phase    = P_CMD;
+        cnt      = 0;
+        cmd      = 8'h0;
+        dq_drive = 1'b0;
+    end
+
+    always @(posedge cs_n) begin
+        dq_drive = 1'b0;
+    end
+
+    // Inputs are sampled on the rising edge
+    always @(posedge sck) begin
+        if (!cs_n) begin
+            case (phase)
+                P_CMD: begin
+                    cmd = {cmd[6:0], dq[0]};
+                    cnt = cnt + 1;
+                    if (cnt == 8) begin
+                        cnt = 0;
+                        if (cmd == 8'hEB) begin
+                            phase = P_ADDR;
+                        end else begin
+                            $display("qspi_flash_model: unsupported command %h", cmd);
+                            phase = P_IGN;
+                        end
+                    end
+                end
+                P_ADDR: begin
+                    addr_mode = {addr_mode[27:0], dq};
+                    cnt = cnt + 1;
+                    if (cnt == 8) begin
+                        if (addr_mode[7:4] == 4'hA)
+                            $display("qspi_flash_model: continuous-read mode byte %h", addr_mode[7:0]);
+                        byte_addr = addr_mode[31:8];
+                        hi_nib    = 1'b1;
+                        cnt       = 0;
+                        phase     = (DUMMY_CLKS > 2) ? P_DUMMY : P_DATA;
+                    end
+                end
+                P_DUMMY: begin
+                    cnt = cnt + 1;
+                    if (cnt == DUMMY_CLKS - 2)
+                        phase = P_DATA;
+                end
+                default: ;
+            endcase
+        end
+    end
+
+    // Data goes out after the falling edge
+    always @(negedge sck) begin
+        if (!cs_n && phase == P_DATA) begin
+            #(T_V);
+            if (!cs_n) begin
+                cur      = byte_at(byte_addr);
+                dq_out   = hi_nib ? cur[7:4] : cur[3:0];
+                dq_drive = 1'b1;
+                if (!hi_nib)
+                    byte_addr = byte_addr + 1'b1;
+                hi_nib = !hi_nib;
+            end
+        end
+    end
+endmodule
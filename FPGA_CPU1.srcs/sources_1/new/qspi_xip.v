@@ -0,0 +1,361 @@
+`timescale 1ns / 1ps
+
+// Quad-SPI flash controller for execute-in-place reads (FLASH region).
+//
+// Both bus ports read through a small direct-mapped line cache:
+//   - instruction slave (level ack, see bus_xbar.v): a hit answers on the
+//     next cycle like the ITCM, a miss holds i_ack low until the word is in;
+//   - data slave (req/ack, see bus_arbiter.v): reads hit in one cycle;
+//     writes are acked and dropped (the flash is read-only here).
+// A line is filled with one Fast Read Quad I/O (0xEB) command: the command
+// on DQ0, address and mode byte on DQ[3:0], DUMMY_CLKS - 2 turnaround
+// clocks, then 2 clocks per byte. A waiting access is answered as soon as
+// its word has arrived, without waiting for the rest of the line.
+//
+// Prefetch: whenever the controller is idle it fetches the line after the
+// last one accessed, so straight-line code and sequential reads mostly hit.
+// A demand miss to another line aborts a prefetch (CS# high ends any read).
+//
+// SCK runs at clk / 2. Outputs change on the falling SCK edge, input is
+// sampled just before it (the flash drives after the previous falling
+// edge, so the data has had a whole SCK period to settle). After reset
+// SCK toggles a few times with CS# high: on the board SCK goes out through
+// STARTUPE2, which swallows its first three edges.
+//
+// Registers (offsets from QSPI_BASE):
+//   0x00 CTRL    [0] prefetch enable (reset 1); W [1] invalidate the cache
+//   0x04 STATUS  [0] flash transaction in progress
+//   0x08 HITS    accesses served from the cache       (write clears)
+//   0x0C MISSES  accesses that waited for the flash   (write clears)
+//   0x10 PREF    lines fetched by prefetch             (write clears)
+//
+// The flash must be in quad mode (Spansion CR1.QUAD / Micron default).
+// DUMMY_CLKS counts the clocks between the address and the first data
+// nibble, mode byte included: 6 for Spansion S25FL128S (mode + 4 dummy),
+// 10 for Micron MT25QL128 (its default for 0xEB); at least 3.
+module qspi_xip #(
+    parameter integer LINES      = 16,    // cache lines, power of two
+    parameter integer LINE_WORDS = 8,     // words per line, power of two
+    parameter integer DUMMY_CLKS = 6
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Instruction slave
+    input  wire        i_req,
+    input  wire [31:0] i_addr,
+    output reg  [31:0] i_rdata,
+    output wire        i_ack,
+
+    // Data slave
+    input  wire        d_req,
+    input  wire [31:0] d_addr,
+    input  wire        d_we,
+    output reg  [31:0] d_rdata,
+    output reg         d_ack,
+
+    // Register port (IO slave in cpu_top: writes on the ack edge)
+    input  wire        wr,
+    input  wire [7:0]  addr,
+    input  wire [31:0] wdata,
+    output reg  [31:0] rdata,
+
+    // Flash pins
+    output reg         sck,
+    output reg         cs_n,
+    output reg  [3:0]  dq_o,
+    output reg  [3:0]  dq_oe,
+    input  wire [3:0]  dq_i
+);
+    localparam integer OFF_BITS  = $clog2(LINE_WORDS);
+    localparam integer IDX_BITS  = $clog2(LINES);
+    localparam integer LINE_BITS = 22 - OFF_BITS;            // 16 MB of words
+    localparam integer TAG_BITS  = LINE_BITS - IDX_BITS;
+
+    localparam [7:0]  CMD_QUAD_IO_READ = 8'hEB;
+    localparam [7:0]  MODE_NO_XIP      = 8'hFF;              // not continuous read
+
+    localparam [2:0] Q_IDLE  = 3'd0;
+    localparam [2:0] Q_CMD   = 3'd1;
+    localparam [2:0] Q_ADDR  = 3'd2;     // address + mode byte, 8 nibbles
+    localparam [2:0] Q_DUMMY = 3'd3;
+    localparam [2:0] Q_DATA  = 3'd4;
+    localparam [2:0] Q_GAP   = 3'd5;     // CS# high time between commands
+    localparam [2:0] Q_WAKE  = 3'd6;     // clocks with CS# high after reset
+
+    // ------------------------------------------------------------
+    // Line cache
+    // ------------------------------------------------------------
+    reg [31:0]          cdata [0:LINES*LINE_WORDS-1];
+    reg [TAG_BITS-1:0]  ctag  [0:LINES-1];
+    reg [LINES-1:0]     cvalid;
+
+    // Line being filled
+    reg                 filling, fill_pref;
+    reg [LINE_BITS-1:0] fill_line;
+    reg [OFF_BITS:0]    fill_cnt;        // words written so far
+
+    function [LINE_BITS-1:0] line_of(input [31:0] a);
+        line_of = a[23:OFF_BITS+2];
+    endfunction
+
+    function present(input [LINE_BITS-1:0] l);
+        present = cvalid[l[IDX_BITS-1:0]] && ctag[l[IDX_BITS-1:0]] == l[LINE_BITS-1:IDX_BITS];
+    endfunction
+
+    function hit(input [31:0] a);
+        hit = present(line_of(a)) ||
+              (filling && fill_line == line_of(a) && a[OFF_BITS+1:2] < fill_cnt);
+    endfunction
+
+    function [31:0] word_of(input [31:0] a);
+        word_of = cdata[a[IDX_BITS+OFF_BITS+1:2]];
+    endfunction
+
+    // ------------------------------------------------------------
+    // Ports
+    // ------------------------------------------------------------
+    reg        i_pend, d_pend, d_we_q;
+    reg [31:0] i_q, d_q;
+    reg        pf_en, pf_valid;
+    reg [LINE_BITS-1:0] pf_line;
+    reg [31:0] stat_hits, stat_misses, stat_pref;
+
+    assign i_ack = !i_pend;
+
+    wire i_miss = i_pend && !hit(i_q);
+    wire d_miss = d_pend && !d_we_q && !hit(d_q);
+
+    // Line the ports are waiting for (data side first)
+    wire                 want     = d_miss || i_miss;
+    wire [LINE_BITS-1:0] want_line = d_miss ? line_of(d_q) : line_of(i_q);
+
+    always @(*) begin
+        case (addr[7:2])
+            6'h0:    rdata = {31'b0, pf_en};
+            6'h1:    rdata = {31'b0, !cs_n};
+            6'h2:    rdata = stat_hits;
+            6'h3:    rdata = stat_misses;
+            6'h4:    rdata = stat_pref;
+            default: rdata = 32'h0;
+        endcase
+    end
+
+    // ------------------------------------------------------------
+    // Flash engine
+    // ------------------------------------------------------------
+    reg [2:0]  q_state;
+    reg [31:0] sh;                       // outgoing bits, MSB first
+    reg [4:0]  cnt;                      // clocks left in this phase
+    reg [2:0]  nib;                      // nibble within the incoming word
+    reg [31:0] rx;
+
+    wire invalidate = wr && addr[7:2] == 6'h0 && wdata[1];
+    wire abort      = filling && (invalidate ||
+                      (fill_pref && want && want_line != fill_line));
+
+    // Address + mode byte, and the incoming word: nibbles arrive high then
+    // low for bytes 0..3
+    wire [31:0] addr_mode = {fill_line, {OFF_BITS{1'b0}}, 2'b00, MODE_NO_XIP};
+    wire [31:0] rx_next   = rx | ({28'b0, dq_i} << {nib[2:1], ~nib[0], 2'b00});
+    wire        word_in   = (q_state == Q_DATA) && sck && nib == 3'd7 && !abort;
+
+    always @(posedge clk) begin
+        if (word_in)
+            cdata[{fill_line[IDX_BITS-1:0], fill_cnt[OFF_BITS-1:0]}] <= rx_next;
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            cvalid      <= {LINES{1'b0}};
+            filling     <= 1'b0;
+            fill_pref   <= 1'b0;
+            fill_line   <= {LINE_BITS{1'b0}};
+            fill_cnt    <= {(OFF_BITS+1){1'b0}};
+            i_pend      <= 1'b0;
+            i_q         <= 32'h0;
+            i_rdata     <= 32'h0;
+            d_pend      <= 1'b0;
+            d_we_q      <= 1'b0;
+            d_q         <= 32'h0;
+            d_rdata     <= 32'h0;
+            d_ack       <= 1'b0;
+            pf_en       <= 1'b1;
+            pf_valid    <= 1'b0;
+            pf_line     <= {LINE_BITS{1'b0}};
+            stat_hits   <= 32'd0;
+            stat_misses <= 32'd0;
+            stat_pref   <= 32'd0;
+            q_state     <= Q_WAKE;
+            sck         <= 1'b0;
+            cs_n        <= 1'b1;
+            dq_o        <= 4'hF;
+            dq_oe       <= 4'h0;
+            sh          <= 32'h0;
+            cnt         <= 5'd8;
+            nib         <= 3'd0;
+            rx          <= 32'h0;
+        end else begin
+            d_ack <= 1'b0;
+
+            // Instruction side
+            if (i_req) begin
+                pf_line  <= line_of(i_addr) + 1'b1;
+                pf_valid <= 1'b1;
+                if (hit(i_addr)) begin
+                    i_rdata   <= word_of(i_addr);
+                    i_pend    <= 1'b0;
+                    stat_hits <= stat_hits + 1'b1;
+                end else begin
+                    i_q         <= i_addr;
+                    i_pend      <= 1'b1;
+                    stat_misses <= stat_misses + 1'b1;
+                end
+            end else if (i_pend && hit(i_q)) begin
+                i_rdata <= word_of(i_q);
+                i_pend  <= 1'b0;
+            end
+
+            // Data side
+            if (d_req) begin
+                d_q    <= d_addr;
+                d_we_q <= d_we;
+                d_pend <= 1'b1;
+                if (!d_we) begin
+                    pf_line  <= line_of(d_addr) + 1'b1;
+                    pf_valid <= 1'b1;
+                    if (hit(d_addr))
+                        stat_hits <= stat_hits + 1'b1;
+                    else
+                        stat_misses <= stat_misses + 1'b1;
+                end
+            end else if (d_pend && (d_we_q || hit(d_q))) begin
+                d_rdata <= word_of(d_q);
+                d_ack   <= 1'b1;
+                d_pend  <= 1'b0;
+            end
+
+            // Registers
+            if (wr) begin
+                case (addr[7:2])
+                    6'h0: begin
+                        pf_en <= wdata[0];
+                        if (wdata[1])
+                            cvalid <= {LINES{1'b0}};
+                    end
+                    6'h2: stat_hits   <= 32'd0;
+                    6'h3: stat_misses <= 32'd0;
+                    6'h4: stat_pref   <= 32'd0;
+                    default: ;
+                endcase
+            end
+
+            // Flash engine
+            if (abort) begin
+                filling <= 1'b0;
+                cs_n    <= 1'b1;
+                sck     <= 1'b0;
+                dq_oe   <= 4'h0;
+                cnt     <= 5'd2;
+                q_state <= Q_GAP;
+            end else begin
+                case (q_state)
+                    Q_IDLE: begin
+                        if (want || (pf_en && pf_valid && !present(pf_line))) begin
+                            fill_line <= want ? want_line : pf_line;
+                            fill_pref <= !want;
+                            fill_cnt  <= {(OFF_BITS+1){1'b0}};
+                            filling   <= 1'b1;
+                            if (!want)
+                                stat_pref <= stat_pref + 1'b1;
+                            // The slot is rewritten from word 0 on
+                            cvalid[want ? want_line[IDX_BITS-1:0] : pf_line[IDX_BITS-1:0]] <= 1'b0;
+                            ctag[want ? want_line[IDX_BITS-1:0] : pf_line[IDX_BITS-1:0]] <=
+                                want ? want_line[LINE_BITS-1:IDX_BITS] : pf_line[LINE_BITS-1:IDX_BITS];
+                            sh      <= {CMD_QUAD_IO_READ, 24'h0};
+                            cnt     <= 5'd8;
+                            cs_n    <= 1'b0;
+                            sck     <= 1'b0;
+                            dq_oe   <= 4'b1101;          // DQ1 is the flash's output
+                            dq_o    <= {3'b110, CMD_QUAD_IO_READ[7]};
+                            q_state <= Q_CMD;
+                        end
+                    end
+
+                    Q_GAP: begin
+                        cnt <= cnt - 1'b1;
+                        if (cnt == 5'd0)
+                            q_state <= Q_IDLE;
+                    end
+
+                    Q_WAKE: begin
+                        sck <= !sck;
+                        cnt <= cnt - 1'b1;
+                        if (cnt == 5'd0) begin
+                            sck     <= 1'b0;
+                            q_state <= Q_IDLE;
+                        end
+                    end
+
+                    default: begin
+                        sck <= !sck;
+                        if (sck) begin
+                            // Falling edge: sample, then drive the next bits
+                            case (q_state)
+                                Q_CMD: begin
+                                    if (cnt == 5'd1) begin
+                                        sh      <= addr_mode;
+                                        dq_oe   <= 4'hF;
+                                        dq_o    <= addr_mode[31:28];
+                                        cnt     <= 5'd8;
+                                        q_state <= Q_ADDR;
+                                    end else begin
+                                        sh   <= sh << 1;
+                                        dq_o <= {3'b110, sh[30]};
+                                        cnt  <= cnt - 1'b1;
+                                    end
+                                end
+                                Q_ADDR: begin
+                                    if (cnt == 5'd1) begin
+                                        dq_o    <= 4'hF;
+                                        cnt     <= DUMMY_CLKS - 2;
+                                        q_state <= Q_DUMMY;
+                                    end else begin
+                                        sh   <= sh << 4;
+                                        dq_o <= sh[27:24];
+                                        cnt  <= cnt - 1'b1;
+                                    end
+                                end
+                                Q_DUMMY: begin
+                                    dq_oe <= 4'h0;
+                                    cnt   <= cnt - 1'b1;
+                                    if (cnt == 5'd1) begin
+                                        nib     <= 3'd0;
+                                        rx      <= 32'h0;
+                                        q_state <= Q_DATA;
+                                    end
+                                end
+                                Q_DATA: begin
+                                    nib <= nib + 1'b1;
+                                    rx  <= rx_next;
+                                    if (nib == 3'd7) begin
+                                        rx       <= 32'h0;
+                                        fill_cnt <= fill_cnt + 1'b1;
+                                        if (fill_cnt == LINE_WORDS - 1) begin
+                                            cvalid[fill_line[IDX_BITS-1:0]] <= 1'b1;
+                                            filling <= 1'b0;
+                                            cs_n    <= 1'b1;
+                                            cnt     <= 5'd2;
+                                            q_state <= Q_GAP;
+                                        end
+                                    end
+                                end
+                                default: ;
+                            endcase
+                        end
+                    end
+                endcase
+            end
+        end
+    end
+endmodule
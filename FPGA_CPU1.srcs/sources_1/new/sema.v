@@ -0,0 +1,55 @@
+`timescale 1ns / 1ps
+
+// Hardware semaphores: N test-and-set lock bits.
+//
+// Registers (offsets from SEMA_BASE):
+//   0x00 + 4*i  LOCK[i]  R: previous state (0 = it was free and the reader
+//                        now holds it, 1 = already held) and sets it
+//                        W: any value releases it
+//   0x80        HELD     RO: bitmap of held locks, no side effect
+//   0x84        RELEASE  W: release every lock whose bit is 1
+//
+// The test and the set happen in the one IO access, so no interrupt (and,
+// with more bus masters, no other hart) can get between them. Bus order
+// gives acquire/release semantics: an MMIO load waits for the store buffer
+// to drain, and the releasing store queues behind the section's stores.
+module sema #(
+    parameter integer N = 32                // locks (<= 32)
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Register port (IO slave in cpu_top: reads and writes on the ack edge)
+    input  wire        wr,
+    input  wire        rd,
+    input  wire [7:0]  addr,
+    input  wire [31:0] wdata,
+    output reg  [31:0] rdata
+);
+    reg [N-1:0] held;
+
+    wire [4:0] idx     = addr[6:2];
+    wire       is_lock = !addr[7] && idx < N;
+
+    always @(*) begin
+        if (is_lock)
+            rdata = {31'b0, held[idx]};
+        else if (addr[7:2] == 6'h20)
+            rdata = held;                    // zero-extended
+        else
+            rdata = 32'h0;
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            held <= {N{1'b0}};
+        end else begin
+            if (rd && is_lock)
+                held[idx] <= 1'b1;
+            if (wr && is_lock)
+                held[idx] <= 1'b0;
+            if (wr && addr[7:2] == 6'h21)
+                held <= held & ~wdata[N-1:0];
+        end
+    end
+endmodule
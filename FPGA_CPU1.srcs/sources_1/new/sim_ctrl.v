@@ -0,0 +1,52 @@
+`timescale 1ns / 1ps
+
+// Simulation-only control device: a console that prints the moment it is
+// written, and a test finisher. cpu_top instantiates it with SIM_CTRL = 1
+// (testbenches, Verilator harness); the board build leaves it out, so its
+// page reads 0 and writes are dropped there.
+//
+// Registers (offsets from SIM_BASE):
+//   0x00  CONSOLE  W: [7:0] printed by the simulator at once, decoded like
+//                  the testbench UART capture (CR dropped, other control
+//                  bytes as [0xNN])
+//   0x04  EXIT     W: ends the simulation with exit code wdata (0 = pass);
+//                  firmware halts after it, like a tohost write
+//   0x08  ID       RO: 0x53494D31 ("SIM1"), for firmware to tell a
+//                  simulation from the board
+//
+// A UART byte costs ~10 bit periods of simulated time; a CONSOLE byte costs
+// one IO write. exit / exit_code hold the finisher write for the harness.
+module sim_ctrl (
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Register port (IO slave in cpu_top: writes on the ack edge)
+    input  wire        wr,
+    input  wire [7:0]  addr,
+    input  wire [31:0] wdata,
+    output wire [31:0] rdata,
+
+    output reg         exit,
+    output reg  [31:0] exit_code
+);
+    assign rdata = (addr[7:2] == 6'h02) ? 32'h53494D31 : 32'h0;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            exit      <= 1'b0;
+            exit_code <= 32'h0;
+        end else if (wr && addr[7:2] == 6'h00) begin
+            if (wdata[7:0] >= 8'd32 && wdata[7:0] < 8'd127)
+                $write("%c", wdata[7:0]);
+            else if (wdata[7:0] == 8'd10)
+                $write("\n");
+            else if (wdata[7:0] != 8'd13)
+                $write("[0x%02x]", wdata[7:0]);
+        end else if (wr && addr[7:2] == 6'h01 && !exit) begin
+            exit      <= 1'b1;
+            exit_code <= wdata;
+            $display("\n[SIM] Firmware exit, code %0d", wdata);
+            $finish;
+        end
+    end
+endmodule
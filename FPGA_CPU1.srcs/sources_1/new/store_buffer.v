@@ -0,0 +1,220 @@
+`timescale 1ns / 1ps
+
+// Store buffer between the core data port and the system bus.
+//
+// Both sides use the data bus protocol from bus_arbiter.v. Stores to memory
+// regions are acked on the next cycle and queued here; the queue drains
+// one word at a time in cycles where the core has no bus access of its own.
+// A store to a word already queued merges its bytes into that entry, so
+// sb/sh streams turn into word writes.
+//
+// Loads go to the bus straight away (ahead of queued stores) and the queued
+// bytes for that word are laid over the response. A load fully covered by
+// the queue is answered from here without a bus access.
+//
+// The IO region has side effects, so IO loads and stores wait for the queue
+// to drain and are passed through in order. 'empty' tells fence logic that
+// everything has reached the bus slaves.
+module store_buffer #(
+    parameter integer DEPTH = 4       // entries (power of two, >= 2)
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // Core side
+    input  wire        s_req,
+    input  wire [31:0] s_addr,
+    input  wire        s_we,
+    input  wire [3:0]  s_be,
+    input  wire [31:0] s_wdata,
+    output wire [31:0] s_rdata,
+    output wire        s_ack,
+
+    // Bus side
+    output wire        m_req,
+    output wire [31:0] m_addr,
+    output wire        m_we,
+    output wire [3:0]  m_be,
+    output wire [31:0] m_wdata,
+    input  wire [31:0] m_rdata,
+    input  wire        m_ack,
+
+    output wire        empty
+);
+    `include "memmap.vh"
+
+    localparam integer PW        = $clog2(DEPTH);
+    localparam [3:0]   REGION_IO = IO_BASE[31:28];
+
+    // ------------------------------------------------------------
+    // Queue (word address + byte mask + data per entry)
+    // ------------------------------------------------------------
+    reg [DEPTH-1:0] e_valid;
+    reg [29:0]      e_addr [0:DEPTH-1];
+    reg [3:0]       e_be   [0:DEPTH-1];
+    reg [31:0]      e_data [0:DEPTH-1];
+    reg [PW-1:0]    head, tail;
+    reg [PW:0]      count;
+
+    // Core request parked until it can be served
+    reg        p_valid;
+    reg [31:0] p_addr, p_wdata;
+    reg        p_we;
+    reg [3:0]  p_be;
+
+    wire        c_req   = p_valid || s_req;
+    wire [31:0] c_addr  = p_valid ? p_addr  : s_addr;
+    wire        c_we    = p_valid ? p_we    : s_we;
+    wire [3:0]  c_be    = p_valid ? p_be    : s_be;
+    wire [31:0] c_wdata = p_valid ? p_wdata : s_wdata;
+    wire        c_io    = (c_addr[31:28] == REGION_IO);
+
+    // Bus: one request in flight; the next may go out in its ack cycle
+    reg  busy;
+    reg  busy_core;          // response goes back to the core
+    reg  [29:0] ld_addr;     // word of the core load in flight
+    wire bus_free = !busy || m_ack;
+
+    // ------------------------------------------------------------
+    // Lookup: entry holding a word, and queued bytes for a load
+    // ------------------------------------------------------------
+    function [PW:0] find;    // {found, index}
+        input [29:0] word;
+        integer k;
+        begin
+            find = {1'b0, {PW{1'b0}}};
+            for (k = 0; k < DEPTH; k = k + 1)
+                if (e_valid[k] && e_addr[k] == word)
+                    find = {1'b1, k[PW-1:0]};
+        end
+    endfunction
+
+    // A word is in at most one entry (merging keeps it that way), so the
+    // overlay does not depend on queue order
+    function [35:0] overlay;  // {mask, data}
+        input [29:0] word;
+        input [31:0] base;
+        integer k, b;
+        begin
+            overlay = {4'b0000, base};
+            for (k = 0; k < DEPTH; k = k + 1)
+                if (e_valid[k] && e_addr[k] == word)
+                    for (b = 0; b < 4; b = b + 1)
+                        if (e_be[k][b]) begin
+                            overlay[32 + b]  = 1'b1;
+                            overlay[8*b +: 8] = e_data[k][8*b +: 8];
+                        end
+        end
+    endfunction
+
+    wire [PW:0]  c_find  = find(c_addr[31:2]);
+    wire [35:0]  c_ovl   = overlay(c_addr[31:2], 32'b0);
+    wire [35:0]  r_ovl   = overlay(ld_addr, m_rdata);
+
+    // ------------------------------------------------------------
+    // What happens to the core request this cycle
+    // ------------------------------------------------------------
+    wire q_empty  = (count == 0);
+    wire q_full   = (count == DEPTH);
+
+    wire drain_go;            // head is issued this cycle (defined below)
+    wire merge_ok = c_find[PW] && !(drain_go && c_find[PW-1:0] == head);
+
+    wire st_merge = c_req &&  c_we && !c_io && merge_ok;
+    wire st_push  = c_req &&  c_we && !c_io && !merge_ok && !q_full;
+    wire ld_fwd   = c_req && !c_we && !c_io && (c_ovl[35:32] == 4'b1111);
+    wire ld_issue = c_req && !c_we && !c_io && !ld_fwd && bus_free;
+    wire io_issue = c_req &&  c_io && q_empty && bus_free;
+    wire c_done   = st_merge | st_push | ld_fwd | ld_issue | io_issue;
+
+    assign drain_go = !ld_issue && !io_issue && !q_empty && bus_free;
+
+    assign m_req   = ld_issue | io_issue | drain_go;
+    assign m_addr  = drain_go ? {e_addr[head], 2'b00} : c_addr;
+    assign m_we    = drain_go ? 1'b1                  : c_we;
+    assign m_be    = drain_go ? e_be[head]            : c_be;
+    assign m_wdata = drain_go ? e_data[head]          : c_wdata;
+
+    // ------------------------------------------------------------
+    // Responses to the core
+    // ------------------------------------------------------------
+    reg        st_ack, fwd_ack;
+    reg [31:0] fwd_data;
+
+    assign s_ack   = st_ack | fwd_ack | (m_ack && busy && busy_core);
+    assign s_rdata = fwd_ack ? fwd_data : r_ovl[31:0];
+
+    assign empty = q_empty && !busy && !p_valid;
+
+    integer b;
+    always @(posedge clk) begin
+        if (st_merge) begin
+            for (b = 0; b < 4; b = b + 1)
+                if (c_be[b])
+                    e_data[c_find[PW-1:0]][8*b +: 8] <= c_wdata[8*b +: 8];
+            e_be[c_find[PW-1:0]] <= e_be[c_find[PW-1:0]] | c_be;
+        end
+        if (st_push) begin
+            e_addr[tail] <= c_addr[31:2];
+            e_be[tail]   <= c_be;
+            e_data[tail] <= c_wdata;
+        end
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            e_valid   <= {DEPTH{1'b0}};
+            head      <= {PW{1'b0}};
+            tail      <= {PW{1'b0}};
+            count     <= {(PW+1){1'b0}};
+            p_valid   <= 1'b0;
+            p_addr    <= 32'b0;
+            p_wdata   <= 32'b0;
+            p_we      <= 1'b0;
+            p_be      <= 4'b0;
+            busy      <= 1'b0;
+            busy_core <= 1'b0;
+            ld_addr   <= 30'b0;
+            st_ack    <= 1'b0;
+            fwd_ack   <= 1'b0;
+            fwd_data  <= 32'b0;
+        end else begin
+            st_ack   <= st_merge | st_push;
+            fwd_ack  <= ld_fwd;
+            fwd_data <= c_ovl[31:0];
+
+            // Park a core request that could not be served
+            if (c_done)
+                p_valid <= 1'b0;
+            else if (s_req) begin
+                p_valid <= 1'b1;
+                p_addr  <= s_addr;
+                p_wdata <= s_wdata;
+                p_we    <= s_we;
+                p_be    <= s_be;
+            end
+
+            if (st_push) begin
+                e_valid[tail] <= 1'b1;
+                tail          <= tail + 1'b1;
+            end
+            if (drain_go) begin
+                e_valid[head] <= 1'b0;
+                head          <= head + 1'b1;
+            end
+            case ({st_push, drain_go})
+                2'b10: count <= count + 1'b1;
+                2'b01: count <= count - 1'b1;
+                default: ;
+            endcase
+
+            if (m_req) begin
+                busy      <= 1'b1;
+                busy_core <= !drain_go;
+                ld_addr   <= c_addr[31:2];
+            end else if (m_ack) begin
+                busy <= 1'b0;
+            end
+        end
+    end
+endmodule
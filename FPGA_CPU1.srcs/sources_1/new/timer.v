@@ -0,0 +1,200 @@
+`timescale 1ns / 1ps
+
+// Multi-channel timer: NCH compare/capture/PWM channels on the low word of
+// the CLINT mtime (cpu_core.mtime_o), so channel times and the tick share
+// one clock and firmware can mix them freely.
+//
+// Registers (offsets from TIMER_BASE; channel c at c * 0x20):
+//   +0x00 CMP     next match time; writing it arms the channel (set the
+//                 mode in CTRL first)
+//   +0x04 PERIOD  compare: added to CMP on every match (0 = one-shot)
+//                 PWM:     period in cycles (0 stops the output)
+//   +0x08 DUTY    PWM high time in cycles (0 = low, >= PERIOD = high)
+//   +0x0C CAPT    RO: mtime at the last selected edge of cap_in[c]
+//   +0x10 CTRL    [1:0] mode (0 off, 1 compare, 2 PWM), [2] irq on match,
+//                 [3] irq on capture, [5:4] capture edge (0 none, 1 rising,
+//                 2 falling, 3 both); R: [8] armed, [9] PWM output
+//   0x80  STATUS  [NCH-1:0] match flags, [16+NCH-1:16] capture flags,
+//                 write 1 to clear
+//   0x84  MTIME   RO: mtime low word
+//
+// A channel matches in the cycle mtime reaches CMP. "Reached" is a wrapping
+// compare (mtime - CMP >= 0 as a signed 32-bit value), so a CMP written up
+// to 2^31 cycles in the past matches at once instead of after a wrap.
+// Compare mode sets the match flag on every match. PWM mode sets it at the
+// start of every period; CMP is the first period start, and the period is
+// timed from where it began, so a DUTY write only moves the falling edge.
+// CAPT is taken after the two-flop synchroniser, three cycles after the pin.
+module timer #(
+    parameter integer NCH = 4               // channels (<= 4)
+)(
+    input  wire           clk,
+    input  wire           rst_n,
+
+    input  wire [31:0]    mtime,
+
+    // Register port (IO slave in cpu_top: writes on the ack edge)
+    input  wire           wr,
+    input  wire [7:0]     addr,
+    input  wire [31:0]    wdata,
+    output reg  [31:0]    rdata,
+
+    input  wire [NCH-1:0] cap_in,
+    output reg  [NCH-1:0] pwm,
+    output wire           irq
+);
+    localparam integer CW = (NCH > 1) ? $clog2(NCH) : 1;
+
+    localparam [1:0] M_OFF     = 2'd0;
+    localparam [1:0] M_COMPARE = 2'd1;
+    localparam [1:0] M_PWM     = 2'd2;
+
+    reg [31:0]    cmp    [0:NCH-1];
+    reg [31:0]    period [0:NCH-1];
+    reg [31:0]    duty   [0:NCH-1];
+    reg [31:0]    capt   [0:NCH-1];
+    reg [31:0]    start  [0:NCH-1];   // PWM: time the current period began
+    reg [5:0]     ctrl   [0:NCH-1];
+    reg [NCH-1:0] armed, match_f, capt_f;
+
+    // Capture input synchroniser and edge detect
+    reg [NCH-1:0] cap_s1, cap_s2, cap_q;
+    wire [NCH-1:0] cap_rise = cap_s2 & ~cap_q;
+    wire [NCH-1:0] cap_fall = ~cap_s2 & cap_q;
+
+    reg [NCH-1:0] match_ie, capt_ie;
+    integer j;
+    always @(*) begin
+        for (j = 0; j < NCH; j = j + 1) begin
+            match_ie[j] = ctrl[j][2];
+            capt_ie[j]  = ctrl[j][3];
+        end
+    end
+
+    assign irq = |(match_f & match_ie) | |(capt_f & capt_ie);
+
+    // Register read
+    wire [CW-1:0] r_ch = addr[CW+4:5];
+    always @(*) begin
+        rdata = 32'h0;
+        if (addr[7]) begin
+            case (addr[6:2])
+                5'd0: rdata = {{(16-NCH){1'b0}}, capt_f, {(16-NCH){1'b0}}, match_f};
+                5'd1: rdata = mtime;
+                default: rdata = 32'h0;
+            endcase
+        end else if (addr[6:5] < NCH) begin
+            case (addr[4:2])
+                3'd0: rdata = cmp[r_ch];
+                3'd1: rdata = period[r_ch];
+                3'd2: rdata = duty[r_ch];
+                3'd3: rdata = capt[r_ch];
+                3'd4: rdata = {22'b0, pwm[r_ch], armed[r_ch], 2'b0, ctrl[r_ch]};
+                default: rdata = 32'h0;
+            endcase
+        end
+    end
+
+    integer i;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            for (i = 0; i < NCH; i = i + 1) begin
+                cmp[i]    <= 32'h0;
+                period[i] <= 32'h0;
+                duty[i]   <= 32'h0;
+                capt[i]   <= 32'h0;
+                start[i]  <= 32'h0;
+                ctrl[i]   <= 6'h0;
+            end
+            armed   <= {NCH{1'b0}};
+            match_f <= {NCH{1'b0}};
+            capt_f  <= {NCH{1'b0}};
+            pwm     <= {NCH{1'b0}};
+            cap_s1  <= {NCH{1'b0}};
+            cap_s2  <= {NCH{1'b0}};
+            cap_q   <= {NCH{1'b0}};
+        end else begin
+            cap_s1 <= cap_in;
+            cap_s2 <= cap_s1;
+            cap_q  <= cap_s2;
+
+            // Flags: clear first so an event in the same cycle is kept
+            if (wr && addr[7] && addr[6:2] == 5'd0) begin
+                match_f <= match_f & ~wdata[NCH-1:0];
+                capt_f  <= capt_f  & ~wdata[16+NCH-1:16];
+            end
+
+            for (i = 0; i < NCH; i = i + 1) begin
+                // Match
+                if (armed[i] && !before(mtime, cmp[i])) begin
+                    case (ctrl[i][1:0])
+                        M_COMPARE: begin
+                            match_f[i] <= 1'b1;
+                            if (period[i] != 32'd0)
+                                cmp[i] <= cmp[i] + period[i];
+                            else
+                                armed[i] <= 1'b0;
+                        end
+                        M_PWM: begin
+                            if (period[i] == 32'd0) begin
+                                pwm[i]   <= 1'b0;
+                                armed[i] <= 1'b0;
+                            end else if (!pwm[i] || cmp[i] == start[i] + period[i]) begin
+                                // Period start (or a high output running on)
+                                match_f[i] <= 1'b1;
+                                start[i]   <= cmp[i];
+                                if (duty[i] == 32'd0 || duty[i] >= period[i]) begin
+                                    pwm[i] <= (duty[i] != 32'd0);
+                                    cmp[i] <= cmp[i] + period[i];
+                                end else begin
+                                    pwm[i] <= 1'b1;
+                                    cmp[i] <= cmp[i] + duty[i];
+                                end
+                            end else begin
+                                // Falling edge
+                                pwm[i] <= 1'b0;
+                                cmp[i] <= start[i] + period[i];
+                            end
+                        end
+                        default: armed[i] <= 1'b0;
+                    endcase
+                end
+
+                // Capture
+                if ((ctrl[i][4] && cap_rise[i]) || (ctrl[i][5] && cap_fall[i])) begin
+                    capt[i]   <= mtime;
+                    capt_f[i] <= 1'b1;
+                end
+            end
+
+            // Channel register writes (after the match so they win)
+            if (wr && !addr[7] && addr[6:5] < NCH) begin
+                case (addr[4:2])
+                    3'd0: begin
+                        cmp[r_ch]   <= wdata;
+                        armed[r_ch] <= (ctrl[r_ch][1:0] != M_OFF);
+                    end
+                    3'd1: period[r_ch] <= wdata;
+                    3'd2: duty[r_ch]   <= wdata;
+                    3'd4: begin
+                        ctrl[r_ch] <= wdata[5:0];
+                        if (wdata[1:0] == M_OFF) begin
+                            armed[r_ch] <= 1'b0;
+                            pwm[r_ch]   <= 1'b0;
+                        end
+                    end
+                    default: ;
+                endcase
+            end
+        end
+    end
+
+    // 1 while mtime is still before t (wrapping)
+    function before(input [31:0] now, input [31:0] t);
+        reg [31:0] d;
+        begin
+            d      = now - t;
+            before = d[31];
+        end
+    endfunction
+endmodule
@@ -3,12 +3,14 @@
 // top.v - Top-level wrapper for Arty A7 board
 module top (
     input  wire        clk100,
-    input  wire        btn0,    // step button (unused)
+    input  wire        btn0,    // GPIO 4 / timer capture (cpu_top)
     input  wire        btn1,    // reset button (active high here)
     input  wire [1:0]  sw,
     output wire [3:0]  led,
     output wire        uart_tx,
-    input  wire        uart_rx
+    input  wire        uart_rx,
+    output wire        qspi_cs,     // configuration flash (SCK via STARTUPE2)
+    inout  wire [3:0]  qspi_dq
 );
 
     // -----------------------------
@@ -36,14 +38,37 @@ module top (
     // -----------------------------
     wire [3:0] led_out;
 
-    cpu_top u_cpu_top (
+    // No DDR controller on this build yet: the external region is backed by
+    // a small on-chip stand-in (aliases every 16 KB)
+    wire qspi_sck;
+
+    cpu_top #(
+        .DDR_SIM_WORDS(4096),
+        .DDR_LATENCY(4),
+        .FLASH_MODEL(0)
+    ) u_cpu_top (
         .clk100 (clk50),      // Actually 50MHz now!
         .rst_n  (rst_n),
         .btn0   (btn0),
         .sw     (sw),
         .led    (led_out),
         .uart_tx(uart_tx),
-        .uart_rx(uart_rx)
+        .uart_rx(uart_rx),
+        .qspi_cs_n(qspi_cs),
+        .qspi_sck(qspi_sck),
+        .qspi_dq(qspi_dq)
+    );
+
+    // The flash clock is the configuration clock pin (CCLK), reachable
+    // only through STARTUPE2 after configuration
+    STARTUPE2 #(
+        .PROG_USR("FALSE"),
+        .SIM_CCLK_FREQ(0.0)
+    ) u_startup (
+        .CFGCLK(), .CFGMCLK(), .EOS(), .PREQ(),
+        .CLK(1'b0), .GSR(1'b0), .GTS(1'b0), .KEYCLEARB(1'b1), .PACK(1'b0),
+        .USRCCLKO(qspi_sck), .USRCCLKTS(1'b0),
+        .USRDONEO(1'b1), .USRDONETS(1'b1)
     );
 
     // -----------------------------
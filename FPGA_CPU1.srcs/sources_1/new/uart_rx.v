@@ -1,101 +1,123 @@
 `timescale 1ns / 1ps
 
+// UART receiver with a runtime bit period.
+//
+// `divisor` is the bit period in clock cycles with 4 fractional bits
+// (cycles * 16). The bit timer is a phase accumulator: it adds 16 per
+// clock and subtracts `divisor` at each sample, so the remainder carries
+// into the next bit and the average period is exact even at 8-13 cycles
+// per bit (2-3 Mbaud at 25 MHz). Each bit is the majority of three
+// consecutive samples centred on mid-bit; the start bit is re-checked half
+// a bit in (glitch reject). The receiver is back in IDLE right after the
+// stop bit, so back-to-back frames are not lost. A low stop bit flags a
+// framing error (uart_rx_ferr, with uart_rx_valid); an all-zero frame with
+// a framing error is a break. Minimum divisor: 4 cycles (0x40).
 module uart_rx #(
-    parameter BIT_RATE     = 115200,
     parameter PAYLOAD_BITS = 8,
-    parameter CLK_HZ       = 100_000_000,
     parameter STOP_BITS    = 1
 )(
     input  wire clk,
     input  wire resetn,        // active low
+    input  wire [19:0] divisor,
     input  wire uart_rxd,
     input  wire uart_rx_en,
-    output wire uart_rx_break,
+    output reg  uart_rx_break,
     output reg  uart_rx_valid,
+    output reg  uart_rx_ferr,
     output reg  [PAYLOAD_BITS-1:0] uart_rx_data
 );
-    localparam integer BIT_P        = 1_000_000_000 / BIT_RATE;      // ns
-    localparam integer CLK_P        = 1_000_000_000 / CLK_HZ;        // ns
-    localparam integer CYCLES_PER_BIT = BIT_P / CLK_P;
-    localparam integer COUNT_REG_LEN  = 1 + $clog2(CYCLES_PER_BIT);
-
-    reg [COUNT_REG_LEN-1:0] cycle_counter;
+    reg [20:0] phase;
     reg [3:0] bit_counter;
     reg [PAYLOAD_BITS-1:0] rx_shift;
-    reg [2:0] fsm_state, n_fsm_state;
+    reg [1:0] fsm_state;
     reg rxd_sync0, rxd_sync1;
+    reg [2:0] rxd_hist;
 
     localparam FSM_IDLE  = 0;
     localparam FSM_START = 1;
     localparam FSM_RECV  = 2;
     localparam FSM_STOP  = 3;
 
-    assign uart_rx_break = 1'b0; // not implemented here
-
-    // sync RXD
+    // sync RXD, keep the last three samples for the majority vote
     always @(posedge clk) begin
         rxd_sync0 <= uart_rxd;
         rxd_sync1 <= rxd_sync0;
+        rxd_hist  <= {rxd_hist[1:0], rxd_sync1};
     end
 
-    wire next_bit    = cycle_counter == CYCLES_PER_BIT;
-    wire payload_done= bit_counter   == PAYLOAD_BITS;
-    wire stop_done   = bit_counter   == STOP_BITS && fsm_state == FSM_STOP;
+    wire rxd_vote = (rxd_hist[0] & rxd_hist[1]) | (rxd_hist[1] & rxd_hist[2]) |
+                    (rxd_hist[0] & rxd_hist[2]);
 
-    // next state
-    always @(*) begin
-        case (fsm_state)
-            FSM_IDLE : n_fsm_state = (uart_rx_en && !rxd_sync1) ? FSM_START : FSM_IDLE;
-            FSM_START: n_fsm_state = next_bit     ? FSM_RECV : FSM_START;
-            FSM_RECV : n_fsm_state = payload_done ? FSM_STOP : FSM_RECV;
-            FSM_STOP : n_fsm_state = stop_done    ? FSM_IDLE : FSM_STOP;
-            default  : n_fsm_state = FSM_IDLE;
-        endcase
-    end
+    // The middle vote sample is two cycles older than rxd_sync1, so the
+    // start bit is checked half a bit + two cycles after the falling edge
+    // (later bits follow at whole bit periods from there).
+    wire [20:0] phase_next = phase + 21'd16;
+    wire [20:0] half_bit   = {2'b0, divisor[19:1]} + 21'd32;
+    wire        at_half    = (phase_next >= half_bit);
+    wire        at_bit     = (phase_next >= {1'b0, divisor});
 
-    // counters and shift
     always @(posedge clk) begin
         if (!resetn) begin
-            cycle_counter <= 0;
+            phase         <= 0;
             bit_counter   <= 0;
             rx_shift      <= 0;
             uart_rx_valid <= 1'b0;
+            uart_rx_ferr  <= 1'b0;
+            uart_rx_break <= 1'b0;
             uart_rx_data  <= 0;
             fsm_state     <= FSM_IDLE;
         end else begin
-            fsm_state <= n_fsm_state;
             uart_rx_valid <= 1'b0;
+            uart_rx_break <= 1'b0;
+            phase         <= phase_next;
 
             case (fsm_state)
                 FSM_IDLE: begin
-                    cycle_counter <= 0;
-                    bit_counter   <= 0;
+                    phase       <= 0;
+                    bit_counter <= 0;
+                    if (uart_rx_en && !rxd_sync1)
+                        fsm_state <= FSM_START;
                 end
+
+                // Middle of the start bit: still low -> real frame
                 FSM_START: begin
-                    cycle_counter <= next_bit ? 0 : cycle_counter + 1;
+                    if (at_half) begin
+                        phase     <= phase_next - half_bit;
+                        fsm_state <= rxd_vote ? FSM_IDLE : FSM_RECV;
+                    end
                 end
+
                 FSM_RECV: begin
-                    if (next_bit) begin
-                        cycle_counter <= 0;
-                        rx_shift <= {rxd_sync1, rx_shift[PAYLOAD_BITS-1:1]};
-                        bit_counter <= bit_counter + 1;
-                    end else begin
-                        cycle_counter <= cycle_counter + 1;
+                    if (at_bit) begin
+                        phase       <= phase_next - {1'b0, divisor};
+                        rx_shift    <= {rxd_vote, rx_shift[PAYLOAD_BITS-1:1]};
+                        bit_counter <= bit_counter + 1'b1;
+                        if (bit_counter == PAYLOAD_BITS - 1) begin
+                            bit_counter <= 0;
+                            fsm_state   <= FSM_STOP;
+                        end
                     end
                 end
+
+                // Middle of each stop bit
                 FSM_STOP: begin
-                    if (next_bit) begin
-                        cycle_counter <= 0;
-                        bit_counter   <= bit_counter + 1;
-                        if (stop_done) begin
+                    if (at_bit) begin
+                        phase       <= phase_next - {1'b0, divisor};
+                        bit_counter <= bit_counter + 1'b1;
+                        if (!rxd_vote)
+                            uart_rx_ferr <= 1'b1;
+                        if (bit_counter == STOP_BITS - 1) begin
                             uart_rx_valid <= 1'b1;
                             uart_rx_data  <= rx_shift;
+                            uart_rx_break <= !rxd_vote && (rx_shift == 0);
+                            fsm_state     <= FSM_IDLE;
                         end
-                    end else begin
-                        cycle_counter <= cycle_counter + 1;
                     end
                 end
             endcase
+
+            if (fsm_state == FSM_IDLE)
+                uart_rx_ferr <= 1'b0;
         end
     end
 endmodule
@@ -0,0 +1,115 @@
+`timescale 1ns / 1ps
+
+// UART receive FIFO with error flags and interrupt conditions.
+//
+//   - Bytes from uart_rx are queued (DEPTH entries). A byte arriving while
+//     the FIFO is full is dropped and sets 'overrun'; a byte with a bad stop
+//     bit is still queued and sets 'ferr'. Both flags are sticky until
+//     cleared by software (clr_overrun / clr_ferr).
+//   - thr_hit: count >= threshold (level; threshold 0 disables it).
+//   - timeout: data is waiting and the line has been idle for timeout_bits
+//     bit periods since the last byte arrived or was read. Sticky until the
+//     next byte arrives or is read, so short messages that never reach the
+//     threshold still raise an interrupt.
+module uart_rx_fifo #(
+    parameter integer DEPTH = 64                  // power of two
+)(
+    input  wire        clk,
+    input  wire        rst_n,
+
+    // From uart_rx
+    input  wire        rx_valid,
+    input  wire [7:0]  rx_data,
+    input  wire        rx_ferr,
+
+    // CPU side
+    input  wire        pop,                        // consume head
+    output wire [7:0]  head,
+    output reg  [$clog2(DEPTH):0] count,
+    output wire        empty,
+    output wire        full,
+
+    // Error flags
+    output reg         overrun,
+    output reg         ferr,
+    input  wire        clr_overrun,
+    input  wire        clr_ferr,
+
+    // Interrupt conditions
+    input  wire [15:0] bit_cycles,                 // clock cycles per bit
+    input  wire [7:0]  threshold,
+    input  wire [7:0]  timeout_bits,
+    output wire        thr_hit,
+    output reg         timeout
+);
+    localparam integer PW = $clog2(DEPTH);
+
+    reg [7:0]    mem [0:DEPTH-1];
+    reg [PW-1:0] wr_ptr, rd_ptr;
+
+    assign empty = (count == 0);
+    assign full  = (count == DEPTH);
+    assign head  = mem[rd_ptr];
+
+    wire push    = rx_valid && !full;
+    wire do_pop  = pop && !empty;
+
+    assign thr_hit = (threshold != 0) && (count >= threshold);
+
+    // Idle timer: bit periods since the last push/pop
+    reg [15:0] cyc_cnt;
+    reg [7:0]  bit_cnt;
+
+    always @(posedge clk) begin
+        if (push)
+            mem[wr_ptr] <= rx_data;
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            wr_ptr  <= {PW{1'b0}};
+            rd_ptr  <= {PW{1'b0}};
+            count   <= 0;
+            overrun <= 1'b0;
+            ferr    <= 1'b0;
+            timeout <= 1'b0;
+            cyc_cnt <= 16'd0;
+            bit_cnt <= 8'd0;
+        end else begin
+            if (push)
+                wr_ptr <= wr_ptr + 1'b1;
+            if (do_pop)
+                rd_ptr <= rd_ptr + 1'b1;
+            case ({push, do_pop})
+                2'b10: count <= count + 1'b1;
+                2'b01: count <= count - 1'b1;
+                default: ;
+            endcase
+
+            if (rx_valid && full)
+                overrun <= 1'b1;
+            else if (clr_overrun)
+                overrun <= 1'b0;
+
+            if (rx_valid && rx_ferr)
+                ferr <= 1'b1;
+            else if (clr_ferr)
+                ferr <= 1'b0;
+
+            if (rx_valid || do_pop || empty) begin
+                cyc_cnt <= 16'd0;
+                bit_cnt <= 8'd0;
+                timeout <= 1'b0;
+            end else if (timeout_bits != 0 && !timeout) begin
+                if (cyc_cnt >= bit_cycles - 1'b1) begin
+                    cyc_cnt <= 16'd0;
+                    bit_cnt <= bit_cnt + 1'b1;
+                    if (bit_cnt + 1'b1 >= timeout_bits)
+                        timeout <= 1'b1;
+                end else begin
+                    cyc_cnt <= cyc_cnt + 1'b1;
+                end
+            end
+        end
+    end
+endmodule
@@ -1,18 +1,18 @@
 `timescale 1ns / 1ps
 
-module uart_tx #(
-    parameter CLK_FREQ = 100_000_000,
-    parameter BAUD     = 115200
-)(
+// UART transmitter. `divisor` is the bit period in clock cycles with 4
+// fractional bits (cycles * 16); the remainder of each bit carries into the
+// next, so fractional rates keep their average period (see uart_rx.v).
+module uart_tx (
     input  wire clk,
     input  wire rst,       // active high
+    input  wire [19:0] divisor,
     input  wire tx_start,
     input  wire [7:0] tx_data,
     output wire tx_busy,
     output reg  tx
 );
-    localparam CLKS_PER_BIT = CLK_FREQ / BAUD;
-    reg [15:0] clk_count = 0;
+    reg [20:0] phase = 0;
     reg [3:0]  bit_index = 0;
     reg [9:0]  shift_reg = 10'b1111111111; // idle high
     reg busy = 0;
@@ -22,24 +22,24 @@ module uart_tx #(
         if (rst) begin
             tx        <= 1'b1;
             busy      <= 1'b0;
-            clk_count <= 0;
+            phase     <= 0;
             bit_index <= 0;
             shift_reg <= 10'h3FF;
         end else begin
             if (tx_start && !busy) begin
                 shift_reg <= {1'b1, tx_data, 1'b0};
                 busy      <= 1'b1;
-                clk_count <= 0;
+                phase     <= 0;
                 bit_index <= 0;
             end else if (busy) begin
-                if (clk_count == CLKS_PER_BIT - 1) begin
-                    clk_count <= 0;
+                if (phase + 21'd16 >= {1'b0, divisor}) begin
+                    phase     <= phase + 21'd16 - {1'b0, divisor};
                     tx        <= shift_reg[bit_index];
                     bit_index <= bit_index + 1;
                     if (bit_index == 9)
                         busy <= 1'b0;
                 end else begin
-                    clk_count <= clk_count + 1;
+                    phase <= phase + 21'd16;
                 end
             end
         end
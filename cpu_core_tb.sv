@@ -6,10 +6,17 @@ module cpu_core_tb;
 
     reg rst_n = 0;
     wire [31:0] pc;
+    wire        i_req;
+    wire [31:0] i_addr;
+    wire        d_req;
     wire [31:0] d_addr;
     wire [31:0] d_wdata;
-    wire [31:0] d_rdata;
+    reg  [31:0] d_rdata_reg = 32'h0;
+    wire [31:0] d_rdata = d_rdata_reg;
+    reg         d_ack_reg = 1'b0;
+    wire        d_ack = d_ack_reg;
     wire        d_we;
+    wire [3:0]  d_be;
     wire        is_sw, is_sh, is_sb;
     wire [31:0] rs2_val_o;
     wire [31:0] wb_value;
@@ -17,7 +24,13 @@ module cpu_core_tb;
     reg [31:0] instr_mem [0:255];
     reg [31:0] data_mem [0:255];
     reg [31:0] prev_pc;
-    wire [31:0] instr_word = instr_mem[pc[9:2]];
+    reg  [31:0] instr_word = 32'h0;
+
+    // Instruction bus: synchronous read, always ready (models ITCM port A)
+    always @(posedge clk) begin
+        if (i_req)
+            instr_word <= instr_mem[i_addr[9:2]];
+    end
 
     cpu_core uut (
         .clk(clk),
@@ -25,11 +38,20 @@ module cpu_core_tb;
         .step_pulse(1'b1),
         .irq_i(1'b0),
         .pc_o(pc),
-        .instr_i(instr_word),
+        .i_req(i_req),
+        .i_addr(i_addr),
+        .i_rdata(instr_word),
+        .i_ack(1'b1),
+        .d_req(d_req),
         .d_addr(d_addr),
+        .d_we(d_we),
+        .d_be(d_be),
         .d_wdata(d_wdata),
         .d_rdata(d_rdata),
-        .d_we(d_we),
+        .d_ack(d_ack),
+        .fence_req_o(),
+        .fence_i_o(),
+        .fence_done_i(1'b1),
         .wb_value(wb_value),
         .is_sw_o(is_sw),
         .is_sh_o(is_sh),
@@ -37,30 +59,23 @@ module cpu_core_tb;
         .rs2_val_o(rs2_val_o)
     );
 
-    // Combinational memory read (no delay for loads)
-    assign d_rdata = (d_addr[31:16] == 16'h0000) ? data_mem[d_addr[9:2]] : 32'h0;
-
+    // Data bus: one-cycle slave (models a TCM behind bus_xbar)
     reg [31:0] word;
+    integer    lane;
     always @(posedge clk) begin
-        if (d_we && d_addr[31:16] == 16'h0000) begin
+        d_ack_reg <= d_req;
+        if (d_req && d_addr[31:16] == 16'h0000) begin
             word = data_mem[d_addr[9:2]];
-            if (is_sw) begin
-                word = d_wdata;
-            end else if (is_sh) begin
-                if (d_addr[1])
-                    word[31:16] = d_wdata[15:0];
-                else
-                    word[15:0] = d_wdata[15:0];
-            end else if (is_sb) begin
-                case (d_addr[1:0])
-                    2'b00: word[7:0]   = d_wdata[7:0];
-                    2'b01: word[15:8]  = d_wdata[7:0];
-                    2'b10: word[23:16] = d_wdata[7:0];
-                    2'b11: word[31:24] = d_wdata[7:0];
-                endcase
+            d_rdata_reg <= word;
+            if (d_we) begin
+                for (lane = 0; lane < 4; lane = lane + 1)
+                    if (d_be[lane])
+                        word[8*lane +: 8] = d_wdata[8*lane +: 8];
+                data_mem[d_addr[9:2]] <= word;
+                $display("MEM WRITE @ %0t idx=%0d data=%h", $time, d_addr[9:2], word);
             end
-            data_mem[d_addr[9:2]] <= word;
-            $display("MEM WRITE @ %0t idx=%0d data=%h", $time, d_addr[9:2], word);
+        end else if (d_req) begin
+            d_rdata_reg <= 32'h0;
         end
     end
 
@@ -5,18 +5,19 @@
 # ============================================================================
 #  UART Bootloader for RISC-V
 #  - Waits for firmware upload via UART
-#  - Writes to RAM starting at 0x1000
-#  - Jumps to firmware
+#  - Optional 'B' + divisor: switch to a faster baud rate for the transfer
+#  - Writes to RAM starting at 0x1000, feeding every byte to the CRC engine
+#  - Host sends the image CRC-32 (zlib.crc32) after it: ACK and jump to the
+#    firmware (at the reset baud rate again), or NAK and wait for a retry
 # ============================================================================
 
 .equ UART_TX_ADDR,    0xFFFFFFF0
 .equ UART_STAT_ADDR,  0xFFFFFFF4
-.equ FIRMWARE_BASE,   0x00001000
-.equ FIRMWARE_MAX,    0x0001F000   # 124KB max firmware
+.include "memmap.inc"           # FIRMWARE_BASE / FIRMWARE_MAX / STACK_TOP / UART_* / CRC_BASE
 
 _boot_start:
     # Initialize stack
-    lui     sp, 0x20              # sp = 0x20000
+    li      sp, STACK_TOP         # sp = top of DTCM
 
     # Print boot message
     la      a0, boot_msg
@@ -26,9 +27,11 @@ _boot_start:
     la      a0, wait_msg
     jal     uart_puts
 
-    # Wait for sync byte (0x55 = 'U')
+    # Wait for sync byte (0x55 = 'U') or baud command ('B')
 wait_sync:
     jal     uart_getc             # a0 = received byte
+    li      t0, 0x42              # 'B' baud command
+    beq     a0, t0, baud_cmd
     li      t0, 0x55              # 'U' sync byte
     bne     a0, t0, wait_sync
     
@@ -37,17 +40,8 @@ wait_sync:
     jal     uart_putc
     
     # Receive 4-byte length (little endian)
-    jal     uart_getc
-    mv      s0, a0                # s0 = byte 0
-    jal     uart_getc
-    slli    t0, a0, 8
-    or      s0, s0, t0            # s0 |= byte1 << 8
-    jal     uart_getc
-    slli    t0, a0, 16
-    or      s0, s0, t0            # s0 |= byte2 << 16
-    jal     uart_getc
-    slli    t0, a0, 24
-    or      s0, s0, t0            # s0 |= byte3 << 24
+    jal     uart_getw
+    mv      s0, a0
     
     # s0 = firmware length in bytes
     # Validate length
@@ -66,12 +60,15 @@ wait_sync:
     # Receive firmware
     li      s1, FIRMWARE_BASE     # s1 = destination pointer
     mv      s2, s0                # s2 = bytes remaining
+    li      s4, CRC_BASE
+    sw      zero, 0x00(s4)        # CRC CTRL: CRC-32, seed 0xFFFFFFFF
     
 receive_loop:
     beqz    s2, receive_done
     
     jal     uart_getc             # a0 = byte
     sb      a0, 0(s1)             # store byte
+    sb      a0, 0x04(s4)          # CRC DATA: one byte
     addi    s1, s1, 1             # ptr++
     addi    s2, s2, -1            # remaining--
     
@@ -83,9 +80,22 @@ receive_loop:
     j       receive_loop
 
 receive_done:
+    # 4-byte CRC-32 of the image from the host (little endian)
+    jal     uart_getw
+    lw      t0, 0x0C(s4)          # CRC RESULT
+    bne     a0, t0, crc_error
+
     # Send final ACK
     li      a0, 0x06
     jal     uart_putc
+
+    # Back to the reset baud rate for the application; give the host time
+    # to reopen its port before the messages below
+    li      a0, UART_DIV
+    jal     uart_set_div
+    li      t0, 200000
+1:  addi    t0, t0, -1
+    bnez    t0, 1b
     
     # Print success
     la      a0, done_msg
@@ -101,14 +111,54 @@ delay:
     addi    t0, t0, -1
     bnez    t0, delay
     
+    # Make the received image visible to instruction fetch (drains the
+    # store buffer, cleans/invalidates the caches)
+    .word   0x0000100f            # fence.i (assembler built for plain rv32i)
+
     # Jump to firmware!
     li      t0, FIRMWARE_BASE
     jr      t0
 
+    # Length out of range, or image corrupted in transit: NAK at the
+    # transfer rate, then back to the reset rate so the host can start over
+    # from scratch
 length_error:
+    li      a0, 0x15              # NAK
+    jal     uart_putc
+    li      a0, UART_DIV
+    jal     uart_set_div
     la      a0, err_msg
     jal     uart_puts
-    j       wait_sync             # Try again
+    j       wait_sync
+
+crc_error:
+    li      a0, 0x15              # NAK
+    jal     uart_putc
+    li      a0, UART_DIV
+    jal     uart_set_div
+    la      a0, crc_msg
+    jal     uart_puts
+    j       wait_sync
+
+    # 'B' + 4-byte BAUD divisor (clocks per bit * 16, little endian).
+    # ACK at the current rate, then switch; the host follows and sends 'U'.
+    # Divisors below 4 clocks per bit get a NAK and nothing changes.
+baud_cmd:
+    jal     uart_getw
+    mv      s3, a0
+    li      t0, 0x40
+    bltu    s3, t0, baud_nak
+    li      t0, 0x100000
+    bgeu    s3, t0, baud_nak
+    li      a0, 0x06              # ACK
+    jal     uart_putc
+    mv      a0, s3
+    jal     uart_set_div
+    j       wait_sync
+baud_nak:
+    li      a0, 0x15              # NAK
+    jal     uart_putc
+    j       wait_sync
 
 # ============================================================================
 #  UART Functions
@@ -147,6 +197,41 @@ uart_getc:
     andi    a0, a0, 0xFF
     ret
 
+# uart_getw: Receive 32-bit little-endian word, return in a0
+uart_getw:
+    mv      t5, ra
+    li      t6, 0                 # result
+    li      t4, 0                 # shift
+1:  jal     uart_getc
+    sll     a0, a0, t4
+    or      t6, t6, a0
+    addi    t4, t4, 8
+    li      t0, 32
+    bne     t4, t0, 1b
+    mv      a0, t6
+    mv      ra, t5
+    ret
+
+# uart_flush: Wait until the TX FIFO and shifter are empty
+uart_flush:
+    li      t1, UART_BASE
+1:  lw      t2, 0x08(t1)          # COUNT: TX FIFO bytes in [31:16]
+    srli    t2, t2, 16
+    bnez    t2, 1b
+    lw      t2, 0x14(t1)          # STATUS: TX busy
+    andi    t2, t2, 0x1
+    bnez    t2, 1b
+    ret
+
+# uart_set_div: Drain TX, then BAUD = a0
+uart_set_div:
+    mv      t3, ra
+    jal     uart_flush
+    li      t1, UART_BASE
+    sw      a0, 0x0C(t1)
+    mv      ra, t3
+    ret
+
 # ============================================================================
 #  Strings
 # ============================================================================
@@ -163,4 +248,6 @@ jump_msg:
     .asciz "Jumping to firmware at 0x1000...\r\n"
 err_msg:
     .asciz "\r\nERROR: Invalid length!\r\n"
+crc_msg:
+    .asciz "\r\nERROR: CRC mismatch, image discarded\r\n"
 
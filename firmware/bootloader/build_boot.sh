@@ -10,7 +10,7 @@ echo "[1] Compiling bootloader..."
 ${RISCV_PREFIX}gcc \
   -march=rv32i -mabi=ilp32 -mno-relax \
   -ffreestanding -nostdlib -nostartfiles \
-  -T boot_link.ld \
+  -L .. -T boot_link.ld \
   boot.s \
   -o boot.elf
 
@@ -18,25 +18,8 @@ echo "[2] ELF -> BIN..."
 ${RISCV_PREFIX}objcopy -O binary boot.elf boot.bin
 
 echo "[3] Generating boot_mem.vh..."
-# Generate hex file for Vivado
-python3 << 'EOF'
-from pathlib import Path
-
-data = Path("boot.bin").read_bytes()
-print(f"Bootloader size: {len(data)} bytes")
-
-# Pad to 32KB (full memory space, app will go at 0x1000)
-TOTAL_WORDS = 32768  # 128KB / 4
-padded = data.ljust(TOTAL_WORDS * 4, b"\x00")
-
-lines = []
-for i in range(TOTAL_WORDS):
-    word = int.from_bytes(padded[4*i:4*i+4], "little")
-    lines.append(f"{word:08x}")
-
-Path("boot_mem.vh").write_text("\n".join(lines) + "\n")
-print(f"Wrote boot_mem.vh")
-EOF
+# Generate hex file for Vivado (padded to the full ITCM, app will go at 0x1000)
+python3 ../make_hex.py boot.bin boot_mem.vh
 
 echo "[4] Copying to parent directories..."
 cp boot_mem.vh ../instr_mem.vh
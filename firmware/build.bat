@@ -4,6 +4,9 @@ cd /d "%~dp0"
 
 set RISCV_PREFIX=riscv64-unknown-elf-
 
+echo [0] Generating memory map (memmap.py)...
+python memmap.py
+
 echo [1] Building FreeRTOS firmware -^> prog.elf...
 %RISCV_PREFIX%gcc ^
   -march=rv32i_zicsr -mabi=ilp32 -mno-relax ^
@@ -13,6 +16,15 @@ echo [1] Building FreeRTOS firmware -^> prog.elf...
   -T link.ld ^
   crt0.s ^
   uart.c ^
+  irq.c ^
+  uart_rtos.c ^
+  dma.c ^
+  dma_rtos.c ^
+  timer.c ^
+  timer_rtos.c ^
+  crc.c ^
+  mbox_rtos.c ^
+  gpio_rtos.c ^
   main.c ^
   mem_util.c ^
   freertos_kernel/event_groups.c ^
@@ -32,13 +44,16 @@ if errorlevel 1 (
 )
 
 echo [2] ELF -^> BIN...
-%RISCV_PREFIX%objcopy -O binary prog.elf prog.bin
+%RISCV_PREFIX%objcopy -O binary -R .ext_text -R .ext_bss -R .flash_text prog.elf prog.bin
+%RISCV_PREFIX%objcopy -O binary -j .flash_text prog.elf flash.bin
 
-echo [3] BIN -^> HEX...
-python make_hex.py
+echo [3] ELF -^> HEX...
+python make_hex.py --elf prog.elf
 
 echo [4] Copying instr_mem.vh to Vivado directories...
 copy /Y instr_mem.vh ..\instr_mem.vh
+copy /Y ext_mem.vh ..\ext_mem.vh
+copy /Y flash_mem.vh ..\flash_mem.vh
 copy /Y instr_mem.vh ..\FPGA_CPU1.runs\synth_1\instr_mem.vh 2>nul
 copy /Y instr_mem.vh ..\FPGA_CPU1.ip_user_files\mem_init_files\instr_mem.vh 2>nul
 copy /Y instr_mem.vh ..\FPGA_CPU1.sim\sim_1\behav\xsim\instr_mem.vh 2>nul
@@ -4,6 +4,14 @@ cd "$(dirname "$0")"
 
 RISCV_PREFIX=riscv64-unknown-elf-
 
+# SIM_CONSOLE=1: print through the simulation console (sim_ctrl.v) instead
+# of the UART - simulation only, the board has no such device
+SIM_CFLAGS=""
+[ "${SIM_CONSOLE:-0}" = 1 ] && SIM_CFLAGS="-DSIM_CONSOLE"
+
+echo "[0] Generating memory map (memmap.py)..."
+python3 memmap.py
+
 echo "[1] Building FreeRTOS firmware -> prog.elf..."
 
 # Compile assembly file with preprocessor (uppercase .S)
@@ -12,9 +20,19 @@ $RISCV_PREFIX"gcc" \
   -ffreestanding -nostdlib -nostartfiles \
   -I freertos_kernel/include \
   -I freertos_port \
+  $SIM_CFLAGS \
   -T link.ld \
   crt0.s \
   uart.c \
+  irq.c \
+  uart_rtos.c \
+  dma.c \
+  dma_rtos.c \
+  timer.c \
+  timer_rtos.c \
+  crc.c \
+  mbox_rtos.c \
+  gpio_rtos.c \
   main.c \
   mem_util.c \
   \
@@ -32,17 +50,17 @@ $RISCV_PREFIX"gcc" \
   -lgcc -o prog.elf
 
 echo "[2] ELF -> BIN..."
-$RISCV_PREFIX"objcopy" -O binary prog.elf prog.bin
-
-echo "[3] BIN -> HEX..."
-xxd -p -c 4 prog.bin > prog.hex
+$RISCV_PREFIX"objcopy" -O binary -R .ext_text -R .ext_bss -R .flash_text prog.elf prog.bin  # UART upload
+$RISCV_PREFIX"objcopy" -O binary -j .flash_text prog.elf flash.bin  # program at FLASH_APP_OFFSET
 
-echo "[4] HEX -> instr_mem.vh..."
-python3 make_hex.py
+echo "[3] ELF -> instr_mem.vh / ext_mem.vh / flash_mem.vh..."
+python3 make_hex.py --elf prog.elf           # sparse, one @address record per segment
 
-echo "[5] Copying instr_mem.vh to Vivado directories..."
+echo "[4] Copying instr_mem.vh to Vivado directories..."
 # Copy to all locations Vivado might look for the file
 cp instr_mem.vh ../instr_mem.vh
+cp ext_mem.vh ../ext_mem.vh
+cp flash_mem.vh ../flash_mem.vh
 cp instr_mem.vh ../FPGA_CPU1.runs/synth_1/instr_mem.vh 2>/dev/null || true
 cp instr_mem.vh ../FPGA_CPU1.ip_user_files/mem_init_files/instr_mem.vh 2>/dev/null || true
 cp instr_mem.vh ../FPGA_CPU1.sim/sim_1/behav/xsim/instr_mem.vh 2>/dev/null || true
@@ -6,6 +6,9 @@ RISCV_PREFIX=riscv64-unknown-elf-
 
 echo "=== Building Application Firmware (for UART upload) ==="
 
+echo "[0] Generating memory map (memmap.py)..."
+python3 memmap.py
+
 echo "[1] Compiling application..."
 $RISCV_PREFIX"gcc" \
   -march=rv32i_zicsr -mabi=ilp32 -mno-relax \
@@ -15,6 +18,15 @@ $RISCV_PREFIX"gcc" \
   -T link_app.ld \
   crt0.s \
   uart.c \
+  irq.c \
+  uart_rtos.c \
+  dma.c \
+  dma_rtos.c \
+  timer.c \
+  timer_rtos.c \
+  crc.c \
+  mbox_rtos.c \
+  gpio_rtos.c \
   main.c \
   mem_util.c \
   freertos_kernel/event_groups.c \
@@ -4,16 +4,49 @@
 # Usage:
 #   ./build_debug.sh trap_test       - Build standalone trap test
 #   ./build_debug.sh context_test    - Build context switch test  
+#   ./build_debug.sh timer_test      - Build timer interrupt test
 #   ./build_debug.sh freertos        - Build FreeRTOS (normal)
+#   ./build_debug.sh mutex_demo      - Build FreeRTOS with demos/main_mutex_demo.c
+#   ./build_debug.sh queue_demo      - Build FreeRTOS with demos/main_queue_demo.c
+#   SIM_CONSOLE=1 ./build_debug.sh ...  - print through the simulation console
+#   OUT=dir ./build_debug.sh ...     - write prog.elf and the images to dir
+#                                      only (parallel builds, sim/regress)
 #
 set -e
 cd "$(dirname "$0")"
 
-RISCV_PREFIX=riscv64-unknown-elf-
+RISCV_PREFIX="${RISCV_PREFIX:-riscv64-unknown-elf-}"
+OUT="${OUT:-.}"
+mkdir -p "$OUT"
+
+# SIM_CONSOLE=1: print through the simulation console (sim_ctrl.v) instead
+# of the UART - simulation only, the board has no such device
+SIM_CFLAGS=""
+[ "${SIM_CONSOLE:-0}" = 1 ] && SIM_CFLAGS="-DSIM_CONSOLE"
 
 # Default to trap_test
 TEST="${1:-trap_test}"
 
+FREERTOS_FILES="
+    uart_rtos.c
+    dma.c
+    dma_rtos.c
+    timer.c
+    timer_rtos.c
+    crc.c
+    mbox_rtos.c
+    gpio_rtos.c
+    freertos_kernel/event_groups.c
+    freertos_kernel/list.c
+    freertos_kernel/queue.c
+    freertos_kernel/stream_buffer.c
+    freertos_kernel/tasks.c
+    freertos_kernel/timers.c
+    freertos_port/port.c
+    freertos_port/portASM.S
+    freertos_port/heap_4.c
+"
+
 echo "================================================"
 echo "  Building: $TEST"
 echo "================================================"
@@ -36,61 +69,68 @@ case "$TEST" in
         ;;
     freertos)
         MAIN_FILE="main.c"
-        EXTRA_FILES="
-            freertos_kernel/event_groups.c
-            freertos_kernel/list.c
-            freertos_kernel/queue.c
-            freertos_kernel/stream_buffer.c
-            freertos_kernel/tasks.c
-            freertos_kernel/timers.c
-            freertos_port/port.c
-            freertos_port/portASM.S
-            freertos_port/heap_4.c
-        "
+        EXTRA_FILES="$FREERTOS_FILES"
         echo "Full FreeRTOS build"
         ;;
+    mutex_demo|queue_demo)
+        MAIN_FILE="demos/main_$TEST.c"
+        EXTRA_FILES="$FREERTOS_FILES"
+        echo "FreeRTOS demo ($MAIN_FILE)"
+        ;;
     *)
         echo "Unknown test: $TEST"
-        echo "Usage: $0 [trap_test|timer_test|context_test|freertos]"
+        echo "Usage: $0 [trap_test|timer_test|context_test|freertos|mutex_demo|queue_demo]"
         exit 1
         ;;
 esac
 
 echo ""
-echo "[1] Compiling $MAIN_FILE -> prog.elf..."
+echo "[0] Generating memory map (memmap.py)..."
+python3 memmap.py
+
+echo "[1] Compiling $MAIN_FILE -> $OUT/prog.elf..."
 
 $RISCV_PREFIX"gcc" \
   -march=rv32i_zicsr -mabi=ilp32 -mno-relax \
   -ffreestanding -nostdlib -nostartfiles \
+  -I . \
   -I freertos_kernel/include \
   -I freertos_port \
+  $SIM_CFLAGS \
   -O2 \
   -T link.ld \
   crt0.s \
   uart.c \
+  irq.c \
   $MAIN_FILE \
   mem_util.c \
   $EXTRA_FILES \
-  -lgcc -o prog.elf
+  -lgcc -o "$OUT/prog.elf"
 
 echo "[2] ELF -> BIN..."
-$RISCV_PREFIX"objcopy" -O binary prog.elf prog.bin
+$RISCV_PREFIX"objcopy" -O binary -R .ext_text -R .ext_bss -R .flash_text "$OUT/prog.elf" "$OUT/prog.bin"  # UART upload
+$RISCV_PREFIX"objcopy" -O binary -j .flash_text "$OUT/prog.elf" "$OUT/flash.bin"  # program at FLASH_APP_OFFSET
 
-echo "[3] BIN -> HEX..."
-xxd -p -c 4 prog.bin > prog.hex
+echo "[3] ELF -> instr_mem.vh / ext_mem.vh / flash_mem.vh..."
+python3 make_hex.py --elf "$OUT/prog.elf" "$OUT"  # sparse, one @address record per segment
 
-echo "[4] HEX -> instr_mem.vh..."
-python3 make_hex.py
+if [ "$OUT" != "." ]; then
+    echo ""
+    echo "Build complete: $TEST -> $OUT"
+    exit 0
+fi
 
-echo "[5] Copying instr_mem.vh to simulation directories..."
+echo "[4] Copying instr_mem.vh to simulation directories..."
 cp instr_mem.vh ../instr_mem.vh
+cp ext_mem.vh ../ext_mem.vh
+cp flash_mem.vh ../flash_mem.vh
 cp instr_mem.vh ../FPGA_CPU1.runs/synth_1/instr_mem.vh 2>/dev/null || true
 cp instr_mem.vh ../FPGA_CPU1.sim/sim_1/behav/xsim/instr_mem.vh 2>/dev/null || true
 cp instr_mem.vh ../sim_debug/instr_mem.vh 2>/dev/null || true
 
 # Print size info
 echo ""
-echo "[6] Binary size:"
+echo "[5] Binary size:"
 ls -la prog.bin
 SIZE=$($RISCV_PREFIX"size" prog.elf)
 echo "$SIZE"
@@ -0,0 +1,36 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "crc.h"
+
+void crc_feed(const void *buf, size_t n) {
+    const uint8_t *p = buf;
+
+    while (n && ((uintptr_t)p & 3u)) {
+        CRC_DATA8 = *p++;
+        n--;
+    }
+    const uint32_t *w = (const uint32_t *)p;
+    for (; n >= 16; n -= 16, w += 4) {
+        CRC_DATA = w[0];
+        CRC_DATA = w[1];
+        CRC_DATA = w[2];
+        CRC_DATA = w[3];
+    }
+    for (; n >= 4; n -= 4)
+        CRC_DATA = *w++;
+    p = (const uint8_t *)w;
+    while (n--)
+        CRC_DATA8 = *p++;
+}
+
+uint32_t crc32(const void *buf, size_t n) {
+    crc_start(CRC_MODE_32);
+    crc_feed(buf, n);
+    return crc_result();
+}
+
+uint16_t crc16_ccitt(const void *buf, size_t n) {
+    crc_start(CRC_MODE_16);
+    crc_feed(buf, n);
+    return (uint16_t)crc_result();
+}
@@ -0,0 +1,49 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "memmap.h"
+
+/*
+ * CRC engine (crc.v) - register-level API, no RTOS needed.
+ *
+ * One engine, one running CRC: tasks that share it must serialise
+ * (mutex), and an ISR must not use it behind a task's back.
+ *
+ * DATA takes the bytes selected by the store's byte enables, so a buffer
+ * can also be fed by DMA with a fixed destination:
+ *   crc_start(CRC_MODE_32);
+ *   dma_start(ch, buf, (void *)&CRC_DATA, n,
+ *             dma_cfg(buf, (void *)&CRC_DATA, DMA_CFG_DST_FIXED), 0);
+ *   dma_wait(ch);
+ *   crc = CRC_RESULT;
+ */
+#define CRC_CTRL            (*(volatile uint32_t *)(MEMMAP_CRC_BASE + 0x00))
+#define CRC_DATA            (*(volatile uint32_t *)(MEMMAP_CRC_BASE + 0x04))
+#define CRC_DATA8           (*(volatile uint8_t  *)(MEMMAP_CRC_BASE + 0x04))
+#define CRC_STATE           (*(volatile uint32_t *)(MEMMAP_CRC_BASE + 0x08))
+#define CRC_RESULT          (*(volatile uint32_t *)(MEMMAP_CRC_BASE + 0x0C))
+#define CRC_COUNT           (*(volatile uint32_t *)(MEMMAP_CRC_BASE + 0x10))
+
+/* CTRL values */
+#define CRC_MODE_32         0u      /* IEEE 802.3, same as zlib.crc32()  */
+#define CRC_MODE_16         1u      /* CCITT 0x1021, seed 0xFFFF          */
+
+/* Select a polynomial and load its standard seed */
+static inline void crc_start(unsigned mode) {
+    CRC_CTRL = mode;
+}
+
+/* Feed n bytes: words while aligned, single bytes at the ends */
+void     crc_feed(const void *buf, size_t n);
+
+/* Finished CRC of everything fed since crc_start() */
+static inline uint32_t crc_result(void) {
+    return CRC_RESULT;
+}
+
+uint32_t crc32(const void *buf, size_t n);
+uint16_t crc16_ccitt(const void *buf, size_t n);
+
+#endif
@@ -5,7 +5,7 @@
  *  RISC-V Reset Startup (crt0.s) for FreeRTOS
  *  - Install early trap handler (CRITICAL - before any code runs!)
  *  - Zero .bss
- *  - Copy .data from flash → RAM (if needed)
+ *  - Copy .data image from ITCM → DTCM
  *  - Set up initial stack
  *  - Call main()
  *  - Call vTaskStartScheduler()
@@ -53,11 +53,10 @@ _start:
 2:
 
     /* ------------------------------------------------------
-     * OPTIONAL: if .data is in flash, copy it into RAM  
-     * (Your linker currently puts everything in RAM,
-     * so this loop does nothing but is future-proof.)
+     * Copy .data from its load image in ITCM into DTCM
+     * (link.ld: .data > DTCM AT > ITCM, see memmap.py)
      * ------------------------------------------------------ */
-    la   t0, _sidata   /* Source (.text/.rodata) */
+    la   t0, _sidata   /* Source (ITCM, after .rodata) */
     la   t1, _sdata    /* Dest (.data) */
     la   t2, _edata    /* End of .data */
 3:
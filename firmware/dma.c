@@ -0,0 +1,38 @@
+#include <stdint.h>
+#include "dma.h"
+
+uint32_t dma_cfg(const void *src, const void *dst, uint32_t flags) {
+    if ((((uint32_t)src | (uint32_t)dst) & 3u) == 0)
+        flags |= DMA_CFG_WORD;
+    return flags;
+}
+
+void dma_start(unsigned ch, const void *src, void *dst, uint32_t len,
+               uint32_t cfg, int irq) {
+    DMA_SRC(ch)  = (uint32_t)src;
+    DMA_DST(ch)  = (uint32_t)dst;
+    DMA_LEN(ch)  = len;
+    DMA_CFG(ch)  = cfg;
+    DMA_NEXT(ch) = 0;
+    DMA_CTRL(ch) = DMA_CTRL_START | (irq ? DMA_CTRL_IRQ : 0);
+}
+
+void dma_start_chain(unsigned ch, const dma_desc_t *first, int irq) {
+    DMA_NEXT(ch) = (uint32_t)first;
+    DMA_CTRL(ch) = DMA_CTRL_START_DESC | (irq ? DMA_CTRL_IRQ : 0);
+}
+
+int dma_busy(unsigned ch) {
+    return (DMA_CTRL(ch) & DMA_CTRL_BUSY) != 0;
+}
+
+void dma_wait(unsigned ch) {
+    while (dma_busy(ch)) {
+        /* spin */
+    }
+}
+
+void dma_abort(unsigned ch) {
+    DMA_CTRL(ch) = DMA_CTRL_ABORT;
+    dma_wait(ch);   /* busy holds until the engine has left the channel */
+}
@@ -0,0 +1,61 @@
+#ifndef DMA_H
+#define DMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "memmap.h"
+
+/*
+ * DMA controller (dma.v) - register-level API, no RTOS needed.
+ *
+ * The start register is MMIO, and MMIO accesses wait for the store buffer
+ * to drain, so data and descriptors written before dma_start*() are what
+ * the DMA reads. EXT memory is reached through the D-cache and stays
+ * coherent; after DMA into code, run fence.i before executing it.
+ */
+#define DMA_CHANNELS        4
+
+#define DMA_CH(c)           (MEMMAP_DMA_BASE + (uint32_t)(c) * 0x20u)
+#define DMA_SRC(c)          (*(volatile uint32_t *)(DMA_CH(c) + 0x00))
+#define DMA_DST(c)          (*(volatile uint32_t *)(DMA_CH(c) + 0x04))
+#define DMA_LEN(c)          (*(volatile uint32_t *)(DMA_CH(c) + 0x08))
+#define DMA_CFG(c)          (*(volatile uint32_t *)(DMA_CH(c) + 0x0C))
+#define DMA_NEXT(c)         (*(volatile uint32_t *)(DMA_CH(c) + 0x10))
+#define DMA_CTRL(c)         (*(volatile uint32_t *)(DMA_CH(c) + 0x14))
+#define DMA_DONE            (*(volatile uint32_t *)(MEMMAP_DMA_BASE + 0x80))
+
+/* CFG bits (also the cfg word of a descriptor) */
+#define DMA_CFG_SRC_FIXED   (1u << 0)
+#define DMA_CFG_DST_FIXED   (1u << 1)
+#define DMA_CFG_WORD        (1u << 2)   /* 32-bit items, src/dst word aligned */
+#define DMA_CFG_PACE_UART   (1u << 4)   /* wait for UART TX FIFO space */
+
+/* CTRL bits */
+#define DMA_CTRL_START      (1u << 0)
+#define DMA_CTRL_START_DESC (1u << 1)
+#define DMA_CTRL_IRQ        (1u << 2)
+#define DMA_CTRL_ABORT      (1u << 3)
+#define DMA_CTRL_BUSY       (1u << 8)
+#define DMA_CTRL_DONE       (1u << 9)
+#define DMA_CTRL_ABORTING   (1u << 10)  /* abort requested, engine not yet off */
+
+/* Descriptor: same order as the channel registers. Word aligned. */
+typedef struct dma_desc {
+    const void      *src;
+    void            *dst;
+    uint32_t         len;       /* bytes */
+    uint32_t         cfg;       /* DMA_CFG_* */
+    struct dma_desc *next;      /* NULL ends the chain */
+} dma_desc_t;
+
+/* DMA_CFG_WORD when src, dst and len allow it, plus `flags` */
+uint32_t dma_cfg(const void *src, const void *dst, uint32_t flags);
+
+void dma_start(unsigned ch, const void *src, void *dst, uint32_t len,
+               uint32_t cfg, int irq);
+void dma_start_chain(unsigned ch, const dma_desc_t *first, int irq);
+int  dma_busy(unsigned ch);
+void dma_wait(unsigned ch);                 /* spin until not busy */
+void dma_abort(unsigned ch);               /* returns once the channel is idle */
+
+#endif
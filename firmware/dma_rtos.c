@@ -0,0 +1,109 @@
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "irq.h"
+#include "uart.h"
+#include "dma.h"
+#include "dma_rtos.h"
+#include "rtos_wait.h"
+
+static SemaphoreHandle_t     free_channels;      /* counting, DMA_CHANNELS */
+static uint32_t              in_use;             /* channel bitmap */
+static TaskHandle_t          waiter[DMA_CHANNELS];
+static volatile uint32_t     finished;           /* set by the ISR */
+static uint32_t              fill_word[DMA_CHANNELS];
+
+static void dma_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t done = DMA_DONE;
+
+    DMA_DONE = done;                        /* drops the irq line */
+    finished |= done;
+    for (unsigned ch = 0; ch < DMA_CHANNELS; ch++) {
+        if ((done & (1u << ch)) && waiter[ch])
+            rtos_wake_from_isr(waiter[ch], &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+BaseType_t dma_rtos_init(void)
+{
+    free_channels = xSemaphoreCreateCounting(DMA_CHANNELS, DMA_CHANNELS);
+    if (free_channels == NULL)
+        return pdFAIL;
+    DMA_DONE = (1u << DMA_CHANNELS) - 1;
+    irq_register(MEMMAP_IRQ_DMA, dma_isr);
+    return pdPASS;
+}
+
+static unsigned channel_get(void)
+{
+    unsigned ch = 0;
+
+    xSemaphoreTake(free_channels, portMAX_DELAY);
+    taskENTER_CRITICAL();
+    while (in_use & (1u << ch))
+        ch++;
+    in_use     |= 1u << ch;
+    finished   &= ~(1u << ch);
+    waiter[ch]  = xTaskGetCurrentTaskHandle();
+    taskEXIT_CRITICAL();
+    return ch;
+}
+
+/* Block until the ISR reports the channel done, then release it */
+static void channel_wait_put(unsigned ch)
+{
+    rtos_wait_flag(&finished, 1u << ch, portMAX_DELAY);
+
+    taskENTER_CRITICAL();
+    waiter[ch]  = NULL;
+    in_use     &= ~(1u << ch);
+    taskEXIT_CRITICAL();
+    xSemaphoreGive(free_channels);
+}
+
+void dma_memcpy(void *dst, const void *src, size_t n)
+{
+    if (n == 0)
+        return;
+    unsigned ch = channel_get();
+    dma_start(ch, src, dst, n, dma_cfg(src, dst, 0), 1);
+    channel_wait_put(ch);
+}
+
+void dma_fill32(void *dst, uint32_t pattern, size_t n)
+{
+    size_t words = n & ~(size_t)3;
+
+    configASSERT(((uint32_t)dst & 3u) == 0);
+    if (words != 0) {
+        unsigned ch = channel_get();
+        fill_word[ch] = pattern;
+        dma_start(ch, &fill_word[ch], dst, words,
+                  DMA_CFG_WORD | DMA_CFG_SRC_FIXED, 1);
+        channel_wait_put(ch);
+    }
+    /* Byte items from a fixed source would all repeat byte 0 */
+    for (size_t i = words; i < n; i++)
+        ((uint8_t *)dst)[i] = (uint8_t)(pattern >> (8 * (i & 3)));
+}
+
+void dma_run_chain(const dma_desc_t *first)
+{
+    unsigned ch = channel_get();
+    dma_start_chain(ch, first, 1);
+    channel_wait_put(ch);
+}
+
+void dma_uart_write(const void *buf, size_t n)
+{
+    if (n == 0)
+        return;
+    unsigned ch = channel_get();
+    dma_start(ch, buf, (void *)UART_TX_ADDR, n,
+              DMA_CFG_DST_FIXED | DMA_CFG_PACE_UART, 1);
+    channel_wait_put(ch);
+}
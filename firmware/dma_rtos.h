@@ -0,0 +1,27 @@
+#ifndef DMA_RTOS_H
+#define DMA_RTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "dma.h"
+
+/*
+ * Blocking DMA for FreeRTOS tasks: each call takes a free channel (waiting
+ * if all DMA_CHANNELS are in use), starts it with the completion interrupt
+ * enabled and blocks the task until it finishes. Other tasks run meanwhile.
+ * Call from tasks only, not from ISRs or critical sections.
+ */
+BaseType_t dma_rtos_init(void);
+
+void dma_memcpy(void *dst, const void *src, size_t n);
+/* n bytes of the repeated pattern from a word-aligned dst; a partial last
+ * word gets the pattern's low bytes, as if the words had been stored */
+void dma_fill32(void *dst, uint32_t pattern, size_t n);
+void dma_run_chain(const dma_desc_t *first);
+
+/* Stream n bytes into the UART TX FIFO, paced by its free space. Bypasses
+ * the uart_write() buffer: don't interleave the two for one message. */
+void dma_uart_write(const void *buf, size_t n);
+
+#endif
@@ -16,7 +16,7 @@
 /* Task configuration */
 #define configMAX_PRIORITIES          ( 5 )
 #define configMINIMAL_STACK_SIZE      ( 512 )  /* Increased for trap handler overhead */
-#define configTOTAL_HEAP_SIZE         ( 20 * 1024 )
+#define configTOTAL_HEAP_SIZE         ( 192 * 1024 )  /* In DTCM (see memmap.py) */
 #define configMAX_TASK_NAME_LEN       ( 16 )
 #define configUSE_16_BIT_TICKS        0
 
@@ -31,10 +31,13 @@
 #define INCLUDE_xTaskGetTickCount     1
 #define INCLUDE_vTaskDelete           0
 #define INCLUDE_vTaskSuspend          0
+#define INCLUDE_xTaskGetSchedulerState 1  /* vPortSpinLock (port.c) */
 
 /* Mutex and timer configuration */
 #define configUSE_MUTEXES             1
+#define configUSE_COUNTING_SEMAPHORES 1   /* DMA channel pool (dma_rtos.c) */
 #define configUSE_TIMERS              0   /* Disable software timers for now */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2  /* 1: driver wake-ups (rtos_wait.h) */
 
 /* Memory allocation */
 #define configSUPPORT_DYNAMIC_ALLOCATION 1
@@ -7,6 +7,7 @@
 #include "task.h"
 #include <stdint.h>
 #include "../uart.h"
+#include "../irq.h"
 
 /* External assembly functions */
 extern void xPortStartFirstTask(void);
@@ -64,8 +65,8 @@ BaseType_t xPortStartScheduler(void)
     /* Setup timer for tick interrupt */
     vPortSetupTimerInterrupt();
     
-    /* Enable timer interrupt (bit 7 = MTIE) */
-    write_csr(mie, (1 << 7));
+    /* Enable timer (bit 7 = MTIE) and external (bit 11 = MEIE) interrupts */
+    write_csr(mie, (1 << 7) | (1 << 11));
     
     /* Start first task - sets mtvec, enables interrupts via mret */
     xPortStartFirstTask();
@@ -99,6 +100,14 @@ void vPortSysTickHandler(void)
 
 /*-----------------------------------------------------------*/
 
+/* External interrupt handler - called from assembly trap handler (cause 11) */
+void vPortExternalHandler(void)
+{
+    irq_dispatch();
+}
+
+/*-----------------------------------------------------------*/
+
 /* Yield handler - called from assembly trap handler on ecall */
 void vPortYieldHandler(void)
 {
@@ -107,6 +116,20 @@ void vPortYieldHandler(void)
 
 /*-----------------------------------------------------------*/
 
+/* The holder can only be a task that is not running: spinning would keep
+ * a lower-priority holder from ever finishing, so give up the CPU until
+ * the next tick. Before the scheduler starts nothing can hold a lock
+ * across a call, so plain spinning is fine there. */
+void vPortSpinLock(UBaseType_t n)
+{
+    while (!xPortSpinTryLock(n)) {
+        if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+            vTaskDelay(1);
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 /* FreeRTOS hooks */
 void vApplicationIdleHook(void)
 {
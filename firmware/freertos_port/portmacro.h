@@ -108,6 +108,38 @@ extern size_t xCriticalNesting;
 #define portMEMORY_BARRIER() __asm volatile( "" ::: "memory" )
 /*-----------------------------------------------------------*/
 
+/* Spinlocks on the hardware semaphore bank (sema.v): short sections shared
+ * between tasks without masking interrupts. Reading a lock register is an
+ * atomic test-and-set, writing it releases. An MMIO load waits for the
+ * store buffer, so acquire and release also order the memory accesses.
+ *
+ * One hart: a lock that is held belongs to a preempted task or to code an
+ * interrupt cut into, so vPortSpinLock() sleeps a tick between attempts
+ * instead of spinning. Interrupt handlers must only use xPortSpinTryLock()
+ * (and release before returning). */
+#include "../memmap.h"
+
+#define portSPINLOCK_COUNT      32
+#define portSPINLOCK_REG( n )   ( *( volatile uint32_t * )( MEMMAP_SEMA_BASE + 4u * ( n ) ) )
+#define portSPINLOCK_HELD       ( *( volatile uint32_t * )( MEMMAP_SEMA_BASE + 0x80u ) )
+#define portSPINLOCK_RELEASE    ( *( volatile uint32_t * )( MEMMAP_SEMA_BASE + 0x84u ) )
+
+static portFORCE_INLINE BaseType_t xPortSpinTryLock( UBaseType_t n )
+{
+    BaseType_t got = ( portSPINLOCK_REG( n ) == 0 );
+    portMEMORY_BARRIER();
+    return got;
+}
+
+static portFORCE_INLINE void vPortSpinUnlock( UBaseType_t n )
+{
+    portMEMORY_BARRIER();
+    portSPINLOCK_REG( n ) = 0;
+}
+
+void vPortSpinLock( UBaseType_t n );
+/*-----------------------------------------------------------*/
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,66 @@
+#ifndef GPIO_H
+#define GPIO_H
+
+#include <stdint.h>
+#include "memmap.h"
+
+/*
+ * GPIO (gpio.v) - register-level API, no RTOS needed.
+ *
+ * Pins 0-3 are the LEDs: an LED shows its debug function (heartbeat, UART
+ * busy, PC running, timer PWM) until gpio_output() claims it. Pins 4-6
+ * (btn0, sw[1:0]) are inputs only. IN is synchronised and, for pins in
+ * DB_EN, debounced; edges and levels are taken from IN.
+ */
+#define GPIO_IN             (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x00))
+#define GPIO_OUT            (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x04))
+#define GPIO_DIR            (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x08))
+#define GPIO_SET            (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x0C))
+#define GPIO_CLR            (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x10))
+#define GPIO_RISE           (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x14))
+#define GPIO_FALL           (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x18))
+#define GPIO_HIGH           (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x1C))
+#define GPIO_LOW            (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x20))
+#define GPIO_EDGES          (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x24))
+#define GPIO_DB_EN          (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x28))
+#define GPIO_DB_TIME        (*(volatile uint32_t *)(MEMMAP_GPIO_BASE + 0x2C))
+
+/* Pins (cpu_top.v) */
+#define GPIO_LED(n)         (n)
+#define GPIO_BTN0           4
+#define GPIO_SW0            5
+#define GPIO_SW1            6
+#define GPIO_PINS           7
+#define GPIO_INPUTS         0x70u           /* btn0, sw[1:0] */
+
+/* EDGES bits, write 1 to clear */
+#define GPIO_EDGE_RISE(p)   (1u << (p))
+#define GPIO_EDGE_FALL(p)   (1u << (16 + (p)))
+
+static inline int gpio_read(unsigned pin) {
+    return (GPIO_IN >> pin) & 1u;
+}
+
+static inline void gpio_write(unsigned pin, int v) {
+    if (v)
+        GPIO_SET = 1u << pin;
+    else
+        GPIO_CLR = 1u << pin;
+}
+
+/* Claim (1) or give back (0) an LED pin */
+static inline void gpio_output(unsigned pin, int on) {
+    if (on)
+        GPIO_DIR |= 1u << pin;
+    else
+        GPIO_DIR &= ~(1u << pin);
+}
+
+/* Debounce the pins in `mask`: a new level needs 2-3 x `cycles` of
+ * stable input. Applies to every debounced pin. */
+static inline void gpio_debounce(uint32_t mask, uint32_t cycles) {
+    GPIO_DB_TIME = cycles;
+    GPIO_DB_EN   = mask;
+}
+
+#endif
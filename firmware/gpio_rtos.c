@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "irq.h"
+#include "gpio.h"
+#include "gpio_rtos.h"
+#include "rtos_wait.h"
+
+struct waiter {
+    TaskHandle_t       task;
+    uint32_t           want;            /* EDGES bits */
+    volatile uint32_t  got;
+};
+
+static struct waiter        *waiters[GPIO_RTOS_WAITERS];
+
+static void gpio_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t st = GPIO_EDGES;
+
+    GPIO_EDGES = st;                        /* drops the irq line */
+    for (unsigned i = 0; i < GPIO_RTOS_WAITERS; i++) {
+        struct waiter *w = waiters[i];
+
+        if (w && (st & w->want)) {
+            w->got |= st & w->want;
+            rtos_wake_from_isr(w->task, &woken);
+        }
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+void gpio_rtos_init(void)
+{
+    gpio_debounce(GPIO_INPUTS, MEMMAP_CLK_HZ / 250);     /* 4 ms samples */
+    GPIO_RISE  = 0;
+    GPIO_FALL  = 0;
+    GPIO_EDGES = 0xFFFFFFFFu;
+    irq_register(MEMMAP_IRQ_GPIO, gpio_isr);
+}
+
+/* Caller holds off interrupts: edge enables = what the waiters want */
+static void update_enables(void)
+{
+    uint32_t want = 0;
+
+    for (unsigned i = 0; i < GPIO_RTOS_WAITERS; i++)
+        if (waiters[i])
+            want |= waiters[i]->want;
+    GPIO_RISE = want & 0xFFFFu;
+    GPIO_FALL = want >> 16;
+}
+
+uint32_t gpio_wait_edge(uint32_t rise, uint32_t fall, TickType_t wait)
+{
+    struct waiter w = { xTaskGetCurrentTaskHandle(),
+                        (rise & 0xFFFFu) | (fall << 16), 0 };
+    unsigned slot;
+
+    taskENTER_CRITICAL();
+    for (slot = 0; slot < GPIO_RTOS_WAITERS && waiters[slot]; slot++)
+        ;
+    if (slot == GPIO_RTOS_WAITERS) {
+        taskEXIT_CRITICAL();
+        return 0;
+    }
+    /* Report new edges only: drop stale flags nobody else waits for */
+    GPIO_EDGES     = w.want & ~(GPIO_RISE | (GPIO_FALL << 16));
+    waiters[slot]  = &w;
+    update_enables();
+    taskEXIT_CRITICAL();
+
+    rtos_wait_flag(&w.got, w.want, wait);
+
+    taskENTER_CRITICAL();
+    waiters[slot] = NULL;
+    update_enables();
+    taskEXIT_CRITICAL();
+    return w.got;
+}
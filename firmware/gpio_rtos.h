@@ -0,0 +1,29 @@
+#ifndef GPIO_RTOS_H
+#define GPIO_RTOS_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "gpio.h"
+
+/*
+ * Edge events for FreeRTOS tasks: a task blocks until one of the selected
+ * edges happens on the GPIO inputs, instead of polling them. Up to
+ * GPIO_RTOS_WAITERS tasks can wait at once, on the same or different
+ * pins; every waiter whose selection matches is woken. Only edges that
+ * happen while a task waits are reported.
+ *
+ * The driver owns IRQ_GPIO and the RISE / FALL enables; level interrupts
+ * (HIGH / LOW) need a handler of their own.
+ */
+#define GPIO_RTOS_WAITERS   4
+
+/* Debounce btn0 and the switches (~10 ms) and enable the interrupt.
+ * Call before vTaskStartScheduler(). */
+void gpio_rtos_init(void);
+
+/* Block until a rising edge of a pin in `rise` or a falling edge of a pin
+ * in `fall`. Returns the edges seen as GPIO_EDGE_RISE/FALL bits, or 0 on
+ * timeout (or when GPIO_RTOS_WAITERS tasks already wait). Tasks only. */
+uint32_t gpio_wait_edge(uint32_t rise, uint32_t fall, TickType_t wait);
+
+#endif
@@ -0,0 +1,31 @@
+#include <stdint.h>
+#include "irq.h"
+
+static irq_handler_t handlers[IRQ_COUNT];
+
+void irq_register(unsigned n, irq_handler_t fn) {
+    if (n >= IRQ_COUNT)
+        return;
+    handlers[n] = fn;
+    irq_enable(n);
+}
+
+void irq_enable(unsigned n) {
+    IRQC_ENABLE |= (1u << n);
+}
+
+void irq_disable(unsigned n) {
+    IRQC_ENABLE &= ~(1u << n);
+}
+
+void irq_dispatch(void) {
+    uint32_t active = IRQC_ACTIVE;
+    for (unsigned n = 0; active != 0 && n < IRQ_COUNT; n++, active >>= 1) {
+        if ((active & 1u) == 0)
+            continue;
+        if (handlers[n])
+            handlers[n]();
+        else
+            irq_disable(n);     /* nobody to clear it - avoid an irq storm */
+    }
+}
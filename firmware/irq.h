@@ -0,0 +1,29 @@
+#ifndef IRQ_H
+#define IRQ_H
+
+#include <stdint.h>
+#include "memmap.h"
+
+/*
+ * Interrupt controller (irq_ctrl.v) - peripheral lines into the core's
+ * machine external interrupt (mcause 11). Sources are levels: a handler
+ * must clear the cause in its device before returning.
+ */
+#define IRQC_PENDING  (*(volatile uint32_t *)(MEMMAP_IRQC_BASE + 0x00))
+#define IRQC_ENABLE   (*(volatile uint32_t *)(MEMMAP_IRQC_BASE + 0x04))
+#define IRQC_ACTIVE   (*(volatile uint32_t *)(MEMMAP_IRQC_BASE + 0x08))
+
+#define IRQ_COUNT     8
+
+typedef void (*irq_handler_t)(void);
+
+/* Install a handler for source n and enable it in the controller.
+ * mie.MEIE must also be set (xPortStartScheduler does this). */
+void irq_register(unsigned n, irq_handler_t fn);
+void irq_enable(unsigned n);
+void irq_disable(unsigned n);
+
+/* Call the handler of every active source (from the trap handler). */
+void irq_dispatch(void);
+
+#endif
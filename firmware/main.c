@@ -7,27 +7,36 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "uart.h"
+#include "uart_rtos.h"
+#include "dma_rtos.h"
+#include "timer_rtos.h"
+#include "mbox_rtos.h"
+#include "gpio_rtos.h"
 
 /* Global counters - avoids any stack weirdness */
 static volatile uint32_t countA = 0;
 static volatile uint32_t countB = 0;
 static volatile uint32_t countC = 0;
 
-/* Print decimal number */
-static void print_num(uint32_t val) {
-    char buf[12];
+/* Format "[X] <n>\r\n" into buf, returns length */
+static size_t fmt_line(char *buf, char tag, uint32_t val) {
+    char digits[10];
+    size_t n = 0;
     int i = 0;
-    if (val == 0) { 
-        uart_putc('0'); 
-        return; 
-    }
-    while (val > 0 && i < 10) {
-        buf[i++] = '0' + (val % 10);
+    buf[n++] = '[';
+    buf[n++] = tag;
+    buf[n++] = ']';
+    buf[n++] = ' ';
+    do {
+        digits[i++] = '0' + (val % 10);
         val /= 10;
-    }
+    } while (val > 0 && i < 10);
     while (i > 0) {
-        uart_putc(buf[--i]);
+        buf[n++] = digits[--i];
     }
+    buf[n++] = '\r';
+    buf[n++] = '\n';
+    return n;
 }
 
 /* Delay loop */
@@ -37,42 +46,47 @@ static void delay(volatile uint32_t n) {
 
 /* ─────────────────────────────────────────────────────────────────────────── */
 
-void vTaskA(void *p) {
-    (void)p;
+/* Each line goes out in one uart_write(): it lands in the TX stream buffer
+ * in one piece and the task carries on while the interrupt sends it */
+static void print_task(char tag, volatile uint32_t *count) {
+    char line[16];
     for (;;) {
-        taskENTER_CRITICAL();
-        uart_puts("[A] ");
-        print_num(countA++);
-        uart_puts("\r\n");
-        taskEXIT_CRITICAL();
+        uart_write(line, fmt_line(line, tag, (*count)++));
         delay(60000);
         taskYIELD();
     }
 }
 
+void vTaskA(void *p) {
+    (void)p;
+    print_task('A', &countA);
+}
+
 void vTaskB(void *p) {
     (void)p;
-    for (;;) {
-        taskENTER_CRITICAL();
-        uart_puts("[B] ");
-        print_num(countB++);
-        uart_puts("\r\n");
-        taskEXIT_CRITICAL();
-        delay(60000);
-        taskYIELD();
-    }
+    print_task('B', &countB);
 }
 
 void vTaskC(void *p) {
+    (void)p;
+    print_task('C', &countC);
+}
+
+/* Sleeps until btn0 is pressed or a switch flips, no polling */
+void vTaskButtons(void *p) {
     (void)p;
     for (;;) {
-        taskENTER_CRITICAL();
-        uart_puts("[C] ");
-        print_num(countC++);
-        uart_puts("\r\n");
-        taskEXIT_CRITICAL();
-        delay(60000);
-        taskYIELD();
+        uint32_t ev = gpio_wait_edge(GPIO_INPUTS, GPIO_INPUTS, portMAX_DELAY);
+
+        if (ev & GPIO_EDGE_RISE(GPIO_BTN0))
+            uart_write("[btn0]\r\n", 8);
+        if (ev & (GPIO_EDGE_RISE(GPIO_SW0) | GPIO_EDGE_FALL(GPIO_SW0) |
+                  GPIO_EDGE_RISE(GPIO_SW1) | GPIO_EDGE_FALL(GPIO_SW1))) {
+            char line[] = "[sw] 00\r\n";
+            line[5] = '0' + gpio_read(GPIO_SW1);
+            line[6] = '0' + gpio_read(GPIO_SW0);
+            uart_write(line, sizeof(line) - 1);
+        }
     }
 }
 
@@ -88,11 +102,24 @@ int main(void) {
     uart_puts("  RTOS: FreeRTOS v10.5.1\r\n");
     uart_puts("========================================\r\n\r\n");
     
-    uart_puts("Starting 3 tasks...\r\n\r\n");
+    uart_puts("Starting 4 tasks...\r\n\r\n");
+
+    if (uart_rtos_init() != pdPASS) {
+        uart_puts("UART driver init failed\r\n");
+        for (;;);
+    }
+    if (dma_rtos_init() != pdPASS) {
+        uart_puts("DMA driver init failed\r\n");
+        for (;;);
+    }
+    timer_rtos_init();
+    mbox_rtos_init();
+    gpio_rtos_init();
     
     xTaskCreate(vTaskA, "A", 256, NULL, 1, NULL);
     xTaskCreate(vTaskB, "B", 256, NULL, 1, NULL);
     xTaskCreate(vTaskC, "C", 256, NULL, 1, NULL);
+    xTaskCreate(vTaskButtons, "btn", 256, NULL, 2, NULL);
     
     vTaskStartScheduler();
     
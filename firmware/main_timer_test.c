@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 #include "uart.h"
+#include "sim_ctrl.h"
 
 /* CSR access macros */
 #define read_csr(reg) ({ uint32_t v; __asm volatile ("csrr %0, " #reg : "=r"(v)); v; })
@@ -159,12 +160,21 @@ int main(void) {
     /* Main loop - let timer interrupts run */
     uint32_t last_report = 0;
     uint32_t target_ticks = 100;  /* Run for 100 ticks (100ms) */
+    /* Give up after twice that: a dead timer then fails instead of hanging */
+    uint32_t deadline = MTIME_LO + target_ticks * TICK_INTERVAL * 2;
     
     uart_puts("Waiting for ");
     print_dec(target_ticks);
     uart_puts(" timer ticks...\r\n\r\n");
     
     while (g_tick_count < target_ticks) {
+        if ((int32_t)(MTIME_LO - deadline) >= 0) {
+            uart_puts("  Deadline passed at MTIME=");
+            print_dec(MTIME_LO);
+            uart_puts("\r\n");
+            break;
+        }
+
         /* Report every 10 ticks */
         if (g_tick_count >= last_report + 10) {
             last_report = g_tick_count;
@@ -207,6 +217,7 @@ int main(void) {
     
     uart_puts("================================================\r\n");
     uart_puts("[END OF TIMER TEST]\r\n");
+    sim_exit(g_tick_count >= target_ticks ? 0 : 1);
     
     for (;;) {
         __asm volatile ("wfi");
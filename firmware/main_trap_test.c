@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 #include "uart.h"
+#include "sim_ctrl.h"
 
 /* CSR access macros */
 #define read_csr(reg) ({ uint32_t v; __asm volatile ("csrr %0, " #reg : "=r"(v)); v; })
@@ -422,6 +423,7 @@ int main(void) {
     }
     
     uart_puts("\r\n[END OF TRAP TESTS]\r\n");
+    sim_exit(g_test_passed == 7 ? 0 : 1);
     
     /* Infinite loop */
     for (;;) {
@@ -1,20 +1,106 @@
 #!/usr/bin/env python3
+"""
+prog.bin -> instr_mem.vh ($readmemh image for the ITCM)
+Usage: python3 make_hex.py [input.bin] [output.vh] [words]
+The image is padded to the full ITCM size defined in memmap.py, or to
+[words] words (0 = just the binary, rounded up to a whole word).
+
+prog.elf -> instr_mem.vh, ext_mem.vh, flash_mem.vh
+Usage: python3 make_hex.py --elf [prog.elf] [output dir]
+Sparse images straight from the ELF's loadable segments: one @address
+record (word offset into the memory) per segment and nothing else, so
+unloaded words keep the memory's fill value (0 for the ITCM, as the ISS).
+Flash offsets are from FLASH_APP_OFFSET, where flash.bin is programmed.
+"""
+import struct
+import sys
 from pathlib import Path
 
+import memmap
+
 BIN_PATH = Path("prog.bin")
 VH_PATH = Path("instr_mem.vh")
-WORD_COUNT = 32768  # 128 KB / 4 bytes
+ELF_PATH = Path("prog.elf")
+WORD_COUNT = memmap.ITCM_WORDS
+
+# (image, base, size) of each memory with a $readmemh image
+ELF_IMAGES = (
+    ("instr_mem.vh", memmap.ITCM_BASE, memmap.ITCM_SIZE),
+    ("ext_mem.vh", memmap.EXT_BASE, memmap.EXT_SIZE),
+    ("flash_mem.vh", memmap.FLASH_BASE + memmap.FLASH_APP_OFFSET,
+     memmap.FLASH_SIZE - memmap.FLASH_APP_OFFSET),
+)
+
+PT_LOAD = 1
+
+
+def elf_segments(data):
+    """(load address, bytes) of every PT_LOAD segment with file contents."""
+    if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+        raise ValueError("not a 32-bit little-endian ELF")
+    phoff, = struct.unpack_from("<I", data, 28)
+    phentsize, phnum = struct.unpack_from("<HH", data, 42)
+    for i in range(phnum):
+        (p_type, p_offset, _vaddr, p_paddr, p_filesz,
+         _memsz, _flags, _align) = struct.unpack_from("<8I", data, phoff + i * phentsize)
+        if p_type == PT_LOAD and p_filesz:
+            yield p_paddr, data[p_offset:p_offset + p_filesz]
+
+
+def elf_to_hex(elf_path, out_dir):
+    if not elf_path.exists():
+        print(f"ERROR: {elf_path} not found!")
+        return False
+
+    records = {name: [] for name, _, _ in ELF_IMAGES}
+    for addr, seg in elf_segments(elf_path.read_bytes()):
+        for name, base, size in ELF_IMAGES:
+            if base <= addr and addr + len(seg) <= base + size:
+                break
+        else:
+            print(f"ERROR: segment at 0x{addr:08x} ({len(seg)} bytes) has no image")
+            return False
+        if addr % 4:
+            print(f"ERROR: segment at 0x{addr:08x} is not word aligned")
+            return False
+        records[name].append((addr - base, seg.ljust((len(seg) + 3) & ~3, b"\x00")))
+
+    for name, _, _ in ELF_IMAGES:
+        lines = []
+        words = 0
+        for off, seg in sorted(records[name]):
+            lines.append(f"@{off // 4:x}")
+            lines += [f"{w:08x}" for w, in struct.iter_unpack("<I", seg)]
+            words += len(seg) // 4
+        if not lines:
+            lines.append("00000000")       # $readmemh wants at least one word
+        (out_dir / name).write_text("\n".join(lines) + "\n")
+        print(f"Wrote {out_dir / name}: {words} words in {len(records[name])} segment(s).")
+    return True
+
 
 def main():
-    if not BIN_PATH.exists():
-        print(f"ERROR: {BIN_PATH} not found!")
+    if len(sys.argv) > 1 and sys.argv[1] == "--elf":
+        elf_path = Path(sys.argv[2]) if len(sys.argv) > 2 else ELF_PATH
+        out_dir = Path(sys.argv[3]) if len(sys.argv) > 3 else Path(".")
+        sys.exit(0 if elf_to_hex(elf_path, out_dir) else 1)
+
+    bin_path = Path(sys.argv[1]) if len(sys.argv) > 1 else BIN_PATH
+    vh_path = Path(sys.argv[2]) if len(sys.argv) > 2 else VH_PATH
+    word_count = int(sys.argv[3], 0) if len(sys.argv) > 3 else WORD_COUNT
+
+    if not bin_path.exists():
+        print(f"ERROR: {bin_path} not found!")
         return
 
-    data = BIN_PATH.read_bytes()
+    data = bin_path.read_bytes()
     bin_size = len(data)
     print(f"Binary size: {bin_size} bytes")
 
-    max_size = WORD_COUNT * 4
+    if word_count == 0:
+        word_count = max(1, (bin_size + 3) // 4)
+
+    max_size = word_count * 4
     if bin_size > max_size:
         print(f"ERROR: Binary too large ({bin_size} bytes > {max_size})")
         return
@@ -22,13 +108,13 @@ def main():
     padded = data.ljust(max_size, b"\x00")
 
     lines = []
-    for i in range(WORD_COUNT):
+    for i in range(word_count):
         word_bytes = padded[4 * i:4 * i + 4]
         word = int.from_bytes(word_bytes, "little")
         lines.append(f"{word:08x}")
 
-    VH_PATH.write_text("\n".join(lines) + "\n")
-    print(f"Wrote {VH_PATH} with {WORD_COUNT} words (plain hex).")
+    vh_path.write_text("\n".join(lines) + "\n")
+    print(f"Wrote {vh_path} with {word_count} words (plain hex).")
 
 if __name__ == "__main__":
     main()
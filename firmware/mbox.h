@@ -0,0 +1,44 @@
+#ifndef MBOX_H
+#define MBOX_H
+
+#include <stdint.h>
+#include "memmap.h"
+
+/*
+ * Mailbox (mbox.v) - register-level API, no RTOS needed.
+ *
+ * A hardware word FIFO: producers (interrupt handlers, the DMA with a
+ * fixed destination) post with one store, the consumer pops with loads.
+ * Posting to a full mailbox drops the word and sets MBOX_ST_OVERFLOW.
+ * Reading DATA when empty returns 0, which is also a valid word: check
+ * COUNT or STATUS first.
+ */
+#define MBOX_DATA           (*(volatile uint32_t *)(MEMMAP_MBOX_BASE + 0x00))
+#define MBOX_COUNT          (*(volatile uint32_t *)(MEMMAP_MBOX_BASE + 0x04))
+#define MBOX_DEPTH          (*(volatile uint32_t *)(MEMMAP_MBOX_BASE + 0x08))
+#define MBOX_CTRL           (*(volatile uint32_t *)(MEMMAP_MBOX_BASE + 0x0C))
+#define MBOX_STATUS         (*(volatile uint32_t *)(MEMMAP_MBOX_BASE + 0x10))
+
+/* CTRL bits */
+#define MBOX_CTRL_IE        (1u << 0)   /* irq while not empty */
+#define MBOX_CTRL_FLUSH     (1u << 1)   /* write-only */
+
+/* STATUS bits */
+#define MBOX_ST_NONEMPTY    (1u << 0)
+#define MBOX_ST_FULL        (1u << 1)
+#define MBOX_ST_OVERFLOW    (1u << 2)   /* write 1 to clear */
+
+/* Safe from any context, including interrupt handlers */
+static inline void mbox_post(uint32_t v) {
+    MBOX_DATA = v;
+}
+
+/* Words were dropped since the last call */
+static inline int mbox_overflowed(void) {
+    if (!(MBOX_STATUS & MBOX_ST_OVERFLOW))
+        return 0;
+    MBOX_STATUS = MBOX_ST_OVERFLOW;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "irq.h"
+#include "mbox.h"
+#include "mbox_rtos.h"
+#include "rtos_wait.h"
+
+static TaskHandle_t          waiter;
+static volatile uint32_t     ready;              /* set by the ISR */
+
+/* The irq is a level while the FIFO is not empty: mask it here and let the
+ * task re-arm it when it runs dry. */
+static void mbox_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    MBOX_CTRL = 0;
+    ready = 1;
+    if (waiter)
+        rtos_wake_from_isr(waiter, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void mbox_rtos_init(void)
+{
+    MBOX_CTRL   = MBOX_CTRL_FLUSH;
+    MBOX_STATUS = MBOX_ST_OVERFLOW;
+    irq_register(MEMMAP_IRQ_MBOX, mbox_isr);
+}
+
+/* One receiver, so a word that raised the irq is still there when it
+ * runs. A word posted between the COUNT check and arming the irq raises
+ * it at once. */
+static BaseType_t wait_nonempty(TickType_t wait)
+{
+    if (MBOX_COUNT != 0)
+        return pdPASS;
+
+    taskENTER_CRITICAL();
+    ready     = 0;
+    waiter    = xTaskGetCurrentTaskHandle();
+    MBOX_CTRL = MBOX_CTRL_IE;
+    taskEXIT_CRITICAL();
+
+    rtos_wait_flag(&ready, 1, wait);
+
+    taskENTER_CRITICAL();
+    MBOX_CTRL = 0;
+    waiter    = NULL;
+    taskEXIT_CRITICAL();
+    return MBOX_COUNT ? pdPASS : pdFAIL;
+}
+
+BaseType_t mbox_receive(uint32_t *v, TickType_t wait)
+{
+    if (wait_nonempty(wait) != pdPASS)
+        return pdFAIL;
+    *v = MBOX_DATA;
+    return pdPASS;
+}
+
+size_t mbox_receive_all(uint32_t *buf, size_t max, TickType_t wait)
+{
+    size_t n;
+
+    if (max == 0 || wait_nonempty(wait) != pdPASS)
+        return 0;
+    n = MBOX_COUNT;
+    if (n > max)
+        n = max;
+    for (size_t i = 0; i < n; i++)
+        buf[i] = MBOX_DATA;
+    return n;
+}
@@ -0,0 +1,28 @@
+#ifndef MBOX_RTOS_H
+#define MBOX_RTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "mbox.h"
+
+/*
+ * Word-sized ISR -> task handoff through the hardware mailbox, instead of
+ * xQueueSendFromISR(). Producers call mbox_post() (one store, no kernel
+ * call, no critical section). The receiving task drains the FIFO directly
+ * and only blocks, on a task notification, when it finds it empty; the
+ * mailbox interrupt then fires once to wake it and stays masked until the
+ * task is waiting again.
+ *
+ * One receiving task at a time. Receive functions are for tasks only.
+ */
+void       mbox_rtos_init(void);
+
+/* pdFAIL when nothing arrived within `wait` ticks */
+BaseType_t mbox_receive(uint32_t *v, TickType_t wait);
+
+/* Block until at least one word is there, then pop up to `max` of them.
+ * Returns the number popped (0 on timeout). */
+size_t     mbox_receive_all(uint32_t *buf, size_t max, TickType_t wait);
+
+#endif
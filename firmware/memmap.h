@@ -0,0 +1,38 @@
+/* Generated by firmware/memmap.py - do not edit, edit memmap.py instead */
+#ifndef MEMMAP_H
+#define MEMMAP_H
+
+#define MEMMAP_ITCM_BASE      0x00000000UL
+#define MEMMAP_ITCM_SIZE      0x00020000UL
+#define MEMMAP_DTCM_BASE      0x10000000UL
+#define MEMMAP_DTCM_SIZE      0x00060000UL
+#define MEMMAP_EXT_BASE       0x80000000UL
+#define MEMMAP_EXT_SIZE       0x10000000UL
+#define MEMMAP_FLASH_BASE     0x20000000UL
+#define MEMMAP_FLASH_SIZE     0x01000000UL
+#define MEMMAP_FLASH_APP      0x20400000UL
+#define MEMMAP_FIRMWARE_BASE  0x00001000UL
+#define MEMMAP_FIRMWARE_MAX   0x0001F000UL
+#define MEMMAP_STACK_TOP      0x10060000UL
+#define MEMMAP_CLK_HZ         25000000UL
+#define MEMMAP_UART_BAUD      115200UL
+#define MEMMAP_UART_DIV       0x00D90UL
+
+#define MEMMAP_IRQC_BASE      0xFFFFF000UL
+#define MEMMAP_DMA_BASE       0xFFFFF100UL
+#define MEMMAP_TIMER_BASE     0xFFFFF200UL
+#define MEMMAP_QSPI_BASE      0xFFFFF300UL
+#define MEMMAP_CRC_BASE       0xFFFFF400UL
+#define MEMMAP_MBOX_BASE      0xFFFFF500UL
+#define MEMMAP_SEMA_BASE      0xFFFFF600UL
+#define MEMMAP_GPIO_BASE      0xFFFFF700UL
+#define MEMMAP_SIM_BASE       0xFFFFF800UL
+#define MEMMAP_UART_BASE      0xFFFFFFE0UL
+
+#define MEMMAP_IRQ_UART       0
+#define MEMMAP_IRQ_DMA        1
+#define MEMMAP_IRQ_TIMER      2
+#define MEMMAP_IRQ_MBOX       3
+#define MEMMAP_IRQ_GPIO       4
+
+#endif /* MEMMAP_H */
@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+"""
+SoC memory map - the ONE place memory sizes and bases are defined.
+
+  ITCM  code TCM  (dual-port BRAM: fetch + load/store), holds .text/.rodata
+        and the .data load image. The bootloader lives in its first BOOT_SIZE
+        bytes; uploaded applications start right after it.
+  DTCM  data TCM  (data port only), holds .data/.bss/heap/stack.
+  EXT   external DDR (Arty: 256 MB DDR3) behind the I/D caches; for large
+        buffers (.ext_bss) and code that does not fit on chip (.ext_text).
+  FLASH QSPI flash (Arty: 16 MB), read-only and executable in place through
+        qspi_xip's line cache. The FPGA bitstream occupies the bottom; images
+        for .flash_text/.flash_rodata go at FLASH_APP_OFFSET.
+  IO    peripheral region; MMIO registers live at 0xFFFF_xxxx (device bases
+        and interrupt numbers below).
+
+The system bus (bus_xbar.v) decodes regions on addr[31:28], so every region
+base must be 256 MB aligned and no two regions may share a top nibble.
+DTCM_SIZE need not be a power of two (384 KB takes a 17-bit word index):
+the bus maps only the first DTCM_SIZE bytes of the region, and the rest
+is unmapped like any other hole (reads 0, writes dropped, as in the ISS).
+
+Run `python3 memmap.py` after editing to regenerate:
+  memmap.ld                                - MEMORY regions for all linker scripts
+  memmap.h                                 - C / preprocessed-asm constants
+  bootloader/memmap.inc                    - constants for boot.s (plain GNU as)
+  ../FPGA_CPU1.srcs/sources_1/new/memmap.vh - localparams for cpu_top.v / bus_xbar.v
+make_hex.py and upload.py import this module directly.
+"""
+from pathlib import Path
+
+ITCM_BASE = 0x0000_0000
+ITCM_SIZE = 128 * 1024
+
+DTCM_BASE = 0x1000_0000
+DTCM_SIZE = 384 * 1024
+
+EXT_BASE  = 0x8000_0000
+EXT_SIZE  = 256 * 1024 * 1024
+
+FLASH_BASE = 0x2000_0000
+FLASH_SIZE = 16 * 1024 * 1024
+FLASH_APP_OFFSET = 0x40_0000  # above the 100T bitstream (~3.8 MB)
+
+IO_BASE   = 0xF000_0000
+
+BOOT_SIZE = 4 * 1024          # UART bootloader at the bottom of ITCM
+
+CLK_HZ    = 25_000_000        # core clock (100 MHz board clock / 4)
+UART_BAUD = 115_200           # UART rate out of reset (BAUD register default)
+
+# MMIO devices (IO region). The CLINT (0xFFFF_0000) and the CSR window
+# (0xFFFF_FFC0) are inside the core and not listed here.
+IRQC_BASE = 0xFFFF_F000       # interrupt controller (irq_ctrl.v)
+DMA_BASE  = 0xFFFF_F100       # DMA controller (dma.v)
+TIMER_BASE = 0xFFFF_F200      # compare/capture/PWM channels (timer.v)
+QSPI_BASE = 0xFFFF_F300       # flash controller control/statistics (qspi_xip.v)
+CRC_BASE  = 0xFFFF_F400       # CRC-32 / CRC-16 engine (crc.v)
+MBOX_BASE = 0xFFFF_F500       # word FIFO, ISR -> task (mbox.v)
+SEMA_BASE = 0xFFFF_F600       # test-and-set lock bank (sema.v)
+GPIO_BASE = 0xFFFF_F700       # LEDs, btn0, sw[1:0] (gpio.v)
+SIM_BASE  = 0xFFFF_F800       # simulation only: console + test exit (sim_ctrl.v)
+UART_BASE = 0xFFFF_FFE0       # UART: CTRL/IRQ/COUNT + legacy TX/STATUS/RX
+
+# Interrupt controller source numbers
+IRQ_UART = 0
+IRQ_DMA  = 1
+IRQ_TIMER = 2
+IRQ_MBOX  = 3
+IRQ_GPIO  = 4
+
+# Arty A7-100T: 135 x RAMB36 (4 KB data each) = 540 KB of block RAM
+BRAM_BUDGET = 540 * 1024
+
+# Derived values
+ITCM_WORDS    = ITCM_SIZE // 4
+DTCM_WORDS    = DTCM_SIZE // 4
+UART_DIV      = (CLK_HZ * 16 + UART_BAUD // 2) // UART_BAUD   # cycles/bit, 4 frac bits
+FIRMWARE_BASE = ITCM_BASE + BOOT_SIZE
+FIRMWARE_MAX  = ITCM_SIZE - BOOT_SIZE
+STACK_TOP     = DTCM_BASE + DTCM_SIZE
+
+HERE = Path(__file__).resolve().parent
+RTL_DIR = HERE.parent / "FPGA_CPU1.srcs" / "sources_1" / "new"
+
+HEADER = "Generated by firmware/memmap.py - do not edit, edit memmap.py instead"
+
+
+def addr_bits(words):
+    """Address bits needed to index `words` 32-bit words."""
+    return max(1, (words - 1).bit_length())
+
+
+def uart_divisor(baud):
+    """BAUD register value for `baud` (bit period in cycles * 16)."""
+    return (CLK_HZ * 16 + baud // 2) // baud
+
+
+def check():
+    assert ITCM_SIZE % 4096 == 0 and DTCM_SIZE % 4096 == 0, "TCMs must be 4 KB multiples"
+    assert ITCM_SIZE + DTCM_SIZE <= BRAM_BUDGET, "TCMs exceed the 100T block RAM"
+    assert ITCM_BASE + ITCM_SIZE <= DTCM_BASE, "ITCM overlaps DTCM"
+    assert DTCM_BASE + DTCM_SIZE <= 0xFFFF_0000, "DTCM overlaps the MMIO window"
+    bases = [ITCM_BASE, DTCM_BASE, EXT_BASE, FLASH_BASE, IO_BASE]
+    assert all(b & 0x0FFF_FFFF == 0 for b in bases), "region bases must be 256 MB aligned"
+    assert len({b >> 28 for b in bases}) == len(bases), "two regions share addr[31:28]"
+    assert max(ITCM_SIZE, DTCM_SIZE, EXT_SIZE, FLASH_SIZE) <= 0x1000_0000, "memory larger than its region"
+    assert FLASH_SIZE <= 16 * 1024 * 1024, "qspi_xip sends 24-bit addresses"
+    assert FLASH_APP_OFFSET % 4096 == 0 and FLASH_APP_OFFSET < FLASH_SIZE, "bad flash image offset"
+    assert uart_divisor(UART_BAUD) >= 0x40, "UART needs at least 4 clocks per bit"
+    devices = [IRQC_BASE, DMA_BASE, TIMER_BASE, QSPI_BASE, CRC_BASE, MBOX_BASE, SEMA_BASE, GPIO_BASE, SIM_BASE, UART_BASE]
+    assert all(d >> 28 == IO_BASE >> 28 for d in devices), "device outside the IO region"
+    assert len({d >> 8 for d in devices}) == len(devices), "two devices share a 256-byte page"
+
+
+def gen_ld():
+    return f"""/* {HEADER} */
+MEMORY {{
+    BOOT (rx)  : ORIGIN = 0x{ITCM_BASE:08X}, LENGTH = 0x{BOOT_SIZE:08X}
+    ITCM (rwx) : ORIGIN = 0x{ITCM_BASE:08X}, LENGTH = 0x{ITCM_SIZE:08X}
+    APP  (rwx) : ORIGIN = 0x{FIRMWARE_BASE:08X}, LENGTH = 0x{FIRMWARE_MAX:08X}
+    DTCM (rw)  : ORIGIN = 0x{DTCM_BASE:08X}, LENGTH = 0x{DTCM_SIZE:08X}
+    EXT  (rwx) : ORIGIN = 0x{EXT_BASE:08X}, LENGTH = 0x{EXT_SIZE:08X}
+    FLASH (rx) : ORIGIN = 0x{FLASH_BASE + FLASH_APP_OFFSET:08X}, LENGTH = 0x{FLASH_SIZE - FLASH_APP_OFFSET:08X}
+}}
+"""
+
+
+def gen_h():
+    return f"""/* {HEADER} */
+#ifndef MEMMAP_H
+#define MEMMAP_H
+
+#define MEMMAP_ITCM_BASE      0x{ITCM_BASE:08X}UL
+#define MEMMAP_ITCM_SIZE      0x{ITCM_SIZE:08X}UL
+#define MEMMAP_DTCM_BASE      0x{DTCM_BASE:08X}UL
+#define MEMMAP_DTCM_SIZE      0x{DTCM_SIZE:08X}UL
+#define MEMMAP_EXT_BASE       0x{EXT_BASE:08X}UL
+#define MEMMAP_EXT_SIZE       0x{EXT_SIZE:08X}UL
+#define MEMMAP_FLASH_BASE     0x{FLASH_BASE:08X}UL
+#define MEMMAP_FLASH_SIZE     0x{FLASH_SIZE:08X}UL
+#define MEMMAP_FLASH_APP      0x{FLASH_BASE + FLASH_APP_OFFSET:08X}UL
+#define MEMMAP_FIRMWARE_BASE  0x{FIRMWARE_BASE:08X}UL
+#define MEMMAP_FIRMWARE_MAX   0x{FIRMWARE_MAX:08X}UL
+#define MEMMAP_STACK_TOP      0x{STACK_TOP:08X}UL
+#define MEMMAP_CLK_HZ         {CLK_HZ}UL
+#define MEMMAP_UART_BAUD      {UART_BAUD}UL
+#define MEMMAP_UART_DIV       0x{UART_DIV:05X}UL
+
+#define MEMMAP_IRQC_BASE      0x{IRQC_BASE:08X}UL
+#define MEMMAP_DMA_BASE       0x{DMA_BASE:08X}UL
+#define MEMMAP_TIMER_BASE     0x{TIMER_BASE:08X}UL
+#define MEMMAP_QSPI_BASE      0x{QSPI_BASE:08X}UL
+#define MEMMAP_CRC_BASE       0x{CRC_BASE:08X}UL
+#define MEMMAP_MBOX_BASE      0x{MBOX_BASE:08X}UL
+#define MEMMAP_SEMA_BASE      0x{SEMA_BASE:08X}UL
+#define MEMMAP_GPIO_BASE      0x{GPIO_BASE:08X}UL
+#define MEMMAP_SIM_BASE       0x{SIM_BASE:08X}UL
+#define MEMMAP_UART_BASE      0x{UART_BASE:08X}UL
+
+#define MEMMAP_IRQ_UART       {IRQ_UART}
+#define MEMMAP_IRQ_DMA        {IRQ_DMA}
+#define MEMMAP_IRQ_TIMER      {IRQ_TIMER}
+#define MEMMAP_IRQ_MBOX       {IRQ_MBOX}
+#define MEMMAP_IRQ_GPIO       {IRQ_GPIO}
+
+#endif /* MEMMAP_H */
+"""
+
+
+def gen_inc():
+    return f"""# {HEADER}
+.equ ITCM_BASE,       0x{ITCM_BASE:08X}
+.equ ITCM_SIZE,       0x{ITCM_SIZE:08X}
+.equ DTCM_BASE,       0x{DTCM_BASE:08X}
+.equ DTCM_SIZE,       0x{DTCM_SIZE:08X}
+.equ FIRMWARE_BASE,   0x{FIRMWARE_BASE:08X}
+.equ FIRMWARE_MAX,    0x{FIRMWARE_MAX:08X}   # {FIRMWARE_MAX // 1024}KB max firmware
+.equ STACK_TOP,       0x{STACK_TOP:08X}
+.equ UART_BASE,       0x{UART_BASE:08X}
+.equ CRC_BASE,        0x{CRC_BASE:08X}
+.equ UART_DIV,        0x{UART_DIV:05X}      # BAUD register reset value ({UART_BAUD} baud)
+"""
+
+
+def gen_vh():
+    return f"""// {HEADER}
+// Included inside cpu_top / bus_xbar (localparams only).
+localparam [31:0]  ITCM_BASE      = 32'h{ITCM_BASE >> 16:04X}_{ITCM_BASE & 0xFFFF:04X};
+localparam integer ITCM_WORDS     = {ITCM_WORDS};
+localparam integer ITCM_ADDR_BITS = {addr_bits(ITCM_WORDS)};
+localparam [31:0]  DTCM_BASE      = 32'h{DTCM_BASE >> 16:04X}_{DTCM_BASE & 0xFFFF:04X};
+localparam integer DTCM_WORDS     = {DTCM_WORDS};
+localparam integer DTCM_ADDR_BITS = {addr_bits(DTCM_WORDS)};
+localparam [31:0]  EXT_BASE       = 32'h{EXT_BASE >> 16:04X}_{EXT_BASE & 0xFFFF:04X};
+localparam [31:0]  FLASH_BASE     = 32'h{FLASH_BASE >> 16:04X}_{FLASH_BASE & 0xFFFF:04X};
+localparam [31:0]  IO_BASE        = 32'h{IO_BASE >> 16:04X}_{IO_BASE & 0xFFFF:04X};
+localparam integer CLK_HZ         = {CLK_HZ};
+localparam [19:0]  UART_DIV       = 20'h{UART_DIV:05X};
+localparam [31:0]  IRQC_BASE      = 32'h{IRQC_BASE >> 16:04X}_{IRQC_BASE & 0xFFFF:04X};
+localparam [31:0]  DMA_BASE       = 32'h{DMA_BASE >> 16:04X}_{DMA_BASE & 0xFFFF:04X};
+localparam [31:0]  TIMER_BASE     = 32'h{TIMER_BASE >> 16:04X}_{TIMER_BASE & 0xFFFF:04X};
+localparam [31:0]  QSPI_BASE      = 32'h{QSPI_BASE >> 16:04X}_{QSPI_BASE & 0xFFFF:04X};
+localparam [31:0]  CRC_BASE       = 32'h{CRC_BASE >> 16:04X}_{CRC_BASE & 0xFFFF:04X};
+localparam [31:0]  MBOX_BASE      = 32'h{MBOX_BASE >> 16:04X}_{MBOX_BASE & 0xFFFF:04X};
+localparam [31:0]  SEMA_BASE      = 32'h{SEMA_BASE >> 16:04X}_{SEMA_BASE & 0xFFFF:04X};
+localparam [31:0]  GPIO_BASE      = 32'h{GPIO_BASE >> 16:04X}_{GPIO_BASE & 0xFFFF:04X};
+localparam [31:0]  SIM_BASE       = 32'h{SIM_BASE >> 16:04X}_{SIM_BASE & 0xFFFF:04X};
+localparam [31:0]  UART_BASE      = 32'h{UART_BASE >> 16:04X}_{UART_BASE & 0xFFFF:04X};
+localparam integer IRQ_UART       = {IRQ_UART};
+localparam integer IRQ_DMA        = {IRQ_DMA};
+localparam integer IRQ_TIMER      = {IRQ_TIMER};
+localparam integer IRQ_MBOX       = {IRQ_MBOX};
+localparam integer IRQ_GPIO       = {IRQ_GPIO};
+"""
+
+
+def main():
+    check()
+    outputs = {
+        HERE / "memmap.ld": gen_ld(),
+        HERE / "memmap.h": gen_h(),
+        HERE / "bootloader" / "memmap.inc": gen_inc(),
+        RTL_DIR / "memmap.vh": gen_vh(),
+    }
+    for path, text in outputs.items():
+        # Unchanged files are left alone: builds running in parallel read
+        # them, and Vivado sees no new timestamp
+        if path.exists() and path.read_text() == text:
+            continue
+        path.write_text(text)
+        print(f"Wrote {path.relative_to(HERE.parent)}")
+    print(f"ITCM {ITCM_SIZE // 1024} KB @ 0x{ITCM_BASE:08X}, "
+          f"DTCM {DTCM_SIZE // 1024} KB @ 0x{DTCM_BASE:08X} "
+          f"({(ITCM_SIZE + DTCM_SIZE) // 1024}/{BRAM_BUDGET // 1024} KB BRAM)")
+
+
+if __name__ == "__main__":
+    main()
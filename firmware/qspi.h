@@ -0,0 +1,52 @@
+#ifndef QSPI_H
+#define QSPI_H
+
+#include <stdint.h>
+#include "memmap.h"
+
+/*
+ * Execute-in-place from the QSPI flash (qspi_xip.v).
+ *
+ * QSPI_TEXT / QSPI_RODATA place a function or a constant in the FLASH
+ * region (link.ld .flash_text). The build extracts that section into
+ * flash.bin, which is programmed at flash offset 0x400000 (MEMMAP_FLASH_APP)
+ * separately from the UART upload. Flash code runs from the line cache:
+ * sequential code mostly hits, a miss costs roughly 60 cycles, so keep
+ * interrupt handlers and timing-critical code out of it. Flash is
+ * read-only; writes are ignored.
+ */
+#define QSPI_TEXT           __attribute__((section(".flash_text"), noinline))
+#define QSPI_RODATA         __attribute__((section(".flash_rodata")))
+
+#define QSPI_CTRL           (*(volatile uint32_t *)(MEMMAP_QSPI_BASE + 0x00))
+#define QSPI_STATUS         (*(volatile uint32_t *)(MEMMAP_QSPI_BASE + 0x04))
+#define QSPI_HITS           (*(volatile uint32_t *)(MEMMAP_QSPI_BASE + 0x08))
+#define QSPI_MISSES         (*(volatile uint32_t *)(MEMMAP_QSPI_BASE + 0x0C))
+#define QSPI_PREF           (*(volatile uint32_t *)(MEMMAP_QSPI_BASE + 0x10))
+
+/* CTRL bits */
+#define QSPI_CTRL_PREFETCH  (1u << 0)
+#define QSPI_CTRL_INVAL     (1u << 1)       /* write-only */
+
+/* STATUS bits */
+#define QSPI_ST_BUSY        (1u << 0)
+
+static inline void qspi_prefetch(int on)
+{
+    QSPI_CTRL = on ? QSPI_CTRL_PREFETCH : 0;
+}
+
+/* Drop the cached lines (after the flash contents changed) */
+static inline void qspi_invalidate(void)
+{
+    QSPI_CTRL = (QSPI_CTRL & QSPI_CTRL_PREFETCH) | QSPI_CTRL_INVAL;
+}
+
+static inline void qspi_stats_clear(void)
+{
+    QSPI_HITS   = 0;
+    QSPI_MISSES = 0;
+    QSPI_PREF   = 0;
+}
+
+#endif
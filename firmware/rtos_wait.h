@@ -0,0 +1,44 @@
+#ifndef RTOS_WAIT_H
+#define RTOS_WAIT_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*
+ * How the blocking drivers (dma, timer, mbox, gpio) wake a task: the ISR
+ * sets a flag the waiting task owns, then rtos_wake_from_isr(); the task
+ * sleeps in rtos_wait_flag() until the flag is set. The wake-ups go to
+ * notification RTOS_NOTIFY_DRIVER, so the kernel's own users of index 0
+ * (stream buffers) neither see nor consume them. A task waits in one
+ * driver at a time; a wake-up left over from an earlier wait just costs
+ * one more look at the flag.
+ */
+#define RTOS_NOTIFY_DRIVER  1
+
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES <= RTOS_NOTIFY_DRIVER
+#error "configTASK_NOTIFICATION_ARRAY_ENTRIES must include RTOS_NOTIFY_DRIVER"
+#endif
+
+static inline void rtos_wake_from_isr(TaskHandle_t task, BaseType_t *woken)
+{
+    vTaskNotifyGiveIndexedFromISR(task, RTOS_NOTIFY_DRIVER, woken);
+}
+
+/* Block until *flag & mask is nonzero or `wait` ticks have passed
+ * (portMAX_DELAY: no limit). Returns *flag & mask, 0 on timeout. */
+static inline uint32_t rtos_wait_flag(volatile uint32_t *flag, uint32_t mask,
+                                      TickType_t wait)
+{
+    TimeOut_t to;
+
+    vTaskSetTimeOutState(&to);
+    while (!(*flag & mask)) {
+        if (wait != portMAX_DELAY && xTaskCheckForTimeOut(&to, &wait) != pdFALSE)
+            break;
+        ulTaskNotifyTakeIndexed(RTOS_NOTIFY_DRIVER, pdTRUE, wait);
+    }
+    return *flag & mask;
+}
+
+#endif
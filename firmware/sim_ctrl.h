@@ -0,0 +1,40 @@
+#ifndef SIM_CTRL_H
+#define SIM_CTRL_H
+
+#include <stdint.h>
+#include "memmap.h"
+
+/*
+ * Simulation control device (sim_ctrl.v) - only present in the testbenches
+ * and the Verilator harness; on the board its page reads 0 and ignores
+ * writes.
+ *
+ * Built with -DSIM_CONSOLE (SIM_CONSOLE=1 ./build.sh), uart_putc() and
+ * uart_write() print through CONSOLE instead of the UART, which costs one
+ * IO write per byte instead of ~10 bit periods, and sim_exit() ends the
+ * simulation with a pass/fail code. Without it sim_exit() does nothing.
+ */
+#define SIM_CONSOLE_ADDR    (MEMMAP_SIM_BASE + 0x00)
+#define SIM_EXIT_ADDR       (MEMMAP_SIM_BASE + 0x04)
+#define SIM_ID_ADDR         (MEMMAP_SIM_BASE + 0x08)
+
+#define SIM_ID              0x53494D31u     /* "SIM1" */
+
+static inline int sim_present(void) {
+    return *(volatile uint32_t *)SIM_ID_ADDR == SIM_ID;
+}
+
+static inline void sim_putc(char c) {
+    *(volatile uint32_t *)SIM_CONSOLE_ADDR = (uint32_t)(uint8_t)c;
+}
+
+/* End the simulation: 0 = pass, anything else = fail */
+static inline void sim_exit(uint32_t code) {
+#ifdef SIM_CONSOLE
+    *(volatile uint32_t *)SIM_EXIT_ADDR = code;
+#else
+    (void)code;
+#endif
+}
+
+#endif /* SIM_CTRL_H */
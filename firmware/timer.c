@@ -0,0 +1,49 @@
+#include <stdint.h>
+#include "timer.h"
+
+/* Capture setup, which timer_compare() / timer_pwm() leave alone */
+#define CTRL_CAPT_BITS  (TIMER_CTRL_CAPT_IE | TIMER_CAPT_RISE | TIMER_CAPT_FALL)
+
+void timer_compare(unsigned ch, uint32_t at, uint32_t period, int irq) {
+    uint32_t capt = TIMER_CTRL(ch) & CTRL_CAPT_BITS;
+
+    TIMER_CTRL(ch)   = capt | TIMER_MODE_OFF;
+    TIMER_STATUS     = TIMER_ST_MATCH(ch);
+    TIMER_PERIOD(ch) = period;
+    TIMER_CTRL(ch)   = capt | TIMER_MODE_COMPARE | (irq ? TIMER_CTRL_MATCH_IE : 0);
+    TIMER_CMP(ch)    = at;
+}
+
+void timer_pwm(unsigned ch, uint32_t at, uint32_t period, uint32_t duty) {
+    uint32_t capt = TIMER_CTRL(ch) & CTRL_CAPT_BITS;
+
+    TIMER_CTRL(ch)   = capt | TIMER_MODE_OFF;
+    TIMER_STATUS     = TIMER_ST_MATCH(ch);
+    TIMER_PERIOD(ch) = period;
+    TIMER_DUTY(ch)   = duty;
+    TIMER_CTRL(ch)   = capt | TIMER_MODE_PWM;
+    TIMER_CMP(ch)    = at;
+}
+
+void timer_pwm_duty(unsigned ch, uint32_t duty) {
+    TIMER_DUTY(ch) = duty;
+}
+
+void timer_capture(unsigned ch, uint32_t edges, int irq) {
+    uint32_t ctrl = TIMER_CTRL(ch) & ~(TIMER_CAPT_RISE | TIMER_CAPT_FALL | TIMER_CTRL_CAPT_IE);
+
+    TIMER_STATUS   = TIMER_ST_CAPT(ch);
+    TIMER_CTRL(ch) = (ctrl & 0x3Fu) | (edges & (TIMER_CAPT_RISE | TIMER_CAPT_FALL)) |
+                     (irq ? TIMER_CTRL_CAPT_IE : 0);
+}
+
+void timer_stop(unsigned ch) {
+    TIMER_CTRL(ch) = TIMER_MODE_OFF;
+    TIMER_STATUS   = TIMER_ST_MATCH(ch) | TIMER_ST_CAPT(ch);
+}
+
+void timer_spin_until(uint32_t t) {
+    while (!timer_reached(timer_now(), t)) {
+        /* spin */
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+#include "memmap.h"
+
+/*
+ * Timer channels (timer.v) - register-level API, no RTOS needed.
+ *
+ * All times are the low word of the CLINT mtime (core clock cycles) and
+ * wrap; compare them with timer_reached(), never with `<`. A CMP up to
+ * 2^31 cycles in the past matches at once. Set the mode before CMP:
+ * writing CMP is what arms a channel.
+ */
+#define TIMER_CHANNELS      4
+
+#define TIMER_CH(c)         (MEMMAP_TIMER_BASE + (uint32_t)(c) * 0x20u)
+#define TIMER_CMP(c)        (*(volatile uint32_t *)(TIMER_CH(c) + 0x00))
+#define TIMER_PERIOD(c)     (*(volatile uint32_t *)(TIMER_CH(c) + 0x04))
+#define TIMER_DUTY(c)       (*(volatile uint32_t *)(TIMER_CH(c) + 0x08))
+#define TIMER_CAPT(c)       (*(volatile uint32_t *)(TIMER_CH(c) + 0x0C))
+#define TIMER_CTRL(c)       (*(volatile uint32_t *)(TIMER_CH(c) + 0x10))
+#define TIMER_STATUS        (*(volatile uint32_t *)(MEMMAP_TIMER_BASE + 0x80))
+#define TIMER_MTIME         (*(volatile uint32_t *)(MEMMAP_TIMER_BASE + 0x84))
+
+/* CTRL bits */
+#define TIMER_MODE_OFF      0u
+#define TIMER_MODE_COMPARE  1u
+#define TIMER_MODE_PWM      2u
+#define TIMER_CTRL_MATCH_IE (1u << 2)
+#define TIMER_CTRL_CAPT_IE  (1u << 3)
+#define TIMER_CAPT_RISE     (1u << 4)
+#define TIMER_CAPT_FALL     (1u << 5)
+#define TIMER_CTRL_ARMED    (1u << 8)
+#define TIMER_CTRL_OUT      (1u << 9)
+
+/* STATUS bits, write 1 to clear */
+#define TIMER_ST_MATCH(c)   (1u << (c))
+#define TIMER_ST_CAPT(c)    (1u << (16 + (c)))
+
+/* Capture inputs (cpu_top.v) */
+#define TIMER_CAP_UART_RX   0
+#define TIMER_CAP_BTN0      1
+#define TIMER_CAP_SW0       2
+#define TIMER_CAP_SW1       3
+
+static inline uint32_t timer_now(void) {
+    return TIMER_MTIME;
+}
+
+/* Has `now` reached `t`? Valid while the two are < 2^31 cycles apart. */
+static inline int timer_reached(uint32_t now, uint32_t t) {
+    return (int32_t)(now - t) >= 0;
+}
+
+/* Match at `at`, then every `period` cycles (0 = once). This and
+ * timer_pwm() keep the channel's capture setup. */
+void timer_compare(unsigned ch, uint32_t at, uint32_t period, int irq);
+/* PWM on the channel output starting at `at` (channel 0 drives led[3]) */
+void timer_pwm(unsigned ch, uint32_t at, uint32_t period, uint32_t duty);
+void timer_pwm_duty(unsigned ch, uint32_t duty);
+/* Latch mtime on the given TIMER_CAPT_* edges of the channel's input */
+void timer_capture(unsigned ch, uint32_t edges, int irq);
+void timer_stop(unsigned ch);              /* compare/PWM and capture off */
+
+/* Spin until mtime reaches `t` (no RTOS, no interrupt) */
+void timer_spin_until(uint32_t t);
+
+#endif
@@ -0,0 +1,132 @@
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "irq.h"
+#include "timer.h"
+#include "timer_rtos.h"
+#include "rtos_wait.h"
+
+static uint32_t              in_use;             /* channel bitmap */
+static timer_cb_t            match_fn[TIMER_CHANNELS];
+static void                 *match_arg[TIMER_CHANNELS];
+static timer_capt_cb_t       capt_fn[TIMER_CHANNELS];
+static void                 *capt_arg[TIMER_CHANNELS];
+
+static void timer_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t st = TIMER_STATUS;
+
+    TIMER_STATUS = st;                      /* drops the irq line */
+    for (unsigned ch = 0; ch < TIMER_CHANNELS; ch++) {
+        if (st & TIMER_ST_CAPT(ch)) {
+            if (capt_fn[ch])
+                capt_fn[ch](capt_arg[ch], TIMER_CAPT(ch), &woken);
+        }
+        if ((st & TIMER_ST_MATCH(ch)) && (in_use & (1u << ch))) {
+            timer_cb_t fn = match_fn[ch];
+            void *arg     = match_arg[ch];
+
+            /* Free the channel first so the callback can re-arm it */
+            TIMER_CTRL(ch) &= ~0x7u;
+            in_use        &= ~(1u << ch);
+            fn(arg, &woken);
+        }
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+void timer_rtos_init(void)
+{
+    TIMER_STATUS = 0xFFFFFFFFu;
+    irq_register(MEMMAP_IRQ_TIMER, timer_isr);
+}
+
+/* Caller holds off interrupts (critical section or ISR) */
+static int arm(uint32_t at, timer_cb_t fn, void *arg)
+{
+    uint32_t free = TIMER_RTOS_CHANNELS & ~in_use;
+    unsigned ch = 0;
+
+    if (free == 0)
+        return -1;
+    while (!(free & (1u << ch)))
+        ch++;
+    in_use       |= 1u << ch;
+    match_fn[ch]  = fn;
+    match_arg[ch] = arg;
+    timer_compare(ch, at, 0, 1);
+    return (int)ch;
+}
+
+int timer_call_at(uint32_t at, timer_cb_t fn, void *arg)
+{
+    int ch;
+
+    taskENTER_CRITICAL();
+    ch = arm(at, fn, arg);
+    taskEXIT_CRITICAL();
+    return ch;
+}
+
+int timer_call_at_from_isr(uint32_t at, timer_cb_t fn, void *arg)
+{
+    return arm(at, fn, arg);
+}
+
+static void notify_cb(void *arg, BaseType_t *woken)
+{
+    rtos_wake_from_isr((TaskHandle_t)arg, woken);
+}
+
+int timer_notify_at(uint32_t at, TaskHandle_t task)
+{
+    return timer_call_at(at, notify_cb, task);
+}
+
+void timer_cancel(int ch)
+{
+    if (ch < 0 || ch >= TIMER_CHANNELS)
+        return;
+    taskENTER_CRITICAL();
+    if (in_use & (1u << ch)) {
+        TIMER_CTRL(ch) &= ~0x7u;
+        TIMER_STATUS    = TIMER_ST_MATCH(ch);
+        in_use         &= ~(1u << ch);
+    }
+    taskEXIT_CRITICAL();
+}
+
+struct sleeper {
+    TaskHandle_t       task;
+    volatile uint32_t  done;
+};
+
+static void wake_cb(void *arg, BaseType_t *woken)
+{
+    struct sleeper *s = arg;
+
+    s->done = 1;
+    rtos_wake_from_isr(s->task, woken);
+}
+
+BaseType_t timer_sleep_until(uint32_t at)
+{
+    struct sleeper s = { xTaskGetCurrentTaskHandle(), 0 };
+
+    if (timer_call_at(at, wake_cb, &s) < 0)
+        return pdFAIL;
+    rtos_wait_flag(&s.done, 1, portMAX_DELAY);
+    return pdPASS;
+}
+
+void timer_on_capture(unsigned ch, uint32_t edges, timer_capt_cb_t fn, void *arg)
+{
+    if (ch >= TIMER_CHANNELS)
+        return;
+    taskENTER_CRITICAL();
+    capt_fn[ch]  = fn;
+    capt_arg[ch] = arg;
+    timer_capture(ch, edges, fn != NULL);
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,50 @@
+#ifndef TIMER_RTOS_H
+#define TIMER_RTOS_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_wait.h"
+#include "timer.h"
+
+/*
+ * Cycle-exact events for FreeRTOS, below the tick: run a callback or wake
+ * a task when mtime reaches a given cycle. Each pending event holds one
+ * hardware compare channel out of TIMER_RTOS_CHANNELS (channel 0 is left
+ * to the application for PWM / capture). The channel matches in the exact
+ * cycle; the callback runs after the trap entry and irq dispatch, a fixed
+ * few dozen cycles later, and a woken task additionally waits for the
+ * context switch (and for any higher-priority task).
+ *
+ * Times are mtime low words (timer_now() + n). An event in the past fires
+ * at once. Functions return the channel used, or -1 when none is free.
+ */
+#define TIMER_RTOS_CHANNELS  0x0Eu      /* bitmap of channels owned here */
+
+/* Runs in the interrupt handler: use FromISR APIs only, set *woken when a
+ * higher-priority task was readied. May re-arm itself with
+ * timer_call_at_from_isr(). */
+typedef void (*timer_cb_t)(void *arg, BaseType_t *woken);
+
+/* mtime at the capture edge */
+typedef void (*timer_capt_cb_t)(void *arg, uint32_t capt, BaseType_t *woken);
+
+/* Enable the timer interrupt. Call before vTaskStartScheduler(). */
+void timer_rtos_init(void);
+
+int  timer_call_at(uint32_t at, timer_cb_t fn, void *arg);
+int  timer_call_at_from_isr(uint32_t at, timer_cb_t fn, void *arg);
+/* Gives notification RTOS_NOTIFY_DRIVER of `task` at `at`: wait with
+ * ulTaskNotifyTakeIndexed(RTOS_NOTIFY_DRIVER, ...), not ulTaskNotifyTake(). */
+int  timer_notify_at(uint32_t at, TaskHandle_t task);
+void timer_cancel(int ch);
+
+/* Block the calling task until mtime reaches `at`. pdFAIL when no channel
+ * is free (the caller can fall back to vTaskDelay). */
+BaseType_t timer_sleep_until(uint32_t at);
+
+/* Call fn on every selected edge (TIMER_CAPT_*) of a capture input. Any
+ * channel may capture, including one in PWM mode. */
+void timer_on_capture(unsigned ch, uint32_t edges, timer_capt_cb_t fn, void *arg);
+
+#endif
@@ -1,18 +1,22 @@
 #include <stdint.h>
 #include "uart.h"
+#include "sim_ctrl.h"
 
-#define UART_TX_ADDR   0xFFFFFFF0u
-#define UART_STAT_ADDR 0xFFFFFFF4u
+#define REG(addr) (*(volatile uint32_t *)(addr))
 
 static inline uint32_t uart_status(void) {
-    return *(volatile uint32_t *)UART_STAT_ADDR;
+    return REG(UART_STAT_ADDR);
 }
 
 void uart_putc(char c) {
-    while (uart_status() & 0x3u) {
+#ifdef SIM_CONSOLE
+    sim_putc(c);
+#else
+    while (uart_status() & (UART_STAT_TX_BUSY | UART_STAT_TX_FULL)) {
         /* wait for not busy and fifo space */
     }
-    *(volatile uint32_t *)UART_TX_ADDR = (uint32_t)(uint8_t)c;
+    REG(UART_TX_ADDR) = (uint32_t)(uint8_t)c;
+#endif
 }
 
 void uart_puts(const char *s) {
@@ -29,3 +33,68 @@ void uart_print_hex(uint32_t val) {
         uart_putc(hex[(val >> i) & 0xF]);
     }
 }
+
+uint32_t uart_rx_count(void) {
+    return REG(UART_COUNT_ADDR) & 0xFFFFu;
+}
+
+int uart_getc_nonblock(void) {
+    if (!(uart_status() & UART_STAT_RX_AVAIL))
+        return -1;
+    return (int)(REG(UART_RX_ADDR) & 0xFFu);
+}
+
+char uart_getc(void) {
+    int c;
+    while ((c = uart_getc_nonblock()) < 0) {
+        /* wait for a byte */
+    }
+    return (char)c;
+}
+
+/* threshold: raise UART_IRQ_RX_THRESH at this many queued bytes (0 = off)
+ * timeout_bits: raise UART_IRQ_RX_TIMEOUT after this many idle bit times
+ * irq_mask: which of UART_IRQ_RX_THRESH/TIMEOUT/ERROR reach the controller */
+void uart_rx_config(uint8_t threshold, uint8_t timeout_bits, uint32_t irq_mask) {
+    uint32_t tx = REG(UART_CTRL_ADDR) & (0xFF000000u | UART_CTRL_TX_LOW);
+    REG(UART_CTRL_ADDR) = tx | ((uint32_t)timeout_bits << 16) |
+                          ((uint32_t)threshold << 8) |
+                          (irq_mask & 0x7u);
+}
+
+uint32_t uart_rx_errors(void) {
+    return REG(UART_IRQ_ADDR) & (UART_IRQ_OVERRUN | UART_IRQ_FERR);
+}
+
+void uart_rx_clear_errors(uint32_t mask) {
+    REG(UART_IRQ_ADDR) = mask & (UART_IRQ_OVERRUN | UART_IRQ_FERR);
+}
+
+uint32_t uart_tx_count(void) {
+    return REG(UART_COUNT_ADDR) >> 16;
+}
+
+void uart_tx_watermark(uint8_t level) {
+    REG(UART_CTRL_ADDR) = (REG(UART_CTRL_ADDR) & 0x00FFFFFFu) | ((uint32_t)level << 24);
+}
+
+/* Read-modify-write of CTRL: mask interrupts around it if an ISR also
+ * writes CTRL */
+void uart_tx_irq(int enable) {
+    if (enable)
+        REG(UART_CTRL_ADDR) |= UART_CTRL_TX_LOW;
+    else
+        REG(UART_CTRL_ADDR) &= ~UART_CTRL_TX_LOW;
+}
+
+void uart_flush(void) {
+    while (uart_tx_count() != 0 || (uart_status() & UART_STAT_TX_BUSY)) {
+        /* wait for FIFO and shifter to empty */
+    }
+}
+
+void uart_set_baud(uint32_t baud) {
+    uint32_t div = (MEMMAP_CLK_HZ * 16u + baud / 2) / baud;
+    uart_flush();
+    REG(UART_BAUD_ADDR) = div;
+}
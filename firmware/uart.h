@@ -2,9 +2,56 @@
 #define UART_H
 
 #include <stdint.h>
+#include "memmap.h"
+
+/* UART registers (cpu_top.v) */
+#define UART_CTRL_ADDR   (MEMMAP_UART_BASE + 0x00)
+#define UART_IRQ_ADDR    (MEMMAP_UART_BASE + 0x04)
+#define UART_COUNT_ADDR  (MEMMAP_UART_BASE + 0x08)
+#define UART_BAUD_ADDR   (MEMMAP_UART_BASE + 0x0C)
+#define UART_TX_ADDR     (MEMMAP_UART_BASE + 0x10)
+#define UART_STAT_ADDR   (MEMMAP_UART_BASE + 0x14)
+#define UART_RX_ADDR     (MEMMAP_UART_BASE + 0x18)
+
+/* STATUS bits */
+#define UART_STAT_TX_BUSY   (1u << 0)
+#define UART_STAT_TX_FULL   (1u << 1)
+#define UART_STAT_RX_AVAIL  (1u << 2)
+#define UART_STAT_OVERRUN   (1u << 3)
+#define UART_STAT_FERR      (1u << 4)
+#define UART_STAT_RX_FULL   (1u << 5)
+
+/* CTRL / IRQ bits */
+#define UART_IRQ_RX_THRESH  (1u << 0)
+#define UART_IRQ_RX_TIMEOUT (1u << 1)
+#define UART_IRQ_RX_ERROR   (1u << 2)   /* CTRL enable for both error flags */
+#define UART_IRQ_OVERRUN    (1u << 2)   /* IRQ register flags, write 1 to clear */
+#define UART_IRQ_FERR       (1u << 3)
+#define UART_CTRL_TX_LOW    (1u << 3)   /* CTRL enable for the TX low-water irq */
+#define UART_IRQ_TX_LOW     (1u << 4)   /* IRQ flag: TX FIFO bytes <= watermark */
+
+#define UART_TX_FIFO_DEPTH  256
 
 void uart_putc(char c);
 void uart_puts(const char *s);
 void uart_print_hex(uint32_t val);
 
+/* Receive side (hardware FIFO, no RTOS needed) */
+uint32_t uart_rx_count(void);
+int      uart_getc_nonblock(void);          /* -1 if the FIFO is empty */
+char     uart_getc(void);                   /* spins until a byte arrives */
+void     uart_rx_config(uint8_t threshold, uint8_t timeout_bits, uint32_t irq_mask);
+uint32_t uart_rx_errors(void);              /* UART_IRQ_OVERRUN | UART_IRQ_FERR */
+void     uart_rx_clear_errors(uint32_t mask);
+
+/* Transmit side helpers for interrupt-driven drivers */
+uint32_t uart_tx_count(void);               /* bytes waiting in the TX FIFO */
+void     uart_tx_watermark(uint8_t level);  /* low-water irq at <= level bytes */
+void     uart_tx_irq(int enable);
+
+/* Waits for the TX FIFO and shifter to empty, then switches both
+ * directions to `baud` (bit period rounded to 1/16 clock). */
+void     uart_set_baud(uint32_t baud);
+void     uart_flush(void);
+
 #endif
@@ -0,0 +1,144 @@
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "irq.h"
+#include "uart.h"
+#include "uart_rtos.h"
+#include "sim_ctrl.h"
+
+#define REG(addr) (*(volatile uint32_t *)(addr))
+
+static StreamBufferHandle_t rx_stream;
+static StreamBufferHandle_t tx_stream;
+static SemaphoreHandle_t    tx_lock;
+static volatile uint32_t rx_dropped;
+static volatile uint32_t rx_ferr_count;
+
+static void uart_isr_rx(BaseType_t *woken)
+{
+    uint8_t chunk[16];
+    uint32_t n;
+
+    /* Drain everything: the source is a level and only drops once the
+     * FIFO is empty, even if the stream buffer cannot take the bytes. */
+    while ((n = REG(UART_COUNT_ADDR) & 0xFFFFu) != 0) {
+        if (n > sizeof(chunk))
+            n = sizeof(chunk);
+        for (uint32_t i = 0; i < n; i++)
+            chunk[i] = (uint8_t)REG(UART_RX_ADDR);
+        size_t sent = xStreamBufferSendFromISR(rx_stream, chunk, n, woken);
+        rx_dropped += n - sent;
+    }
+
+    uint32_t err = uart_rx_errors();
+    if (err) {
+        if (err & UART_IRQ_OVERRUN)
+            rx_dropped++;               /* at least one byte lost in hardware */
+        if (err & UART_IRQ_FERR)
+            rx_ferr_count++;
+        uart_rx_clear_errors(err);
+    }
+}
+
+static void uart_isr_tx(BaseType_t *woken)
+{
+    uint8_t chunk[16];
+    uint32_t space = UART_TX_FIFO_DEPTH - uart_tx_count();
+
+    /* Fill the hardware FIFO; each write is acked at once while there is
+     * room, so this never stalls on the bus */
+    while (space != 0) {
+        size_t want = space < sizeof(chunk) ? space : sizeof(chunk);
+        size_t got = xStreamBufferReceiveFromISR(tx_stream, chunk, want, woken);
+        for (size_t i = 0; i < got; i++)
+            REG(UART_TX_ADDR) = chunk[i];
+        space -= got;
+        if (got < want)
+            break;
+    }
+
+    /* Low water is a level: stop it once there is nothing left to send.
+     * uart_write() re-enables it after queueing more. */
+    if (xStreamBufferIsEmpty(tx_stream))
+        uart_tx_irq(0);
+}
+
+static void uart_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    uint32_t flags = REG(UART_IRQ_ADDR);
+
+    if (flags & (UART_IRQ_RX_THRESH | UART_IRQ_RX_TIMEOUT | UART_IRQ_OVERRUN | UART_IRQ_FERR))
+        uart_isr_rx(&woken);
+    if ((flags & UART_IRQ_TX_LOW) && (REG(UART_CTRL_ADDR) & UART_CTRL_TX_LOW))
+        uart_isr_tx(&woken);
+
+    portYIELD_FROM_ISR(woken);
+}
+
+BaseType_t uart_rtos_init(void)
+{
+    rx_stream = xStreamBufferCreate(UART_RTOS_RX_BUF, 1);
+    tx_stream = xStreamBufferCreate(UART_RTOS_TX_BUF, 1);
+    tx_lock   = xSemaphoreCreateMutex();
+    if (rx_stream == NULL || tx_stream == NULL || tx_lock == NULL)
+        return pdFAIL;
+
+    uart_rx_clear_errors(UART_IRQ_OVERRUN | UART_IRQ_FERR);
+    uart_rx_config(UART_RTOS_RX_THRESH, UART_RTOS_RX_TIMEOUT,
+                   UART_IRQ_RX_THRESH | UART_IRQ_RX_TIMEOUT | UART_IRQ_RX_ERROR);
+    uart_tx_watermark(UART_RTOS_TX_LOW);
+    irq_register(MEMMAP_IRQ_UART, uart_isr);
+    return pdPASS;
+}
+
+size_t uart_read(void *buf, size_t len, TickType_t timeout)
+{
+    return xStreamBufferReceive(rx_stream, buf, len, timeout);
+}
+
+void uart_write(const void *buf, size_t len)
+{
+    const uint8_t *p = buf;
+
+    xSemaphoreTake(tx_lock, portMAX_DELAY);
+#ifdef SIM_CONSOLE
+    /* Simulation console: no FIFO to wait for, so skip the stream buffer */
+    while (len != 0) {
+        sim_putc((char)*p++);
+        len--;
+    }
+#endif
+    while (len != 0) {
+        /* Chunks of at most half the buffer, so the ISR is already
+         * draining while a long message is still being queued */
+        size_t n = len < UART_RTOS_TX_BUF / 2 ? len : UART_RTOS_TX_BUF / 2;
+        n = xStreamBufferSend(tx_stream, p, n, portMAX_DELAY);
+        p   += n;
+        len -= n;
+        taskENTER_CRITICAL();
+        uart_tx_irq(1);
+        taskEXIT_CRITICAL();
+    }
+    xSemaphoreGive(tx_lock);
+}
+
+void uart_print(const char *s)
+{
+    size_t n = 0;
+    while (s[n])
+        n++;
+    uart_write(s, n);
+}
+
+uint32_t uart_rtos_rx_dropped(void)
+{
+    return rx_dropped;
+}
+
+uint32_t uart_rtos_rx_framing_errors(void)
+{
+    return rx_ferr_count;
+}
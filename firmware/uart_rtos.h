@@ -0,0 +1,43 @@
+#ifndef UART_RTOS_H
+#define UART_RTOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+/*
+ * Interrupt-driven UART for FreeRTOS tasks.
+ *
+ * RX: the RX interrupt (FIFO threshold / idle timeout / error) drains the
+ * hardware FIFO into a stream buffer; tasks block in uart_read() instead
+ * of polling STATUS. Only one task may read at a time (stream buffer rule).
+ *
+ * TX: uart_write() copies into a stream buffer and returns; the TX
+ * low-water interrupt refills the hardware FIFO. Writers are serialised
+ * by a mutex, so a message from one call is never split by another task.
+ * The polled uart_putc()/uart_puts() stay usable for panics and for
+ * output before the scheduler starts.
+ */
+#define UART_RTOS_RX_BUF      512   /* software buffers, bytes */
+#define UART_RTOS_TX_BUF      1024
+#define UART_RTOS_RX_THRESH   32    /* irq when the 64-byte FIFO is half full */
+#define UART_RTOS_RX_TIMEOUT  40    /* ...or after ~4 idle character times */
+#define UART_RTOS_TX_LOW      64    /* refill when the TX FIFO drops to this */
+
+/* Create the buffers and enable the UART interrupt. Call before
+ * vTaskStartScheduler() (or from a task). Returns pdFAIL on no memory. */
+BaseType_t uart_rtos_init(void);
+
+/* Block up to `timeout` ticks for at least one byte; returns bytes read. */
+size_t uart_read(void *buf, size_t len, TickType_t timeout);
+
+/* Queue len bytes for transmission. Blocks only while the software buffer
+ * is full; call from tasks, not ISRs. */
+void uart_write(const void *buf, size_t len);
+void uart_print(const char *s);
+
+/* Bytes lost: hardware FIFO overruns + software buffer full */
+uint32_t uart_rtos_rx_dropped(void);
+uint32_t uart_rtos_rx_framing_errors(void);
+
+#endif
@@ -1,23 +1,68 @@
 #!/usr/bin/env python3
 """
 UART Firmware Uploader for RISC-V Bootloader
-Usage: python upload.py <COM_PORT> <firmware.bin>
+Usage: python upload.py <COM_PORT> <firmware.bin> [--baud N]
 Example: python upload.py COM3 app.bin
+
+The bootloader starts at memmap.UART_BAUD. Unless --baud equals that, the
+uploader first sends 'B' + the BAUD register divisor, waits for the ACK,
+and switches both ends to the faster rate for the transfer. The bootloader
+returns to the reset rate before starting the application.
+
+The image is followed by its CRC-32 (zlib.crc32, little endian). The
+bootloader runs every received byte through the hardware CRC engine and
+answers ACK and starts the application, or NAK and discards the image.
 """
 
+import argparse
 import serial
 import sys
 import time
 import struct
+import zlib
+
+import memmap
+
+ACK = b'\x06'
+NAK = b'\x15'
+
+# Arty's FTDI bridge: 12 MHz / n (3M, 2M, 1.5M, 1M ...) plus the classic rates
+DEFAULT_BAUD = 2_000_000
+
+
+def negotiate_baud(ser, baud):
+    """Switch bootloader and port to `baud`. Returns False if refused."""
+    div = memmap.uart_divisor(baud)
+    actual = memmap.CLK_HZ * 16 / div
+    err = (actual - baud) / baud * 100
+    print(f"Switching to {baud} baud (divisor {div / 16:.4f} clocks/bit, {err:+.2f}%)...")
+    if abs(err) > 2.0:
+        print("ERROR: rate error too large for this clock")
+        return False
+    ser.write(b'B' + struct.pack('<I', div))
+    ack = ser.read(1)
+    if ack != ACK:
+        why = "divisor rejected" if ack == NAK else f"got: {ack.hex() if ack else 'nothing'}"
+        print(f"ERROR: baud change refused, {why}")
+        return False
+    ser.flush()
+    ser.baudrate = baud
+    time.sleep(0.05)
+    ser.reset_input_buffer()
+    return True
+
 
 def main():
-    if len(sys.argv) < 3:
-        print("Usage: python upload.py <COM_PORT> <firmware.bin>")
-        print("Example: python upload.py COM3 app.bin")
-        sys.exit(1)
-    
-    port = sys.argv[1]
-    firmware_path = sys.argv[2]
+    ap = argparse.ArgumentParser(description="Upload firmware through the UART bootloader")
+    ap.add_argument("port", help="serial port, e.g. COM3 or /dev/ttyUSB1")
+    ap.add_argument("firmware", help="raw binary (app.bin)")
+    ap.add_argument("--baud", type=int, default=DEFAULT_BAUD,
+                    help=f"transfer rate (default {DEFAULT_BAUD}, "
+                         f"{memmap.UART_BAUD} = no negotiation)")
+    args = ap.parse_args()
+
+    port = args.port
+    firmware_path = args.firmware
     
     # Read firmware
     print(f"Reading firmware from {firmware_path}...")
@@ -27,14 +72,14 @@ def main():
     size = len(firmware)
     print(f"Firmware size: {size} bytes ({size/1024:.1f} KB)")
     
-    if size > 124 * 1024:
-        print("ERROR: Firmware too large! Max 124KB")
+    if size > memmap.FIRMWARE_MAX:
+        print(f"ERROR: Firmware too large! Max {memmap.FIRMWARE_MAX // 1024}KB")
         sys.exit(1)
     
     # Open serial port
-    print(f"Opening {port} at 115200 baud...")
+    print(f"Opening {port} at {memmap.UART_BAUD} baud...")
     try:
-        ser = serial.Serial(port, 115200, timeout=1)
+        ser = serial.Serial(port, memmap.UART_BAUD, timeout=1)
     except Exception as e:
         print(f"ERROR: Could not open {port}: {e}")
         sys.exit(1)
@@ -42,6 +87,10 @@ def main():
     # Clear any pending data
     ser.reset_input_buffer()
     time.sleep(0.1)
+
+    if args.baud != memmap.UART_BAUD and not negotiate_baud(ser, args.baud):
+        ser.close()
+        sys.exit(1)
     
     # Send sync byte
     print("Sending sync byte 'U' (0x55)...")
@@ -50,7 +99,7 @@ def main():
     # Wait for ACK
     print("Waiting for ACK...")
     ack = ser.read(1)
-    if ack != b'\x06':
+    if ack != ACK:
         print(f"ERROR: Expected ACK (0x06), got: {ack.hex() if ack else 'nothing'}")
         print("Make sure the FPGA is running the bootloader!")
         ser.close()
@@ -63,7 +112,11 @@ def main():
     
     # Wait for ACK
     ack = ser.read(1)
-    if ack != b'\x06':
+    if ack == NAK:
+        print(f"ERROR: The bootloader rejected the length ({size} bytes)")
+        ser.close()
+        sys.exit(1)
+    if ack != ACK:
         print(f"ERROR: Length ACK failed, got: {ack.hex() if ack else 'nothing'}")
         ser.close()
         sys.exit(1)
@@ -84,22 +137,34 @@ def main():
         filled = int(bar_len * (i + len(chunk)) / size)
         bar = '=' * filled + '-' * (bar_len - filled)
         print(f"\r[{bar}] {progress:5.1f}%", end='', flush=True)
-        
-        # Small delay to avoid buffer overflow
-        time.sleep(0.001)
-    
+
+    # No pacing needed: the bootloader's RX FIFO absorbs USB bursts
     print()
+
+    crc = zlib.crc32(firmware)
+    print(f"Sending CRC-32 0x{crc:08X}...")
+    ser.write(struct.pack('<I', crc))
     
     # Wait for final ACK
     print("Waiting for completion ACK...")
+    # The bootloader's "Receiving firmware...." progress text comes first
     ack = ser.read(1)
-    if ack != b'\x06':
+    while ack and ack not in (ACK, NAK):
+        ack = ser.read(1)
+    if ack == NAK:
+        print("ERROR: CRC mismatch, the bootloader discarded the image - run the upload again")
+        ser.close()
+        sys.exit(1)
+    if ack != ACK:
         print(f"WARNING: Final ACK not received, got: {ack.hex() if ack else 'nothing'}")
     else:
-        print("Upload complete!")
+        print("Upload complete, CRC verified!")
     
     elapsed = time.time() - start_time
     print(f"Transfer time: {elapsed:.2f}s ({size/elapsed/1024:.1f} KB/s)")
+
+    # The bootloader is back at the reset rate before it prints anything
+    ser.baudrate = memmap.UART_BAUD
     
     # Read any output from the firmware
     print("\n--- Firmware Output ---")
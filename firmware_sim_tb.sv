@@ -15,8 +15,12 @@ module firmware_sim_tb;
     reg [7:0] uart_rx_byte;
     reg uart_rx_valid;
     
-    // Instantiate the full CPU top
-    cpu_top uut (
+    // Instantiate the full CPU top (external memory preloaded with .ext_text)
+    cpu_top #(
+        .DDR_INIT_FILE("ext_mem.vh"),
+        .FLASH_INIT_FILE("flash_mem.vh"),
+        .SIM_CTRL(1)
+    ) uut (
         .clk100(clk),
         .rst_n(rst_n),
         .btn0(1'b0),
@@ -26,9 +30,15 @@ module firmware_sim_tb;
         .uart_rx(1'b1)  // Idle high
     );
     
+    // Warm start from a checkpoint directory (vvp sim_firmware +warm, run
+    // from that directory): see sim/warm_start.vh
+    reg warm_start = 1'b0;
+    initial warm_start = $test$plusargs("warm");
+    `include "warm_start.vh"
+
     // Track PC for debugging
     wire [31:0] pc = uut.pc;
-    wire [31:0] instr = uut.instr;
+    wire [31:0] instr = uut.i_rdata;
     
     // UART bit capture (115200 baud @ 100MHz = 868 cycles/bit)
     localparam BAUD_CYCLES = 868;
@@ -121,9 +131,13 @@ module firmware_sim_tb;
         // Reset
         rst_n = 0;
         repeat(10) @(posedge clk);
+        if (warm_start) begin
+            @(negedge clk);         // after warm_start.vh's last write
+            #1;
+        end
         rst_n = 1;
         
-        // Run for a while (10 million cycles = 100ms at 100MHz)
+        // Run for a while (10 million cycles = 400ms at 25MHz)
         repeat(10_000_000) @(posedge clk);
         
         $display("\n========================================");
@@ -20,9 +20,18 @@ cd ..
 echo.
 echo [2] Compiling simulation...
 iverilog -g2012 -o sim_firmware ^
+    -I FPGA_CPU1.srcs/sources_1/new ^
     firmware_sim_tb.sv ^
     FPGA_CPU1.srcs/sources_1/new/cpu_top.v ^
     FPGA_CPU1.srcs/sources_1/new/cpu_core.v ^
+    FPGA_CPU1.srcs/sources_1/new/dp_bram.v ^
+    FPGA_CPU1.srcs/sources_1/new/bus_xbar.v ^
+    FPGA_CPU1.srcs/sources_1/new/store_buffer.v ^
+    FPGA_CPU1.srcs/sources_1/new/bus_arbiter.v ^
+    FPGA_CPU1.srcs/sources_1/new/icache.v ^
+    FPGA_CPU1.srcs/sources_1/new/dcache.v ^
+    FPGA_CPU1.srcs/sources_1/new/burst_arbiter.v ^
+    FPGA_CPU1.srcs/sources_1/new/ddr_model.v ^
     FPGA_CPU1.srcs/sources_1/new/id_ex.v ^
     FPGA_CPU1.srcs/sources_1/new/if_id.v ^
     FPGA_CPU1.srcs/sources_1/new/decoder.v ^
@@ -31,6 +40,16 @@ iverilog -g2012 -o sim_firmware ^
     FPGA_CPU1.srcs/sources_1/new/pc_reg.v ^
     FPGA_CPU1.srcs/sources_1/new/pc_stepper.v ^
     FPGA_CPU1.srcs/sources_1/new/uart_tx.v ^
+    FPGA_CPU1.srcs/sources_1/new/uart_rx_fifo.v ^
+    FPGA_CPU1.srcs/sources_1/new/irq_ctrl.v ^
+    FPGA_CPU1.srcs/sources_1/new/dma.v ^
+    FPGA_CPU1.srcs/sources_1/new/timer.v ^
+    FPGA_CPU1.srcs/sources_1/new/qspi_xip.v ^
+    FPGA_CPU1.srcs/sources_1/new/qspi_flash_model.v ^
+    FPGA_CPU1.srcs/sources_1/new/crc.v ^
+    FPGA_CPU1.srcs/sources_1/new/mbox.v ^
+    FPGA_CPU1.srcs/sources_1/new/sema.v ^
+    FPGA_CPU1.srcs/sources_1/new/gpio.v ^
     FPGA_CPU1.srcs/sources_1/new/uart_rx.v
 
 if errorlevel 1 (
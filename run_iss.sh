@@ -0,0 +1,55 @@
+#!/bin/bash
+# Full-firmware run on the instruction-set simulator (sim/iss): same images
+# and console output as run_firmware_sim.sh, at tens of MIPS, for firmware
+# bring-up and long software runs without the RTL.
+#
+#   ./run_iss.sh [--no-build] [ISS options]
+#
+# --no-build   skip the firmware build
+# Everything else goes to the ISS, e.g. --timing --cycles 500000000
+# (see sim/iss/iss_main.cpp). Its exit status is passed through.
+set -e
+cd "$(dirname "$0")"
+
+BUILD_FW=1
+ARGS=()
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --no-build) BUILD_FW=0; shift ;;
+        *)          ARGS+=("$1"); shift ;;
+    esac
+done
+
+echo "================================================"
+echo "  Firmware Simulation (ISS)"
+echo "================================================"
+echo
+
+if [ "$BUILD_FW" = 1 ]; then
+    echo "[1] Ensuring firmware is up to date..."
+    (cd firmware && ./build.sh)
+    echo
+fi
+
+echo "[2] Building ISS (obj_iss/iss)..."
+mkdir -p obj_iss
+g++ -O2 -std=c++14 -Wall -I firmware -o obj_iss/iss \
+    sim/iss/rv32_iss.cpp \
+    sim/iss/soc.cpp \
+    sim/iss/checkpoint.cpp \
+    sim/iss/elf.cpp \
+    sim/iss/iss_main.cpp
+
+echo
+echo "[3] Running simulation..."
+echo "================================================"
+set +e
+obj_iss/iss "${ARGS[@]}"
+STATUS=$?
+set -e
+
+echo
+echo "================================================"
+echo "  Simulation complete! (exit $STATUS)"
+echo "================================================"
+exit $STATUS
@@ -0,0 +1,114 @@
+#!/bin/bash
+# Full-firmware simulation under Verilator (sim/verilator/sim_main.cpp):
+# the same run as run_firmware_sim.sh, tens of times faster.
+#
+#   ./run_verilator_sim.sh [--threads N] [--trace] [--no-build] [harness options]
+#
+# --threads N  multithreaded model (verilator --threads N)
+# --trace      build with VCD support; then pass --trace FILE to the harness
+# --no-build   skip the firmware build
+# --build-only build the model ($OBJ/Vsim_top below) and stop
+# Everything else goes to the harness, e.g. --cycles 500000000 --stuck 0,
+# or --cosim to check every retired instruction against the ISS (see
+# sim/verilator/sim_main.cpp). Its exit status is passed through.
+set -e
+cd "$(dirname "$0")"
+
+THREADS=1
+TRACE=0
+BUILD_FW=1
+BUILD_ONLY=0
+ARGS=()
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --threads)  THREADS="$2"; shift 2 ;;
+        --trace)
+            if [ -n "$2" ] && [ "${2#-}" = "$2" ]; then
+                TRACE=1; ARGS+=(--trace "$2"); shift 2
+            else
+                TRACE=1; shift
+            fi ;;
+        --no-build) BUILD_FW=0; shift ;;
+        --build-only) BUILD_ONLY=1; BUILD_FW=0; shift ;;
+        *)          ARGS+=("$1"); shift ;;
+    esac
+done
+
+OBJ=obj_verilator/t${THREADS}_tr${TRACE}
+VFLAGS=(-O3 --x-assign 0 --x-initial 0 -Wno-fatal -Wno-lint -Wno-style)
+[ "$THREADS" -gt 1 ] && VFLAGS+=(--threads "$THREADS")
+[ "$TRACE" = 1 ] && VFLAGS+=(--trace)
+
+echo "================================================"
+echo "  Firmware Simulation (Verilator, threads=$THREADS)"
+echo "================================================"
+echo
+
+if [ "$BUILD_FW" = 1 ]; then
+    echo "[1] Ensuring firmware is up to date..."
+    (cd firmware && ./build.sh)
+    echo
+fi
+
+echo "[2] Building Verilator model ($OBJ)..."
+verilator --cc --exe --build -j "$(nproc)" "${VFLAGS[@]}" \
+    --top-module sim_top --Mdir "$OBJ" -o Vsim_top \
+    -I FPGA_CPU1.srcs/sources_1/new \
+    -I sim \
+    -CFLAGS "-O2 -std=c++14 -I$PWD/sim/iss -I$PWD/firmware" \
+    sim/verilator/sim_main.cpp \
+    sim/iss/cosim.cpp \
+    sim/iss/rv32_iss.cpp \
+    sim/iss/soc.cpp \
+    sim/iss/checkpoint.cpp \
+    sim/iss/elf.cpp \
+    sim/verilator/sim_top.sv \
+    FPGA_CPU1.srcs/sources_1/new/cpu_top.v \
+    FPGA_CPU1.srcs/sources_1/new/cpu_core.v \
+    FPGA_CPU1.srcs/sources_1/new/dp_bram.v \
+    FPGA_CPU1.srcs/sources_1/new/bus_xbar.v \
+    FPGA_CPU1.srcs/sources_1/new/store_buffer.v \
+    FPGA_CPU1.srcs/sources_1/new/bus_arbiter.v \
+    FPGA_CPU1.srcs/sources_1/new/icache.v \
+    FPGA_CPU1.srcs/sources_1/new/dcache.v \
+    FPGA_CPU1.srcs/sources_1/new/burst_arbiter.v \
+    FPGA_CPU1.srcs/sources_1/new/ddr_model.v \
+    FPGA_CPU1.srcs/sources_1/new/id_ex.v \
+    FPGA_CPU1.srcs/sources_1/new/if_id.v \
+    FPGA_CPU1.srcs/sources_1/new/decoder.v \
+    FPGA_CPU1.srcs/sources_1/new/alu.v \
+    FPGA_CPU1.srcs/sources_1/new/regfile.v \
+    FPGA_CPU1.srcs/sources_1/new/pc_reg.v \
+    FPGA_CPU1.srcs/sources_1/new/pc_stepper.v \
+    FPGA_CPU1.srcs/sources_1/new/uart_tx.v \
+    FPGA_CPU1.srcs/sources_1/new/uart_rx_fifo.v \
+    FPGA_CPU1.srcs/sources_1/new/irq_ctrl.v \
+    FPGA_CPU1.srcs/sources_1/new/dma.v \
+    FPGA_CPU1.srcs/sources_1/new/timer.v \
+    FPGA_CPU1.srcs/sources_1/new/qspi_xip.v \
+    FPGA_CPU1.srcs/sources_1/new/qspi_flash_model.v \
+    FPGA_CPU1.srcs/sources_1/new/crc.v \
+    FPGA_CPU1.srcs/sources_1/new/mbox.v \
+    FPGA_CPU1.srcs/sources_1/new/sema.v \
+    FPGA_CPU1.srcs/sources_1/new/gpio.v \
+    FPGA_CPU1.srcs/sources_1/new/sim_ctrl.v \
+    FPGA_CPU1.srcs/sources_1/new/uart_rx.v
+
+if [ "$BUILD_ONLY" = 1 ]; then
+    echo "Model: $OBJ/Vsim_top"
+    exit 0
+fi
+
+echo
+echo "[3] Running simulation..."
+echo "================================================"
+set +e
+"$OBJ/Vsim_top" "${ARGS[@]}"
+STATUS=$?
+set -e
+
+echo
+echo "================================================"
+echo "  Simulation complete! (exit $STATUS)"
+echo "================================================"
+exit $STATUS
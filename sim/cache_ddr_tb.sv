@@ -0,0 +1,255 @@
+`timescale 1ns / 1ps
+
+// I-cache + D-cache + burst arbiter + DDR model, driven directly.
+// Checks every read against a reference copy, checks that fence (clean) and
+// fence.i (clean + invalidate) make stores visible to memory and to fetch,
+// and reports hit rate and miss penalty per access pattern.
+module cache_ddr_tb;
+    parameter integer WAYS       = 2;
+    parameter integer SETS       = 64;
+    parameter integer LINE_WORDS = 8;
+    parameter integer LATENCY    = 20;
+
+    localparam integer    MEM_WORDS = 4096;           // 16 KB window, 4x the cache
+    localparam [31:0]     EXT       = 32'h8000_0000;
+
+    reg clk = 0;
+    always #5 clk = ~clk;
+    reg rst_n;
+
+    // D side
+    reg         d_req;
+    reg  [31:0] d_addr, d_wdata;
+    reg         d_we;
+    reg  [3:0]  d_be;
+    wire [31:0] d_rdata;
+    wire        d_ack;
+
+    // I side
+    reg         i_req;
+    reg  [31:0] i_addr;
+    wire [31:0] i_rdata;
+    wire        i_ack;
+
+    reg  fence_req, fence_i;
+    wire dc_flush_done, ic_inv_done;
+
+    wire        ic_req, ic_we, ic_wready, ic_rvalid, ic_done;
+    wire [31:0] ic_addr, ic_wdata, ic_rdata;
+    wire        dc_req, dc_we, dc_wready, dc_rvalid, dc_done;
+    wire [31:0] dc_addr, dc_wdata, dc_rdata;
+    wire        m_req, m_we, m_wready, m_rvalid, m_done;
+    wire [31:0] m_addr, m_wdata, m_rdata;
+
+    icache #(.WAYS(WAYS), .SETS(SETS), .LINE_WORDS(LINE_WORDS)) u_ic (
+        .clk(clk), .rst_n(rst_n),
+        .i_req(i_req), .i_addr(i_addr), .i_rdata(i_rdata), .i_ack(i_ack),
+        .inv_req(fence_req && fence_i && dc_flush_done), .inv_done(ic_inv_done),
+        .mem_req(ic_req), .mem_we(ic_we), .mem_addr(ic_addr), .mem_wdata(ic_wdata),
+        .mem_wready(ic_wready), .mem_rvalid(ic_rvalid), .mem_rdata(ic_rdata), .mem_done(ic_done)
+    );
+
+    dcache #(.WAYS(WAYS), .SETS(SETS), .LINE_WORDS(LINE_WORDS)) u_dc (
+        .clk(clk), .rst_n(rst_n),
+        .s_req(d_req), .s_addr(d_addr), .s_we(d_we), .s_be(d_be), .s_wdata(d_wdata),
+        .s_rdata(d_rdata), .s_ack(d_ack),
+        .flush_req(fence_req), .flush_done(dc_flush_done),
+        .mem_req(dc_req), .mem_we(dc_we), .mem_addr(dc_addr), .mem_wdata(dc_wdata),
+        .mem_wready(dc_wready), .mem_rvalid(dc_rvalid), .mem_rdata(dc_rdata), .mem_done(dc_done)
+    );
+
+    burst_arbiter u_arb (
+        .clk(clk), .rst_n(rst_n),
+        .m0_req(dc_req), .m0_we(dc_we), .m0_addr(dc_addr), .m0_wdata(dc_wdata),
+        .m0_wready(dc_wready), .m0_rvalid(dc_rvalid), .m0_rdata(dc_rdata), .m0_done(dc_done),
+        .m1_req(ic_req), .m1_we(ic_we), .m1_addr(ic_addr), .m1_wdata(ic_wdata),
+        .m1_wready(ic_wready), .m1_rvalid(ic_rvalid), .m1_rdata(ic_rdata), .m1_done(ic_done),
+        .s_req(m_req), .s_we(m_we), .s_addr(m_addr), .s_wdata(m_wdata),
+        .s_wready(m_wready), .s_rvalid(m_rvalid), .s_rdata(m_rdata), .s_done(m_done)
+    );
+
+    ddr_model #(.WORDS(MEM_WORDS), .LATENCY(LATENCY), .LINE_WORDS(LINE_WORDS)) u_ddr (
+        .clk(clk), .rst_n(rst_n),
+        .mem_req(m_req), .mem_we(m_we), .mem_addr(m_addr), .mem_wdata(m_wdata),
+        .mem_wready(m_wready), .mem_rvalid(m_rvalid), .mem_rdata(m_rdata), .mem_done(m_done)
+    );
+
+    // Reference copy of what the CPU should see
+    reg [31:0] ref_mem [0:MEM_WORDS-1];
+    integer errors;
+
+    // ------------------------------------------------------------
+    // Bus tasks (drive on negedge, sample on negedge)
+    // ------------------------------------------------------------
+    task d_access(input we, input [31:0] addr, input [3:0] be, input [31:0] wdata,
+                  output [31:0] rdata);
+        begin
+            d_req = 1; d_we = we; d_addr = addr; d_be = be; d_wdata = wdata;
+            @(negedge clk);
+            d_req = 0;
+            while (!d_ack) @(negedge clk);
+            rdata = d_rdata;
+        end
+    endtask
+
+    task d_write(input [31:0] addr, input [3:0] be, input [31:0] wdata);
+        reg [31:0] dummy;
+        integer k;
+        begin
+            d_access(1'b1, addr, be, wdata, dummy);
+            for (k = 0; k < 4; k = k + 1)
+                if (be[k])
+                    ref_mem[addr[13:2]][8*k +: 8] = wdata[8*k +: 8];
+        end
+    endtask
+
+    task d_read_check(input [31:0] addr);
+        reg [31:0] got;
+        begin
+            d_access(1'b0, addr, 4'b1111, 32'b0, got);
+            if (got !== ref_mem[addr[13:2]]) begin
+                if (errors < 10)
+                    $display("  D read %h: got %h expected %h", addr, got, ref_mem[addr[13:2]]);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    task i_fetch_check(input [31:0] addr);
+        begin
+            i_req = 1; i_addr = addr;
+            @(negedge clk);
+            i_req = 0;
+            while (!i_ack) @(negedge clk);
+            if (i_rdata !== ref_mem[addr[13:2]]) begin
+                if (errors < 10)
+                    $display("  I fetch %h: got %h expected %h", addr, i_rdata, ref_mem[addr[13:2]]);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    task fence(input is_fence_i);
+        begin
+            fence_req = 1; fence_i = is_fence_i;
+            while (!(dc_flush_done && (!is_fence_i || ic_inv_done))) @(negedge clk);
+            fence_req = 0; fence_i = 0;
+            @(negedge clk);
+        end
+    endtask
+
+    // ------------------------------------------------------------
+    // Statistics per phase
+    // ------------------------------------------------------------
+    reg [31:0] d_h0, d_m0, d_c0, d_w0, i_h0, i_m0, i_c0;
+
+    task stats_begin;
+        begin
+            d_h0 = u_dc.stat_hits; d_m0 = u_dc.stat_misses;
+            d_c0 = u_dc.stat_miss_cycles; d_w0 = u_dc.stat_writebacks;
+            i_h0 = u_ic.stat_hits; i_m0 = u_ic.stat_misses; i_c0 = u_ic.stat_miss_cycles;
+        end
+    endtask
+
+    task stats_report(input [8*24-1:0] name);
+        integer dh, dm, dc, dw, ih, im, ic;
+        begin
+            dh = u_dc.stat_hits - d_h0;  dm = u_dc.stat_misses - d_m0;
+            dc = u_dc.stat_miss_cycles - d_c0; dw = u_dc.stat_writebacks - d_w0;
+            ih = u_ic.stat_hits - i_h0;  im = u_ic.stat_misses - i_m0;
+            ic = u_ic.stat_miss_cycles - i_c0;
+            if (dh + dm > 0)
+                $display("  %0s D: %0d acc, hit %0d%%, %0d misses, %0d writebacks, miss penalty %0d cyc",
+                         name, dh + dm, (dh * 100) / (dh + dm), dm, dw, (dm > 0) ? dc / dm : 0);
+            if (ih + im > 0)
+                $display("  %0s I: %0d acc, hit %0d%%, %0d misses, miss penalty %0d cyc",
+                         name, ih + im, (ih * 100) / (ih + im), im, (im > 0) ? ic / im : 0);
+        end
+    endtask
+
+    // ------------------------------------------------------------
+    // Test sequence
+    // ------------------------------------------------------------
+    integer i, n, seed;
+    reg [31:0] a;
+
+    initial begin
+        errors = 0;
+        seed = 1;
+        d_req = 0; d_we = 0; d_addr = 0; d_be = 0; d_wdata = 0;
+        i_req = 0; i_addr = 0;
+        fence_req = 0; fence_i = 0;
+        for (i = 0; i < MEM_WORDS; i = i + 1) begin
+            ref_mem[i]   = 32'hC0DE_0000 ^ (i * 32'h0001_0003);
+            u_ddr.mem[i] = ref_mem[i];
+        end
+
+        rst_n = 0;
+        repeat (4) @(negedge clk);
+        rst_n = 1;
+        @(negedge clk);
+
+        $display("cache_ddr_tb: %0d-way, %0d sets, %0d-word lines, DDR latency %0d",
+                 WAYS, SETS, LINE_WORDS, LATENCY);
+
+        // 1. Sequential reads over 2 KB, twice: cold misses, then all hits
+        stats_begin;
+        for (n = 0; n < 2; n = n + 1)
+            for (i = 0; i < 512; i = i + 1)
+                d_read_check(EXT + i * 4);
+        stats_report("seq-read");
+
+        // 2. Random byte/half/word stores and loads over 16 KB: conflict
+        //    misses and dirty-victim writebacks
+        stats_begin;
+        for (i = 0; i < 4000; i = i + 1) begin
+            a = EXT + (($random(seed) & (MEM_WORDS - 1)) << 2);
+            case ($random(seed) & 3)
+                0: d_write(a, 4'b0001 << ($random(seed) & 3), $random(seed));
+                1: d_write(a, ($random(seed) & 1) ? 4'b1100 : 4'b0011, $random(seed));
+                2: d_write(a, 4'b1111, $random(seed));
+                default: d_read_check(a);
+            endcase
+        end
+        stats_report("random-rw");
+
+        // 3. fence: every dirty line reaches memory
+        fence(1'b0);
+        for (i = 0; i < MEM_WORDS; i = i + 1)
+            if (u_ddr.mem[i] !== ref_mem[i]) begin
+                if (errors < 10)
+                    $display("  after fence mem[%0d] = %h expected %h", i, u_ddr.mem[i], ref_mem[i]);
+                errors = errors + 1;
+            end
+
+        // 4. Code loop (1 KB) fetched twice while the D side streams through
+        //    another region: both caches share the burst port
+        stats_begin;
+        fork
+            for (n = 0; n < 2; n = n + 1)
+                for (i = 0; i < 256; i = i + 1)
+                    i_fetch_check(EXT + 32'h2000 + i * 4);
+            begin : d_stream
+                integer j;
+                for (j = 0; j < 512; j = j + 1)
+                    d_read_check(EXT + 32'h3000 + j * 4);
+            end
+        join
+        stats_report("loop+stream");
+
+        // 5. Self-modifying code: the store is only fetched after fence.i
+        i_fetch_check(EXT + 32'h2010);
+        d_write(EXT + 32'h2010, 4'b1111, 32'h0010_0073);
+        fence(1'b1);
+        i_fetch_check(EXT + 32'h2010);
+
+        $display("cache_ddr_tb: %s (%0d errors)", (errors == 0) ? "PASS" : "FAIL", errors);
+        $finish;
+    end
+
+    initial begin
+        #50_000_000;
+        $display("cache_ddr_tb: FAIL (timeout)");
+        $finish;
+    end
+endmodule
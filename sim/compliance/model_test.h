@@ -0,0 +1,50 @@
+// riscv-arch-test target model for this SoC (sim/compliance/link.ld).
+//
+// The test halts by writing 1 to tohost and jumping to itself; the
+// simulators stop on the PC hold and dump [begin_signature, end_signature)
+// from the ITCM. No interrupts are wired to the tests and there is no
+// console, so the IO and interrupt hooks are empty.
+#ifndef _COMPLIANCE_MODEL_H
+#define _COMPLIANCE_MODEL_H
+
+#define RVMODEL_DATA_SECTION                                            \
+        .pushsection .tohost,"aw",@progbits;                            \
+        .align 8; .global tohost; tohost: .dword 0;                     \
+        .align 8; .global fromhost; fromhost: .dword 0;                 \
+        .popsection;                                                    \
+        .align 8; .global begin_regstate; begin_regstate:               \
+        .word 128;                                                      \
+        .align 8; .global end_regstate; end_regstate:                   \
+        .word 4;
+
+#define RVMODEL_HALT                                                    \
+        li x1, 1;                                                       \
+        la t5, tohost;                                                  \
+        sw x1, 0(t5);                                                   \
+rvmodel_halt_loop:                                                      \
+        j rvmodel_halt_loop;
+
+#define RVMODEL_BOOT
+
+#define RVMODEL_DATA_BEGIN                                              \
+        RVMODEL_DATA_SECTION                                            \
+        .align 4;                                                       \
+        .global begin_signature; begin_signature:
+
+#define RVMODEL_DATA_END                                                \
+        .align 4;                                                       \
+        .global end_signature; end_signature:
+
+#define RVMODEL_IO_INIT
+#define RVMODEL_IO_WRITE_STR(_R, _STR)
+#define RVMODEL_IO_CHECK()
+#define RVMODEL_IO_ASSERT_GPR_EQ(_S, _R, _I)
+#define RVMODEL_IO_ASSERT_SFPR_EQ(_F, _R, _I)
+#define RVMODEL_IO_ASSERT_DFPR_EQ(_D, _R, _I)
+
+#define RVMODEL_SET_MSW_INT
+#define RVMODEL_CLEAR_MSW_INT
+#define RVMODEL_CLEAR_MTIMER_INT
+#define RVMODEL_CLEAR_MEXT_INT
+
+#endif  // _COMPLIANCE_MODEL_H
@@ -0,0 +1,71 @@
+// riscv-tests environment for this SoC (replaces env/p/riscv_test.h for the
+// user-level suites: rv32ui, rv32um, ...). Physical addressing, machine mode
+// only, linked with sim/compliance/link.ld.
+//
+// The result goes to tohost as in the upstream environment (1 = pass,
+// (TESTNUM << 1) | 1 = that test case failed), written directly instead of
+// through ecall, and the test then jumps to itself so the simulators stop on
+// the PC hold. Any trap is unexpected and fails the running test case.
+#ifndef _ENV_COMPLIANCE_H
+#define _ENV_COMPLIANCE_H
+
+#define RVTEST_RV64U                                                    \
+        .macro init;                                                    \
+        .endm
+
+#define RVTEST_RV32U RVTEST_RV64U
+
+#define TESTNUM gp
+
+#define RVTEST_REPORT                                                   \
+        la t5, tohost;                                                  \
+        sw TESTNUM, 0(t5);                                              \
+1:      j 1b;
+
+#define RVTEST_FAIL_REPORT                                              \
+        fence;                                                          \
+1:      beqz TESTNUM, 1b;                                               \
+        sll TESTNUM, TESTNUM, 1;                                        \
+        or TESTNUM, TESTNUM, 1;                                         \
+        RVTEST_REPORT
+
+#define RVTEST_CODE_BEGIN                                               \
+        .section .text.init;                                            \
+        .align  6;                                                      \
+        .globl _start;                                                  \
+_start:                                                                 \
+        la t0, trap_vector;                                             \
+        csrw mtvec, t0;                                                 \
+        li TESTNUM, 0;                                                  \
+        j reset_done;                                                   \
+        .align 2;                                                       \
+trap_vector:                                                            \
+        RVTEST_FAIL_REPORT                                              \
+reset_done:                                                             \
+        init;
+
+#define RVTEST_CODE_END                                                 \
+        unimp
+
+#define RVTEST_PASS                                                     \
+        fence;                                                          \
+        li TESTNUM, 1;                                                  \
+        RVTEST_REPORT
+
+#define RVTEST_FAIL                                                     \
+        RVTEST_FAIL_REPORT
+
+#define EXTRA_DATA
+
+#define RVTEST_DATA_BEGIN                                               \
+        EXTRA_DATA                                                      \
+        .pushsection .tohost,"aw",@progbits;                            \
+        .align 6; .global tohost; tohost: .dword 0; .size tohost, 8;    \
+        .align 6; .global fromhost; fromhost: .dword 0; .size fromhost, 8; \
+        .popsection;                                                    \
+        .align 4; .global begin_signature; begin_signature:
+
+#define RVTEST_DATA_END                                                 \
+        .align 4; .global end_signature; end_signature:
+
+#endif  // _ENV_COMPLIANCE_H
@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+"""
+ISA compliance runner: builds the official test suites against this SoC
+(sim/compliance: ITCM-only link script, signature region), runs every test
+in simulation and reports pass/fail per test.
+
+  riscv-arch-test  rv32i_m/<EXT>/src/*.S; the signature
+                   [begin_signature, end_signature) is dumped from the ITCM
+                   after the run and compared with references/*.reference_output
+                   (or, where the suite ships none, with the ISS's signature -
+                   the ISS shares the core's deviations, see sim/iss/rv32_iss.h)
+  riscv-tests      isa/<SUITE>/*.S; the test writes its result to tohost
+
+Usage: python3 sim/compliance/run_compliance.py [options]
+  --arch-test DIR     riscv-arch-test checkout
+  --riscv-tests DIR   riscv-tests checkout (isa/ and env/)
+  --ext LIST          arch-test extensions, comma separated (default I)
+  --suites LIST       riscv-tests suites, comma separated (default rv32ui)
+  --sim verilator|iss simulator (default verilator: the RTL)
+  --only GLOB         run only tests whose id (e.g. I/add-01) matches
+  -j N                parallel jobs (default: all host cores)
+  --cycles N          per-test cycle limit (default 2000000)
+  --out DIR           build and log directory (default obj_compliance)
+  --no-build-sim      use the simulator built last time
+
+The toolchain prefix comes from RISCV_PREFIX (default riscv64-unknown-elf-,
+as firmware/build.sh). Exit status: 0 = no test failed, 1 = failures.
+"""
+import argparse
+import concurrent.futures
+import fnmatch
+import os
+import re
+import subprocess
+import sys
+from pathlib import Path
+
+HERE = Path(__file__).resolve().parent
+ROOT = HERE.parent.parent
+PREFIX = os.environ.get("RISCV_PREFIX", "riscv64-unknown-elf-")
+
+ISS_BIN = ROOT / "obj_iss" / "iss"
+VERILATOR_BIN = ROOT / "obj_verilator" / "t1_tr0" / "Vsim_top"
+
+STUCK_CYCLES = 100      # the halt loop jumps to itself
+
+
+class Test:
+    def __init__(self, tid, src, kind, march, includes, ref=None):
+        self.tid = tid              # e.g. I/add-01 or rv32ui/add
+        self.src = src
+        self.kind = kind            # "signature" or "tohost"
+        self.march = march
+        self.includes = includes
+        self.ref = ref              # reference_output path, if any
+
+
+def march_for(exts):
+    base = "rv32i"
+    for e in "MAFDC":
+        if e in exts:
+            base += e.lower()
+    extra = [e.lower() for e in exts if e.startswith("Z") or e == "B"]
+    for z in ("zicsr", "zifencei"):
+        if z not in extra:
+            extra.append(z)
+    extra = ["zba_zbb_zbc_zbs" if e == "b" else e for e in extra]
+    return base + "_" + "_".join(extra)
+
+
+def collect(args):
+    tests = []
+    if args.arch_test:
+        suite = Path(args.arch_test) / "riscv-test-suite"
+        env = suite / "env"
+        for ext in args.ext.split(","):
+            d = suite / "rv32i_m" / ext
+            if not (d / "src").is_dir():
+                sys.exit(f"ERROR: {d}/src not found")
+            for src in sorted((d / "src").glob("*.S")):
+                ref = d / "references" / (src.stem + ".reference_output")
+                tests.append(Test(f"{ext}/{src.stem}", src, "signature",
+                                  march_for([ext]), [HERE, env],
+                                  ref if ref.exists() else None))
+    if args.riscv_tests:
+        rt = Path(args.riscv_tests)
+        for suite in args.suites.split(","):
+            d = rt / "isa" / suite
+            if not d.is_dir():
+                sys.exit(f"ERROR: {d} not found")
+            exts = [c.upper() for c in suite[len("rv32u"):]] if suite.startswith("rv32u") else []
+            for src in sorted(d.glob("*.S")):
+                tests.append(Test(f"{suite}/{src.stem}", src, "tohost",
+                                  march_for(exts),
+                                  [HERE, rt / "env", rt / "isa" / "macros" / "scalar"]))
+    if args.only:
+        tests = [t for t in tests if fnmatch.fnmatch(t.tid, args.only)]
+    return tests
+
+
+def run(cmd, cwd=None, log=None):
+    p = subprocess.run([str(c) for c in cmd], cwd=cwd, stdout=subprocess.PIPE,
+                       stderr=subprocess.STDOUT, text=True)
+    if log is not None:
+        log.write("$ " + " ".join(str(c) for c in cmd) + "\n" + p.stdout)
+    return p
+
+
+def build_sims(args):
+    (ROOT / "obj_iss").mkdir(exist_ok=True)
+    print("Building ISS (obj_iss/iss)...")
+    # Same command as run_iss.sh
+    p = run(["g++", "-O2", "-std=c++14", "-Wall", "-I", ROOT / "firmware",
+             "-o", ISS_BIN, ROOT / "sim/iss/rv32_iss.cpp",
+             ROOT / "sim/iss/soc.cpp", ROOT / "sim/iss/checkpoint.cpp",
+             ROOT / "sim/iss/elf.cpp", ROOT / "sim/iss/iss_main.cpp"])
+    if p.returncode:
+        sys.exit(p.stdout + "ERROR: ISS build failed")
+    if args.sim == "verilator":
+        print("Building Verilator model...")
+        p = run([ROOT / "run_verilator_sim.sh", "--build-only"], cwd=ROOT)
+        if p.returncode:
+            sys.exit(p.stdout + "ERROR: Verilator build failed")
+
+
+def symbols(elf, log):
+    p = run([PREFIX + "nm", elf], log=log)
+    syms = {}
+    for line in p.stdout.splitlines():
+        f = line.split()
+        if len(f) == 3:
+            syms[f[2]] = int(f[0], 16)
+    return syms
+
+
+def simulate(sim, out, begin, end, sig, cycles, log):
+    if sim == "iss":
+        cmd = [ISS_BIN]
+    else:
+        cmd = [VERILATOR_BIN]
+    cmd += ["--dir", out, "--cycles", cycles, "--stuck", STUCK_CYCLES,
+            "--signature", sig, "--sig-begin", hex(begin), "--sig-end", hex(end)]
+    p = run(cmd, log=log)
+    m = re.search(r"\[(?:ISS\] \d+ instructions,|SIM\]) (\d+) cycles", p.stdout)
+    return "PC stuck" in p.stdout, int(m.group(1)) if m else 0
+
+
+def read_words(path):
+    return [w.strip().lower() for w in Path(path).read_text().split()]
+
+
+def run_test(t, args):
+    out = Path(args.out).resolve() / t.tid
+    out.mkdir(parents=True, exist_ok=True)
+    with open(out / "run.log", "w") as log:
+        elf, binf = out / "test.elf", out / "test.bin"
+        cc = [PREFIX + "gcc", "-march=" + t.march, "-mabi=ilp32", "-static",
+              "-mcmodel=medany", "-fvisibility=hidden", "-nostdlib",
+              "-nostartfiles", "-DXLEN=32", "-DTEST_CASE_1=True",
+              "-T", HERE / "link.ld"]
+        for inc in t.includes:
+            cc += ["-I", inc]
+        if run(cc + [t.src, "-o", elf], log=log).returncode:
+            return "ERROR", "compile failed", 0
+        if run([PREFIX + "objcopy", "-O", "binary", elf, binf], log=log).returncode:
+            return "ERROR", "objcopy failed", 0
+        if binf.stat().st_size > 0x20000:
+            return "ERROR", "image larger than the ITCM", 0
+        run([sys.executable, ROOT / "firmware" / "make_hex.py", binf,
+             out / "instr_mem.vh", "0"], log=log)
+        for img in ("ext_mem.vh", "flash_mem.vh"):
+            (out / img).write_text("00000000\n")
+
+        syms = symbols(elf, log)
+        if t.kind == "tohost":
+            if "tohost" not in syms:
+                return "ERROR", "no tohost symbol", 0
+            begin, end = syms["tohost"], syms["tohost"] + 4
+        else:
+            if "begin_signature" not in syms or "end_signature" not in syms:
+                return "ERROR", "no signature symbols", 0
+            begin, end = syms["begin_signature"], syms["end_signature"]
+
+        sig = out / "test.signature"
+        halted, cycles = simulate(args.sim, out, begin, end, sig, args.cycles, log)
+        if not halted:
+            return "FAIL", f"no halt within {args.cycles} cycles", cycles
+        got = read_words(sig)
+
+        if t.kind == "tohost":
+            v = int(got[0], 16) if got else 0
+            if v == 1:
+                return "PASS", "", cycles
+            if v == 0:
+                return "FAIL", "no result in tohost", cycles
+            return "FAIL", f"test case {v >> 1} failed", cycles
+
+        if t.ref:
+            ref, src = read_words(t.ref), "reference"
+        elif args.sim == "iss":
+            return "SKIP", "no reference signature", cycles
+        else:
+            ref_sig = out / "iss.signature"
+            simulate("iss", out, begin, end, ref_sig, args.cycles, log)
+            ref, src = read_words(ref_sig), "ISS"
+        if got == ref:
+            return "PASS", "" if t.ref else "vs ISS", cycles
+        bad = next((i for i, (a, b) in enumerate(zip(got, ref)) if a != b),
+                   min(len(got), len(ref)))
+        return "FAIL", (f"signature word {bad} differs from the {src} "
+                        f"({len(got)} vs {len(ref)} words)"), cycles
+
+
+def main():
+    ap = argparse.ArgumentParser(add_help=False)
+    ap.add_argument("--arch-test")
+    ap.add_argument("--riscv-tests")
+    ap.add_argument("--ext", default="I")
+    ap.add_argument("--suites", default="rv32ui")
+    ap.add_argument("--sim", choices=("verilator", "iss"), default="verilator")
+    ap.add_argument("--only")
+    ap.add_argument("-j", type=int, default=os.cpu_count() or 1)
+    ap.add_argument("--cycles", type=int, default=2000000)
+    ap.add_argument("--out", default=str(ROOT / "obj_compliance"))
+    ap.add_argument("--no-build-sim", action="store_true")
+    ap.add_argument("-h", "--help", action="store_true")
+    args = ap.parse_args()
+    if args.help or not (args.arch_test or args.riscv_tests):
+        print(__doc__.strip())
+        return 0 if args.help else 2
+
+    tests = collect(args)
+    if not tests:
+        print("No tests selected")
+        return 2
+    if not args.no_build_sim:
+        build_sims(args)
+
+    print(f"Running {len(tests)} tests on {args.sim} ({args.j} jobs)...")
+    results = {}
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.j) as pool:
+        futures = {pool.submit(run_test, t, args): t for t in tests}
+        for f in concurrent.futures.as_completed(futures):
+            t = futures[f]
+            status, detail, cycles = f.result()
+            results[t.tid] = (status, detail, cycles)
+            print(f"  {status:5s} {t.tid:40s} {cycles:>9d} cycles  {detail}", flush=True)
+
+    passed = sum(1 for s, _, _ in results.values() if s == "PASS")
+    failed = sum(1 for s, _, _ in results.values() if s in ("FAIL", "ERROR"))
+    lines = [f"{s:5s} {tid:40s} {c:>9d}  {d}"
+             for tid, (s, d, c) in sorted(results.items())]
+    (Path(args.out) / "results.txt").write_text("\n".join(lines) + "\n")
+    print("========================================")
+    print(f"{passed}/{len(results)} passed, {failed} failed (details: {args.out}/results.txt, "
+          f"per-test logs in {args.out}/<id>/run.log)")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -6,19 +6,40 @@ module cpu_core_tb;
 
     reg rst_n = 0;
     wire [31:0] pc;
+    wire        i_req;
+    wire [31:0] i_addr;
+    wire        d_req;
     wire [31:0] d_addr;
     wire [31:0] d_wdata;
-    reg  [31:0] d_rdata_reg;
+    reg  [31:0] d_rdata_reg = 32'h0;
     wire [31:0] d_rdata = d_rdata_reg;
+    reg         d_ack_reg = 1'b0;
+    wire        d_ack = d_ack_reg;
     wire        d_we;
+    wire [3:0]  d_be;
     wire        is_sw, is_sh, is_sb;
     wire [31:0] rs2_val_o;
     wire [31:0] wb_value;
 
+    wire        rvfi_valid;
+    wire [63:0] rvfi_order;
+    wire [31:0] rvfi_insn, rvfi_pc_rdata, rvfi_pc_wdata;
+    wire        rvfi_trap, rvfi_intr;
+    wire [4:0]  rvfi_rs1_addr, rvfi_rs2_addr, rvfi_rd_addr;
+    wire [31:0] rvfi_rs1_rdata, rvfi_rs2_rdata, rvfi_rd_wdata;
+    wire [31:0] rvfi_mem_addr, rvfi_mem_rdata, rvfi_mem_wdata;
+    wire [3:0]  rvfi_mem_rmask, rvfi_mem_wmask;
+
     reg [31:0] instr_mem [0:255];
     reg [31:0] data_mem [0:255];
     reg [31:0] prev_pc;
-    wire [31:0] instr_word = instr_mem[pc[9:2]];
+    reg  [31:0] instr_word = 32'h0;
+
+    // Instruction bus: synchronous read, always ready (models ITCM port A)
+    always @(posedge clk) begin
+        if (i_req)
+            instr_word <= instr_mem[i_addr[9:2]];
+    end
 
     cpu_core uut (
         .clk(clk),
@@ -26,44 +47,95 @@ module cpu_core_tb;
         .step_pulse(1'b1),
         .irq_i(1'b0),
         .pc_o(pc),
-        .instr_i(instr_word),
+        .i_req(i_req),
+        .i_addr(i_addr),
+        .i_rdata(instr_word),
+        .i_ack(1'b1),
+        .d_req(d_req),
         .d_addr(d_addr),
+        .d_we(d_we),
+        .d_be(d_be),
         .d_wdata(d_wdata),
         .d_rdata(d_rdata),
-        .d_we(d_we),
+        .d_ack(d_ack),
+        .fence_req_o(),
+        .fence_i_o(),
+        .fence_done_i(1'b1),
         .wb_value(wb_value),
         .is_sw_o(is_sw),
         .is_sh_o(is_sh),
         .is_sb_o(is_sb),
-        .rs2_val_o(rs2_val_o)
+        .rs2_val_o(rs2_val_o),
+        .rvfi_valid(rvfi_valid),
+        .rvfi_order(rvfi_order),
+        .rvfi_insn(rvfi_insn),
+        .rvfi_trap(rvfi_trap),
+        .rvfi_intr(rvfi_intr),
+        .rvfi_pc_rdata(rvfi_pc_rdata),
+        .rvfi_pc_wdata(rvfi_pc_wdata),
+        .rvfi_rs1_addr(rvfi_rs1_addr),
+        .rvfi_rs2_addr(rvfi_rs2_addr),
+        .rvfi_rs1_rdata(rvfi_rs1_rdata),
+        .rvfi_rs2_rdata(rvfi_rs2_rdata),
+        .rvfi_rd_addr(rvfi_rd_addr),
+        .rvfi_rd_wdata(rvfi_rd_wdata),
+        .rvfi_mem_addr(rvfi_mem_addr),
+        .rvfi_mem_rmask(rvfi_mem_rmask),
+        .rvfi_mem_wmask(rvfi_mem_wmask),
+        .rvfi_mem_rdata(rvfi_mem_rdata),
+        .rvfi_mem_wdata(rvfi_mem_wdata)
     );
 
+    // RVFI log: retirements of the current program, indexed by rvfi_order
+    reg [31:0] ret_pc    [0:31];
+    reg [31:0] ret_insn  [0:31];
+    reg [31:0] ret_next  [0:31];
+    reg [4:0]  ret_rd    [0:31];
+    reg [31:0] ret_wdata [0:31];
+    reg [1:0]  ret_flags [0:31];    // {trap, intr}
+    reg [31:0] ret_mem   [0:31];    // address for loads/stores
+    reg [31:0] ret_mdata [0:31];    // load rdata / store wdata
+    reg [3:0]  ret_mask  [0:31];    // rmask | wmask
+    integer    ret_count = 0;
+    integer    ret_gaps  = 0;
 
     always @(posedge clk) begin
-        if (d_we && d_addr[31:16] == 16'h0000) begin
-            reg [31:0] word = data_mem[d_addr[9:2]];
-            if (is_sw) begin
-                word = d_wdata;
-            end else if (is_sh) begin
-                if (d_addr[1])
-                    word[31:16] = d_wdata[15:0];
-                else
-                    word[15:0] = d_wdata[15:0];
-            end else if (is_sb) begin
-                case (d_addr[1:0])
-                    2'b00: word[7:0]   = d_wdata[7:0];
-                    2'b01: word[15:8]  = d_wdata[7:0];
-                    2'b10: word[23:16] = d_wdata[7:0];
-                    2'b11: word[31:24] = d_wdata[7:0];
-                endcase
+        if (rvfi_valid) begin
+            if (rvfi_order != ret_count)
+                ret_gaps = ret_gaps + 1;
+            if (ret_count < 32) begin
+                ret_pc[ret_count]    = rvfi_pc_rdata;
+                ret_insn[ret_count]  = rvfi_insn;
+                ret_next[ret_count]  = rvfi_pc_wdata;
+                ret_rd[ret_count]    = rvfi_rd_addr;
+                ret_wdata[ret_count] = rvfi_rd_wdata;
+                ret_flags[ret_count] = {rvfi_trap, rvfi_intr};
+                ret_mem[ret_count]   = rvfi_mem_addr;
+                ret_mdata[ret_count] = rvfi_mem_wmask ? rvfi_mem_wdata : rvfi_mem_rdata;
+                ret_mask[ret_count]  = rvfi_mem_rmask | rvfi_mem_wmask;
             end
-            data_mem[d_addr[9:2]] <= word;
-            $display("MEM WRITE @ %0t idx=%0d data=%h", $time, d_addr[9:2], word);
+            ret_count = ret_count + 1;
         end
-        if (d_addr[31:16] == 16'h0000)
-            d_rdata_reg <= data_mem[d_addr[9:2]];
-        else
+    end
+
+    // Data bus: one-cycle slave (models a TCM behind bus_xbar)
+    reg [31:0] word;
+    integer    lane;
+    always @(posedge clk) begin
+        d_ack_reg <= d_req;
+        if (d_req && d_addr[31:16] == 16'h0000) begin
+            word = data_mem[d_addr[9:2]];
+            d_rdata_reg <= word;
+            if (d_we) begin
+                for (lane = 0; lane < 4; lane = lane + 1)
+                    if (d_be[lane])
+                        word[8*lane +: 8] = d_wdata[8*lane +: 8];
+                data_mem[d_addr[9:2]] <= word;
+                $display("MEM WRITE @ %0t idx=%0d data=%h", $time, d_addr[9:2], word);
+            end
+        end else if (d_req) begin
             d_rdata_reg <= 32'h0;
+        end
     end
 
     task init_mem();
@@ -79,6 +151,8 @@ module cpu_core_tb;
     task reset_cpu();
         begin
             rst_n = 0;
+            ret_count = 0;
+            ret_gaps  = 0;
             @(posedge clk);
             #1 rst_n = 1;
             @(posedge clk);
@@ -217,6 +291,78 @@ module cpu_core_tb;
         end
     endtask
 
+    function reg check_ret(input integer n, input [31:0] pc, input [31:0] insn,
+                           input [31:0] next, input [4:0] rd, input [31:0] wdata,
+                           input [1:0] flags);
+        begin
+            check_ret = 1;
+            if (ret_pc[n] !== pc || ret_insn[n] !== insn || ret_next[n] !== next ||
+                ret_rd[n] !== rd || ret_wdata[n] !== wdata || ret_flags[n] !== flags) begin
+                $display("  RETIRE %0d: pc=%h insn=%h next=%h rd=x%0d/%h ti=%b", n,
+                         ret_pc[n], ret_insn[n], ret_next[n], ret_rd[n], ret_wdata[n], ret_flags[n]);
+                $display("  expected:  pc=%h insn=%h next=%h rd=x%0d/%h ti=%b",
+                         pc, insn, next, rd, wdata, flags);
+                check_ret = 0;
+            end
+        end
+    endfunction
+
+    function reg check_ret_mem(input integer n, input [31:0] addr, input [3:0] mask,
+                               input [31:0] data);
+        begin
+            check_ret_mem = 1;
+            if (ret_mem[n] !== addr || ret_mask[n] !== mask || ret_mdata[n] !== data) begin
+                $display("  RETIRE %0d mem: [%h] %b %h, expected [%h] %b %h", n,
+                         ret_mem[n], ret_mask[n], ret_mdata[n], addr, mask, data);
+                check_ret_mem = 0;
+            end
+        end
+    endfunction
+
+    // RVFI: program order across a trap, mret, a taken branch (the skipped
+    // instruction and the squashed fetches must not appear) and memory ops
+    task run_rvfi();
+        reg passed;
+        begin
+            init_mem();
+            data_mem[0]   = 32'h12345678;
+            instr_mem[0]  = 32'h04000293; // addi x5,x0,64
+            instr_mem[1]  = 32'h30529073; // csrrw x0,mtvec,x5
+            instr_mem[2]  = 32'h00100093; // addi x1,x0,1
+            instr_mem[3]  = 32'h00000073; // ecall
+            instr_mem[4]  = 32'h00002103; // lw x2,0(x0)
+            instr_mem[5]  = 32'h00000463; // beq x0,x0,8
+            instr_mem[6]  = 32'h00500093; // addi x1,x0,5 (skipped)
+            instr_mem[7]  = 32'h00202423; // sw x2,8(x0)
+            instr_mem[8]  = 32'h0000006f; // jal x0,0
+            instr_mem[16] = 32'h34102373; // csrrs x6,mepc,x0
+            instr_mem[17] = 32'h00430313; // addi x6,x6,4
+            instr_mem[18] = 32'h34131073; // csrrw x0,mepc,x6
+            instr_mem[19] = 32'h30200073; // mret
+            reset_cpu();
+            run_cycles(100);
+            passed = (ret_gaps == 0) && (ret_count > 12) &&
+                check_ret(0,  32'h00, 32'h04000293, 32'h04, 5, 64, 2'b00) &&
+                check_ret(1,  32'h04, 32'h30529073, 32'h08, 0, 0,  2'b00) &&
+                check_ret(2,  32'h08, 32'h00100093, 32'h0c, 1, 1,  2'b00) &&
+                check_ret(3,  32'h0c, 32'h00000073, 32'h40, 0, 0,  2'b10) &&
+                check_ret(4,  32'h40, 32'h34102373, 32'h44, 6, 12, 2'b01) &&
+                check_ret(5,  32'h44, 32'h00430313, 32'h48, 6, 16, 2'b00) &&
+                check_ret(6,  32'h48, 32'h34131073, 32'h4c, 0, 0,  2'b00) &&
+                check_ret(7,  32'h4c, 32'h30200073, 32'h10, 0, 0,  2'b00) &&
+                check_ret(8,  32'h10, 32'h00002103, 32'h14, 2, 32'h12345678, 2'b00) &&
+                check_ret(9,  32'h14, 32'h00000463, 32'h1c, 0, 0,  2'b00) &&
+                check_ret(10, 32'h1c, 32'h00202423, 32'h20, 0, 0,  2'b00) &&
+                check_ret(11, 32'h20, 32'h0000006f, 32'h20, 0, 0,  2'b00) &&
+                check_ret(12, 32'h20, 32'h0000006f, 32'h20, 0, 0,  2'b00) &&
+                check_ret_mem(8,  32'h0, 4'b1111, 32'h12345678) &&
+                check_ret_mem(10, 32'h8, 4'b1111, 32'h12345678) &&
+                check_ret_mem(9,  32'h0, 4'b0000, 32'h0);
+            $display("RVFI retirement trace: %s (%0d retired, %0d order gaps)",
+                     passed ? "PASS" : "FAIL", ret_count, ret_gaps);
+        end
+    endtask
+
     initial begin
         init_mem();
         reset_cpu();
@@ -226,6 +372,7 @@ module cpu_core_tb;
         run_trap_mret();
         run_misaligned();
         run_csr_hazard();
+        run_rvfi();
         $display("CPU core tests completed");
         $finish;
     end
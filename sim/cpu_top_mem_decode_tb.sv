@@ -14,7 +14,7 @@ module cpu_top_mem_decode_tb;
     reg ram_store_seen;
     reg clint_load_seen;
     reg unmapped_store_seen;
-    reg unmapped_blocked;
+    reg unmapped_leaked;
     reg [31:0] prev_pc_display;
     integer pc_cycles;
 
@@ -22,7 +22,7 @@ module cpu_top_mem_decode_tb;
     localparam [31:0] RAM_END       = (16384 * 4) - 1;
     localparam [31:0] CLINT_BASE    = 32'hFFFF_0000;
     localparam [31:0] CLINT_END     = 32'hFFFF_001F;
-    localparam [31:0] UNMAPPED_BASE = 32'h8000_0000;
+    localparam [31:0] UNMAPPED_BASE = 32'h4000_0000;
 
     cpu_top dut_top (
         .clk100(clk),
@@ -38,7 +38,7 @@ module cpu_top_mem_decode_tb;
         integer i;
         begin
             for (i = 0; i < 64; i = i + 1)
-                dut_top.data_mem[i] = 32'h0;
+                dut_top.u_itcm.mem[i] = 32'h0;
         end
     endtask
 
@@ -46,13 +46,13 @@ module cpu_top_mem_decode_tb;
         integer i;
         begin
             for (i = 0; i < 256; i = i + 1)
-                dut_top.instr_mem[i] = 32'h00000013;
-            dut_top.instr_mem[0] = 32'h01100093; // addi x1,x0,0x11
-            dut_top.instr_mem[1] = 32'h00102023; // sw x1,0(x0)
-            dut_top.instr_mem[2] = 32'hffff0137; // lui x2,0xffff0
-            dut_top.instr_mem[3] = 32'h00012183; // lw x3,0(x2) -> CLINT load
-            dut_top.instr_mem[4] = 32'h80000237; // lui x4,0x80000
-            dut_top.instr_mem[5] = 32'h0011a023; // sw x1,0(x4) -> unmapped
+                dut_top.u_itcm.mem[i] = 32'h00000013;
+            dut_top.u_itcm.mem[0] = 32'h01100093; // addi x1,x0,0x11
+            dut_top.u_itcm.mem[1] = 32'h00102023; // sw x1,0(x0)
+            dut_top.u_itcm.mem[2] = 32'hffff0137; // lui x2,0xffff0
+            dut_top.u_itcm.mem[3] = 32'h00012183; // lw x3,0(x2) -> CLINT load
+            dut_top.u_itcm.mem[4] = 32'h40000237; // lui x4,0x40000
+            dut_top.u_itcm.mem[5] = 32'h0011a023; // sw x1,0(x4) -> unmapped
         end
     endtask
 
@@ -68,12 +68,20 @@ module cpu_top_mem_decode_tb;
         if (dut_top.u_cpu.mem_is_sw) begin
             if (dut_top.u_cpu.mem_alu_res >= RAM_BASE && dut_top.u_cpu.mem_alu_res <= RAM_END)
                 ram_store_seen <= 1;
-            else if (dut_top.u_cpu.mem_alu_res >= UNMAPPED_BASE)
-                begin
-                    unmapped_store_seen <= 1;
-                    if (dut_top.u_cpu.d_we == 1'b0)
-                        unmapped_blocked <= 1;
-                end
+        end
+        // The unmapped store must leave the store buffer for the bus, and
+        // no slave may see it at any point in the run (slaves get the full
+        // address)
+        if (dut_top.sb_req && dut_top.sb_we && dut_top.sb_addr == UNMAPPED_BASE)
+            unmapped_store_seen <= 1;
+        if ((dut_top.itcm_d_req  && dut_top.itcm_d_we  && dut_top.itcm_d_addr  == UNMAPPED_BASE) ||
+            (dut_top.dtcm_req    && dut_top.dtcm_we    && dut_top.dtcm_addr    == UNMAPPED_BASE) ||
+            (dut_top.flash_d_req && dut_top.flash_d_we && dut_top.flash_d_addr == UNMAPPED_BASE) ||
+            (dut_top.ext_d_req   && dut_top.ext_d_we   && dut_top.ext_d_addr   == UNMAPPED_BASE) ||
+            (dut_top.io_req      && dut_top.io_we      && dut_top.io_addr      == UNMAPPED_BASE)) begin
+            if (!unmapped_leaked)
+                $display("unmapped store reached a slave at %0t", $time);
+            unmapped_leaked <= 1;
         end
         if (dut_top.u_cpu.mem_is_lw &&
             dut_top.u_cpu.mem_alu_res >= CLINT_BASE &&
@@ -105,7 +113,7 @@ module cpu_top_mem_decode_tb;
         ram_store_seen = 0;
         clint_load_seen = 0;
         unmapped_store_seen = 0;
-        unmapped_blocked = 0;
+        unmapped_leaked = 0;
         init_mem();
         load_program();
         rst_n = 0;
@@ -115,8 +123,8 @@ module cpu_top_mem_decode_tb;
         passed = ram_store_seen &&
                  clint_load_seen &&
                  unmapped_store_seen &&
-                 unmapped_blocked &&
-                 (dut_top.data_mem[0] == 32'h11);
+                 !unmapped_leaked &&
+                 (dut_top.u_itcm.mem[0] == 32'h11);
         $display("memory decode (RAM/CLINT/unmapped): %s", passed ? "PASS" : "FAIL");
         $finish;
     end
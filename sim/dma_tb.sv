@@ -0,0 +1,305 @@
+`timescale 1ns / 1ps
+
+// dma against a memory slave with random wait states.
+// Word copy, unaligned byte copy, word copy with a byte tail, fill, a byte
+// stream into a paced FIFO register (never overfilled, order kept), a
+// three-descriptor chain with the completion irq, two channels at once, and
+// an abort of a paced transfer stalled on its request line.
+// Every transfer is checked against a reference copy of memory, including
+// the bytes around the destination.
+module dma_tb;
+    reg clk = 0;
+    always #5 clk = ~clk;
+    reg rst_n;
+
+    localparam integer    WORDS    = 1024;
+    localparam [31:0]     FIFO_REG = 32'hF000_0000;   // paced sink
+    localparam integer    FIFO_DEPTH = 8;
+
+    // Register port
+    reg         wr;
+    reg  [7:0]  addr;
+    reg  [31:0] wdata;
+    wire [31:0] rdata;
+
+    // Bus
+    wire        m_req, m_we;
+    wire [31:0] m_addr, m_wdata;
+    wire [3:0]  m_be;
+    reg  [31:0] m_rdata;
+    reg         m_ack;
+    wire        irq;
+
+    integer     fifo_count;
+    reg         dreq_hold;                          // pace line 2, held by the test
+
+    dma #(.NCH(4), .BURST(4)) dut (
+        .clk(clk), .rst_n(rst_n),
+        .wr(wr), .addr(addr), .wdata(wdata), .rdata(rdata),
+        .dreq({1'b0, dreq_hold, fifo_count < FIFO_DEPTH - 1}),
+        .m_req(m_req), .m_addr(m_addr), .m_we(m_we), .m_be(m_be),
+        .m_wdata(m_wdata), .m_rdata(m_rdata), .m_ack(m_ack),
+        .irq(irq)
+    );
+
+    localparam         TB_NAME    = "dma_tb";
+    localparam integer TB_TIMEOUT = 20_000_000;
+    `define TB_IO_REGS
+    `include "tb_common.vh"
+
+    // ------------------------------------------------------------
+    // Slave: byte-addressed memory at 0, FIFO register at FIFO_REG
+    // ------------------------------------------------------------
+    reg  [31:0] mem     [0:WORDS-1];
+    reg  [7:0]  ref_b   [0:WORDS*4-1];
+    reg  [7:0]  fifo_log [0:4095];
+    integer     fifo_in, fifo_max, wait_max, seed, k;
+    reg         pend;
+    integer     pend_cnt;
+    reg  [31:0] pend_addr, pend_wdata;
+    reg         pend_we;
+    reg  [3:0]  pend_be;
+
+    always @(posedge clk) begin
+        m_ack <= 1'b0;
+        if (m_req) begin
+            if (pend) begin
+                $display("  slave: second request while one is outstanding");
+                errors = errors + 1;
+            end
+            pend       <= 1'b1;
+            pend_addr  <= m_addr;
+            pend_we    <= m_we;
+            pend_be    <= m_be;
+            pend_wdata <= m_wdata;
+            pend_cnt   <= (wait_max > 0) ? ($random(seed) & 32'h7fffffff) % (wait_max + 1) : 0;
+        end else if (pend) begin
+            if (pend_cnt == 0) begin
+                m_ack <= 1'b1;
+                pend  <= 1'b0;
+                if (pend_addr == FIFO_REG) begin
+                    if (pend_we) begin
+                        fifo_log[fifo_in] = pend_wdata[7:0];
+                        fifo_in    = fifo_in + 1;
+                        fifo_count = fifo_count + 1;
+                        if (fifo_count > fifo_max)
+                            fifo_max = fifo_count;
+                    end
+                    m_rdata <= 32'h0;
+                end else begin
+                    m_rdata <= mem[pend_addr[11:2]];
+                    if (pend_we)
+                        for (k = 0; k < 4; k = k + 1)
+                            if (pend_be[k])
+                                mem[pend_addr[11:2]][8*k +: 8] <= pend_wdata[8*k +: 8];
+                end
+            end else begin
+                pend_cnt <= pend_cnt - 1;
+            end
+        end
+    end
+
+    // The FIFO drains one byte every 12 cycles (a slow shifter)
+    integer drain_cnt;
+    always @(posedge clk) begin
+        if (drain_cnt == 11) begin
+            drain_cnt <= 0;
+            if (fifo_count > 0)
+                fifo_count = fifo_count - 1;
+        end else begin
+            drain_cnt <= drain_cnt + 1;
+        end
+    end
+
+    // ------------------------------------------------------------
+    // Helpers
+    // ------------------------------------------------------------
+    task start(input integer ch, input [31:0] src, input [31:0] dst,
+               input [31:0] len, input [31:0] cfg, input [31:0] ctrl);
+        begin
+            reg_wr(ch * 32 + 8'h00, src);
+            reg_wr(ch * 32 + 8'h04, dst);
+            reg_wr(ch * 32 + 8'h08, len);
+            reg_wr(ch * 32 + 8'h0C, cfg);
+            reg_wr(ch * 32 + 8'h10, 32'h0);
+            reg_wr(ch * 32 + 8'h14, ctrl);
+        end
+    endtask
+
+    task wait_idle(input integer ch);
+        integer t;
+        reg [31:0] ctrl;
+        begin
+            t = 0;
+            @(negedge clk);
+            reg_rd(ch * 32 + 8'h14, ctrl);
+            while ((ctrl & 32'h100) && t < 100000) begin
+                @(negedge clk);
+                t = t + 1;
+                reg_rd(ch * 32 + 8'h14, ctrl);
+            end
+            if (t >= 100000) begin
+                $display("  channel %0d never finished", ch);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    // Reference model of one transfer
+    task ref_copy(input [31:0] src, input [31:0] dst, input [31:0] len,
+                  input src_fixed);
+        integer b;
+        begin
+            for (b = 0; b < len; b = b + 1)
+                ref_b[dst + b] = src_fixed ? ref_b[src + (b & 3)] : ref_b[src + b];
+        end
+    endtask
+
+    task check_mem(input [8*24-1:0] what);
+        integer b, bad;
+        begin
+            bad = 0;
+            for (b = 0; b < WORDS * 4; b = b + 1)
+                if (mem[b >> 2][8*(b & 3) +: 8] !== ref_b[b]) begin
+                    if (bad < 4)
+                        $display("  %0s: byte %h = %h expected %h",
+                                 what, b, mem[b >> 2][8*(b & 3) +: 8], ref_b[b]);
+                    bad = bad + 1;
+                end
+            errors = errors + bad;
+        end
+    endtask
+
+    task put_word(input [31:0] a, input [31:0] d);
+        integer b;
+        begin
+            mem[a[11:2]] = d;
+            for (b = 0; b < 4; b = b + 1)
+                ref_b[a + b] = d[8*b +: 8];
+        end
+    endtask
+
+    // ------------------------------------------------------------
+    // Test sequence
+    // ------------------------------------------------------------
+    integer    i, t0;
+    reg [31:0] v;
+
+    initial begin
+        seed = 11; wait_max = 2;
+        fifo_count = 0; fifo_in = 0; fifo_max = 0; drain_cnt = 0; dreq_hold = 0;
+        wr = 0; addr = 0; wdata = 0; m_ack = 0; m_rdata = 0; pend = 0; pend_cnt = 0;
+        for (i = 0; i < WORDS; i = i + 1)
+            put_word(i * 4, $random(seed));
+        rst_n = 0;
+        repeat (3) @(negedge clk);
+        rst_n = 1;
+
+        // 1. Word copy, 64 bytes
+        t0 = $time;
+        start(0, 32'h100, 32'h800, 64, 32'h4, 32'h1);
+        wait_idle(0);
+        ref_copy(32'h100, 32'h800, 64, 0);
+        check_mem("word copy");
+        $display("dma_tb: 16-word copy took %0d cycles (slave waits 0..%0d)",
+                 ($time - t0) / 10, wait_max);
+
+        // 2. Unaligned byte copy
+        start(1, 32'h201, 32'h903, 37, 32'h0, 32'h1);
+        wait_idle(1);
+        ref_copy(32'h201, 32'h903, 37, 0);
+        check_mem("byte copy");
+
+        // 3. Word mode with a 2-byte tail
+        start(2, 32'h300, 32'hA00, 22, 32'h4, 32'h1);
+        wait_idle(2);
+        ref_copy(32'h300, 32'hA00, 22, 0);
+        check_mem("word copy + tail");
+
+        // 4. Fill from a fixed source word
+        put_word(32'h0F0, 32'hDEAD_BEEF);
+        start(3, 32'h0F0, 32'hB00, 40, 32'h5, 32'h1);
+        wait_idle(3);
+        ref_copy(32'h0F0, 32'hB00, 40, 1);
+        check_mem("fill");
+
+        // 5. Byte stream into the paced FIFO register
+        fifo_in = 0;
+        start(0, 32'h400, FIFO_REG, 100, 32'h12, 32'h1);
+        wait_idle(0);
+        for (i = 0; i < 100; i = i + 1)
+            if (fifo_log[i] !== ref_b[32'h400 + i]) begin
+                if (errors < 10)
+                    $display("  fifo byte %0d = %h expected %h", i, fifo_log[i], ref_b[32'h400 + i]);
+                errors = errors + 1;
+            end
+        check(fifo_in == 100, "fifo: every byte written");
+        check(fifo_max <= FIFO_DEPTH, "fifo: never overfilled");
+
+        // 6. Three-descriptor chain at 0xC00, irq at the end only
+        put_word(32'hC00, 32'h500); put_word(32'hC04, 32'hD00);
+        put_word(32'hC08, 32'd16);  put_word(32'hC0C, 32'h4);
+        put_word(32'hC10, 32'hC20);
+        put_word(32'hC20, 32'h541); put_word(32'hC24, 32'hD42);
+        put_word(32'hC28, 32'd9);   put_word(32'hC2C, 32'h0);
+        put_word(32'hC30, 32'hC40);
+        put_word(32'hC40, 32'h0F0); put_word(32'hC44, 32'hD80);
+        put_word(32'hC48, 32'd8);   put_word(32'hC4C, 32'h5);
+        put_word(32'hC50, 32'h0);
+        reg_wr(8'h80, 32'hF);                       // clear DONE
+        reg_wr(1 * 32 + 8'h10, 32'hC00);
+        reg_wr(1 * 32 + 8'h14, 32'h6);              // start from descriptor, irq
+        @(negedge clk);
+        check(!irq, "no irq before the chain ran");
+        wait_idle(1);
+        @(negedge clk);
+        reg_rd(8'h80, v);
+        check(irq && v === 32'h2, "chain: irq and DONE of channel 1");
+        reg_wr(8'h80, 32'h2);
+        @(negedge clk);
+        check(!irq, "irq drops when DONE is cleared");
+        ref_copy(32'h500, 32'hD00, 16, 0);
+        ref_copy(32'h541, 32'hD42, 9, 0);
+        ref_copy(32'h0F0, 32'hD80, 8, 1);
+        check_mem("chain");
+
+        // 7. Two channels at once
+        start(2, 32'h600, 32'hE00, 128, 32'h4, 32'h1);
+        start(3, 32'h700, 32'hF00, 61, 32'h0, 32'h1);
+        wait_idle(2);
+        wait_idle(3);
+        ref_copy(32'h600, 32'hE00, 128, 0);
+        ref_copy(32'h700, 32'hF00, 61, 0);
+        check_mem("two channels");
+
+        // 8. Abort a byte stream paced on line 2 while the line is held low:
+        //    the engine sits in the write, the abort must get it off the
+        //    channel without touching the registers programmed afterwards
+        fifo_in = 0;
+        start(1, 32'h480, FIFO_REG, 20, 32'h20, 32'h1);
+        repeat (20) @(negedge clk);
+        reg_rd(1 * 32 + 8'h14, v);
+        check((v & 32'h100) != 0 && fifo_in == 0, "abort: stalled on dreq");
+        reg_wr(1 * 32 + 8'h14, 32'h8);
+        wait_idle(1);
+        reg_rd(1 * 32 + 8'h14, v);
+        check((v & 32'h700) == 0, "abort: not busy, done or aborting");
+        reg_wr(1 * 32 + 8'h00, 32'h1234);
+        reg_wr(1 * 32 + 8'h04, 32'h5678);
+        reg_wr(1 * 32 + 8'h08, 32'd77);
+        repeat (50) @(negedge clk);
+        reg_rd(1 * 32 + 8'h00, v);
+        check(v === 32'h1234, "abort: SRC kept");
+        reg_rd(1 * 32 + 8'h04, v);
+        check(v === 32'h5678, "abort: DST kept");
+        reg_rd(1 * 32 + 8'h08, v);
+        check(v === 32'd77, "abort: LEN kept");
+        check(fifo_in == 0, "abort: nothing written");
+        start(0, 32'h100, 32'h880, 32, 32'h4, 32'h1);
+        wait_idle(0);
+        ref_copy(32'h100, 32'h880, 32, 0);
+        check_mem("copy after abort");
+
+        tb_finish;
+    end
+endmodule
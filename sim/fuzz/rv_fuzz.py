@@ -0,0 +1,542 @@
+#!/usr/bin/env python3
+"""
+Constrained-random RV32I/Zicsr fuzzer for the cpu_core pipeline.
+
+Each seed becomes a self-contained ITCM program, encoded here (no
+toolchain needed), that is dense in what the forwarding, CSR-hazard and
+trap-cancellation paths of cpu_core.v have to get right:
+  - back-to-back dependencies (sources drawn mostly from the last few
+    destinations, x0 as a destination now and then)
+  - loads right after stores to the same or an overlapping address, in
+    DTCM, external memory and flash (XIP, read only), load-use chains
+  - CSR read-modify-write chains on mscratch, reads of every CSR and of
+    the CSR MMIO window, toggles of mstatus.MIE
+  - forward branches and jumps (jal, auipc + jalr) whose target or
+    shadow is an ecall / ebreak, fence.i
+  - timer interrupts: the handler re-arms mtimecmp a random, partly
+    data-dependent number of cycles ahead, so interrupts land everywhere
+Control flow only goes forward, so every program ends at its final `j .`.
+
+The reference model is the ISS: with --sim verilator (default) every
+program runs on the RTL with --cosim, which checks each retired
+instruction against the ISS and stops at the first divergence. --sim iss
+runs the programs on the ISS alone, to check the generator.
+
+Usage: python3 sim/fuzz/rv_fuzz.py [options]
+  --seed N          first seed (default 1)
+  -n N              number of programs (default 100)
+  --length N        random instructions per program (default 2000)
+  --sim verilator|iss
+  -j N              parallel jobs (default: all host cores)
+  --out DIR         output directory (default obj_fuzz)
+  --keep            keep the directories of passing seeds too
+  --no-build-sim    use the simulator built last time
+
+Each failing seed keeps obj_fuzz/seed_N/ (images, prog.S, run.log); rerun
+it with --seed N -n 1. Exit status: 0 = all passed, 1 = failures.
+"""
+import argparse
+import concurrent.futures
+import os
+import random
+import re
+import shutil
+import subprocess
+import sys
+from pathlib import Path
+
+HERE = Path(__file__).resolve().parent
+ROOT = HERE.parent.parent
+
+ISS_BIN = ROOT / "obj_iss" / "iss"
+VERILATOR_BIN = ROOT / "obj_verilator" / "t1_tr0" / "Vsim_top"
+
+ABI = ["zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+       "s0", "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+       "a6", "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+       "s8", "s9", "s10", "s11", "t3", "t4", "t5", "t6"]
+
+# Reserved registers: memory window bases, and the handler's temporaries
+R_FLASH, R_EXT, R_DTCM = 25, 26, 27
+R_H0, R_H1 = 30, 31
+DEST = [r for r in range(32) if r not in (R_FLASH, R_EXT, R_DTCM, R_H0, R_H1)]
+
+DTCM_BASE, EXT_BASE, FLASH_BASE = 0x10000000, 0x80000000, 0x20000000
+WINDOW = 256                            # bytes of each region the program uses
+MTIME_LO, MTIMECMP_LO, MTIMECMP_HI = 0x8, 0x10, 0x14    # from 0xFFFF0000
+
+CSRS = {0x300: "mstatus", 0x304: "mie", 0x305: "mtvec", 0x340: "mscratch",
+        0x341: "mepc", 0x342: "mcause", 0x344: "mip", 0xF14: "mhartid"}
+MMIO_CSRS = {-64: "mtvec", -60: "mstatus", -56: "mepc", -52: "mcause"}
+
+
+# --- encoders ---------------------------------------------------------------
+
+def enc_r(f7, rs2, rs1, f3, rd, op=0x33):
+    return f7 << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op
+
+
+def enc_i(imm, rs1, f3, rd, op):
+    return (imm & 0xFFF) << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op
+
+
+def enc_s(imm, rs2, rs1, f3):
+    return ((imm >> 5) & 0x7F) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | \
+        (imm & 0x1F) << 7 | 0x23
+
+
+def enc_b(off, rs2, rs1, f3):
+    return ((off >> 12) & 1) << 31 | ((off >> 5) & 0x3F) << 25 | rs2 << 20 | \
+        rs1 << 15 | f3 << 12 | ((off >> 1) & 0xF) << 8 | ((off >> 11) & 1) << 7 | 0x63
+
+
+def enc_j(off, rd):
+    return ((off >> 20) & 1) << 31 | ((off >> 1) & 0x3FF) << 21 | \
+        ((off >> 11) & 1) << 20 | ((off >> 12) & 0xFF) << 12 | rd << 7 | 0x6F
+
+
+def hi_lo(v):
+    """lui/addi split of a 32-bit constant."""
+    lo = v & 0xFFF
+    lo = lo - 0x1000 if lo & 0x800 else lo
+    return ((v - lo) >> 12) & 0xFFFFF, lo
+
+
+class Program:
+    """Instruction words at consecutive addresses from 0, with labels."""
+
+    def __init__(self):
+        self.items = []             # (encode(addr, labels), text)
+        self.labels = {}
+        self.at = {}                # addr -> label names, for the listing
+
+    def pc(self):
+        return 4 * len(self.items)
+
+    def label(self, name):
+        self.labels[name] = self.pc()
+        self.at.setdefault(self.pc(), []).append(name)
+
+    def emit(self, word, text):
+        self.items.append((word if callable(word) else (lambda a, L, w=word: w), text))
+
+    def assemble(self):
+        words, lines = [], []
+        for i, (enc, text) in enumerate(self.items):
+            a = 4 * i
+            for name in self.at.get(a, []):
+                lines.append(f"{name}:")
+            w = enc(a, self.labels) & 0xFFFFFFFF
+            words.append(w)
+            lines.append(f"        {text:40s} # {a:05x}: {w:08x}")
+        for name in self.at.get(self.pc(), []):
+            lines.append(f"{name}:")
+        return words, lines
+
+    # instruction helpers
+    def alu_r(self, mn, f7, f3, rd, rs1, rs2):
+        self.emit(enc_r(f7, rs2, rs1, f3, rd), f"{mn} {ABI[rd]}, {ABI[rs1]}, {ABI[rs2]}")
+
+    def alu_i(self, mn, f3, rd, rs1, imm):
+        self.emit(enc_i(imm, rs1, f3, rd, 0x13), f"{mn} {ABI[rd]}, {ABI[rs1]}, {imm}")
+
+    def lui(self, rd, imm20):
+        self.emit(imm20 << 12 | rd << 7 | 0x37, f"lui {ABI[rd]}, {imm20:#x}")
+
+    def li(self, rd, v):
+        hi, lo = hi_lo(v & 0xFFFFFFFF)
+        self.lui(rd, hi)
+        self.alu_i("addi", 0, rd, rd, lo)
+
+    def load(self, mn, f3, rd, rs1, off):
+        self.emit(enc_i(off, rs1, f3, rd, 0x03), f"{mn} {ABI[rd]}, {off}({ABI[rs1]})")
+
+    def store(self, mn, f3, rs2, rs1, off):
+        self.emit(enc_s(off, rs2, rs1, f3), f"{mn} {ABI[rs2]}, {off}({ABI[rs1]})")
+
+    def branch(self, mn, f3, rs1, rs2, target):
+        self.emit(lambda a, L: enc_b(L[target] - a, rs2, rs1, f3),
+                  f"{mn} {ABI[rs1]}, {ABI[rs2]}, {target}")
+
+    def jal(self, rd, target):
+        self.emit(lambda a, L: enc_j(L[target] - a, rd), f"jal {ABI[rd]}, {target}")
+
+    def csr(self, mn, f3, rd, csr, src):
+        name = CSRS.get(csr, f"{csr:#x}")
+        arg = str(src) if f3 & 4 else ABI[src]
+        self.emit(csr << 20 | src << 15 | f3 << 12 | rd << 7 | 0x73,
+                  f"{mn} {ABI[rd]}, {name}, {arg}")
+
+
+ALU_R = [("add", 0, 0), ("sub", 0x20, 0), ("sll", 0, 1), ("slt", 0, 2),
+         ("sltu", 0, 3), ("xor", 0, 4), ("srl", 0, 5), ("sra", 0x20, 5),
+         ("or", 0, 6), ("and", 0, 7)]
+ALU_I = [("addi", 0), ("slti", 2), ("sltiu", 3), ("xori", 4), ("ori", 6), ("andi", 7)]
+SHIFT_I = [("slli", 1, 0), ("srli", 5, 0), ("srai", 5, 0x20)]
+LOADS = [("lb", 0, 1), ("lh", 1, 2), ("lw", 2, 4), ("lbu", 4, 1), ("lhu", 5, 2)]
+STORES = [("sb", 0, 1), ("sh", 1, 2), ("sw", 2, 4)]
+BRANCHES = [("beq", 0), ("bne", 1), ("blt", 4), ("bge", 5), ("bltu", 6), ("bgeu", 7)]
+CSR_OPS = [("csrrw", 1), ("csrrs", 2), ("csrrc", 3)]
+CSR_IOPS = [("csrrwi", 5), ("csrrsi", 6), ("csrrci", 7)]
+
+
+class Generator:
+    def __init__(self, seed, length):
+        self.rng = random.Random(seed)
+        self.length = length
+        self.p = Program()
+        self.hot = [1, 2, 3]            # recent destinations
+        self.n_labels = 0
+        self.pending = []               # (group index, label) forward targets
+        self.trap_at = {}               # group index -> label of an ecall/ebreak
+
+    # register choice: dense dependencies on the last few results
+    def src(self):
+        if self.rng.random() < 0.75:
+            return self.rng.choice(self.hot)
+        return self.rng.randrange(32)
+
+    def dst(self):
+        r = self.rng.random()
+        if r < 0.05:
+            return 0
+        if r < 0.35:
+            return self.rng.choice([h for h in self.hot if h in DEST] or DEST)
+        return self.rng.choice(DEST)
+
+    def wrote(self, rd):
+        if rd:
+            self.hot = (self.hot + [rd])[-4:]
+
+    def new_label(self):
+        self.n_labels += 1
+        return f"L{self.n_labels}"
+
+    def window(self, size, regions=(R_DTCM, R_EXT, R_FLASH)):
+        base = self.rng.choice(regions)
+        off = self.rng.randrange(0, WINDOW, size)
+        if size > 1 and self.rng.random() < 0.05:
+            off += self.rng.randrange(1, size)  # misaligned: address bits dropped
+        return base, off
+
+    # --- program sections ---
+
+    def setup(self, handler):
+        p, rng = self.p, self.rng
+        p.emit(lambda a, L: hi_lo(L[handler])[0] << 12 | R_H0 << 7 | 0x37, f"lui t5, %hi({handler})")
+        p.emit(lambda a, L: enc_i(hi_lo(L[handler])[1], R_H0, 0, R_H0, 0x13),
+               f"addi t5, t5, %lo({handler})")
+        p.csr("csrrw", 1, 0, 0x305, R_H0)
+        p.li(R_DTCM, DTCM_BASE + rng.randrange(0, 0x10000, WINDOW))
+        p.li(R_EXT, EXT_BASE)               # ext_mem.vh / flash_mem.vh hold
+        p.li(R_FLASH, FLASH_BASE)           # random words there
+        for off in range(0, WINDOW, 4):     # DTCM has no init image
+            p.li(5, rng.getrandbits(32))
+            p.store("sw", 2, 5, R_DTCM, off)
+        for r in DEST[1:]:
+            p.li(r, rng.choice([rng.getrandbits(32), rng.randrange(-8, 8), 0x80000000]))
+        # mtimecmp = first interrupt, hi word 0 (mtime stays below 2^32)
+        p.lui(R_H0, 0xFFFF0)
+        p.load("lw", 2, R_H1, R_H0, MTIME_LO)
+        p.alu_i("addi", 0, R_H1, R_H1, rng.randrange(20, 400))
+        p.store("sw", 2, R_H1, R_H0, MTIMECMP_LO)
+        p.store("sw", 2, 0, R_H0, MTIMECMP_HI)
+        p.li(R_H1, 0x80)
+        p.csr("csrrs", 2, 0, 0x304, R_H1)   # mie.MTIE
+        p.csr("csrrsi", 6, 0, 0x300, 8)     # mstatus.MIE
+
+    def handler(self, name):
+        """ecall/ebreak: skip it. Timer: re-arm mtimecmp and return."""
+        p, rng = self.p, self.rng
+        irq = name + "_irq"
+        p.label(name)
+        p.csr("csrrs", 2, R_H0, 0x342, 0)                   # mcause
+        p.branch("blt", 4, R_H0, 0, irq)
+        p.csr("csrrs", 2, R_H1, 0x341, 0)                   # mepc
+        p.alu_i("addi", 0, R_H1, R_H1, 4)
+        p.csr("csrrw", 1, 0, 0x341, R_H1)
+        p.emit(0x30200073, "mret")
+        p.label(irq)
+        p.alu_i("andi", 7, R_H1, rng.choice(DEST[1:]), 0x7F)   # data-dependent part
+        p.lui(R_H0, 0xFFFF0)
+        p.load("lw", 2, R_H0, R_H0, MTIME_LO)
+        p.alu_r("add", 0, 0, R_H1, R_H1, R_H0)
+        p.alu_i("addi", 0, R_H1, R_H1, rng.randrange(12, 200))
+        p.lui(R_H0, 0xFFFF0)
+        p.store("sw", 2, R_H1, R_H0, MTIMECMP_LO)
+        p.emit(0x30200073, "mret")
+
+    def group(self, g, filler=False):
+        """One unit of the random body; branch targets land between units."""
+        p, rng = self.p, self.rng
+        if g in self.trap_at:
+            p.label(self.trap_at.pop(g))
+            self.trap()
+            return
+        if filler:
+            p.alu_i("addi", 0, 0, 0, 0)
+            return
+        k = rng.choices(["alu", "alui", "lui", "load", "store", "st_ld", "csr",
+                         "mmio", "branch", "jal", "jalr", "trap", "fence"],
+                        [30, 20, 4, 10, 8, 8, 6, 2, 8, 2, 2, 2, 1])[0]
+        if k == "alu":
+            mn, f7, f3 = rng.choice(ALU_R)
+            rd = self.dst()
+            p.alu_r(mn, f7, f3, rd, self.src(), self.src())
+            self.wrote(rd)
+        elif k == "alui":
+            rd = self.dst()
+            if rng.random() < 0.3:
+                mn, f3, f7 = rng.choice(SHIFT_I)
+                rs1, sh = self.src(), rng.randrange(32)
+                p.emit(enc_i(f7 << 5 | sh, rs1, f3, rd, 0x13), f"{mn} {ABI[rd]}, {ABI[rs1]}, {sh}")
+            else:
+                mn, f3 = rng.choice(ALU_I)
+                p.alu_i(mn, f3, rd, self.src(), rng.randrange(-2048, 2048))
+            self.wrote(rd)
+        elif k == "lui":
+            rd = self.dst()
+            if rng.random() < 0.5:
+                p.lui(rd, rng.getrandbits(20))
+            else:
+                imm = rng.getrandbits(20)
+                p.emit(imm << 12 | rd << 7 | 0x17, f"auipc {ABI[rd]}, {imm:#x}")
+            self.wrote(rd)
+        elif k == "load":
+            mn, f3, size = rng.choice(LOADS)
+            base, off = self.window(size)
+            rd = self.dst()
+            p.load(mn, f3, rd, base, off)
+            self.wrote(rd)
+            if rng.random() < 0.5:                          # load-use
+                mn, f7, f3 = rng.choice(ALU_R)
+                rd2 = self.dst()
+                p.alu_r(mn, f7, f3, rd2, rd, self.src())
+                self.wrote(rd2)
+        elif k == "store":
+            mn, f3, size = rng.choice(STORES)
+            base, off = self.window(size, (R_DTCM, R_EXT))
+            p.store(mn, f3, self.src(), base, off)
+        elif k == "st_ld":
+            smn, sf3, ssize = rng.choice(STORES)
+            base, off = self.window(ssize, (R_DTCM, R_EXT))
+            p.store(smn, sf3, self.src(), base, off)
+            for _ in range(rng.choice([1, 1, 2])):
+                lmn, lf3, lsize = rng.choice(LOADS)
+                loff = (off & ~3) + rng.randrange(0, 4, lsize)  # same word
+                rd = self.dst()
+                p.load(lmn, lf3, rd, base, loff)
+                self.wrote(rd)
+        elif k == "csr":
+            self.csr_chain()
+        elif k == "mmio":
+            off = rng.choice(list(MMIO_CSRS))
+            rd = self.dst()
+            p.load("lw", 2, rd, 0, off)
+            self.wrote(rd)
+        elif k == "branch":
+            mn, f3 = rng.choice(BRANCHES)
+            target = self.new_label()
+            ahead = rng.randrange(1, 6)
+            if rng.random() < 0.3:
+                self.trap_at.setdefault(g + ahead, target)
+                target = self.trap_at[g + ahead]
+            else:
+                self.pending.append((g + ahead, target))
+            p.branch(mn, f3, self.src(), self.src(), target)
+            if rng.random() < 0.2:
+                self.trap()                                 # in the branch shadow
+        elif k == "jal":
+            target = self.new_label()
+            self.pending.append((g + rng.randrange(1, 4), target))
+            rd = self.dst()
+            p.jal(rd, target)
+            self.wrote(rd)
+            if rng.random() < 0.3:
+                self.trap()
+        elif k == "jalr":
+            target = self.new_label()
+            self.pending.append((g + rng.randrange(1, 4), target))
+            rb, rd = self.dst() or 1, self.dst()
+            here = self.new_label()
+            p.label(here)
+            p.emit(rb << 7 | 0x17, f"auipc {ABI[rb]}, 0")
+            p.emit(lambda a, L: enc_i(L[target] - L[here], rb, 0, rd, 0x67),
+                   f"jalr {ABI[rd]}, {target}-{here}({ABI[rb]})")
+            self.wrote(rb)
+            self.wrote(rd)
+        elif k == "trap":
+            self.trap()
+        else:
+            if rng.random() < 0.5:
+                p.emit(0x0000100F, "fence.i")
+            else:
+                p.emit(0x0FF0000F, "fence")
+
+    def trap(self):
+        if self.rng.random() < 0.7:
+            self.p.emit(0x00000073, "ecall")
+        else:
+            self.p.emit(0x00100073, "ebreak")
+
+    def csr_chain(self):
+        """mscratch read-modify-write chains; reads of the other CSRs."""
+        p, rng = self.p, self.rng
+        r = rng.random()
+        if r < 0.15:
+            mn, f3 = ("csrrsi", 6) if rng.random() < 0.75 else ("csrrci", 7)
+            rd = self.dst()
+            p.csr(mn, f3, rd, 0x300, 8)                     # mstatus.MIE
+            self.wrote(rd)
+            return
+        if r < 0.35:
+            rd = self.dst()
+            p.csr("csrrs", 2, rd, rng.choice(list(CSRS)), 0)
+            self.wrote(rd)
+            return
+        src = self.src()
+        for _ in range(rng.randrange(2, 5)):
+            rd = self.dst()
+            if rng.random() < 0.7:
+                mn, f3 = rng.choice(CSR_OPS)
+                p.csr(mn, f3, rd, 0x340, src)
+            else:
+                mn, f3 = rng.choice(CSR_IOPS)
+                p.csr(mn, f3, rd, 0x340, rng.randrange(32))
+            self.wrote(rd)
+            if rng.random() < 0.5:                          # use the old value
+                mn, f7, f3 = rng.choice(ALU_R)
+                rd2 = self.dst()
+                p.alu_r(mn, f7, f3, rd2, rd, self.src())
+                self.wrote(rd2)
+                src = rd2
+            else:
+                src = rd
+
+    def generate(self):
+        """Returns the image words, the listing and the address of the end."""
+        p = self.p
+        self.setup("handler")
+        g = 0
+        while True:
+            for _, name in [x for x in self.pending if x[0] <= g]:
+                p.label(name)
+            self.pending = [x for x in self.pending if x[0] > g]
+            body_done = p.pc() >= 4 * self.length
+            if body_done and not self.trap_at:
+                break
+            self.group(g, filler=body_done)     # only reach pending traps
+            g += 1
+        for _, name in self.pending:
+            p.label(name)
+        p.csr("csrrci", 7, 0, 0x300, 8)                     # no interrupts in the halt loop
+        p.label("done")
+        p.emit(enc_j(0, 0), "j done")
+        self.handler("handler")
+        words, lines = p.assemble()
+        return words, lines, p.labels["done"]
+
+
+def write_images(out, seed, length):
+    words, lines, done = Generator(seed, length).generate()
+    out.mkdir(parents=True, exist_ok=True)
+    (out / "instr_mem.vh").write_text("".join(f"{w:08x}\n" for w in words))
+    rng = random.Random(seed ^ 0x5EED)
+    for img in ("ext_mem.vh", "flash_mem.vh"):
+        (out / img).write_text("".join(f"{rng.getrandbits(32):08x}\n"
+                                       for _ in range(WINDOW // 4)))
+    (out / "prog.S").write_text(f"# rv_fuzz.py seed {seed}, length {length}\n"
+                                "        .text\n" + "\n".join(lines) + "\n")
+    return len(words), done
+
+
+def run_seed(seed, args):
+    out = Path(args.out).resolve() / f"seed_{seed}"
+    n_words, done = write_images(out, seed, args.length)
+
+    cycles = 40 * n_words + 100000
+    if args.sim == "iss":
+        cmd = [ISS_BIN, "--stuck", "50"]
+    else:
+        cmd = [VERILATOR_BIN, "--cosim", "--stuck", "200"]
+    cmd += ["--dir", out, "--cycles", cycles]
+    p = subprocess.run([str(c) for c in cmd], stdout=subprocess.PIPE,
+                       stderr=subprocess.STDOUT, text=True)
+    (out / "run.log").write_text(p.stdout)
+
+    m = re.search(r"PC stuck at 0x([0-9a-f]+)", p.stdout)
+    n = re.search(r"\[COSIM\] (\d+) instructions checked.*\((\d+) interrupts\)", p.stdout) or \
+        re.search(r"\[ISS\] (\d+) instructions", p.stdout)
+    info = f"{n.group(1)} insns" if n else ""
+    if n and n.lastindex == 2:
+        info += f", {n.group(2)} interrupts"
+    if "DIVERGENCE" in p.stdout:
+        d = re.search(r"DIVERGENCE at instruction (\d+) \(cycle (\d+)\): (.*)", p.stdout)
+        status, detail = "FAIL", f"diverged at instruction {d.group(1)}: {d.group(3)}"
+    elif not m:
+        status, detail = "FAIL", "did not reach the end"
+    elif int(m.group(1), 16) != done:
+        status, detail = "FAIL", f"stopped at {m.group(1)}, end is {done:08x}"
+    else:
+        status, detail = "PASS", info
+    if status == "PASS" and not args.keep:
+        shutil.rmtree(out)
+    return status, detail
+
+
+def build_sims(args):
+    (ROOT / "obj_iss").mkdir(exist_ok=True)
+    if args.sim == "iss":
+        print("Building ISS (obj_iss/iss)...")
+        p = subprocess.run(["g++", "-O2", "-std=c++14", "-Wall", "-I", str(ROOT / "firmware"),
+                            "-o", str(ISS_BIN), str(ROOT / "sim/iss/rv32_iss.cpp"),
+                            str(ROOT / "sim/iss/soc.cpp"), str(ROOT / "sim/iss/checkpoint.cpp"),
+                            str(ROOT / "sim/iss/elf.cpp"), str(ROOT / "sim/iss/iss_main.cpp")])
+    else:
+        print("Building Verilator model...")
+        p = subprocess.run([str(ROOT / "run_verilator_sim.sh"), "--build-only"], cwd=ROOT)
+    if p.returncode:
+        sys.exit("ERROR: simulator build failed")
+
+
+def main():
+    ap = argparse.ArgumentParser(add_help=False)
+    ap.add_argument("--seed", type=int, default=1)
+    ap.add_argument("-n", type=int, default=100)
+    ap.add_argument("--length", type=int, default=2000)
+    ap.add_argument("--sim", choices=("verilator", "iss"), default="verilator")
+    ap.add_argument("-j", type=int, default=os.cpu_count() or 1)
+    ap.add_argument("--out", default=str(ROOT / "obj_fuzz"))
+    ap.add_argument("--keep", action="store_true")
+    ap.add_argument("--no-build-sim", action="store_true")
+    ap.add_argument("-h", "--help", action="store_true")
+    args = ap.parse_args()
+    if args.help:
+        print(__doc__.strip())
+        return 0
+    if not args.no_build_sim:
+        build_sims(args)
+
+    seeds = range(args.seed, args.seed + args.n)
+    print(f"Fuzzing {len(seeds)} programs of {args.length} instructions on "
+          f"{args.sim} ({args.j} jobs)...")
+    failed = []
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.j) as pool:
+        futures = {pool.submit(run_seed, s, args): s for s in seeds}
+        for f in concurrent.futures.as_completed(futures):
+            s = futures[f]
+            status, detail = f.result()
+            if status != "PASS":
+                failed.append(s)
+            print(f"  {status:5s} seed {s:<8d} {detail}", flush=True)
+
+    print("========================================")
+    print(f"{len(seeds) - len(failed)}/{len(seeds)} passed")
+    if failed:
+        print(f"Failing seeds: {' '.join(map(str, sorted(failed)))} "
+              f"(kept in {args.out}/seed_N)")
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,120 @@
+`timescale 1ns / 1ps
+
+// gpio: OUT/SET/CLR and DIR (masked to the output-capable pins), IN after
+// the synchroniser, rising/falling edge flags with their enables and W1C,
+// level interrupts, and the debouncer ignoring a bouncing button until it
+// has been stable for three samples.
+module gpio_tb;
+    reg clk = 0;
+    always #5 clk = ~clk;
+    reg rst_n;
+
+    reg         wr;
+    reg  [7:0]  addr;
+    reg  [31:0] wdata;
+    wire [31:0] rdata;
+    reg  [2:0]  ext;                // btn0, sw[1:0] stand-ins
+    wire [6:0]  pin_o, pin_oe;
+    wire [3:0]  led = (pin_oe[3:0] & pin_o[3:0]) | (~pin_oe[3:0] & 4'b1010);
+    wire        irq;
+
+    gpio #(.W(7), .OUT_MASK(7'b000_1111)) dut (
+        .clk(clk), .rst_n(rst_n),
+        .wr(wr), .addr(addr), .wdata(wdata), .rdata(rdata),
+        .pin_i({ext, led}), .pin_o(pin_o), .pin_oe(pin_oe), .irq(irq)
+    );
+
+    localparam         TB_NAME    = "gpio_tb";
+    localparam integer TB_TIMEOUT = 1_000_000;
+    `define TB_IO_REGS
+    `include "tb_common.vh"
+
+    integer    i;
+    reg [31:0] r0, r1;
+
+    initial begin
+        wr = 0; addr = 0; wdata = 0; ext = 0;
+        rst_n = 0;
+        repeat (3) @(negedge clk);
+        rst_n = 1;
+        repeat (4) @(negedge clk);
+
+        // 1. Outputs: LEDs show their function until DIR claims them
+        check(led == 4'b1010, "LEDs show their function after reset");
+        reg_rd(8'h00, r0);
+        check(r0 == 7'b000_1010, "IN reads the LED levels back");
+        reg_wr(8'h08, 32'h7F);
+        reg_rd(8'h08, r0);
+        check(r0 == 32'h0F, "DIR only on output-capable pins");
+        check(led == 4'b0000, "claimed LEDs follow OUT");
+        reg_wr(8'h0C, 32'h5);
+        check(led == 4'b0101, "SET");
+        reg_wr(8'h10, 32'h4);
+        reg_rd(8'h04, r0);
+        check(led == 4'b0001 && r0 == 32'h1, "CLR");
+        reg_wr(8'h08, 32'h0);
+        check(led == 4'b1010, "DIR 0 gives the LEDs back");
+
+        // 2. Edge flags on btn0 (pin 4)
+        reg_wr(8'h14, 32'h10);                      // rising on btn0
+        reg_wr(8'h18, 32'h10);                      // falling on btn0
+        ext[0] = 1'b1;
+        repeat (4) @(negedge clk);
+        reg_rd(8'h00, r0);
+        check((r0 & 32'h10) != 0, "IN follows btn0");
+        reg_rd(8'h24, r0);
+        check(r0 == 32'h0000_0010 && irq, "rising flag + irq");
+        reg_wr(8'h24, 32'h10);
+        reg_rd(8'h24, r0);
+        check(!irq && r0 == 0, "W1C");
+        ext[0] = 1'b0;
+        repeat (4) @(negedge clk);
+        reg_rd(8'h24, r0);
+        check(r0 == 32'h0010_0000 && irq, "falling flag");
+        reg_wr(8'h24, 32'h0010_0000);
+        ext[1] = 1'b1;                              // sw0: no enable
+        repeat (4) @(negedge clk);
+        reg_rd(8'h24, r0);
+        check(r0 == 0 && !irq, "no flag without an enable");
+        reg_wr(8'h14, 32'h0);
+        reg_wr(8'h18, 32'h0);
+
+        // 3. Level interrupts on sw0 (pin 5, currently high)
+        reg_wr(8'h1C, 32'h20);
+        check(irq, "HIGH level irq");
+        ext[1] = 1'b0;
+        repeat (4) @(negedge clk);
+        check(!irq, "level irq follows the pin");
+        reg_wr(8'h1C, 32'h0);
+        reg_wr(8'h20, 32'h20);
+        check(irq, "LOW level irq");
+        reg_wr(8'h20, 32'h0);
+        check(!irq, "level irq disabled");
+
+        // 4. Debounce btn0: samples every 11 cycles, bounce with 3-cycle
+        //    highs every 8 cycles (never high on two samples in a row)
+        reg_wr(8'h2C, 32'd10);
+        reg_wr(8'h28, 32'h10);
+        reg_wr(8'h14, 32'h10);
+        for (i = 0; i < 12; i = i + 1) begin
+            ext[0] = 1'b1;
+            repeat (3) @(negedge clk);
+            ext[0] = 1'b0;
+            repeat (5) @(negedge clk);
+        end
+        repeat (60) @(negedge clk);
+        reg_rd(8'h00, r0);
+        reg_rd(8'h24, r1);
+        check(!(r0 & 32'h10) && r1 == 0, "bounce filtered");
+        ext[0] = 1'b1;
+        repeat (15) @(negedge clk);
+        reg_rd(8'h00, r0);
+        check(!(r0 & 32'h10), "not accepted after one sample");
+        repeat (30) @(negedge clk);
+        reg_rd(8'h00, r0);
+        reg_rd(8'h24, r1);
+        check((r0 & 32'h10) && r1 == 32'h10, "accepted once stable");
+
+        tb_finish;
+    end
+endmodule
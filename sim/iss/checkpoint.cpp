@@ -0,0 +1,108 @@
+// Checkpoint save / restore; see checkpoint.h.
+#include "checkpoint.h"
+#include "memmap.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+namespace iss {
+
+namespace {
+
+constexpr uint32_t CSR_MIP = 0x344;
+
+}  // namespace
+
+bool save_checkpoint(const std::string& dir, const Cpu& cpu, const Soc& soc) {
+    mkdir(dir.c_str(), 0777);               // may exist; fopen reports the rest
+    const std::string d = dir + "/";
+
+    if (!soc.save_hex(d + "instr_mem.vh", MEMMAP_ITCM_BASE, false) ||
+        !soc.save_hex(d + "dtcm_mem.vh", MEMMAP_DTCM_BASE, false) ||
+        !soc.save_hex(d + "ext_mem.vh", MEMMAP_EXT_BASE, true) ||
+        !soc.save_hex(d + "flash_mem.vh", MEMMAP_FLASH_BASE, true))
+        return false;
+
+    uint32_t w[WARM_WORDS];
+    std::memset(w, 0, sizeof(w));
+    for (unsigned i = 1; i < 32; i++)
+        w[WARM_X + i] = cpu.x[i];
+    w[WARM_PC]          = cpu.pc;
+    w[WARM_MSTATUS]     = cpu.mstatus;
+    w[WARM_MIE]         = cpu.mie;
+    w[WARM_MTVEC]       = cpu.mtvec;
+    w[WARM_MSCRATCH]    = cpu.mscratch;
+    w[WARM_MEPC]        = cpu.mepc;
+    w[WARM_MCAUSE]      = cpu.mcause;
+    w[WARM_MIP]         = cpu.mip;
+    w[WARM_MTIME_LO]    = uint32_t(cpu.mtime());
+    w[WARM_MTIME_HI]    = uint32_t(cpu.mtime() >> 32);
+    w[WARM_MTIMECMP_LO] = uint32_t(cpu.mtimecmp);
+    w[WARM_MTIMECMP_HI] = uint32_t(cpu.mtimecmp >> 32);
+    w[WARM_INSTRET_LO]  = uint32_t(cpu.instret);
+    w[WARM_INSTRET_HI]  = uint32_t(cpu.instret >> 32);
+    soc.save_io(w);
+
+    FILE* f = std::fopen((d + "warm_core.vh").c_str(), "w");
+    if (!f)
+        return false;
+    for (unsigned i = 0; i < WARM_WORDS; i++)
+        std::fprintf(f, "%08x\n", w[i]);
+    return std::fclose(f) == 0;
+}
+
+bool load_checkpoint(const std::string& dir, Cpu& cpu, Soc& soc) {
+    const std::string d = dir.empty() ? "" : dir + "/";
+    std::ifstream in(d + "warm_core.vh");
+    if (!in)
+        return false;
+    uint32_t w[WARM_WORDS];
+    std::memset(w, 0, sizeof(w));
+    std::string tok;
+    for (unsigned i = 0; i < WARM_WORDS && in >> tok; i++)
+        w[i] = uint32_t(std::strtoul(tok.c_str(), nullptr, 16));
+    if (!soc.load_hex(d + "dtcm_mem.vh", MEMMAP_DTCM_BASE))
+        return false;
+
+    cpu.reset(w[WARM_PC]);
+    for (unsigned i = 1; i < 32; i++)
+        cpu.x[i] = w[WARM_X + i];
+    cpu.mstatus  = w[WARM_MSTATUS];
+    cpu.mie      = w[WARM_MIE];
+    cpu.mtvec    = w[WARM_MTVEC];
+    cpu.mscratch = w[WARM_MSCRATCH];
+    cpu.mepc     = w[WARM_MEPC];
+    cpu.mcause   = w[WARM_MCAUSE];
+    cpu.csr_write(CSR_MIP, w[WARM_MIP]);
+    cpu.mtimecmp = uint64_t(w[WARM_MTIMECMP_HI]) << 32 | w[WARM_MTIMECMP_LO];
+    cpu.set_mtime(uint64_t(w[WARM_MTIME_HI]) << 32 | w[WARM_MTIME_LO]);
+    soc.restore_io(w);
+    cpu.wake();
+    return true;
+}
+
+bool parse_marker(const std::string& s, const ElfImage* elf, uint32_t* pc,
+                  uint64_t* count) {
+    const size_t colon = s.find(':');
+    const std::string where = s.substr(0, colon);
+    char* end;
+    *count = 1;
+    if (colon != std::string::npos) {
+        const char* p = s.c_str() + colon + 1;
+        unsigned long long n = std::strtoull(p, &end, 0);
+        if (end == p || *end != '\0' || n == 0)
+            return false;
+        *count = n;
+    }
+    unsigned long v = std::strtoul(where.c_str(), &end, 0);
+    if (!where.empty() && *end == '\0' && v <= 0xFFFFFFFFul) {
+        *pc = uint32_t(v);
+        return true;
+    }
+    return elf && elf->symbol(where, pc);
+}
+
+}  // namespace iss
@@ -0,0 +1,75 @@
+// Checkpoints: the architectural state of the SoC at a marker, written as
+// a run directory that any of the simulators can start from instead of
+// reset (warm start), so a late phase of the firmware runs on the RTL
+// without re-executing everything before it.
+//
+// A checkpoint directory holds
+//   instr_mem.vh  ITCM, whole           } $readmemh images under the names
+//   dtcm_mem.vh   DTCM, whole           } the cold runs use (only a warm
+//   ext_mem.vh    external memory       } start loads dtcm_mem.vh)
+//   flash_mem.vh  QSPI flash            }
+//   warm_core.vh  one hex word per line, indices WARM_* below
+// and is taken in front of the marker instruction: pc is the marker and it
+// has not executed yet.
+//
+// State outside the list below restarts from reset: TIMER, DMA, MBOX, SEMA,
+// CRC, GPIO and the UART receiver. Take checkpoints where the firmware has
+// configured them but nothing is in flight (e.g. at the start of a task
+// body), or re-initialise them after the marker. Bytes still in the UART
+// TX FIFO at the marker are sent again by the warm run, so its FIFO level
+// and TX-low interrupts carry on as before.
+//
+// sim/warm_start.vh loads warm_core.vh into cpu_top (RTL runs with --warm /
+// +warm); load_checkpoint() into the ISS.
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "elf.h"
+#include "rv32_iss.h"
+#include "soc.h"
+
+#include <cstdint>
+#include <string>
+
+namespace iss {
+
+// warm_core.vh word indices (sim/warm_start.vh uses the same)
+enum : unsigned {
+    WARM_X             = 0x00,  // x0..x31
+    WARM_PC            = 0x20,
+    WARM_MSTATUS       = 0x21,
+    WARM_MIE           = 0x22,
+    WARM_MTVEC         = 0x23,
+    WARM_MSCRATCH      = 0x24,
+    WARM_MEPC          = 0x25,
+    WARM_MCAUSE        = 0x26,
+    WARM_MIP           = 0x27,  // software-writable bits only
+    WARM_MTIME_LO      = 0x28,
+    WARM_MTIME_HI      = 0x29,
+    WARM_MTIMECMP_LO   = 0x2A,
+    WARM_MTIMECMP_HI   = 0x2B,
+    WARM_INSTRET_LO    = 0x2C,  // instructions before the marker (report only)
+    WARM_INSTRET_HI    = 0x2D,
+    WARM_UART_CTRL     = 0x30,
+    WARM_UART_BAUD     = 0x31,
+    WARM_IRQ_ENABLE    = 0x32,
+    WARM_UART_TX_COUNT = 0x33,  // bytes queued for TX, oldest first at
+    WARM_UART_TX       = 0x40,  //   WARM_UART_TX, one per word
+    WARM_WORDS         = 0x140
+};
+
+// Write dir/ (created if missing) from the current state
+bool save_checkpoint(const std::string& dir, const Cpu& cpu, const Soc& soc);
+
+// Restore warm_core.vh and dtcm_mem.vh from dir into a reset Cpu and a Soc
+// that has already loaded the images (load_hex) from the same directory
+bool load_checkpoint(const std::string& dir, Cpu& cpu, Soc& soc);
+
+// "PC" or "PC:N": stop in front of the Nth execution (default 1) of PC,
+// which may also be a symbol of elf (nullptr: numbers only)
+bool parse_marker(const std::string& s, const ElfImage* elf, uint32_t* pc,
+                  uint64_t* count);
+
+}  // namespace iss
+
+#endif  // CHECKPOINT_H
@@ -0,0 +1,223 @@
+// Lockstep checker; see cosim.h.
+#include "cosim.h"
+#include "checkpoint.h"
+#include "memmap.h"
+
+#include <cstring>
+
+namespace iss {
+
+namespace {
+
+constexpr uint32_t CSR_MIP = 0x344;
+
+const char* const ABI[32] = {
+    "zero", "ra", "sp", "gp", "tp", "t0", "t1", "t2",
+    "s0",   "s1", "a0", "a1", "a2", "a3", "a4", "a5",
+    "a6",   "a7", "s2", "s3", "s4", "s5", "s6", "s7",
+    "s8",   "s9", "s10", "s11", "t3", "t4", "t5", "t6",
+};
+
+inline uint32_t lanes(uint8_t mask) {
+    uint32_t m = 0;
+    for (unsigned i = 0; i < 4; i++)
+        if (mask & (1u << i))
+            m |= 0xFFu << (8 * i);
+    return m;
+}
+
+// The ISS record in trace form, for comparing and printing
+Rvfi from_iss(const Retire& s, bool intr) {
+    Rvfi v;
+    std::memset(&v, 0, sizeof(v));
+    v.insn      = s.insn;
+    v.trap      = s.trap;
+    v.intr      = intr;
+    v.pc_rdata  = s.pc;
+    v.pc_wdata  = s.next_pc;
+    v.rd_addr   = s.rd;
+    v.rd_wdata  = s.rd_val;
+    v.mem_rmask = s.mem_rmask;
+    v.mem_wmask = s.mem_wmask;
+    v.mem_addr  = (s.mem_rmask | s.mem_wmask) ? s.mem_addr & ~3u : 0;
+    v.mem_rdata = s.mem_rmask ? s.mem_rdata : 0;
+    v.mem_wdata = s.mem_wmask ? s.mem_wdata : 0;
+    return v;
+}
+
+void print_rec(FILE* f, const char* who, const Rvfi& r) {
+    std::fprintf(f, "[COSIM]   %s  %08x  %08x  -> %08x", who, r.pc_rdata, r.insn, r.pc_wdata);
+    if (r.rd_addr)
+        std::fprintf(f, "  x%u = %08x", r.rd_addr, r.rd_wdata);
+    if (r.mem_rmask)
+        std::fprintf(f, "  [%08x]/%x -> %08x", r.mem_addr, r.mem_rmask, r.mem_rdata);
+    if (r.mem_wmask)
+        std::fprintf(f, "  [%08x]/%x <- %08x", r.mem_addr, r.mem_wmask, r.mem_wdata);
+    if (r.trap)
+        std::fputs("  trap", f);
+    if (r.intr)
+        std::fputs("  intr", f);
+    std::fputc('\n', f);
+}
+
+}  // namespace
+
+Lockstep::Lockstep(FILE* log) : cpu_(soc_), log_(log) {
+    soc_.console = nullptr;             // the RTL UART is the one that prints
+    cpu_.auto_irq = false;
+    std::memset(rtl_x_, 0, sizeof(rtl_x_));
+}
+
+bool Lockstep::load(const std::string& itcm, const std::string& ext,
+                    const std::string& flash) {
+    if (!soc_.load_hex(itcm, MEMMAP_ITCM_BASE))
+        return false;
+    soc_.load_hex(ext, MEMMAP_EXT_BASE);
+    soc_.load_hex(flash, MEMMAP_FLASH_BASE);
+    return true;
+}
+
+bool Lockstep::warm(const std::string& dir) {
+    if (!load_checkpoint(dir, cpu_, soc_))
+        return false;
+    std::memcpy(rtl_x_, cpu_.x, sizeof(rtl_x_));
+    return true;
+}
+
+bool Lockstep::checkpoint(const std::string& dir, uint64_t mtime) {
+    cpu_.set_mtime(mtime);
+    return save_checkpoint(dir, cpu_, soc_);
+}
+
+bool Lockstep::retire(const Rvfi& r, uint32_t irq_cause, const CsrState* csr,
+                      uint64_t cycle) {
+    Retire s;
+    std::memset(&s, 0, sizeof(s));
+
+    if (r.order != checked_) {
+        report(r, nullptr, csr, cycle, "gap in the retirement order");
+        return false;
+    }
+
+    // The operands the RTL used against its own register state (forwarding)
+    bool operands_ok = (!r.rs1_addr || r.rs1_rdata == rtl_x_[r.rs1_addr]) &&
+                       (!r.rs2_addr || r.rs2_rdata == rtl_x_[r.rs2_addr]);
+
+    // A handler entered without a trap is an interrupt the RTL took in front
+    // of this instruction: take it on the ISS at the same point
+    bool intr = r.intr && !prev_trap_;
+    if (intr) {
+        cpu_.interrupt(irq_cause);
+        interrupts_++;
+    }
+    cpu_.step(&s);
+
+    // Values from outside the core come from the RTL
+    bool outside = false;
+    if (s.mem_rmask) {
+        uint32_t a = s.mem_addr;
+        bool word = s.mem_rmask == 0xF;
+        outside = a == CLINT_MTIME_LO || a == CLINT_MTIME_HI ||
+                  (!soc_.region[a >> 28].mem &&
+                   !(word && (a == CLINT_MTIMECMP_LO || a == CLINT_MTIMECMP_HI ||
+                              a == CSR_MTVEC_ADDR || a == CSR_MSTATUS_ADDR ||
+                              a == CSR_MEPC_ADDR || a == CSR_MCAUSE_ADDR)));
+    } else if ((s.insn & 0x7F) == 0x73 && ((s.insn >> 12) & 7) != 0 &&
+               (s.insn >> 20) == CSR_MIP) {
+        outside = true;
+    }
+    if (outside) {
+        if (s.rd && s.rd == r.rd_addr) {
+            cpu_.x[s.rd] = r.rd_wdata;
+            s.rd_val     = r.rd_wdata;
+        }
+        s.mem_rdata = r.mem_rdata;
+    }
+
+    if (r.rd_addr)
+        rtl_x_[r.rd_addr] = r.rd_wdata;
+
+    Rvfi v = from_iss(s, intr || prev_trap_);
+    uint32_t rl = lanes(r.mem_rmask), wl = lanes(r.mem_wmask);
+    const char* what = nullptr;
+    if (v.pc_rdata != r.pc_rdata)
+        what = intr ? "interrupt taken at a different pc" : "pc";
+    else if (v.insn != r.insn)
+        what = "instruction word";
+    else if (v.intr != r.intr)
+        what = "trap handler entry flag";
+    else if (!operands_ok)
+        what = "source operand differs from the RTL register file (forwarding)";
+    else if (v.pc_wdata != r.pc_wdata)
+        what = "next pc";
+    else if (v.trap != r.trap)
+        what = "trap";
+    else if (v.rd_addr != r.rd_addr || v.rd_wdata != r.rd_wdata)
+        what = "destination register";
+    else if (v.mem_rmask != r.mem_rmask || v.mem_wmask != r.mem_wmask ||
+             ((r.mem_rmask | r.mem_wmask) && v.mem_addr != r.mem_addr))
+        what = "memory access";
+    else if ((v.mem_rdata ^ r.mem_rdata) & rl)
+        what = "load data";
+    else if ((v.mem_wdata ^ r.mem_wdata) & wl)
+        what = "store data";
+    else if (csr && (csr->mstatus  != cpu_.mstatus  || csr->mie    != cpu_.mie  ||
+                     csr->mtvec    != cpu_.mtvec    || csr->mepc   != cpu_.mepc ||
+                     csr->mscratch != cpu_.mscratch || csr->mcause != cpu_.mcause))
+        what = "CSR state";
+
+    if (what) {
+        report(r, &s, csr, cycle, what);
+        return false;
+    }
+    prev_trap_ = r.trap;
+    checked_++;
+    return true;
+}
+
+void Lockstep::report(const Rvfi& r, const Retire* s, const CsrState* csr,
+                      uint64_t cycle, const char* what) {
+    std::fprintf(log_, "\n[COSIM] DIVERGENCE at instruction %llu (cycle %llu): %s\n",
+                 (unsigned long long)r.order, (unsigned long long)cycle, what);
+    print_rec(log_, "RTL", r);
+    if (s)
+        print_rec(log_, "ISS", from_iss(*s, r.intr));
+    if (r.rs1_addr || r.rs2_addr)
+        std::fprintf(log_, "[COSIM]   RTL operands  x%u = %08x  x%u = %08x\n",
+                     r.rs1_addr, r.rs1_rdata, r.rs2_addr, r.rs2_rdata);
+
+    std::fprintf(log_, "[COSIM] registers after it (RTL, ISS; * = differs):\n");
+    for (unsigned i = 0; i < 16; i++) {
+        std::fprintf(log_, "[COSIM]   ");
+        for (unsigned j = i; j < 32; j += 16)
+            std::fprintf(log_, "%c x%-2u %-4s %08x %08x    ",
+                         rtl_x_[j] != cpu_.x[j] ? '*' : ' ', j, ABI[j],
+                         rtl_x_[j], cpu_.x[j]);
+        std::fputc('\n', log_);
+    }
+
+    const struct {
+        const char* name;
+        uint32_t    iss;
+        uint32_t    rtl;
+    } csrs[] = {
+        {"mstatus",  cpu_.mstatus,  csr ? csr->mstatus  : 0},
+        {"mie",      cpu_.mie,      csr ? csr->mie      : 0},
+        {"mtvec",    cpu_.mtvec,    csr ? csr->mtvec    : 0},
+        {"mscratch", cpu_.mscratch, csr ? csr->mscratch : 0},
+        {"mepc",     cpu_.mepc,     csr ? csr->mepc     : 0},
+        {"mcause",   cpu_.mcause,   csr ? csr->mcause   : 0},
+    };
+    std::fprintf(log_, "[COSIM] CSRs (RTL, ISS%s):\n",
+                 csr ? "" : "; RTL not comparable on this edge");
+    for (const auto& c : csrs) {
+        if (csr)
+            std::fprintf(log_, "[COSIM]   %c %-8s %08x %08x\n",
+                         c.rtl != c.iss ? '*' : ' ', c.name, c.rtl, c.iss);
+        else
+            std::fprintf(log_, "[COSIM]     %-8s -------- %08x\n", c.name, c.iss);
+    }
+    std::fflush(log_);
+}
+
+}  // namespace iss
@@ -0,0 +1,95 @@
+// Lockstep checking of the cpu_core.v retirement trace (its rvfi_* port)
+// against the ISS: every retired instruction is stepped on the ISS and the
+// two records compared, stopping at the first divergence with a register
+// and CSR diff.
+//
+// The RTL is the reference for everything from outside the core:
+//   - interrupts: the ISS takes one (Cpu::interrupt) exactly where the trace
+//     enters a handler without a trap; the ISS never decides on its own
+//   - IO loads, mtime and mip reads: the ISS executes them (device side
+//     effects stay in step) but the value is taken from the trace
+// Memory is not: loads from ITCM/DTCM/EXT/flash must return what the ISS
+// holds, so a lost or late store shows up as a divergence. The ISS runs
+// DMA transfers to completion when they start; firmware that reads a
+// destination before polling DONE diverges on purpose.
+#ifndef COSIM_H
+#define COSIM_H
+
+#include "rv32_iss.h"
+#include "soc.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace iss {
+
+// One rvfi_* record (see the port list in cpu_core.v)
+struct Rvfi {
+    uint64_t order;
+    uint32_t insn;
+    bool     trap;
+    bool     intr;          // first instruction of a trap handler
+    uint32_t pc_rdata;
+    uint32_t pc_wdata;
+    uint8_t  rs1_addr;
+    uint8_t  rs2_addr;
+    uint32_t rs1_rdata;
+    uint32_t rs2_rdata;
+    uint8_t  rd_addr;
+    uint32_t rd_wdata;
+    uint32_t mem_addr;      // word address
+    uint8_t  mem_rmask;
+    uint8_t  mem_wmask;
+    uint32_t mem_rdata;
+    uint32_t mem_wdata;
+};
+
+// The CSRs both sides hold (mip is live and compared through reads only)
+struct CsrState {
+    uint32_t mstatus, mie, mtvec, mscratch, mepc, mcause;
+};
+
+class Lockstep {
+public:
+    explicit Lockstep(FILE* log = stdout);
+
+    // Same images as the RTL run; ITCM required, the others optional
+    bool load(const std::string& itcm, const std::string& ext,
+              const std::string& flash);
+    // Or the executable the RTL memories were loaded from (--elf)
+    bool load_elf(const ElfImage& elf) { return soc_.load_elf(elf); }
+    // After load(): start from the checkpoint in dir, as the RTL does
+    bool warm(const std::string& dir);
+    // Save the ISS state, with the RTL's mtime, as a checkpoint; the ISS is
+    // in step with the RTL's architectural state after every retire()
+    bool checkpoint(const std::string& dir, uint64_t mtime);
+    // Next instruction to execute (checkpoint markers)
+    uint32_t pc() const { return cpu_.pc; }
+
+    // Check the next retirement. irq_cause is the mcause of the last
+    // interrupt the RTL took; csr is the RTL CSR file right after this
+    // instruction, or nullptr when a trap entry / mret in ID changed it on
+    // the same edge. Returns false at the first divergence (reported).
+    bool retire(const Rvfi& r, uint32_t irq_cause, const CsrState* csr,
+                uint64_t cycle);
+
+    uint64_t checked() const { return checked_; }
+    uint64_t interrupts() const { return interrupts_; }
+
+private:
+    void report(const Rvfi& r, const Retire* s, const CsrState* csr,
+                uint64_t cycle, const char* what);
+
+    Soc      soc_;
+    Cpu      cpu_;
+    FILE*    log_;
+    uint32_t rtl_x_[32];    // RTL registers, rebuilt from the trace
+    bool     prev_trap_  = false;
+    uint64_t checked_    = 0;
+    uint64_t interrupts_ = 0;
+};
+
+}  // namespace iss
+
+#endif  // COSIM_H
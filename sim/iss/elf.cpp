@@ -0,0 +1,104 @@
+// ELF loading; see elf.h.
+#include "elf.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace iss {
+
+namespace {
+
+constexpr uint16_t EM_RISCV    = 243;
+constexpr uint32_t PT_LOAD     = 1;
+constexpr uint32_t SHT_SYMTAB  = 2;
+constexpr unsigned STT_SECTION = 3;
+constexpr unsigned STT_FILE    = 4;
+constexpr unsigned STB_LOCAL   = 0;
+
+uint16_t rd16(const std::vector<uint8_t>& f, size_t off) {
+    uint16_t v = 0;
+    if (off + 2 <= f.size())
+        std::memcpy(&v, &f[off], 2);
+    return v;
+}
+
+uint32_t rd32(const std::vector<uint8_t>& f, size_t off) {
+    uint32_t v = 0;
+    if (off + 4 <= f.size())
+        std::memcpy(&v, &f[off], 4);
+    return v;
+}
+
+}  // namespace
+
+bool ElfImage::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error_ = path + ": cannot open";
+        return false;
+    }
+    const std::vector<uint8_t> f((std::istreambuf_iterator<char>(in)),
+                                 std::istreambuf_iterator<char>());
+    if (f.size() < 52 || std::memcmp(f.data(), "\x7f" "ELF", 4) != 0 ||
+        f[4] != 1 || f[5] != 1 || rd16(f, 18) != EM_RISCV) {
+        error_ = path + ": not a 32-bit little-endian RISC-V ELF";
+        return false;
+    }
+
+    entry = rd32(f, 24);
+    const uint32_t phoff = rd32(f, 28), shoff = rd32(f, 32);
+    const uint16_t phentsize = rd16(f, 42), phnum = rd16(f, 44);
+    const uint16_t shentsize = rd16(f, 46), shnum = rd16(f, 48);
+
+    segments.clear();
+    for (unsigned i = 0; i < phnum; i++) {
+        const size_t ph = phoff + size_t(i) * phentsize;
+        const uint32_t offset = rd32(f, ph + 4), paddr = rd32(f, ph + 12);
+        const uint32_t filesz = rd32(f, ph + 16);
+        if (rd32(f, ph) != PT_LOAD || !filesz)
+            continue;
+        if (size_t(offset) + filesz > f.size()) {
+            error_ = path + ": truncated segment";
+            return false;
+        }
+        segments.push_back({paddr, std::vector<uint8_t>(f.begin() + offset,
+                                                        f.begin() + offset + filesz)});
+    }
+
+    // Symbols: the one .symtab (stripped files have none, which is fine)
+    symbols_.clear();
+    for (unsigned i = 0; i < shnum; i++) {
+        const size_t sh = shoff + size_t(i) * shentsize;
+        if (rd32(f, sh + 4) != SHT_SYMTAB)
+            continue;
+        const uint32_t off = rd32(f, sh + 16), size = rd32(f, sh + 20);
+        const uint32_t link = rd32(f, sh + 24);
+        const size_t   str  = rd32(f, shoff + size_t(link) * shentsize + 16);
+        for (uint32_t s = 16; s + 16 <= size; s += 16) {     // entry 0 is null
+            const uint32_t name  = rd32(f, off + s);
+            const uint32_t value = rd32(f, off + s + 4);
+            const unsigned info  = off + s + 12 < f.size() ? f[off + s + 12] : 0;
+            if (!name || !rd16(f, off + s + 14) ||            // SHN_UNDEF
+                (info & 15) == STT_SECTION || (info & 15) == STT_FILE ||
+                str + name >= f.size())
+                continue;
+            const char* p = reinterpret_cast<const char*>(&f[str + name]);
+            const std::string sym(p, strnlen(p, f.size() - str - name));
+            // A global wins over a local of the same name
+            if ((info >> 4) != STB_LOCAL || !symbols_.count(sym))
+                symbols_[sym] = value;
+        }
+    }
+    return true;
+}
+
+bool ElfImage::symbol(const std::string& name, uint32_t* value) const {
+    auto it = symbols_.find(name);
+    if (it == symbols_.end())
+        return false;
+    *value = it->second;
+    return true;
+}
+
+}  // namespace iss
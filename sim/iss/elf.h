@@ -0,0 +1,40 @@
+// RV32 ELF executables for the simulators: the loadable segments at their
+// load addresses (what the $readmemh images would hold, without going
+// through objcopy / make_hex.py) and the symbol table, so markers can be
+// given by name.
+#ifndef ELF_H
+#define ELF_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace iss {
+
+class ElfImage {
+public:
+    struct Segment {
+        uint32_t             addr;      // load (physical) address
+        std::vector<uint8_t> data;      // file contents; the rest of memsz is NOLOAD
+    };
+
+    // Read a 32-bit little-endian executable; false with error() set
+    bool load(const std::string& path);
+
+    // Symbol value by name (functions, objects, linker-script labels)
+    bool symbol(const std::string& name, uint32_t* value) const;
+
+    const std::string& error() const { return error_; }
+
+    uint32_t             entry = 0;
+    std::vector<Segment> segments;      // PT_LOAD with file contents, file order
+
+private:
+    std::map<std::string, uint32_t> symbols_;
+    std::string                     error_;
+};
+
+}  // namespace iss
+
+#endif  // ELF_H
@@ -0,0 +1,345 @@
+// Command-line driver for the ISS: loads the same images as the RTL
+// simulations and runs them with the firmware_sim_tb.sv checks (restart
+// detection, PC watchdog), printing the UART output as it is written.
+//
+// Built by run_iss.sh; run from the directory holding instr_mem.vh /
+// ext_mem.vh / flash_mem.vh (or pass --dir), or load the executable itself
+// with --elf, which also lets markers name symbols.
+//
+// --checkpoint-at / --checkpoint save the state in front of a marker
+// instruction as a run directory (sim/iss/checkpoint.h); --warm starts from
+// one instead of reset, as the RTL harnesses do.
+//
+// Exit status: 0 = ran to the limit, wrote the checkpoint or saw the
+// --until output, 1 = watchdog or restart limit,
+// 2 = bad arguments or a missing image. A write to the sim_ctrl EXIT
+// register ends the run with that code instead (low byte, nonzero kept
+// nonzero).
+
+#include "rv32_iss.h"
+#include "soc.h"
+#include "checkpoint.h"
+#include "memmap.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Options {
+    uint64_t    insns        = UINT64_MAX;
+    uint64_t    cycles       = 10000000;  // same default as the RTL runs
+    uint64_t    stuck        = 1000000;
+    unsigned    max_restarts = 3;
+    bool        timing       = false;
+    std::string dir;
+    std::string itcm  = "instr_mem.vh";
+    std::string ext   = "ext_mem.vh";
+    std::string flash = "flash_mem.vh";
+    std::string elf;
+    std::string trace;
+    std::string signature;
+    uint64_t    sig_begin    = 0;
+    uint64_t    sig_end      = 0;
+    bool        warm         = false;
+    std::string checkpoint;
+    std::string mark;                     // --checkpoint-at, resolved after loading
+    std::vector<std::string> until;
+    uint32_t    mark_pc      = ~0u;
+    uint64_t    mark_count   = 0;
+};
+
+void usage(const char* prog) {
+    std::fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --cycles N        stop after N modelled cycles (default 10000000)\n"
+        "  --insns N         stop after N instructions\n"
+        "  --timing          charge pipeline and memory latencies (cycle estimate);\n"
+        "                    otherwise one cycle per instruction\n"
+        "  --stuck N         PC watchdog: halt when PC holds for N cycles (default\n"
+        "                    1000000, 0 = off)\n"
+        "  --max-restarts N  stop after N+1 jumps back to 0 (default 3)\n"
+        "  --dir DIR         directory with the images\n"
+        "  --itcm FILE       ITCM image (default instr_mem.vh)\n"
+        "  --ext FILE        external memory image (default ext_mem.vh, optional)\n"
+        "  --flash FILE      flash image (default flash_mem.vh, optional)\n"
+        "  --elf FILE        load the executable's segments instead of the images\n"
+        "  --trace FILE      write one line per instruction ('-' = stdout)\n"
+        "  --signature FILE  at the end, dump the words in [--sig-begin, --sig-end)\n"
+        "                    one per line (riscv-arch-test signature format)\n"
+        "  --warm            start from the checkpoint in the image directory\n"
+        "  --checkpoint DIR  write a checkpoint to DIR at the marker and stop\n"
+        "  --checkpoint-at PC[:N]  marker: in front of the Nth execution of PC\n"
+        "                    (an address, or a symbol with --elf)\n"
+        "  --until TEXT      stop once TEXT has been printed (repeatable: all of them)\n",
+        prog);
+}
+
+bool parse_u64(const char* s, uint64_t* out) {
+    char* end;
+    unsigned long long v = std::strtoull(s, &end, 0);
+    if (*s == '\0' || *end != '\0')
+        return false;
+    *out = v;
+    return true;
+}
+
+bool parse_args(int argc, char** argv, Options* o) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "-h" || a == "--help")
+            return false;
+        if (a == "--timing") {
+            o->timing = true;
+            continue;
+        }
+        if (a == "--warm") {
+            o->warm = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "%s: missing value\n", a.c_str());
+            return false;
+        }
+        const char* v = argv[++i];
+        uint64_t n;
+        if (a == "--dir") {
+            o->dir = v;
+        } else if (a == "--itcm") {
+            o->itcm = v;
+        } else if (a == "--ext") {
+            o->ext = v;
+        } else if (a == "--flash") {
+            o->flash = v;
+        } else if (a == "--elf") {
+            o->elf = v;
+        } else if (a == "--trace") {
+            o->trace = v;
+        } else if (a == "--signature") {
+            o->signature = v;
+        } else if (a == "--checkpoint") {
+            o->checkpoint = v;
+        } else if (a == "--checkpoint-at") {
+            o->mark = v;
+        } else if (a == "--until") {
+            o->until.push_back(v);
+        } else if (!parse_u64(v, &n)) {
+            std::fprintf(stderr, "%s: bad number '%s'\n", a.c_str(), v);
+            return false;
+        } else if (a == "--cycles") {
+            o->cycles = n;
+        } else if (a == "--insns") {
+            o->insns = n;
+        } else if (a == "--stuck") {
+            o->stuck = n;
+        } else if (a == "--max-restarts") {
+            o->max_restarts = unsigned(n);
+        } else if (a == "--sig-begin") {
+            o->sig_begin = n;
+        } else if (a == "--sig-end") {
+            o->sig_end = n;
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", a.c_str());
+            return false;
+        }
+    }
+    if (o->checkpoint.empty() != o->mark.empty()) {
+        std::fprintf(stderr, "--checkpoint and --checkpoint-at go together\n");
+        return false;
+    }
+    return true;
+}
+
+void trace_line(FILE* f, uint64_t cycle, const iss::Retire& r) {
+    if (r.intr)
+        std::fprintf(f, "%10llu  -- interrupt\n", (unsigned long long)cycle);
+    std::fprintf(f, "%10llu  %08x  %08x", (unsigned long long)cycle, r.pc, r.insn);
+    if (r.rd)
+        std::fprintf(f, "  x%-2u = %08x", r.rd, r.rd_val);
+    if (r.mem_rmask)
+        std::fprintf(f, "  [%08x] -> %08x", r.mem_addr, r.mem_rdata);
+    if (r.mem_wmask)
+        std::fprintf(f, "  [%08x] <- %08x/%x", r.mem_addr, r.mem_wdata, r.mem_wmask);
+    if (r.trap)
+        std::fprintf(f, "  trap -> %08x", r.next_pc);
+    std::fputc('\n', f);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, &opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+    iss::ElfImage elf;
+    if (!opt.elf.empty() && !elf.load(opt.elf)) {
+        std::fprintf(stderr, "%s\n", elf.error().c_str());
+        return 2;
+    }
+    if (!opt.mark.empty() &&
+        !iss::parse_marker(opt.mark, opt.elf.empty() ? nullptr : &elf,
+                           &opt.mark_pc, &opt.mark_count)) {
+        std::fprintf(stderr, "--checkpoint-at: bad marker '%s' (PC, symbol, :N)\n",
+                     opt.mark.c_str());
+        return 2;
+    }
+    char cwd[4096];
+    if (!opt.checkpoint.empty() && opt.checkpoint[0] != '/' && getcwd(cwd, sizeof(cwd)))
+        opt.checkpoint = std::string(cwd) + "/" + opt.checkpoint;
+    if (!opt.dir.empty() && chdir(opt.dir.c_str()) != 0) {
+        std::perror(opt.dir.c_str());
+        return 2;
+    }
+
+    iss::Soc soc;
+    if (!opt.elf.empty()) {
+        if (!soc.load_elf(elf)) {
+            std::fprintf(stderr, "%s: segment outside the memories\n", opt.elf.c_str());
+            return 2;
+        }
+    } else if (!soc.load_hex(opt.itcm, MEMMAP_ITCM_BASE)) {
+        std::perror(opt.itcm.c_str());
+        return 2;
+    } else {
+        soc.load_hex(opt.ext, MEMMAP_EXT_BASE);         // optional
+        soc.load_hex(opt.flash, MEMMAP_FLASH_BASE);     // optional
+    }
+
+    FILE* trace = nullptr;
+    if (!opt.trace.empty()) {
+        trace = opt.trace == "-" ? stdout : std::fopen(opt.trace.c_str(), "w");
+        if (!trace) {
+            std::perror(opt.trace.c_str());
+            return 2;
+        }
+    }
+
+    for (const std::string& s : opt.until)
+        soc.until.add(s);
+
+    iss::Cpu cpu(soc);
+    cpu.timing   = opt.timing;
+    cpu.break_pc = opt.mark_pc;
+
+    std::printf("[SIM] Starting firmware simulation (ISS%s)...\n",
+                opt.timing ? ", timing model" : "");
+    std::printf("[SIM] Monitoring PC and UART output\n");
+    std::printf("[SIM] Will stop on: %u restarts OR PC stuck for %llu cycles\n",
+                opt.max_restarts, (unsigned long long)opt.stuck);
+    std::printf("========================================\n");
+
+    if (opt.warm) {
+        if (!iss::load_checkpoint(".", cpu, soc)) {
+            std::perror("warm_core.vh / dtcm_mem.vh");
+            return 2;
+        }
+        std::printf("[SIM] Warm start at PC=0x%08x\n", cpu.pc);
+    }
+
+    iss::Retire r;
+    uint64_t stuck_from = 0;
+    uint64_t hold_insns = 0;
+    uint64_t mark_hits  = 0;
+    unsigned restarts   = 0;
+    int      status     = 0;
+    bool     saved      = false;
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    while (cpu.cycles < opt.cycles && cpu.instret < opt.insns) {
+        if (trace) {
+            uint64_t cycle = cpu.cycles;
+            cpu.step(&r);
+            trace_line(trace, cycle, r);
+        } else if (cpu.run(opt.cycles, opt.insns)) {
+            break;                              // limit reached
+        }
+
+        if (soc.until.met()) {
+            std::printf("\n[SIM] Expected output seen after %llu cycles\n",
+                        (unsigned long long)cpu.cycles);
+            break;
+        }
+        if (soc.halt) {
+            std::printf("\n[SIM] Firmware exit, code %u\n", soc.exit_code);
+            status = int(soc.exit_code & 0xFF);
+            if (soc.exit_code && !status)
+                status = 1;
+            break;
+        }
+
+        if (cpu.pc == opt.mark_pc && ++mark_hits == opt.mark_count) {
+            if (!iss::save_checkpoint(opt.checkpoint, cpu, soc)) {
+                std::perror(opt.checkpoint.c_str());
+                return 2;
+            }
+            std::printf("\n[SIM] Checkpoint at PC=0x%08x (instruction %llu, cycle %llu) -> %s\n",
+                        cpu.pc, (unsigned long long)cpu.instret,
+                        (unsigned long long)cpu.cycles, opt.checkpoint.c_str());
+            saved = true;
+            break;
+        }
+
+        // run() only returns on a jump to 0 or to itself, so checking the
+        // last instruction sees every restart and every PC hold
+        uint32_t pc = cpu.pc;
+        if (pc == 0 && cpu.prev_pc != 0) {
+            std::printf("\n[SIM] !!! RESTART DETECTED !!! (count=%u, came from PC=0x%08x)\n",
+                        restarts, cpu.prev_pc);
+            if (restarts++ >= opt.max_restarts) {
+                std::printf("[SIM] Too many restarts - stopping simulation\n");
+                status = 1;
+                break;
+            }
+        }
+        if (pc != cpu.prev_pc || cpu.instret != hold_insns + 1) {
+            stuck_from = cpu.cycles;            // not the same hold as last time
+        } else if (opt.stuck && cpu.cycles - stuck_from >= opt.stuck) {
+            std::printf("\n[SIM] PC stuck at 0x%08x for %llu cycles - halting\n",
+                        pc, (unsigned long long)opt.stuck);
+            status = 1;
+            break;
+        }
+        hold_insns = cpu.instret;
+    }
+
+    double secs = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t0).count();
+    if (status == 0 && !soc.halt && !saved) {
+        std::printf("\n========================================\n");
+        std::printf("[SIM] Simulation complete (%llu cycles)\n",
+                    (unsigned long long)cpu.cycles);
+    }
+    std::fflush(stdout);
+    if (trace && trace != stdout)
+        std::fclose(trace);
+
+    if (!opt.signature.empty()) {
+        FILE* f = std::fopen(opt.signature.c_str(), "w");
+        if (!f) {
+            std::perror(opt.signature.c_str());
+            return 2;
+        }
+        for (uint64_t a = opt.sig_begin & ~3ull; a < opt.sig_end; a += 4)
+            std::fprintf(f, "%08x\n", soc.peek(uint32_t(a)));
+        std::fclose(f);
+    }
+
+    std::fprintf(stderr,
+        "[ISS] %llu instructions, %llu cycles (CPI %.2f%s), %llu UART bytes\n"
+        "[ISS] %.2f s, %.1f MIPS\n",
+        (unsigned long long)cpu.instret, (unsigned long long)cpu.cycles,
+        cpu.instret ? double(cpu.cycles) / cpu.instret : 0.0,
+        opt.timing ? ", timing model" : "",
+        (unsigned long long)soc.uart_bytes,
+        secs, secs > 0 ? cpu.instret / secs / 1e6 : 0.0);
+    return status;
+}
@@ -0,0 +1,508 @@
+// RV32I + Zicsr interpreter; see rv32_iss.h for what it models.
+#include "rv32_iss.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace iss {
+
+namespace {
+
+constexpr uint32_t MSTATUS_MIE  = 1u << 3;
+constexpr uint32_t MSTATUS_MPIE = 1u << 7;
+constexpr uint32_t MIP_MTIP     = 1u << 7;
+constexpr uint32_t MIP_MEIP     = 1u << 11;
+
+constexpr uint32_t CSR_MSTATUS  = 0x300;
+constexpr uint32_t CSR_MIE      = 0x304;
+constexpr uint32_t CSR_MTVEC    = 0x305;
+constexpr uint32_t CSR_MSCRATCH = 0x340;
+constexpr uint32_t CSR_MEPC     = 0x341;
+constexpr uint32_t CSR_MCAUSE   = 0x342;
+constexpr uint32_t CSR_MIP      = 0x344;
+constexpr uint32_t CSR_MHARTID  = 0xF14;
+
+inline uint32_t rd32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);              // little-endian host
+    return v;
+}
+
+inline int32_t sext(uint32_t v, unsigned bits) {
+    return int32_t(v << (32 - bits)) >> (32 - bits);
+}
+
+inline bool core_internal(uint32_t a) {
+    return a == CLINT_MTIME_LO || a == CLINT_MTIME_HI ||
+           a == CLINT_MTIMECMP_LO || a == CLINT_MTIMECMP_HI ||
+           a == CSR_MTVEC_ADDR || a == CSR_MSTATUS_ADDR ||
+           a == CSR_MEPC_ADDR || a == CSR_MCAUSE_ADDR;
+}
+
+inline bool system_insn(uint32_t insn) {
+    return insn == INSN_ECALL || insn == INSN_EBREAK || insn == INSN_MRET;
+}
+
+}  // namespace
+
+void Cpu::reset(uint32_t start_pc) {
+    std::memset(x, 0, sizeof(x));
+    pc        = start_pc;
+    prev_pc   = start_pc;
+    fpage_     = nullptr;
+    fpage_tag_ = ~0u;
+    mstatus   = mie = mtvec = mscratch = mepc = mcause = mip = 0;
+    mtimecmp  = UINT64_MAX;
+    cycles    = 0;
+    instret   = 0;
+    mtime_adj_      = 0;
+    attn_           = 0;
+    last_csr_       = false;
+    last_csr_rd_    = 0;
+    last_csr_num_   = 0;
+    last_csr_wrote_ = false;
+}
+
+uint32_t Cpu::csr_read(uint32_t num) const {
+    switch (num) {
+    case CSR_MSTATUS:  return mstatus;
+    case CSR_MIE:      return mie;
+    case CSR_MTVEC:    return mtvec;
+    case CSR_MSCRATCH: return mscratch;
+    case CSR_MEPC:     return mepc;
+    case CSR_MCAUSE:   return mcause;
+    case CSR_MIP:
+        return (mip & ~(MIP_MEIP | MIP_MTIP)) |
+               (bus_.irq ? MIP_MEIP : 0) |
+               (mtime() >= mtimecmp ? MIP_MTIP : 0);
+    case CSR_MHARTID:  return 0;
+    default:           return 0;
+    }
+}
+
+void Cpu::csr_write(uint32_t num, uint32_t v) {
+    attn_ = 0;
+    switch (num) {
+    case CSR_MSTATUS:  mstatus  = v; break;
+    case CSR_MIE:      mie      = v; break;
+    case CSR_MTVEC:    mtvec    = v; break;
+    case CSR_MSCRATCH: mscratch = v; break;
+    case CSR_MEPC:     mepc     = v; break;
+    case CSR_MCAUSE:   mcause   = v; break;
+    case CSR_MIP:      mip      = v & ~(MIP_MEIP | MIP_MTIP); break;
+    default: break;
+    }
+}
+
+uint32_t Cpu::irq_cause() const {
+    return (bus_.irq && (mie & MIP_MEIP)) ? CAUSE_MEI : CAUSE_MTI;
+}
+
+bool Cpu::irq_ready() {
+    if (!(mstatus & MSTATUS_MIE) || last_csr_)
+        return false;
+    bool ext   = bus_.irq && (mie & MIP_MEIP);
+    bool timer = (mie & MIP_MTIP) && mtime() >= mtimecmp;
+    return (ext || timer) && !system_insn(fetch(pc));
+}
+
+void Cpu::trap(uint32_t cause, uint32_t epc) {
+    mepc    = epc;
+    mcause  = cause;
+    mstatus = (mstatus & ~(MSTATUS_MIE | MSTATUS_MPIE)) |
+              ((mstatus & MSTATUS_MIE) ? MSTATUS_MPIE : 0);
+    pc      = mtvec;
+    attn_   = 0;
+    if (timing)
+        cycles += PEN_TRAP;
+}
+
+void Cpu::interrupt(uint32_t cause) {
+    trap(cause, pc);
+    last_csr_ = false;
+}
+
+uint32_t Cpu::fetch(uint32_t addr) {
+    // Fast path: the 4 KB page of the last fetch (reads live memory, so
+    // stores into code need no invalidation)
+    if ((addr >> 12) == fpage_tag_)
+        return rd32(fpage_ + (addr & 0xFFC));
+    const Bus::Region& R = bus_.region[addr >> 28];
+    if (!R.exec)
+        return INSN_JAL_SELF;
+    uint32_t off = addr & R.mask & ~3u;
+    if (off >= R.size)
+        return 0;
+    uint32_t page = off & ~0xFFFu;
+    if (page + 0x1000 <= R.size && R.mask >= 0xFFF) {
+        fpage_     = R.mem + page;
+        fpage_tag_ = addr >> 12;
+    }
+    return rd32(R.mem + off);
+}
+
+uint32_t Cpu::load(uint32_t addr, unsigned funct3, Retire* r) {
+    uint32_t word = 0;
+
+    if (core_internal(addr)) {
+        // Only lw reaches the CLINT / CSR window; other sizes get nothing
+        if (funct3 == 2) {
+            uint64_t t = mtime();
+            switch (addr) {
+            case CLINT_MTIME_LO:    word = uint32_t(t); break;
+            case CLINT_MTIME_HI:    word = uint32_t(t >> 32); break;
+            case CLINT_MTIMECMP_LO: word = uint32_t(mtimecmp); break;
+            case CLINT_MTIMECMP_HI: word = uint32_t(mtimecmp >> 32); break;
+            case CSR_MTVEC_ADDR:    word = mtvec; break;
+            case CSR_MSTATUS_ADDR:  word = mstatus; break;
+            case CSR_MEPC_ADDR:     word = mepc; break;
+            case CSR_MCAUSE_ADDR:   word = mcause; break;
+            }
+        }
+    } else {
+        const Bus::Region& R = bus_.region[addr >> 28];
+        if (R.mem) {
+            uint32_t off = addr & R.mask & ~3u;
+            word = off < R.size ? rd32(R.mem + off) : 0;
+            if (timing)
+                cycles += bus_.data_cycles(addr, false);
+        } else {
+            unsigned wait = 0;
+            bus_.sync(cycles, uint32_t(mtime()));
+            word = bus_.io_read(addr, cycles, &wait);
+            cycles += wait;
+            attn_ = 0;                      // irq / next_event may have moved
+            if (timing)
+                cycles += bus_.data_cycles(addr, false);
+        }
+    }
+
+    if (r) {
+        static const uint8_t rmask[8] = {1, 3, 15, 0, 1, 3, 0, 0};
+        unsigned sh = funct3 & 1 ? (addr & 2) : funct3 & 2 ? 0 : (addr & 3);
+        r->mem_addr  = addr;
+        r->mem_rmask = uint8_t(rmask[funct3] << sh);
+        r->mem_rdata = word;
+    }
+
+    switch (funct3) {
+    case 0:  return uint32_t(sext(word >> (8 * (addr & 3)), 8));
+    case 1:  return uint32_t(sext(word >> (8 * (addr & 2)), 16));
+    case 4:  return (word >> (8 * (addr & 3))) & 0xFF;
+    case 5:  return (word >> (8 * (addr & 2))) & 0xFFFF;
+    default: return word;
+    }
+}
+
+void Cpu::store(uint32_t addr, uint32_t v, unsigned funct3, Retire* r) {
+    unsigned be;
+    uint32_t wdata;
+    switch (funct3) {
+    case 0:  be = 1u << (addr & 3); wdata = (v & 0xFF) * 0x01010101u; break;
+    case 1:  be = (addr & 2) ? 0xC : 0x3; wdata = (v & 0xFFFF) * 0x00010001u; break;
+    default: be = 0xF; wdata = v; break;
+    }
+
+    if (r) {
+        r->mem_addr  = addr;
+        r->mem_wmask = uint8_t(be);
+        r->mem_wdata = wdata;
+    }
+
+    if (core_internal(addr)) {
+        if (funct3 != 2)
+            return;
+        uint64_t t = mtime();
+        switch (addr) {
+        case CLINT_MTIME_LO:
+            t = (t & ~0xFFFFFFFFull) | v;
+            mtime_adj_ = t - cycles;
+            bus_.next_event = 0;            // timer channels run on mtime
+            break;
+        case CLINT_MTIME_HI:
+            t = (t & 0xFFFFFFFFull) | (uint64_t(v) << 32);
+            mtime_adj_ = t - cycles;
+            bus_.next_event = 0;
+            break;
+        case CLINT_MTIMECMP_LO:
+            mtimecmp = (mtimecmp & ~0xFFFFFFFFull) | v;
+            break;
+        case CLINT_MTIMECMP_HI:
+            mtimecmp = (mtimecmp & 0xFFFFFFFFull) | (uint64_t(v) << 32);
+            break;
+        case CSR_MTVEC_ADDR:   mtvec   = v; break;
+        case CSR_MSTATUS_ADDR: mstatus = v; break;
+        case CSR_MEPC_ADDR:    mepc    = v; break;
+        case CSR_MCAUSE_ADDR:  mcause  = v; break;
+        }
+        attn_ = 0;
+        return;
+    }
+
+    const Bus::Region& R = bus_.region[addr >> 28];
+    if (R.mem) {
+        uint32_t off = addr & R.mask & ~3u;
+        if (R.writable && off < R.size) {
+            for (unsigned i = 0; i < 4; i++)
+                if (be & (1u << i))
+                    R.mem[off + i] = uint8_t(wdata >> (8 * i));
+        }
+        if (timing)
+            cycles += bus_.data_cycles(addr, true);
+    } else {
+        unsigned wait = 0;
+        bus_.sync(cycles, uint32_t(mtime()));
+        bus_.io_write(addr, wdata, be, cycles, &wait);
+        cycles += wait;
+        attn_ = 0;
+        if (timing)
+            cycles += bus_.data_cycles(addr, true);
+    }
+}
+
+// Inlined into run() so the nullptr Retire checks and, with Timing a
+// template argument, the timing model fold away
+template <bool Timing>
+__attribute__((always_inline)) inline void Cpu::exec(Retire* r) {
+    uint32_t insn = fetch(pc);
+    bool intr = false;
+
+    // Device events and interrupts only need a look once attn_ is due
+    if (cycles >= attn_) {
+        if (cycles >= bus_.next_event)
+            bus_.sync(cycles, uint32_t(mtime()));
+        attn_ = bus_.next_event;
+        if (mstatus & MSTATUS_MIE) {
+            bool ext   = bus_.irq && (mie & MIP_MEIP);
+            bool timer = (mie & MIP_MTIP) && mtime() >= mtimecmp;
+            if (ext || timer) {
+                attn_ = 0;                      // pending: look again next time
+                if (auto_irq && !last_csr_ && !system_insn(insn)) {
+                    trap(irq_cause(), pc);
+                    intr = true;
+                    insn = fetch(pc);
+                }
+            } else if (mie & MIP_MTIP) {
+                attn_ = std::min(attn_, mtimecmp - mtime_adj_);
+            }
+        }
+    }
+
+    if (r) {
+        std::memset(r, 0, sizeof(*r));
+        r->pc   = pc;
+        r->insn = insn;
+        r->intr = intr;
+    }
+
+    const uint32_t opcode = insn & 0x7F;
+    const uint32_t rd     = (insn >> 7) & 31;
+    const uint32_t f3     = (insn >> 12) & 7;
+    const uint32_t rs1    = (insn >> 15) & 31;
+    const uint32_t rs2    = (insn >> 20) & 31;
+    const uint32_t f7     = insn >> 25;
+    const uint32_t a      = x[rs1];
+    const uint32_t b      = x[rs2];
+    const uint32_t imm_i  = uint32_t(int32_t(insn) >> 20);
+
+    uint32_t next  = pc + 4;
+    uint32_t wval  = 0;
+    bool     wr    = false;
+    bool     csr   = false;
+    unsigned cost  = 1;
+
+    if (Timing) {
+        if (last_csr_ && last_csr_rd_ && (rs1 == last_csr_rd_ || rs2 == last_csr_rd_))
+            cost += PEN_CSR_USE;
+        else if (last_csr_ && last_csr_wrote_ &&
+                 ((opcode == 0x73 && f3 != 0 && (insn >> 20) == last_csr_num_) ||
+                  (insn == INSN_MRET && last_csr_num_ == CSR_MEPC)))
+            cost += PEN_CSR_CSR;
+        if (pc >> 28)
+            cost += bus_.fetch_cycles(pc);
+    }
+
+    switch (opcode) {
+    case 0x37:                                          // lui
+        wval = insn & 0xFFFFF000; wr = true;
+        break;
+    case 0x17:                                          // auipc
+        wval = pc + (insn & 0xFFFFF000); wr = true;
+        break;
+    case 0x6F: {                                        // jal
+        uint32_t imm = (uint32_t(sext(insn >> 31, 1)) << 20) |
+                       (insn & 0x000FF000) | ((insn >> 9) & 0x800) |
+                       ((insn >> 20) & 0x7FE);
+        wval = pc + 4; wr = true;
+        next = pc + imm;
+        break;
+    }
+    case 0x67:                                          // jalr
+        if (f3 == 0) {
+            wval = pc + 4; wr = true;
+            next = (a + imm_i) & ~1u;
+        }
+        break;
+    case 0x63: {                                        // branches
+        bool take;
+        switch (f3) {
+        case 0:  take = a == b; break;
+        case 1:  take = a != b; break;
+        case 4:  take = int32_t(a) < int32_t(b); break;
+        case 5:  take = int32_t(a) >= int32_t(b); break;
+        case 6:  take = a < b; break;
+        case 7:  take = a >= b; break;
+        default: take = false; break;
+        }
+        if (take) {
+            uint32_t imm = (uint32_t(sext(insn >> 31, 1)) << 12) |
+                           ((insn << 4) & 0x800) | ((insn >> 20) & 0x7E0) |
+                           ((insn >> 7) & 0x1E);
+            next = pc + imm;
+        }
+        break;
+    }
+    case 0x03:                                          // loads
+        if (f3 != 3 && f3 < 6) {
+            wval = load(a + imm_i, f3, r);
+            wr = true;
+        }
+        break;
+    case 0x23:                                          // stores
+        if (f3 < 3) {
+            uint32_t imm_s = uint32_t(int32_t(insn & 0xFE000000) >> 20) | ((insn >> 7) & 31);
+            store(a + imm_s, b, f3, r);
+        }
+        break;
+    case 0x13:                                          // ALU immediate
+        wr = true;
+        switch (f3) {
+        case 0: wval = a + imm_i; break;
+        case 2: wval = int32_t(a) < int32_t(imm_i); break;
+        case 3: wval = a < imm_i; break;
+        case 4: wval = a ^ imm_i; break;
+        case 6: wval = a | imm_i; break;
+        case 7: wval = a & imm_i; break;
+        case 1:
+            wr = f7 == 0;
+            wval = a << (imm_i & 31);
+            break;
+        case 5:
+            if (f7 == 0)
+                wval = a >> (imm_i & 31);
+            else if (f7 == 0x20)
+                wval = uint32_t(int32_t(a) >> (imm_i & 31));
+            else
+                wr = false;
+            break;
+        }
+        break;
+    case 0x33:                                          // ALU register
+        wr = true;
+        switch (f3) {
+        // The decoder only checks funct7 on these
+        case 0:
+            if (f7 == 0)         wval = a + b;
+            else if (f7 == 0x20) wval = a - b;
+            else                 wr = false;
+            break;
+        case 1: wr = f7 == 0; wval = a << (b & 31); break;
+        case 2: wr = f7 == 0; wval = int32_t(a) < int32_t(b); break;
+        case 3: wr = f7 == 0; wval = a < b; break;
+        case 5:
+            if (f7 == 0)         wval = a >> (b & 31);
+            else if (f7 == 0x20) wval = uint32_t(int32_t(a) >> (b & 31));
+            else                 wr = false;
+            break;
+        // ...but not on these
+        case 4: wval = a ^ b; break;
+        case 6: wval = a | b; break;
+        case 7: wval = a & b; break;
+        }
+        break;
+    case 0x0F:                                          // fence, fence.i
+        break;
+    case 0x73:                                          // SYSTEM
+        if (f3 != 0) {
+            uint32_t num = insn >> 20;
+            uint32_t old = csr_read(num);
+            uint32_t src = (f3 & 4) ? rs1 : a;          // zimm or rs1
+            bool     wcsr;
+            uint32_t nv;
+            switch (f3 & 3) {
+            case 1:  wcsr = true;     nv = src;        break;
+            case 2:  wcsr = src != 0; nv = old | src;  break;
+            case 3:  wcsr = src != 0; nv = old & ~src; break;
+            default: wcsr = false;    nv = old;        break;
+            }
+            if (wcsr)
+                csr_write(num, nv);
+            wval = old; wr = true;
+            csr = true;
+            last_csr_rd_    = uint8_t(rd);
+            last_csr_num_   = num;
+            last_csr_wrote_ = wcsr;
+        } else if (insn == INSN_ECALL || insn == INSN_EBREAK) {
+            trap(insn == INSN_ECALL ? CAUSE_ECALL : CAUSE_EBREAK, pc);
+            next = mtvec;
+            if (r)
+                r->trap = true;
+        } else if (insn == INSN_MRET) {
+            mstatus = (mstatus & ~MSTATUS_MIE) |
+                      ((mstatus & MSTATUS_MPIE) ? MSTATUS_MIE : 0) | MSTATUS_MPIE;
+            next = mepc;
+            attn_ = 0;
+            if (Timing)
+                cost += PEN_TRAP;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (Timing && next != pc + 4 && opcode != 0x73)
+        cost += PEN_REDIRECT;
+
+    if (wr && rd) {
+        x[rd] = wval;
+        if (r) {
+            r->rd     = uint8_t(rd);
+            r->rd_val = wval;
+        }
+    }
+    last_csr_ = csr;
+    pc = next;
+    if (r)
+        r->next_pc = pc;
+
+    cycles += cost;
+    instret++;
+}
+
+template <bool Timing>
+bool Cpu::run_loop(uint64_t cycle_limit, uint64_t insn_limit) {
+    while (cycles < cycle_limit && instret < insn_limit) {
+        uint32_t from = pc;
+        exec<Timing>(nullptr);
+        if (pc == from || (pc == 0 && from != 0) || pc == break_pc || bus_.halt) {
+            prev_pc = from;
+            return false;
+        }
+    }
+    return true;
+}
+
+void Cpu::step(Retire* r) {
+    prev_pc = pc;
+    if (timing)
+        exec<true>(r);
+    else
+        exec<false>(r);
+}
+
+bool Cpu::run(uint64_t cycle_limit, uint64_t insn_limit) {
+    return timing ? run_loop<true>(cycle_limit, insn_limit)
+                  : run_loop<false>(cycle_limit, insn_limit);
+}
+
+}  // namespace iss
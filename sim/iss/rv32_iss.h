@@ -0,0 +1,179 @@
+// RV32I + Zicsr instruction-set simulator of cpu_core.v.
+//
+// Architectural behaviour follows the RTL rather than the spec where the
+// two differ, so the model can stand in for the core:
+//   - no illegal-instruction or misaligned traps: encodings the decoder
+//     does not know execute as NOPs, AND/OR/XOR ignore funct7, and loads /
+//     stores use the naturally aligned address (lw/sw drop addr[1:0],
+//     lh/sh drop addr[0])
+//   - CSRs: mstatus, mie, mtvec, mscratch, mepc, mcause, mip (MEIP/MTIP
+//     live, not writable), mhartid; anything else reads 0, writes dropped
+//   - CLINT (mtime / mtimecmp) and the CSR MMIO window are word accesses
+//     inside the core; mtime counts core cycles
+//   - traps: mepc = the trapping ecall/ebreak itself, or for an interrupt
+//     the next instruction to execute; mtvec is used as is (direct mode);
+//     mret returns to mepc with no adjustment
+//   - interrupts: external (mcause 11) beats timer (7); none is taken
+//     between a CSR instruction and the next one, or in front of an
+//     ecall / ebreak / mret
+//
+// Bus is the SoC behind the core (soc.h); it owns the memories and the
+// devices. With `timing` set, each instruction also charges the pipeline
+// penalties of the 3-stage core and the bus latencies the Bus reports, for
+// a cycle estimate; otherwise every instruction takes one cycle.
+#ifndef RV32_ISS_H
+#define RV32_ISS_H
+
+#include <cstdint>
+
+namespace iss {
+
+// Encodings the core treats specially
+constexpr uint32_t INSN_ECALL    = 0x00000073;
+constexpr uint32_t INSN_EBREAK   = 0x00100073;
+constexpr uint32_t INSN_MRET     = 0x30200073;
+constexpr uint32_t INSN_JAL_SELF = 0x0000006F;   // unmapped fetch (bus_xbar.v)
+
+constexpr uint32_t CAUSE_EBREAK  = 0x00000003;
+constexpr uint32_t CAUSE_ECALL   = 0x0000000B;
+constexpr uint32_t CAUSE_MTI     = 0x80000007;
+constexpr uint32_t CAUSE_MEI     = 0x8000000B;
+
+// Core-internal addresses (cpu_core.v)
+constexpr uint32_t CLINT_MTIME_LO    = 0xFFFF0008;
+constexpr uint32_t CLINT_MTIME_HI    = 0xFFFF000C;
+constexpr uint32_t CLINT_MTIMECMP_LO = 0xFFFF0010;
+constexpr uint32_t CLINT_MTIMECMP_HI = 0xFFFF0014;
+constexpr uint32_t CSR_MTVEC_ADDR    = 0xFFFFFFC0;
+constexpr uint32_t CSR_MSTATUS_ADDR  = 0xFFFFFFC4;
+constexpr uint32_t CSR_MEPC_ADDR     = 0xFFFFFFC8;
+constexpr uint32_t CSR_MCAUSE_ADDR   = 0xFFFFFFCC;
+
+// Pipeline penalties in cycles on top of one per instruction
+constexpr unsigned PEN_REDIRECT = 2;   // taken branch/jump (resolved in EX)
+constexpr unsigned PEN_TRAP     = 2;   // trap entry or mret (ID redirect)
+constexpr unsigned PEN_CSR_USE  = 1;   // reading rd of the CSR op just before
+constexpr unsigned PEN_CSR_CSR  = 1;   // same CSR written by the op before
+
+// What one step retired, for traces and lockstep checking
+struct Retire {
+    uint32_t pc;
+    uint32_t prev_pc;       // pc of the last step(), or of run()'s last one
+    uint32_t insn;
+    uint32_t next_pc;
+    bool     trap;          // ecall / ebreak: next_pc is the handler
+    bool     intr;          // an interrupt was taken before this instruction
+    uint8_t  rd;            // 0 = no register written
+    uint32_t rd_val;
+    uint32_t mem_addr;
+    uint8_t  mem_rmask;     // byte lanes of the word at mem_addr & ~3
+    uint8_t  mem_wmask;
+    uint32_t mem_rdata;     // whole word, before lane extraction
+    uint32_t mem_wdata;     // lane-replicated store data
+};
+
+class Bus {
+public:
+    struct Region {
+        uint8_t* mem      = nullptr;    // nullptr: io_read / io_write
+        uint32_t mask     = 0;          // offset = addr & mask
+        uint32_t size     = 0;          // offsets >= size read 0
+        bool     writable = false;
+        bool     exec     = false;      // fetch allowed (else JAL_SELF)
+    };
+
+    virtual ~Bus() = default;
+
+    // Regions with no memory behind them (IO, unmapped). addr is the exact
+    // byte address; reads return the whole word (the core picks the lanes),
+    // writes get the lane-replicated data and byte enables. *wait returns
+    // cycles the access stalled (e.g. on a full UART FIFO). The core calls
+    // sync() first, so devices are current.
+    virtual uint32_t io_read(uint32_t addr, uint64_t cycle, unsigned* wait) = 0;
+    virtual void     io_write(uint32_t addr, uint32_t wdata, unsigned be,
+                              uint64_t cycle, unsigned* wait) = 0;
+
+    // Bring device state up to `cycle` (mtime = CLINT time low word)
+    virtual void sync(uint64_t cycle, uint32_t mtime) = 0;
+
+    // Timing model: extra cycles for a fetch / data access (any region)
+    virtual unsigned fetch_cycles(uint32_t addr) { (void)addr; return 0; }
+    virtual unsigned data_cycles(uint32_t addr, bool store) {
+        (void)addr; (void)store; return 0;
+    }
+
+    Region   region[16];                // by addr[31:28]
+    uint64_t next_event = UINT64_MAX;   // sync() is due at this cycle
+    bool     irq        = false;        // machine external interrupt level
+    bool     halt       = false;        // a device ended the run (Cpu::run stops)
+};
+
+class Cpu {
+public:
+    explicit Cpu(Bus& bus) : bus_(bus) { reset(); }
+
+    void reset(uint32_t start_pc = 0);
+
+    // Execute one instruction; an interrupt that is due is taken first
+    // (when auto_irq is set) and flagged in r->intr.
+    void step(Retire* r = nullptr);
+
+    // step() until a limit is reached (returns true) or an instruction
+    // jumps to itself or to 0, reaches break_pc or sets Bus::halt (returns
+    // false), the events the simulation harnesses watch for, without a
+    // call per instruction.
+    bool run(uint64_t cycle_limit, uint64_t insn_limit);
+
+    // Interrupt pending, enabled and not blocked in front of pc
+    bool irq_ready();
+    // Enter a trap now with mepc = pc (lockstep: the RTL decided)
+    void interrupt(uint32_t cause);
+    uint32_t irq_cause() const;
+    // Call after changing Bus::irq / next_event outside io_read, io_write
+    // and sync(), or mstatus / mie / mtimecmp directly
+    void wake() { attn_ = 0; }
+
+    uint64_t mtime() const { return cycles + mtime_adj_; }
+    // Set the CLINT time (checkpoint restore)
+    void set_mtime(uint64_t t) {
+        mtime_adj_      = t - cycles;
+        bus_.next_event = 0;
+        attn_           = 0;
+    }
+
+    uint32_t x[32];
+    uint32_t pc;
+    uint32_t prev_pc;       // pc of the last step(), or of run()'s last one
+    uint32_t mstatus, mie, mtvec, mscratch, mepc, mcause, mip;
+    uint64_t mtimecmp;
+    uint64_t cycles;
+    uint64_t instret;
+    bool     timing   = false;
+    bool     auto_irq = true;
+    uint32_t break_pc = ~0u;    // run() also stops in front of this pc
+
+    uint32_t csr_read(uint32_t num) const;
+    void     csr_write(uint32_t num, uint32_t v);
+
+private:
+    template <bool Timing> void exec(Retire* r);
+    template <bool Timing> bool run_loop(uint64_t cycle_limit, uint64_t insn_limit);
+    uint32_t fetch(uint32_t addr);
+    uint32_t load(uint32_t addr, unsigned funct3, Retire* r);
+    void     store(uint32_t addr, uint32_t v, unsigned funct3, Retire* r);
+    void     trap(uint32_t cause, uint32_t epc);
+
+    Bus&     bus_;
+    const uint8_t* fpage_;
+    uint32_t fpage_tag_;
+    uint64_t mtime_adj_;
+    uint64_t attn_;             // cycle to next look at bus events / interrupts
+    bool     last_csr_;         // previous instruction was a CSR op
+    uint8_t  last_csr_rd_;
+    uint32_t last_csr_num_;
+    bool     last_csr_wrote_;
+};
+
+}  // namespace iss
+
+#endif  // RV32_ISS_H
@@ -0,0 +1,680 @@
+// SoC model behind the ISS core; see soc.h.
+#include "soc.h"
+#include "checkpoint.h"
+#include "memmap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace iss {
+
+namespace {
+
+// cpu_top.v parameters
+constexpr uint32_t DDR_SIM_BYTES   = 4u << 20;      // DDR_SIM_WORDS (wraps)
+constexpr uint32_t FLASH_SIM_BYTES = 4u << 16;      // FLASH_SIM_WORDS (wraps)
+constexpr unsigned UART_FIFO_DEPTH = 256;
+constexpr unsigned MBOX_DEPTH      = 64;
+constexpr unsigned DMA_MAX_DESC    = 1024;          // runaway chain guard
+
+// Timing model (cycles on top of the pipeline's own)
+constexpr unsigned T_EXT_MISS   = 30;   // DDR LATENCY + 8 beats + refill
+constexpr unsigned T_EXT_DIRTY  = 28;   // victim write-back first
+constexpr unsigned T_DCACHE_HIT = 1;
+constexpr unsigned T_FLASH_MISS = 168;  // 0xEB + addr + dummy + 64 nibbles
+constexpr unsigned T_IO         = 2;    // latch + ack
+
+inline uint32_t rd32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline bool before(uint32_t now, uint32_t t) {
+    return int32_t(now - t) < 0;
+}
+
+uint32_t crc_next(uint32_t c, uint32_t d, unsigned be, bool m16) {
+    for (unsigned l = 0; l < 4; l++) {
+        if (!(be & (1u << l)))
+            continue;
+        uint8_t byte = uint8_t(d >> (8 * l));
+        for (unsigned k = 0; k < 8; k++) {
+            if (!m16) {
+                bool fb = (c ^ (byte >> k)) & 1;
+                c = (c >> 1) ^ (fb ? 0xEDB88320u : 0);
+            } else {
+                bool fb = ((c >> 15) ^ (byte >> (7 - k))) & 1;
+                c = ((c << 1) & 0xFFFF) ^ (fb ? 0x1021u : 0);
+            }
+        }
+    }
+    return c;
+}
+
+}  // namespace
+
+Soc::Cache::Cache(unsigned w, unsigned s, unsigned line_bytes)
+    : ways(w), sets(s), line_shift(0),
+      tag(w * s, ~0u), dirty(w * s, 0), lru(s, 0) {
+    while ((1u << line_shift) < line_bytes)
+        line_shift++;
+}
+
+bool Soc::Cache::access(uint32_t addr, bool store, bool* dirty_victim) {
+    uint32_t line = addr >> line_shift;
+    unsigned set  = line & (sets - 1);
+    unsigned base = set * ways;
+    for (unsigned w = 0; w < ways; w++) {
+        if (tag[base + w] == line) {
+            lru[set] = uint8_t(w);
+            dirty[base + w] |= store;
+            return true;
+        }
+    }
+    unsigned victim = ways == 1 ? 0 : (lru[set] + 1) % ways;
+    if (dirty_victim)
+        *dirty_victim = tag[base + victim] != ~0u && dirty[base + victim];
+    tag[base + victim]   = line;
+    dirty[base + victim] = store;
+    lru[set] = uint8_t(victim);
+    return false;
+}
+
+Soc::Soc()
+    : itcm_(MEMMAP_ITCM_SIZE), dtcm_(MEMMAP_DTCM_SIZE),
+      ext_(DDR_SIM_BYTES), flash_(FLASH_SIM_BYTES),
+      uart_baud_(MEMMAP_UART_DIV),
+      icache_(2, 64, 32), dcache_(2, 64, 32), flash_cache_(1, 16, 32) {
+    Region& itcm = region[MEMMAP_ITCM_BASE >> 28];
+    itcm.mem  = itcm_.data();
+    itcm.mask = MEMMAP_ITCM_SIZE - 1;
+    itcm.size = MEMMAP_ITCM_SIZE;
+    itcm.writable = itcm.exec = true;
+
+    Region& dtcm = region[MEMMAP_DTCM_BASE >> 28];
+    dtcm.mem  = dtcm_.data();
+    dtcm.mask = 0x0FFFFFFF;
+    dtcm.size = MEMMAP_DTCM_SIZE;
+    dtcm.writable = true;
+
+    Region& ext = region[MEMMAP_EXT_BASE >> 28];
+    ext.mem  = ext_.data();
+    ext.mask = DDR_SIM_BYTES - 1;
+    ext.size = DDR_SIM_BYTES;
+    ext.writable = ext.exec = true;
+
+    Region& flash = region[MEMMAP_FLASH_BASE >> 28];
+    flash.mem  = flash_.data();
+    flash.mask = FLASH_SIM_BYTES - 1;
+    flash.size = FLASH_SIM_BYTES;
+    flash.exec = true;
+}
+
+bool Soc::load_hex(const std::string& path, uint32_t base) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    const Region& R = region[base >> 28];
+    uint32_t off = base & R.mask;
+    std::string tok;
+    while (in >> tok) {
+        if (tok.compare(0, 2, "//") == 0) {
+            std::getline(in, tok);
+            continue;
+        }
+        if (tok[0] == '@') {
+            off = (base & R.mask) + uint32_t(std::stoul(tok.substr(1), nullptr, 16)) * 4;
+            continue;
+        }
+        uint32_t w = uint32_t(std::stoul(tok, nullptr, 16));
+        off &= R.mask;
+        if (off + 4 <= R.size)
+            std::memcpy(R.mem + off, &w, 4);
+        off += 4;
+    }
+    return true;
+}
+
+bool Soc::load_elf(const ElfImage& elf) {
+    for (const ElfImage::Segment& seg : elf.segments) {
+        const Region& R = region[seg.addr >> 28];
+        if (!R.mem)
+            return false;
+        for (size_t i = 0; i < seg.data.size(); i++) {
+            const uint32_t off = (seg.addr + uint32_t(i)) & R.mask;
+            if (off >= R.size)
+                return false;
+            R.mem[off] = seg.data[i];
+        }
+    }
+    return true;
+}
+
+bool Soc::save_hex(const std::string& path, uint32_t base, bool trim) const {
+    const Region& R = region[base >> 28];
+    uint32_t words = R.size / 4;
+    if (trim)
+        while (words && !rd32(R.mem + (words - 1) * 4))
+            words--;
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f)
+        return false;
+    for (uint32_t i = 0; i < words; i++)
+        std::fprintf(f, "%08x\n", rd32(R.mem + i * 4));
+    if (!words)
+        std::fprintf(f, "00000000\n");     // $readmemh wants at least one word
+    return std::fclose(f) == 0;
+}
+
+// Only the registers the firmware sets up once (UART, IRQC) and the TX
+// queue; see checkpoint.h for what a warm start leaves at reset
+void Soc::save_io(uint32_t* warm) const {
+    warm[WARM_UART_CTRL]  = uart_ctrl_;
+    warm[WARM_UART_BAUD]  = uart_baud_;
+    warm[WARM_IRQ_ENABLE] = irq_enable_;
+    // The byte in the shifter is sent again from its start bit
+    unsigned n = std::min(uart_fifo_ + (uart_busy_ ? 1u : 0u), UART_FIFO_DEPTH);
+    n = std::min(n, uart_tail_n_);
+    warm[WARM_UART_TX_COUNT] = n;
+    for (unsigned i = 0; i < n; i++)
+        warm[WARM_UART_TX + i] =
+            uart_tail_[(uart_tail_n_ - n + i) % sizeof(uart_tail_)];
+}
+
+void Soc::restore_io(const uint32_t* warm) {
+    uart_ctrl_  = warm[WARM_UART_CTRL];
+    uart_baud_  = warm[WARM_UART_BAUD] & 0xFFFFF;
+    irq_enable_ = warm[WARM_IRQ_ENABLE] & 0xFF;
+    unsigned n = std::min(warm[WARM_UART_TX_COUNT], uint32_t(UART_FIFO_DEPTH));
+    for (unsigned i = 0; i < n; i++) {
+        uint8_t c = uint8_t(warm[WARM_UART_TX + i]);
+        uart_tail_[uart_tail_n_++ % sizeof(uart_tail_)] = c;
+        console_putc(c);
+    }
+    uart_busy_ = n != 0;
+    uart_fifo_ = n ? n - 1 : 0;
+    uart_done_ = last_cycle_ + 10 * uint64_t(uart_baud_) / 16 + 1;
+    next_event = 0;
+}
+
+// ------------------------------------------------------------
+// Data path shared by the core (io_*) and the DMA
+// ------------------------------------------------------------
+
+uint32_t Soc::mem_read32(uint32_t addr) {
+    const Region& R = region[addr >> 28];
+    if (R.mem) {
+        uint32_t off = addr & R.mask & ~3u;
+        return off < R.size ? rd32(R.mem + off) : 0;
+    }
+    return io_read(addr & ~3u, last_cycle_, nullptr);
+}
+
+uint32_t Soc::peek(uint32_t addr) const {
+    const Region& R = region[addr >> 28];
+    uint32_t off = addr & R.mask & ~3u;
+    return R.mem && off < R.size ? rd32(R.mem + off) : 0;
+}
+
+void Soc::mem_write(uint32_t addr, uint32_t wdata, unsigned be, uint64_t cycle) {
+    const Region& R = region[addr >> 28];
+    if (R.mem) {
+        uint32_t off = addr & R.mask & ~3u;
+        if (R.writable && off < R.size)
+            for (unsigned i = 0; i < 4; i++)
+                if (be & (1u << i))
+                    R.mem[off + i] = uint8_t(wdata >> (8 * i));
+        return;
+    }
+    io_write(addr & ~3u, wdata, be, cycle, nullptr);   // DMA: never stalls
+}
+
+void OutputWatch::add(const std::string& s) {
+    want_.push_back(s);
+    seen_.push_back(s.empty());
+    longest_ = std::max(longest_, s.size());
+}
+
+bool OutputWatch::feed(uint8_t c) {
+    if (met_ || want_.empty() || c == '\r')
+        return met_;
+    tail_ += char(c);
+    if (tail_.size() > longest_)
+        tail_.erase(0, tail_.size() - longest_);
+    met_ = true;
+    for (size_t i = 0; i < want_.size(); i++) {
+        const std::string& w = want_[i];
+        if (!seen_[i] && tail_.size() >= w.size() &&
+            tail_.compare(tail_.size() - w.size(), w.size(), w) == 0)
+            seen_[i] = true;
+        met_ = met_ && seen_[i];
+    }
+    return met_;
+}
+
+void Soc::console_putc(uint8_t c) {
+    if (until.feed(c))
+        halt = true;
+    if (!console)
+        return;
+    if (c >= 32 && c < 127)
+        std::fputc(c, console);
+    else if (c == '\n')
+        std::fputc('\n', console);
+    else if (c != '\r')
+        std::fprintf(console, "[0x%02x]", c);
+    if (c == '\n')
+        std::fflush(console);
+}
+
+// ------------------------------------------------------------
+// Devices
+// ------------------------------------------------------------
+
+void Soc::uart_drain(uint64_t cycle) {
+    uint64_t byte_cycles = 10 * uint64_t(uart_baud_) / 16 + 1;
+    while (uart_busy_ && uart_done_ <= cycle) {
+        if (uart_fifo_) {
+            uart_fifo_--;
+            uart_done_ += byte_cycles;
+        } else {
+            uart_busy_ = false;
+        }
+    }
+}
+
+bool Soc::uart_tx_low() const {
+    return uart_fifo_ <= (uart_ctrl_ >> 24);
+}
+
+void Soc::timer_run(uint32_t now) {
+    for (TimerCh& t : tmr_) {
+        unsigned ch = unsigned(&t - tmr_);
+        for (unsigned guard = 0; t.armed && !before(now, t.cmp); guard++) {
+            switch (t.ctrl & 3) {
+            case 1:                                     // compare
+                tmr_match_ |= 1u << ch;
+                if (t.period == 0) {
+                    t.armed = false;
+                } else if (guard >= 4) {
+                    // Long gap (e.g. mtime written): skip whole periods
+                    uint32_t n = (now - t.cmp) / t.period + 1;
+                    t.cmp += n * t.period;
+                } else {
+                    t.cmp += t.period;
+                }
+                break;
+            case 2:                                     // PWM period flags
+                if (t.period == 0) {
+                    t.armed = false;
+                } else {
+                    tmr_match_ |= 1u << ch;
+                    uint32_t n = guard >= 4 ? (now - t.cmp) / t.period + 1 : 1;
+                    t.cmp += n * t.period;
+                }
+                break;
+            default:
+                t.armed = false;
+                break;
+            }
+        }
+    }
+}
+
+void Soc::dma_run(unsigned ch, bool from_next, uint64_t cycle) {
+    DmaCh& c = dma_[ch];
+    for (unsigned n = 0; n < DMA_MAX_DESC; n++) {
+        if (from_next) {
+            uint32_t d = c.next & ~3u;
+            c.src  = mem_read32(d);
+            c.dst  = mem_read32(d + 4);
+            c.len  = mem_read32(d + 8);
+            c.cfg  = mem_read32(d + 12) & 0x3F;
+            c.next = mem_read32(d + 16);
+        }
+        while (c.len) {
+            bool words = (c.cfg & 4) && c.len >= 4;
+            if (words) {
+                mem_write(c.dst, mem_read32(c.src), 0xF, cycle);
+            } else {
+                uint8_t b = uint8_t(mem_read32(c.src) >> (8 * (c.src & 3)));
+                mem_write(c.dst, b * 0x01010101u, 1u << (c.dst & 3), cycle);
+            }
+            uint32_t step = words ? 4 : 1;
+            if (!(c.cfg & 1)) c.src += step;
+            if (!(c.cfg & 2)) c.dst += step;
+            c.len -= step;
+        }
+        if (!c.next)
+            break;
+        from_next = true;
+    }
+    dma_done_ |= 1u << ch;
+}
+
+uint32_t Soc::gpio_in() const {
+    // Pins 3:0 read back the LEDs; btn0 and the switches are idle (0)
+    return gpio_out_ & gpio_dir_ & 0xF;
+}
+
+void Soc::gpio_edges(uint32_t before_in) {
+    uint32_t now = gpio_in();
+    gpio_rise_f_ |= now & ~before_in & gpio_rise_en_;
+    gpio_fall_f_ |= ~now & before_in & gpio_fall_en_;
+}
+
+void Soc::update(uint64_t cycle) {
+    uint32_t in = gpio_in();
+    irq_src_ = 0;
+    if (uart_tx_low() && (uart_ctrl_ & 8))
+        irq_src_ |= 1u << MEMMAP_IRQ_UART;
+    if (dma_done_ & (dma_[0].ie | dma_[1].ie << 1 | dma_[2].ie << 2 | dma_[3].ie << 3))
+        irq_src_ |= 1u << MEMMAP_IRQ_DMA;
+    uint32_t tmr_ie = 0;
+    for (unsigned i = 0; i < 4; i++)
+        tmr_ie |= ((tmr_[i].ctrl >> 2) & 1) << i;
+    if (tmr_match_ & tmr_ie)
+        irq_src_ |= 1u << MEMMAP_IRQ_TIMER;
+    if (mbox_ie_ && !mbox_.empty())
+        irq_src_ |= 1u << MEMMAP_IRQ_MBOX;
+    if (gpio_rise_f_ | gpio_fall_f_ | (in & gpio_high_en_) | (~in & 0x7F & gpio_low_en_))
+        irq_src_ |= 1u << MEMMAP_IRQ_GPIO;
+    irq = (irq_src_ & irq_enable_) != 0;
+
+    // Next time something changes on its own
+    next_event = UINT64_MAX;
+    if (uart_busy_)
+        next_event = uart_done_;
+    for (const TimerCh& t : tmr_)
+        if (t.armed)
+            next_event = std::min(next_event, cycle + (before(mtime_, t.cmp) ? t.cmp - mtime_ : 0));
+}
+
+void Soc::sync(uint64_t cycle, uint32_t mtime) {
+    last_cycle_ = cycle;
+    mtime_      = mtime;
+    uart_drain(cycle);
+    timer_run(mtime);
+    update(cycle);
+}
+
+uint32_t Soc::io_read(uint32_t addr, uint64_t cycle, unsigned* wait) {
+    (void)wait;
+    const uint32_t blk = addr & ~0xFFu;
+    const unsigned reg = (addr & 0xFF) >> 2;
+    const unsigned ch  = (addr >> 5) & 3;
+    uint32_t v = 0;
+
+    if (addr >> 28 != 0xF) {
+        v = 0;                                          // unmapped
+    } else if (addr == MEMMAP_UART_BASE + 0x14) {      // STATUS
+        v = (uart_fifo_ >= UART_FIFO_DEPTH ? 2 : 0) | (uart_busy_ ? 1 : 0);
+    } else if (addr == MEMMAP_UART_BASE + 0x00) {
+        v = uart_ctrl_;
+    } else if (addr == MEMMAP_UART_BASE + 0x04) {
+        v = uart_tx_low() ? 0x10 : 0;
+    } else if (addr == MEMMAP_UART_BASE + 0x08) {
+        v = std::min(uart_fifo_, UART_FIFO_DEPTH) << 16;
+    } else if (addr == MEMMAP_UART_BASE + 0x0C) {
+        v = uart_baud_;
+    } else if (blk == MEMMAP_IRQC_BASE) {
+        v = reg == 0 ? irq_src_ : reg == 1 ? irq_enable_ :
+            reg == 2 ? irq_src_ & irq_enable_ : 0;
+    } else if (blk == MEMMAP_DMA_BASE) {
+        const DmaCh& c = dma_[ch];
+        if (addr & 0x80)
+            v = reg == 0x20 ? dma_done_ : 0;
+        else switch (reg & 7) {
+            case 0: v = c.src; break;
+            case 1: v = c.dst; break;
+            case 2: v = c.len; break;
+            case 3: v = c.cfg; break;
+            case 4: v = c.next; break;
+            case 5: v = ((dma_done_ >> ch) & 1) << 9 | (c.ie ? 4 : 0); break;
+        }
+    } else if (blk == MEMMAP_TIMER_BASE) {
+        const TimerCh& t = tmr_[ch];
+        if (addr & 0x80)
+            v = reg == 0x20 ? tmr_match_ : reg == 0x21 ? mtime_ : 0;
+        else switch (reg & 7) {
+            case 0: v = t.cmp; break;
+            case 1: v = t.period; break;
+            case 2: v = t.duty; break;
+            case 4: v = (t.armed ? 0x100 : 0) | t.ctrl; break;
+        }
+    } else if (blk == MEMMAP_CRC_BASE) {
+        switch (reg) {
+        case 0: v = crc_mode_; break;
+        case 2: v = crc_state_; break;
+        case 3: v = crc_mode_ ? crc_state_ & 0xFFFF : ~crc_state_; break;
+        case 4: v = crc_count_; break;
+        }
+    } else if (blk == MEMMAP_MBOX_BASE) {
+        switch (reg) {
+        case 0:
+            if (!mbox_.empty()) {
+                v = mbox_.front();
+                mbox_.pop_front();
+            }
+            break;
+        case 1: v = uint32_t(mbox_.size()); break;
+        case 2: v = MBOX_DEPTH; break;
+        case 3: v = mbox_ie_; break;
+        case 4:
+            v = (mbox_ovf_ ? 4 : 0) | (mbox_.size() == MBOX_DEPTH ? 2 : 0) |
+                (mbox_.empty() ? 0 : 1);
+            break;
+        }
+    } else if (blk == MEMMAP_SEMA_BASE) {
+        if (!(addr & 0x80)) {
+            v = (sema_held_ >> reg) & 1;
+            sema_held_ |= 1u << reg;
+        } else if (reg == 0x20) {
+            v = sema_held_;
+        }
+    } else if (blk == MEMMAP_SIM_BASE) {
+        if (reg == 2)
+            v = 0x53494D31;                             // "SIM1"
+    } else if (blk == MEMMAP_GPIO_BASE) {
+        switch (reg) {
+        case 0x00: v = gpio_in(); break;
+        case 0x01: v = gpio_out_; break;
+        case 0x02: v = gpio_dir_; break;
+        case 0x05: v = gpio_rise_en_; break;
+        case 0x06: v = gpio_fall_en_; break;
+        case 0x07: v = gpio_high_en_; break;
+        case 0x08: v = gpio_low_en_; break;
+        case 0x09: v = gpio_fall_f_ << 16 | gpio_rise_f_; break;
+        case 0x0A: v = gpio_db_en_; break;
+        case 0x0B: v = gpio_db_time_; break;
+        }
+    }
+
+    update(cycle);
+    return v;
+}
+
+void Soc::io_write(uint32_t addr, uint32_t wdata, unsigned be, uint64_t cycle,
+                   unsigned* wait) {
+    const uint32_t blk = addr & ~0xFFu;
+    const unsigned reg = (addr & 0xFF) >> 2;
+    const unsigned ch  = (addr >> 5) & 3;
+
+    if (addr >> 28 != 0xF) {
+        // unmapped: dropped
+    } else if (addr == MEMMAP_UART_BASE + 0x10) {      // TX
+        uint64_t byte_cycles = 10 * uint64_t(uart_baud_) / 16 + 1;
+        if (uart_busy_ && uart_fifo_ >= UART_FIFO_DEPTH && wait) {
+            // The core stalls until the shifter takes the next byte
+            *wait += unsigned(uart_done_ - std::min(uart_done_, cycle));
+            cycle = std::max(cycle, uart_done_);
+            uart_drain(cycle);
+        }
+        if (!uart_busy_) {
+            uart_busy_ = true;
+            uart_done_ = cycle + byte_cycles;
+        } else {
+            uart_fifo_++;                               // DMA may overfill
+        }
+        uart_tail_[uart_tail_n_++ % sizeof(uart_tail_)] = uint8_t(wdata);
+        uart_bytes++;
+        console_putc(uint8_t(wdata));
+    } else if (addr == MEMMAP_UART_BASE + 0x00) {
+        uart_ctrl_ = wdata;
+    } else if (addr == MEMMAP_UART_BASE + 0x0C) {
+        if (((wdata >> 4) & 0xFFFF) >= 4)
+            uart_baud_ = wdata & 0xFFFFF;
+    } else if (blk == MEMMAP_IRQC_BASE) {
+        if (reg == 1)
+            irq_enable_ = wdata & 0xFF;
+    } else if (blk == MEMMAP_DMA_BASE) {
+        DmaCh& c = dma_[ch];
+        if (addr & 0x80) {
+            if (reg == 0x20)
+                dma_done_ &= ~wdata;
+        } else if ((reg & 7) == 5) {
+            c.ie = wdata & 4;
+            if (!(wdata & 8) && (wdata & 3)) {
+                dma_done_ &= ~(1u << ch);
+                dma_run(ch, !(wdata & 1), cycle);
+            }
+        } else {
+            switch (reg & 7) {
+            case 0: c.src  = wdata; break;
+            case 1: c.dst  = wdata; break;
+            case 2: c.len  = wdata; break;
+            case 3: c.cfg  = wdata & 0x3F; break;
+            case 4: c.next = wdata; break;
+            }
+        }
+    } else if (blk == MEMMAP_TIMER_BASE) {
+        TimerCh& t = tmr_[ch];
+        if (addr & 0x80) {
+            if (reg == 0x20)
+                tmr_match_ &= ~wdata;
+        } else {
+            switch (reg & 7) {
+            case 0: t.cmp = wdata; t.armed = (t.ctrl & 3) != 0; break;
+            case 1: t.period = wdata; break;
+            case 2: t.duty = wdata; break;
+            case 4:
+                t.ctrl = wdata & 0x3F;
+                if ((wdata & 3) == 0)
+                    t.armed = false;
+                break;
+            }
+            timer_run(mtime_);
+        }
+    } else if (blk == MEMMAP_CRC_BASE) {
+        switch (reg) {
+        case 0:
+            crc_mode_  = wdata & 1;
+            crc_state_ = crc_mode_ ? 0xFFFF : 0xFFFFFFFF;
+            crc_count_ = 0;
+            break;
+        case 1:
+            crc_state_  = crc_next(crc_state_, wdata, be, crc_mode_);
+            crc_count_ += __builtin_popcount(be & 0xF);
+            break;
+        case 2: crc_state_ = wdata; break;
+        case 4: crc_count_ = wdata; break;
+        }
+    } else if (blk == MEMMAP_MBOX_BASE) {
+        switch (reg) {
+        case 0:
+            if (mbox_.size() < MBOX_DEPTH)
+                mbox_.push_back(wdata);
+            else
+                mbox_ovf_ = true;
+            break;
+        case 3:
+            mbox_ie_ = wdata & 1;
+            if (wdata & 2)
+                mbox_.clear();
+            break;
+        case 4:
+            if (wdata & 4)
+                mbox_ovf_ = false;
+            break;
+        }
+    } else if (blk == MEMMAP_SEMA_BASE) {
+        if (!(addr & 0x80))
+            sema_held_ &= ~(1u << reg);
+        else if (reg == 0x21)
+            sema_held_ &= ~wdata;
+    } else if (blk == MEMMAP_SIM_BASE) {
+        if (reg == 0) {
+            console_putc(uint8_t(wdata));
+        } else if (reg == 1 && !halt) {
+            halt      = true;
+            exit_code = wdata;
+        }
+    } else if (blk == MEMMAP_GPIO_BASE) {
+        uint32_t in = gpio_in();
+        switch (reg) {
+        case 0x01: gpio_out_ = wdata & 0x7F; break;
+        case 0x02: gpio_dir_ = wdata & 0x0F; break;
+        case 0x03: gpio_out_ |= wdata & 0x7F; break;
+        case 0x04: gpio_out_ &= ~wdata; break;
+        case 0x05: gpio_rise_en_ = wdata & 0x7F; break;
+        case 0x06: gpio_fall_en_ = wdata & 0x7F; break;
+        case 0x07: gpio_high_en_ = wdata & 0x7F; break;
+        case 0x08: gpio_low_en_  = wdata & 0x7F; break;
+        case 0x09:
+            gpio_rise_f_ &= ~wdata;
+            gpio_fall_f_ &= ~(wdata >> 16);
+            break;
+        case 0x0A: gpio_db_en_   = wdata & 0x7F; break;
+        case 0x0B: gpio_db_time_ = wdata & 0xFFFFF; break;
+        }
+        gpio_edges(in);
+    }
+
+    update(cycle);
+}
+
+// ------------------------------------------------------------
+// Timing
+// ------------------------------------------------------------
+
+unsigned Soc::fetch_cycles(uint32_t addr) {
+    switch (addr >> 28) {
+    case MEMMAP_EXT_BASE >> 28:
+        if (icache_.access(addr, false, nullptr))
+            return 0;
+        cache_misses++;
+        return T_EXT_MISS;
+    case MEMMAP_FLASH_BASE >> 28:
+        if (flash_cache_.access(addr, false, nullptr))
+            return 0;
+        cache_misses++;
+        return T_FLASH_MISS;
+    default:
+        return 0;
+    }
+}
+
+unsigned Soc::data_cycles(uint32_t addr, bool store) {
+    switch (addr >> 28) {
+    case MEMMAP_EXT_BASE >> 28: {
+        bool dirty = false;
+        if (dcache_.access(addr, store, &dirty))
+            return T_DCACHE_HIT;
+        cache_misses++;
+        return T_EXT_MISS + (dirty ? T_EXT_DIRTY : 0);
+    }
+    case MEMMAP_FLASH_BASE >> 28:
+        if (flash_cache_.access(addr, false, nullptr))
+            return T_DCACHE_HIT;
+        cache_misses++;
+        return T_FLASH_MISS;
+    case 0xF:
+        return T_IO;
+    default:
+        return 0;
+    }
+}
+
+}  // namespace iss
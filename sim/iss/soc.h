@@ -0,0 +1,166 @@
+// The cpu_top.v SoC around the ISS core: TCMs, external memory, QSPI
+// flash, and the peripherals on the IO region, at the addresses in
+// firmware/memmap.h.
+//
+// Devices are modelled as far as the firmware drivers rely on them, in
+// core cycles:
+//   UART     TX FIFO draining at the BAUD rate (a write to a full FIFO
+//            stalls), STATUS/COUNT/IRQ/CTRL/BAUD, TX low-water irq; bytes go
+//            to the console as they are written. RX is always empty.
+//   IRQC     PENDING / ENABLE / ACTIVE
+//   TIMER    compare channels and PWM period flags on mtime, STATUS, MTIME
+//            (no PWM output, no capture edges)
+//   DMA      descriptors and chains run to completion when started
+//   CRC, MBOX, SEMA   as the RTL
+//   GPIO     registers, LED readback, edge/level flags on the outputs;
+//            button and switches read 0
+//   QSPI     control registers read 0
+//   SIM      sim_ctrl.v: CONSOLE bytes go straight to the console, EXIT
+//            sets Bus::halt with the code in exit_code
+#ifndef SOC_H
+#define SOC_H
+
+#include "elf.h"
+#include "rv32_iss.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace iss {
+
+// --until: waits for every one of a set of strings to appear in the
+// console output (in any order; CR is dropped, as on the console)
+class OutputWatch {
+public:
+    void add(const std::string& s);
+    bool empty() const { return want_.empty(); }
+    // One console byte; true once every string has been seen
+    bool feed(uint8_t c);
+    bool met() const { return met_; }
+
+private:
+    std::vector<std::string> want_;
+    std::vector<bool>        seen_;
+    std::string              tail_;     // the last longest_ bytes
+    size_t                   longest_ = 0;
+    bool                     met_     = false;
+};
+
+class Soc : public Bus {
+public:
+    Soc();
+
+    // $readmemh image (hex words, optional @word-address lines) at base
+    bool load_hex(const std::string& path, uint32_t base);
+
+    // The loadable segments of an executable at their load addresses;
+    // false if one falls outside the memories
+    bool load_elf(const ElfImage& elf);
+
+    // Word at addr from a memory region, without side effects (0 for IO)
+    uint32_t peek(uint32_t addr) const;
+
+    // Checkpoints (checkpoint.h): a memory region as a $readmemh image
+    // (trim: stop after the last nonzero word), and the device state kept
+    // in warm_core.vh
+    bool save_hex(const std::string& path, uint32_t base, bool trim) const;
+    void save_io(uint32_t* warm) const;
+    void restore_io(const uint32_t* warm);
+
+    uint32_t io_read(uint32_t addr, uint64_t cycle, unsigned* wait) override;
+    void     io_write(uint32_t addr, uint32_t wdata, unsigned be,
+                      uint64_t cycle, unsigned* wait) override;
+    void     sync(uint64_t cycle, uint32_t mtime) override;
+    unsigned fetch_cycles(uint32_t addr) override;
+    unsigned data_cycles(uint32_t addr, bool store) override;
+
+    FILE*    console    = stdout;   // nullptr: count the UART bytes only
+    uint64_t uart_bytes = 0;
+    uint32_t exit_code  = 0;        // sim_ctrl EXIT value, once Bus::halt
+    OutputWatch until;              // sets Bus::halt once met
+
+    // Timing model: external-memory and flash cache statistics
+    uint64_t cache_misses = 0;
+
+private:
+    struct Cache {
+        Cache(unsigned ways, unsigned sets, unsigned line_bytes);
+        bool access(uint32_t addr, bool store, bool* dirty_victim);
+        unsigned ways, sets, line_shift;
+        std::vector<uint32_t> tag;      // [set * ways + way], ~0 = invalid
+        std::vector<uint8_t>  dirty;
+        std::vector<uint8_t>  lru;      // per set: most recently used way
+    };
+
+    struct TimerCh {
+        uint32_t cmp = 0, period = 0, duty = 0;
+        uint32_t ctrl = 0;
+        bool     armed = false;
+    };
+
+    struct DmaCh {
+        uint32_t src = 0, dst = 0, len = 0, cfg = 0, next = 0;
+        bool     ie = false;
+    };
+
+    uint32_t mem_read32(uint32_t addr);
+    void     mem_write(uint32_t addr, uint32_t wdata, unsigned be, uint64_t cycle);
+    void     console_putc(uint8_t c);
+
+    void     uart_drain(uint64_t cycle);
+    bool     uart_tx_low() const;
+    void     timer_run(uint32_t mtime);
+    void     dma_run(unsigned ch, bool from_next, uint64_t cycle);
+    uint32_t gpio_in() const;
+    void     gpio_edges(uint32_t before);
+    void     update(uint64_t cycle);
+
+    std::vector<uint8_t> itcm_, dtcm_, ext_, flash_;
+
+    uint64_t last_cycle_ = 0;
+    uint32_t mtime_      = 0;           // at last_cycle_
+
+    // UART
+    uint32_t uart_ctrl_ = 0, uart_baud_;
+    unsigned uart_fifo_ = 0;            // bytes queued behind the shifter
+    bool     uart_busy_ = false;
+    uint64_t uart_done_ = 0;            // cycle the byte in the shifter ends
+    uint8_t  uart_tail_[512];           // last bytes written, for checkpoints
+    unsigned uart_tail_n_ = 0;
+
+    // IRQC
+    uint32_t irq_enable_ = 0;
+    uint32_t irq_src_    = 0;
+
+    // TIMER
+    TimerCh  tmr_[4];
+    uint32_t tmr_match_ = 0;
+
+    // DMA
+    DmaCh    dma_[4];
+    uint32_t dma_done_ = 0;
+
+    // CRC
+    uint32_t crc_mode_ = 0, crc_state_ = 0xFFFFFFFF, crc_count_ = 0;
+
+    // MBOX
+    std::deque<uint32_t> mbox_;
+    bool     mbox_ie_ = false, mbox_ovf_ = false;
+
+    // SEMA
+    uint32_t sema_held_ = 0;
+
+    // GPIO
+    uint32_t gpio_out_ = 0, gpio_dir_ = 0;
+    uint32_t gpio_rise_en_ = 0, gpio_fall_en_ = 0, gpio_high_en_ = 0, gpio_low_en_ = 0;
+    uint32_t gpio_rise_f_ = 0, gpio_fall_f_ = 0, gpio_db_en_ = 0, gpio_db_time_ = 0;
+
+    Cache    icache_, dcache_, flash_cache_;
+};
+
+}  // namespace iss
+
+#endif  // SOC_H
@@ -0,0 +1,234 @@
+`timescale 1ns / 1ps
+
+// qspi_xip against the behavioural flash model.
+// A cold fetch misses and fills the line, prefetch makes the next line
+// hit, a data read is answered as soon as its word arrives (before the
+// line is complete), a demand miss aborts a prefetch, writes are dropped,
+// invalidate and the statistics registers, and random reads on both ports
+// return the flash contents.
+module qspi_xip_tb;
+    reg clk = 0;
+    always #5 clk = ~clk;
+    reg rst_n;
+
+    localparam integer WORDS = 1 << 12;
+    localparam integer DUMMY = 6;
+    // SCK cycles for a whole 8-word line: command, address, dummy, data
+    localparam integer LINE_CLKS = 2 * (8 + 8 + (DUMMY - 2) + 8 * 8);
+
+    reg         i_req;
+    reg  [31:0] i_addr;
+    wire [31:0] i_rdata;
+    wire        i_ack;
+    reg         d_req, d_we;
+    reg  [31:0] d_addr;
+    wire [31:0] d_rdata;
+    wire        d_ack;
+    reg         wr;
+    reg  [7:0]  addr;
+    reg  [31:0] wdata;
+    wire [31:0] rdata;
+    wire        sck, cs_n;
+    wire [3:0]  dq_o, dq_oe;
+    wire [3:0]  dq;
+
+    qspi_xip #(.LINES(16), .LINE_WORDS(8), .DUMMY_CLKS(DUMMY)) dut (
+        .clk(clk), .rst_n(rst_n),
+        .i_req(i_req), .i_addr(i_addr), .i_rdata(i_rdata), .i_ack(i_ack),
+        .d_req(d_req), .d_addr(d_addr), .d_we(d_we), .d_rdata(d_rdata), .d_ack(d_ack),
+        .wr(wr), .addr(addr), .wdata(wdata), .rdata(rdata),
+        .sck(sck), .cs_n(cs_n), .dq_o(dq_o), .dq_oe(dq_oe), .dq_i(dq)
+    );
+
+    genvar g;
+    generate
+        for (g = 0; g < 4; g = g + 1) begin : g_dq
+            assign dq[g] = dq_oe[g] ? dq_o[g] : 1'bz;
+        end
+    endgenerate
+
+    qspi_flash_model #(.WORDS(WORDS), .DUMMY_CLKS(DUMMY)) flash (
+        .sck(sck), .cs_n(cs_n), .dq(dq)
+    );
+
+    localparam         TB_NAME    = "qspi_xip_tb";
+    localparam integer TB_TIMEOUT = 5_000_000;
+    `define TB_IO_REGS
+    `include "tb_common.vh"
+
+    function [31:0] expect_at(input [31:0] a);
+        expect_at = flash.mem[a[13:2]];
+    endfunction
+
+    // Instruction fetch: cycles until i_ack, data in `got`
+    reg  [31:0] got;
+    integer     lat;
+
+    task fetch(input [31:0] a);
+        begin
+            @(negedge clk);
+            i_req = 1; i_addr = a;
+            @(negedge clk);
+            i_req = 0;
+            lat = 1;
+            while (!i_ack) begin
+                @(negedge clk);
+                lat = lat + 1;
+            end
+            got = i_rdata;
+        end
+    endtask
+
+    task dread(input [31:0] a);
+        begin
+            @(negedge clk);
+            d_req = 1; d_we = 0; d_addr = a;
+            @(negedge clk);
+            d_req = 0;
+            lat = 1;
+            while (!d_ack) begin
+                @(negedge clk);
+                lat = lat + 1;
+            end
+            got = d_rdata;
+        end
+    endtask
+
+    task dwrite(input [31:0] a);
+        begin
+            @(negedge clk);
+            d_req = 1; d_we = 1; d_addr = a;
+            @(negedge clk);
+            d_req = 0;
+            lat = 1;
+            while (!d_ack) begin
+                @(negedge clk);
+                lat = lat + 1;
+            end
+        end
+    endtask
+
+    // Engine idle for a few cycles in a row (a prefetch starts one cycle
+    // after a fill ends, so a single idle cycle proves nothing)
+    task wait_idle;
+        integer quiet;
+        reg [31:0] st;
+        begin
+            quiet = 0;
+            while (quiet < 8) begin
+                @(negedge clk);
+                reg_rd(8'h04, st);
+                if (st != 0 || dut.q_state != 0)
+                    quiet = 0;
+                else
+                    quiet = quiet + 1;
+            end
+        end
+    endtask
+
+    integer i, hits0, miss0, cold;
+    reg [31:0] a, v;
+
+    initial begin
+        i_req = 0; i_addr = 0; d_req = 0; d_we = 0; d_addr = 0;
+        wr = 0; addr = 0; wdata = 0;
+        #1;
+        for (i = 0; i < WORDS; i = i + 1)
+            flash.mem[i] = {i[15:0] ^ 16'hA5C3, ~i[15:0]};
+        rst_n = 0;
+        repeat (3) @(negedge clk);
+        rst_n = 1;
+        wait_idle;
+
+        // 1. Cold fetch, then sequential code hits thanks to prefetch
+        fetch(32'h0000_0100);
+        cold = lat;
+        check(got == expect_at(32'h100), "cold fetch data");
+        check(lat > 40 && lat < LINE_CLKS, "cold fetch waits for its word only");
+        for (i = 1; i < 8; i = i + 1) begin
+            fetch(32'h100 + 4 * i);
+            check(got == expect_at(32'h100 + 4 * i), "same-line fetch data");
+        end
+        wait_idle;
+        reg_rd(8'h10, v);
+        check(v == 1, "next line prefetched");
+        reg_wr(8'h08, 0);
+        for (i = 8; i < 16; i = i + 1) begin
+            fetch(32'h100 + 4 * i);
+            check(got == expect_at(32'h100 + 4 * i), "prefetched line data");
+            check(lat == 1, "prefetched line hits");
+        end
+        reg_rd(8'h08, v);
+        check(v == 8, "HITS counts the hits");
+
+        // 2. Data read answered at its word, before the line is complete
+        reg_wr(8'h00, 32'h0);                       // prefetch off
+        wait_idle;
+        dread(32'h0000_0814);                       // word 5 of its line
+        check(got == expect_at(32'h814), "early word data");
+        check(lat < LINE_CLKS - 8, "early word before the line end");
+        check(!cs_n, "line still filling at the ack");
+        wait_idle;
+        dread(32'h0000_081C);
+        check(got == expect_at(32'h81C) && lat <= 2, "rest of the line hits");
+        repeat (LINE_CLKS) @(negedge clk);
+        check(cs_n, "no prefetch when disabled");
+
+        // 3. A demand miss aborts a running prefetch
+        reg_wr(8'h00, 32'h1);
+        fetch(32'h0000_0400);
+        wait_idle;                                  // line 0x420 prefetched
+        fetch(32'h0000_0420);                       // hit, starts prefetch of 0x440
+        repeat (6) @(negedge clk);
+        check(!cs_n && dut.fill_pref, "prefetch running");
+        dread(32'h0000_3000);
+        check(got == expect_at(32'h3000), "data after the abort");
+        check(lat <= cold + 8, "abort did not wait for the prefetch");
+        wait_idle;
+        fetch(32'h0000_0444);
+        check(got == expect_at(32'h444), "aborted line refetched");
+
+        // 4. Writes are acked and dropped
+        dwrite(32'h0000_3004);
+        check(lat <= 2, "write acked at once");
+        dread(32'h0000_3004);
+        check(got == expect_at(32'h3004), "write dropped");
+
+        // 5. Invalidate and the statistics registers
+        reg_wr(8'h00, 32'h0);
+        wait_idle;
+        reg_wr(8'h00, 32'h2);                       // invalidate, prefetch off
+        reg_rd(8'h00, v);
+        check(v == 0, "CTRL reads prefetch off");
+        reg_rd(8'h0C, miss0);
+        reg_rd(8'h08, hits0);
+        dread(32'h0000_3004);
+        reg_rd(8'h0C, v);
+        check(v == miss0 + 1, "invalidated line misses");
+        reg_rd(8'h08, v);
+        check(v == hits0, "no hit counted on the miss");
+        reg_wr(8'h0C, 0);
+        reg_wr(8'h10, 0);
+        reg_rd(8'h0C, v);
+        check(v == 0, "MISSES clears on write");
+        reg_rd(8'h10, v);
+        check(v == 0, "PREF clears on write");
+
+        // 6. Random reads on both ports, prefetch on
+        reg_wr(8'h00, 32'h1);
+        for (i = 0; i < 300; i = i + 1) begin
+            a = ($random & (WORDS * 4 - 1)) & ~32'h3;
+            if (i & 1) begin
+                fetch(a);
+                check(got == expect_at(a), "random fetch data");
+            end else begin
+                dread(a);
+                check(got == expect_at(a), "random read data");
+            end
+            if (($random & 3) == 0)
+                repeat ($random & 63) @(negedge clk);
+        end
+
+        tb_finish;
+    end
+endmodule
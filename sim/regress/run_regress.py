@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+"""
+Firmware regression: builds every firmware image (the firmware/build_debug.sh
+variants, demos included) into its own directory, simulates them in
+parallel and checks each one's console output, reporting pass/fail and
+cycles to completion per image.
+
+  trap_test, timer_test     end themselves through sim_ctrl EXIT: pass on
+                            exit code 0 with the summary line printed
+  context_test, freertos,   run forever: the run stops (--until) once every
+  mutex_demo, queue_demo    expected line has appeared, and that cycle is
+                            the completion time
+
+Images are built with SIM_CONSOLE=1 (console output in one IO write instead
+of UART bit times). Any of the failure markers below, a watchdog or restart
+stop, or a missing expected line fails the image.
+
+Usage: python3 sim/regress/run_regress.py [options]
+  --sim verilator|iss  simulator (default verilator: the RTL; the ISS runs
+                       with --timing, so its cycles are estimates)
+  --only GLOB          run only images whose name matches
+  -j N                 parallel jobs (default: all host cores)
+  --cycles N           cycle limit for every image (default: per image)
+  --out DIR            build and log directory (default obj_regress)
+  --baseline FILE      results.txt of an earlier run: an image that takes
+                       more than --slack percent more cycles fails as SLOW
+  --slack PCT          allowed slowdown against --baseline (default 2)
+  --no-build           simulate the images built last time
+  --no-build-sim       use the simulator built last time
+
+The toolchain prefix comes from RISCV_PREFIX (default riscv64-unknown-elf-,
+as firmware/build_debug.sh). Exit status: 0 = every image passed, 1 = not.
+"""
+import argparse
+import concurrent.futures
+import fnmatch
+import os
+import re
+import subprocess
+import sys
+from pathlib import Path
+
+HERE = Path(__file__).resolve().parent
+ROOT = HERE.parent.parent
+
+ISS_BIN = ROOT / "obj_iss" / "iss"
+VERILATOR_BIN = ROOT / "obj_verilator" / "t1_tr0" / "Vsim_top"
+
+# Printed by the firmware or the harnesses when something went wrong
+FAIL_MARKERS = ("[FAIL]", "FAILED", "ERROR", "RESTART DETECTED", "PC stuck at",
+                "diverged", "Too many restarts")
+
+
+class Image:
+    def __init__(self, name, expect, cycles, exits=False):
+        self.name = name            # build_debug.sh target
+        self.expect = expect        # console lines that must appear (CR dropped)
+        self.cycles = cycles        # default cycle limit
+        self.exits = exits          # ends through sim_ctrl EXIT
+
+
+IMAGES = [
+    Image("trap_test", ["*** ALL TESTS PASSED ***", "[END OF TRAP TESTS]"],
+          5_000_000, exits=True),
+    Image("timer_test", ["*** TIMER TEST PASSED ***", "[END OF TIMER TEST]"],
+          10_000_000, exits=True),
+    Image("context_test", ["[Task1] count=5,", "[Task2] count=5,"], 5_000_000),
+    Image("freertos", ["[A] 3\n", "[B] 3\n", "[C] 3\n"], 50_000_000),
+    Image("mutex_demo", ["[OK] Mutex created!", "[A] Mutex acquired! Count: 3\n",
+                         "[B] Mutex acquired! Count: 3\n"], 50_000_000),
+    Image("queue_demo", ["[OK] Queue created (5 slots)!",
+                         "[Consumer] Received from P: 3\n"], 50_000_000),
+]
+
+
+def run(cmd, cwd=None, env=None, log=None):
+    p = subprocess.run([str(c) for c in cmd], cwd=cwd, env=env, stdout=subprocess.PIPE,
+                       stderr=subprocess.STDOUT, text=True, errors="replace")
+    if log is not None:
+        log.write("$ " + " ".join(str(c) for c in cmd) + "\n" + p.stdout)
+    return p
+
+
+def build_sims(args):
+    (ROOT / "obj_iss").mkdir(exist_ok=True)
+    if args.sim == "iss":
+        print("Building ISS (obj_iss/iss)...")
+        # Same command as run_iss.sh
+        p = run(["g++", "-O2", "-std=c++14", "-Wall", "-I", ROOT / "firmware",
+                 "-o", ISS_BIN, ROOT / "sim/iss/rv32_iss.cpp",
+                 ROOT / "sim/iss/soc.cpp", ROOT / "sim/iss/checkpoint.cpp",
+                 ROOT / "sim/iss/elf.cpp", ROOT / "sim/iss/iss_main.cpp"])
+    else:
+        print("Building Verilator model...")
+        p = run([ROOT / "run_verilator_sim.sh", "--build-only"], cwd=ROOT)
+    if p.returncode:
+        sys.exit(p.stdout + "ERROR: simulator build failed")
+
+
+def run_image(img, args):
+    out = Path(args.out).resolve() / img.name
+    out.mkdir(parents=True, exist_ok=True)
+    with open(out / "run.log", "w") as log:
+        if not args.no_build:
+            env = dict(os.environ, OUT=str(out), SIM_CONSOLE="1")
+            if run([ROOT / "firmware" / "build_debug.sh", img.name],
+                   cwd=ROOT / "firmware", env=env, log=log).returncode:
+                return "ERROR", "build failed", 0
+        if not (out / "instr_mem.vh").exists():
+            return "ERROR", "no image (build first)", 0
+
+        cycles = args.cycles or img.cycles
+        cmd = [ISS_BIN, "--timing"] if args.sim == "iss" else [VERILATOR_BIN]
+        cmd += ["--dir", out, "--cycles", cycles]
+        if not img.exits:
+            for e in img.expect:
+                cmd += ["--until", e]
+        p = run(cmd, log=log)
+
+    text = p.stdout.replace("\r", "")
+    m = (re.search(r"Expected output seen after (\d+) cycles", text) or
+         re.search(r"\[(?:ISS\] \d+ instructions,|SIM\]) (\d+) cycles", text))
+    used = int(m.group(1)) if m else 0
+
+    bad = next((f for f in FAIL_MARKERS if f in text), None)
+    if bad:
+        return "FAIL", f"'{bad}' in the output", used
+    missing = [e.strip() for e in img.expect if e not in text]
+    if missing:
+        return "FAIL", f"missing '{missing[0]}'", used
+    if p.returncode:
+        return "FAIL", f"exit status {p.returncode}", used
+    if img.exits and "Firmware exit" not in text:
+        return "FAIL", f"no firmware exit within {cycles} cycles", used
+    return "PASS", "", used
+
+
+def read_results(path):
+    base = {}
+    for line in Path(path).read_text().splitlines():
+        f = line.split()
+        if len(f) >= 3 and f[2].isdigit():
+            base[f[1]] = (f[0], int(f[2]))
+    return base
+
+
+def main():
+    ap = argparse.ArgumentParser(add_help=False)
+    ap.add_argument("--sim", choices=("verilator", "iss"), default="verilator")
+    ap.add_argument("--only")
+    ap.add_argument("-j", type=int, default=os.cpu_count() or 1)
+    ap.add_argument("--cycles", type=int, default=0)
+    ap.add_argument("--out", default=str(ROOT / "obj_regress"))
+    ap.add_argument("--baseline")
+    ap.add_argument("--slack", type=float, default=2.0)
+    ap.add_argument("--no-build", action="store_true")
+    ap.add_argument("--no-build-sim", action="store_true")
+    ap.add_argument("-h", "--help", action="store_true")
+    args = ap.parse_args()
+    if args.help:
+        print(__doc__.strip())
+        return 0
+
+    images = [i for i in IMAGES if not args.only or fnmatch.fnmatch(i.name, args.only)]
+    if not images:
+        print("No images selected")
+        return 2
+    base = read_results(args.baseline) if args.baseline else {}
+    if not args.no_build:
+        # Once up front: the parallel builds then find memmap.* up to date
+        if run([sys.executable, "memmap.py"], cwd=ROOT / "firmware").returncode:
+            sys.exit("ERROR: memmap.py failed")
+    if not args.no_build_sim:
+        build_sims(args)
+
+    print(f"Running {len(images)} images on {args.sim} ({args.j} jobs)...")
+    results = {}
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.j) as pool:
+        futures = {pool.submit(run_image, i, args): i for i in images}
+        for f in concurrent.futures.as_completed(futures):
+            img = futures[f]
+            status, detail, cycles = f.result()
+            if img.name in base and base[img.name][1] and status == "PASS":
+                was = base[img.name][1]
+                delta = 100.0 * (cycles - was) / was
+                if delta > args.slack:
+                    status = "SLOW"
+                detail = f"{delta:+.1f}% vs {was}"
+            results[img.name] = (status, detail, cycles)
+            print(f"  {status:5s} {img.name:14s} {cycles:>10d} cycles  {detail}", flush=True)
+
+    passed = sum(1 for s, _, _ in results.values() if s == "PASS")
+    lines = [f"{s:5s} {name:14s} {c:>10d}  {d}"
+             for name, (s, d, c) in sorted(results.items())]
+    (Path(args.out) / "results.txt").write_text("\n".join(lines) + "\n")
+    print("========================================")
+    print(f"{passed}/{len(results)} passed (details: {args.out}/results.txt, "
+          f"per-image logs in {args.out}/<image>/run.log)")
+    return 0 if passed == len(results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,68 @@
+// Scaffold of the block-level testbenches in sim/: included inside the
+// testbench module, which first declares clk and
+//   localparam TB_NAME            = "<module>";   // prefix of the verdict
+//   localparam integer TB_TIMEOUT = <ns>;         // run limit
+// and, for reg_wr() / reg_rd(), `define TB_IO_REGS and the IO slave
+// port regs wr, addr[7:0], wdata and wire rdata. With TB_IO_BE also
+// defined, the port has byte enables (reg be[3:0]) and reg_wr() takes them.
+//
+// Compile with -I sim (as run_firmware_sim.sh does for warm_start.vh).
+//
+// check() counts failures, tb_finish() prints "<TB_NAME>: PASS|FAIL (n
+// errors)" and ends the run; reaching TB_TIMEOUT is a FAIL.
+
+integer errors = 0;
+
+task check(input cond, input [8*48-1:0] what);
+    begin
+        if (!cond) begin
+            $display("  FAIL: %0s (t=%0t)", what, $time);
+            errors = errors + 1;
+        end
+    end
+endtask
+
+task tb_finish;
+    begin
+        $display("%0s: %s (%0d errors)", TB_NAME, errors == 0 ? "PASS" : "FAIL", errors);
+        $finish;
+    end
+endtask
+
+initial begin
+    #(TB_TIMEOUT);
+    $display("%0s: FAIL (timeout)", TB_NAME);
+    $finish;
+end
+
+`ifdef TB_IO_REGS
+// One IO write, on the falling edges so the DUT samples it cleanly
+`ifdef TB_IO_BE
+task reg_wr(input [7:0] a, input [31:0] d, input [3:0] e);
+    begin
+        @(negedge clk);
+        wr = 1; addr = a; wdata = d; be = e;
+        @(negedge clk);
+        wr = 0;
+    end
+endtask
+`else
+task reg_wr(input [7:0] a, input [31:0] d);
+    begin
+        @(negedge clk);
+        wr = 1; addr = a; wdata = d;
+        @(negedge clk);
+        wr = 0;
+    end
+endtask
+`endif
+
+// Side-effect-free look at a register (rdata is combinational). A task:
+// functions may not wait for rdata to settle.
+task reg_rd(input [7:0] a, output [31:0] d);
+    begin
+        addr = a;
+        #1 d = rdata;
+    end
+endtask
+`endif
@@ -0,0 +1,214 @@
+`timescale 1ns / 1ps
+
+// uart_rx + uart_rx_fifo driven from a serial line model.
+// Checks back-to-back frames (no idle between stop and next start bit),
+// the threshold and idle-timeout interrupt conditions, framing errors,
+// overrun, and a 600-byte stream read only from the "interrupt" (pop when
+// thr_hit/timeout, with ISR entry latency) - nothing may be lost. Finally
+// the fractional divisor at 8.33 clocks per bit (3 Mbaud at 25 MHz) with
+// the sender 2% fast and 2% slow.
+module uart_rx_fifo_tb;
+    reg clk = 0;
+    always #5 clk = ~clk;
+    reg rst_n;
+
+    localparam integer BIT   = 16;                 // clocks per bit
+    localparam integer DEPTH = 16;
+
+    reg         rxd = 1'b1;
+    wire        rx_valid, rx_ferr;
+    wire [7:0]  rx_data;
+
+    reg  [19:0] divisor = BIT * 16;
+    real        bit_ns  = BIT * 10.0;              // sender's bit period
+
+    uart_rx #(
+        .PAYLOAD_BITS(8)
+    ) u_rx (
+        .clk(clk), .resetn(rst_n), .divisor(divisor),
+        .uart_rxd(rxd), .uart_rx_en(1'b1),
+        .uart_rx_break(), .uart_rx_valid(rx_valid), .uart_rx_ferr(rx_ferr),
+        .uart_rx_data(rx_data)
+    );
+
+    reg         pop, clr_overrun, clr_ferr;
+    reg  [7:0]  threshold, timeout_bits;
+    wire [7:0]  head;
+    wire [$clog2(DEPTH):0] count;
+    wire        empty, full, overrun, ferr, thr_hit, timeout;
+
+    uart_rx_fifo #(.DEPTH(DEPTH)) dut (
+        .clk(clk), .rst_n(rst_n),
+        .rx_valid(rx_valid), .rx_data(rx_data), .rx_ferr(rx_ferr),
+        .pop(pop), .head(head), .count(count), .empty(empty), .full(full),
+        .overrun(overrun), .ferr(ferr),
+        .clr_overrun(clr_overrun), .clr_ferr(clr_ferr),
+        .bit_cycles(BIT[15:0]), .threshold(threshold), .timeout_bits(timeout_bits),
+        .thr_hit(thr_hit), .timeout(timeout)
+    );
+
+    localparam         TB_NAME    = "uart_rx_fifo_tb";
+    localparam integer TB_TIMEOUT = 20_000_000;
+    `include "tb_common.vh"
+
+    // ------------------------------------------------------------
+    // Line driver: 8N1, LSB first, bit_ns per bit (not tied to clk);
+    // stop_ok=0 sends a low stop bit
+    // ------------------------------------------------------------
+    task send(input [7:0] b, input stop_ok);
+        integer i;
+        begin
+            rxd = 1'b0;
+            #(bit_ns);
+            for (i = 0; i < 8; i = i + 1) begin
+                rxd = b[i];
+                #(bit_ns);
+            end
+            rxd = stop_ok;
+            #(bit_ns);
+            rxd = 1'b1;
+        end
+    endtask
+
+    task pop_one(output [7:0] b);
+        begin
+            @(negedge clk);
+            b   = head;
+            pop = 1'b1;
+            @(negedge clk);
+            pop = 1'b0;
+        end
+    endtask
+
+    // ------------------------------------------------------------
+    // Stream test: sender and "ISR" reader run concurrently
+    // ------------------------------------------------------------
+    localparam integer STREAM = 600;
+    reg        stream_on;
+    integer    rx_idx, isr_count;
+    reg  [7:0] got;
+
+    always @(negedge clk) begin
+        if (stream_on && (thr_hit || timeout)) begin
+            isr_count = isr_count + 1;
+            repeat (40) @(negedge clk);           // trap entry + context save
+            while (!empty) begin
+                pop_one(got);
+                if (got !== rx_idx[7:0] * 8'd7) begin
+                    if (errors < 10)
+                        $display("  stream byte %0d: got %h expected %h",
+                                 rx_idx, got, rx_idx[7:0] * 8'd7);
+                    errors = errors + 1;
+                end
+                rx_idx = rx_idx + 1;
+                repeat (6) @(negedge clk);        // lw + sb + loop per byte
+            end
+        end
+    end
+
+    integer i, k;
+    reg [7:0] b;
+
+    initial begin
+        stream_on = 0; rx_idx = 0; isr_count = 0;
+        pop = 0; clr_overrun = 0; clr_ferr = 0;
+        threshold = 0; timeout_bits = 0;
+        rst_n = 0;
+        repeat (4) @(negedge clk);
+        rst_n = 1;
+        repeat (4) @(negedge clk);
+
+        // 1. Back-to-back frames
+        for (i = 0; i < 12; i = i + 1)
+            send(8'h30 + i, 1'b1);
+        repeat (BIT) @(posedge clk);
+        check(count == 12, "12 back-to-back frames queued");
+        for (i = 0; i < 12; i = i + 1) begin
+            pop_one(b);
+            check(b == 8'h30 + i, "back-to-back data");
+        end
+        check(empty && !overrun && !ferr, "clean after back-to-back");
+
+        // 2. Threshold
+        threshold = 8'd5;
+        for (i = 0; i < 4; i = i + 1)
+            send(8'hA0 + i, 1'b1);
+        repeat (BIT) @(posedge clk);
+        check(!thr_hit, "threshold not yet reached");
+        send(8'hA4, 1'b1);
+        repeat (BIT) @(posedge clk);
+        check(thr_hit, "threshold reached");
+        while (!empty) pop_one(b);
+        check(!thr_hit, "threshold clears when drained");
+        threshold = 8'd0;
+
+        // 3. Idle timeout (two bytes, below any threshold)
+        timeout_bits = 8'd20;
+        send(8'h55, 1'b1);
+        send(8'h66, 1'b1);
+        repeat (15 * BIT) @(posedge clk);
+        check(!timeout, "no timeout before 20 idle bits");
+        repeat (10 * BIT) @(posedge clk);
+        check(timeout, "timeout after 20 idle bits");
+        pop_one(b);
+        check(!timeout, "read restarts the idle timer");
+        pop_one(b);
+        check(b == 8'h66 && empty, "timeout data");
+
+        // 4. Framing error: byte kept, sticky flag, clear
+        send(8'h3C, 1'b0);
+        repeat (2 * BIT) @(posedge clk);
+        check(ferr && count == 1, "framing error flagged");
+        send(8'h3D, 1'b1);
+        repeat (BIT) @(posedge clk);
+        check(ferr, "framing error is sticky");
+        @(negedge clk) clr_ferr = 1'b1;
+        @(negedge clk) clr_ferr = 1'b0;
+        check(!ferr, "framing error cleared");
+        while (!empty) pop_one(b);
+        check(b == 8'h3D, "byte after framing error");
+
+        // 5. Overrun: DEPTH + 3 bytes with no reader
+        for (i = 0; i < DEPTH + 3; i = i + 1)
+            send(i[7:0], 1'b1);
+        repeat (BIT) @(posedge clk);
+        check(full && overrun, "overrun flagged when full");
+        for (i = 0; i < DEPTH; i = i + 1) begin
+            pop_one(b);
+            check(b == i[7:0], "oldest bytes kept on overrun");
+        end
+        @(negedge clk) clr_overrun = 1'b1;
+        @(negedge clk) clr_overrun = 1'b0;
+        check(!overrun && empty, "overrun cleared");
+
+        // 6. Continuous stream, read only from the interrupt conditions
+        threshold    = DEPTH / 2;
+        timeout_bits = 8'd40;
+        stream_on    = 1'b1;
+        for (i = 0; i < STREAM; i = i + 1)
+            send(i[7:0] * 8'd7, 1'b1);
+        repeat (60 * BIT) @(posedge clk);
+        stream_on = 1'b0;
+        check(rx_idx == STREAM, "stream: every byte delivered");
+        check(!overrun && !ferr, "stream: no overrun");
+        $display("uart_rx_fifo_tb: %0d-byte stream in %0d interrupts", rx_idx, isr_count);
+
+        // 7. 3 Mbaud at 25 MHz = 8.333 clocks per bit; divisor 133/16 =
+        //    8.3125. Sender 2% fast, then 2% slow, back-to-back frames.
+        threshold = 0; timeout_bits = 0;
+        divisor   = 20'd133;
+        for (k = 0; k < 2; k = k + 1) begin
+            bit_ns = (25.0 / 3.0) * 10.0 * (k == 0 ? 0.98 : 1.02);
+            for (i = 0; i < DEPTH; i = i + 1)
+                send(8'hC3 ^ (i * 37), 1'b1);
+            #(4 * bit_ns);
+            check(count == DEPTH && !ferr, "3 Mbaud: all frames received");
+            for (i = 0; i < DEPTH; i = i + 1) begin
+                pop_one(b);
+                check(b == (8'hC3 ^ (i * 37)), "3 Mbaud: data");
+            end
+        end
+
+        tb_finish;
+    end
+endmodule
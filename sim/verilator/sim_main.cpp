@@ -0,0 +1,477 @@
+// Verilator harness for full-firmware runs: the C++ counterpart of
+// firmware_sim_tb.sv. Drives the clock, decodes UART TX, and applies the
+// same PC watchdog and restart detection, so logs match the iverilog run.
+// With --cosim, every instruction the core retires is also stepped on the
+// ISS (sim/iss/cosim.h) and the run stops at the first divergence.
+// --warm starts from a checkpoint directory (sim/iss/checkpoint.h) instead
+// of reset; --checkpoint-at / --checkpoint write one from this run, taken
+// from the lockstep ISS (so they imply --cosim).
+//
+// Built by run_verilator_sim.sh; run from the directory holding
+// instr_mem.vh / ext_mem.vh / flash_mem.vh (or pass --dir), or give the
+// executable with --elf: its segments are written into the memories
+// through sim_top's backdoor, and markers can name its symbols.
+//
+// Exit status: 0 = ran to the cycle limit (or saw the --until output),
+// 1 = watchdog, restart limit or co-simulation divergence, 2 = bad
+// arguments; a firmware exit through sim_ctrl.v returns its code instead
+// (low byte, nonzero stays nonzero).
+
+#include "Vsim_top.h"
+#include "Vsim_top__Dpi.h"
+#include "svdpi.h"
+#include "verilated.h"
+#if VM_TRACE
+#include "verilated_vcd_c.h"
+#endif
+
+#include "cosim.h"
+#include "checkpoint.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct Options {
+    uint64_t    cycles       = 10000000;  // 400 ms at 25 MHz, as the tb
+    uint64_t    stuck        = 1000000;   // PC watchdog
+    unsigned    max_restarts = 3;
+    std::string dir;
+    std::string trace;
+    uint64_t    trace_start  = 0;
+    uint64_t    trace_cycles = UINT64_MAX;
+    bool        cosim        = false;
+    std::string signature;
+    uint64_t    sig_begin    = 0;
+    uint64_t    sig_end      = 0;
+    bool        warm         = false;
+    std::string elf;
+    std::string checkpoint;
+    std::string mark;                     // --checkpoint-at, resolved after loading
+    std::vector<std::string> until;
+    uint32_t    mark_pc      = ~0u;
+    uint64_t    mark_count   = 0;
+};
+
+void usage(const char* prog) {
+    std::fprintf(stderr,
+        "usage: %s [options] [+verilator+...]\n"
+        "  --cycles N        stop after N cycles (default 10000000)\n"
+        "  --stuck N         PC watchdog: halt when PC holds for N cycles (default\n"
+        "                    1000000, 0 = off)\n"
+        "  --max-restarts N  stop after N+1 jumps back to 0 (default 3)\n"
+        "  --dir DIR         directory with instr_mem.vh, ext_mem.vh, flash_mem.vh\n"
+        "  --trace FILE      write a VCD (model built with --trace)\n"
+        "  --trace-start N   first traced cycle (default 0)\n"
+        "  --trace-cycles N  number of traced cycles (default: to the end)\n"
+        "  --cosim           check every retired instruction against the ISS\n"
+        "  --signature FILE  at the end, dump the ITCM words in [--sig-begin,\n"
+        "                    --sig-end) one per line (riscv-arch-test format)\n"
+        "  --elf FILE        load the executable's segments over the images\n"
+        "  --warm            start from the checkpoint in the image directory\n"
+        "  --checkpoint DIR  write a checkpoint to DIR at the marker and stop\n"
+        "                    (implies --cosim)\n"
+        "  --checkpoint-at PC[:N]  marker: in front of the Nth execution of PC\n"
+        "                    (an address, or a symbol with --elf)\n"
+        "  --until TEXT      stop once TEXT has been printed (repeatable: all of them)\n",
+        prog);
+}
+
+bool parse_u64(const char* s, uint64_t* out) {
+    char* end;
+    unsigned long long v = std::strtoull(s, &end, 0);
+    if (*s == '\0' || *end != '\0')
+        return false;
+    *out = v;
+    return true;
+}
+
+bool parse_args(int argc, char** argv, Options* o) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a[0] == '+')
+            continue;                          // Verilator runtime options
+        if (a == "-h" || a == "--help")
+            return false;
+        if (a == "--cosim") {
+            o->cosim = true;
+            continue;
+        }
+        if (a == "--warm") {
+            o->warm = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "%s: missing value\n", a.c_str());
+            return false;
+        }
+        const char* v = argv[++i];
+        uint64_t n;
+        if (a == "--dir") {
+            o->dir = v;
+        } else if (a == "--trace") {
+            o->trace = v;
+        } else if (a == "--signature") {
+            o->signature = v;
+        } else if (a == "--checkpoint") {
+            o->checkpoint = v;
+        } else if (a == "--elf") {
+            o->elf = v;
+        } else if (a == "--checkpoint-at") {
+            o->mark = v;
+        } else if (a == "--until") {
+            o->until.push_back(v);
+        } else if (!parse_u64(v, &n)) {
+            std::fprintf(stderr, "%s: bad number '%s'\n", a.c_str(), v);
+            return false;
+        } else if (a == "--cycles") {
+            o->cycles = n;
+        } else if (a == "--stuck") {
+            o->stuck = n;
+        } else if (a == "--max-restarts") {
+            o->max_restarts = unsigned(n);
+        } else if (a == "--trace-start") {
+            o->trace_start = n;
+        } else if (a == "--trace-cycles") {
+            o->trace_cycles = n;
+        } else if (a == "--sig-begin") {
+            o->sig_begin = n;
+        } else if (a == "--sig-end") {
+            o->sig_end = n;
+        } else {
+            std::fprintf(stderr, "unknown option %s\n", a.c_str());
+            return false;
+        }
+    }
+    if (o->checkpoint.empty() != o->mark.empty()) {
+        std::fprintf(stderr, "--checkpoint and --checkpoint-at go together\n");
+        return false;
+    }
+    if (!o->checkpoint.empty())
+        o->cosim = true;
+    return true;
+}
+
+// 8N1 receiver on the TX pin. The bit period comes from the core's BAUD
+// register (cycles * 16) so runtime baud changes decode without options;
+// positions are kept in 1/16 cycles like uart_tx.v.
+class UartDecoder {
+public:
+    // Returns the byte that completed on this cycle, or -1
+    int clock(bool tx, uint32_t divisor) {
+        int out = -1;
+        if (!active_) {
+            if (prev_ && !tx) {                // start bit edge
+                active_ = true;
+                pos_    = 0;
+                next_   = divisor / 2;         // middle of the start bit
+                bit_    = 0;
+                shift_  = 0;
+            }
+        } else {
+            pos_ += 16;
+            if (pos_ >= next_) {
+                next_ += divisor;
+                if (bit_ == 0) {
+                    if (tx)
+                        active_ = false;       // glitch, not a start bit
+                } else if (bit_ <= 8) {
+                    shift_ |= uint8_t(tx) << (bit_ - 1);
+                } else {
+                    active_ = false;
+                    emit(shift_);
+                    out = shift_;
+                }
+                bit_++;
+            }
+        }
+        prev_ = tx;
+        return out;
+    }
+
+private:
+    static void emit(uint8_t c) {
+        if (c >= 32 && c < 127)
+            std::putchar(c);
+        else if (c == '\n')
+            std::putchar('\n');
+        else if (c != '\r')
+            std::printf("[0x%02x]", c);
+        if (c == '\n')
+            std::fflush(stdout);
+    }
+
+    bool     prev_   = true;
+    bool     active_ = false;
+    uint64_t pos_    = 0;
+    uint64_t next_   = 0;
+    unsigned bit_    = 0;
+    uint8_t  shift_  = 0;
+};
+
+iss::Rvfi rvfi_record(const Vsim_top& t) {
+    iss::Rvfi r;
+    r.order     = t.rvfi_order;
+    r.insn      = t.rvfi_insn;
+    r.trap      = t.rvfi_trap;
+    r.intr      = t.rvfi_intr;
+    r.pc_rdata  = t.rvfi_pc_rdata;
+    r.pc_wdata  = t.rvfi_pc_wdata;
+    r.rs1_addr  = t.rvfi_rs1_addr;
+    r.rs2_addr  = t.rvfi_rs2_addr;
+    r.rs1_rdata = t.rvfi_rs1_rdata;
+    r.rs2_rdata = t.rvfi_rs2_rdata;
+    r.rd_addr   = t.rvfi_rd_addr;
+    r.rd_wdata  = t.rvfi_rd_wdata;
+    r.mem_addr  = t.rvfi_mem_addr;
+    r.mem_rmask = t.rvfi_mem_rmask;
+    r.mem_wmask = t.rvfi_mem_wmask;
+    r.mem_rdata = t.rvfi_mem_rdata;
+    r.mem_wdata = t.rvfi_mem_wdata;
+    return r;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    if (!parse_args(argc, argv, &opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+    iss::ElfImage elf;
+    if (!opt.elf.empty() && !elf.load(opt.elf)) {
+        std::fprintf(stderr, "%s\n", elf.error().c_str());
+        return 2;
+    }
+    if (!opt.mark.empty() &&
+        !iss::parse_marker(opt.mark, opt.elf.empty() ? nullptr : &elf,
+                           &opt.mark_pc, &opt.mark_count)) {
+        std::fprintf(stderr, "--checkpoint-at: bad marker '%s' (PC, symbol, :N)\n",
+                     opt.mark.c_str());
+        return 2;
+    }
+    char cwd[4096];
+    if (!opt.checkpoint.empty() && opt.checkpoint[0] != '/' && getcwd(cwd, sizeof(cwd)))
+        opt.checkpoint = std::string(cwd) + "/" + opt.checkpoint;
+    if (!opt.dir.empty() && chdir(opt.dir.c_str()) != 0) {
+        std::perror(opt.dir.c_str());
+        return 2;
+    }
+
+    auto ctx = std::make_unique<VerilatedContext>();
+    ctx->commandArgs(argc, argv);
+    auto top = std::make_unique<Vsim_top>(ctx.get(), "TOP");
+
+#if VM_TRACE
+    std::unique_ptr<VerilatedVcdC> vcd;
+    if (!opt.trace.empty()) {
+        ctx->traceEverOn(true);
+        vcd = std::make_unique<VerilatedVcdC>();
+        top->trace(vcd.get(), 99);
+        vcd->open(opt.trace.c_str());
+    }
+#else
+    if (!opt.trace.empty()) {
+        std::fprintf(stderr, "--trace: model built without --trace\n");
+        return 2;
+    }
+#endif
+
+    std::unique_ptr<iss::Lockstep> cosim;
+    if (opt.cosim) {
+        cosim = std::make_unique<iss::Lockstep>();
+        if (!opt.elf.empty()) {
+            if (!cosim->load_elf(elf)) {
+                std::fprintf(stderr, "%s: segment outside the memories\n", opt.elf.c_str());
+                return 2;
+            }
+        } else if (!cosim->load("instr_mem.vh", "ext_mem.vh", "flash_mem.vh")) {
+            std::perror("instr_mem.vh");
+            return 2;
+        }
+        if (opt.warm && !cosim->warm(".")) {
+            std::perror("warm_core.vh / dtcm_mem.vh");
+            return 2;
+        }
+    }
+
+    std::printf("[SIM] Starting firmware simulation (Verilator%s)...\n",
+                opt.cosim ? ", lockstep with the ISS" : "");
+    std::printf("[SIM] Monitoring PC and UART output\n");
+    std::printf("[SIM] Will stop on: %u restarts OR PC stuck for %llu cycles\n",
+                opt.max_restarts, (unsigned long long)opt.stuck);
+    std::printf("========================================\n");
+
+    UartDecoder uart;
+    iss::OutputWatch until;
+    for (const std::string& s : opt.until)
+        until.add(s);
+    uint32_t last_pc  = 0;
+    uint32_t watch_pc = 0;
+    uint64_t stuck    = 0;
+    uint64_t hits     = 0;
+    bool     saved    = false;
+    unsigned restarts = 0;
+    int      status   = 0;
+    uint64_t cycle    = 0;
+    const uint64_t reset_cycles = 10;
+
+    top->clk     = 0;
+    top->rst_n   = 0;
+    top->uart_rx = 1;                          // idle high
+    top->warm_start = opt.warm;
+    top->eval();
+
+    // The first eval ran the initial blocks ($readmemh of whatever images
+    // are present); the ELF goes on top of them
+    if (!opt.elf.empty()) {
+        svSetScope(svGetScopeFromName("TOP.sim_top"));
+        for (const iss::ElfImage::Segment& seg : elf.segments) {
+            for (size_t i = 0; i < seg.data.size(); i += 4) {
+                uint32_t w = 0;
+                std::memcpy(&w, &seg.data[i], std::min<size_t>(4, seg.data.size() - i));
+                if ((seg.addr & 3) || !sim_mem_write(seg.addr + uint32_t(i), w)) {
+                    std::fprintf(stderr, "%s: cannot load 0x%08x\n", opt.elf.c_str(),
+                                 seg.addr + uint32_t(i));
+                    return 2;
+                }
+            }
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    for (; cycle < reset_cycles + opt.cycles && !ctx->gotFinish(); cycle++) {
+        top->rst_n = cycle >= reset_cycles;
+        top->clk   = 1;
+        top->eval();
+        ctx->timeInc(5000);
+#if VM_TRACE
+        bool traced = vcd && cycle >= opt.trace_start &&
+                      cycle - opt.trace_start < opt.trace_cycles;
+        if (traced)
+            vcd->dump(ctx->time());
+#endif
+        top->clk = 0;
+        top->eval();
+        ctx->timeInc(5000);
+#if VM_TRACE
+        if (traced)
+            vcd->dump(ctx->time());
+#endif
+
+        const int rx = uart.clock(top->uart_tx, top->uart_baud);
+        if ((rx >= 0 && until.feed(uint8_t(rx))) ||
+            (top->console_valid && until.feed(uint8_t(top->console_byte)))) {
+            std::printf("\n[SIM] Expected output seen after %llu cycles\n",
+                        (unsigned long long)(cycle - reset_cycles));
+            cycle++;
+            break;
+        }
+
+        if (cosim && top->rvfi_valid) {
+            iss::CsrState csr = {top->csr_mstatus, top->csr_mie, top->csr_mtvec,
+                                 top->csr_mscratch, top->csr_mepc, top->csr_mcause};
+            if (!cosim->retire(rvfi_record(*top), top->irq_cause,
+                               top->csr_redirect ? nullptr : &csr,
+                               cycle - reset_cycles)) {
+                std::printf("\n[SIM] Co-simulation diverged - halting\n");
+                status = 1;
+                cycle++;
+                break;
+            }
+            if (cosim->pc() == opt.mark_pc && ++hits == opt.mark_count) {
+                if (!cosim->checkpoint(opt.checkpoint, top->mtime)) {
+                    std::perror(opt.checkpoint.c_str());
+                    return 2;
+                }
+                std::printf("\n[SIM] Checkpoint at PC=0x%08x (instruction %llu, cycle %llu) -> %s\n",
+                            opt.mark_pc, (unsigned long long)cosim->checked(),
+                            (unsigned long long)(cycle - reset_cycles),
+                            opt.checkpoint.c_str());
+                saved = true;
+                cycle++;
+                break;
+            }
+        }
+
+        uint32_t pc = top->pc;
+        if (pc == 0 && last_pc != 0) {
+            std::printf("\n[SIM] !!! RESTART DETECTED !!! (count=%u, came from PC=0x%08x)\n",
+                        restarts, last_pc);
+            if (restarts++ >= opt.max_restarts) {
+                std::printf("[SIM] Too many restarts - stopping simulation\n");
+                status = 1;
+                cycle++;
+                break;
+            }
+        }
+        last_pc = pc;
+        // The watchdog follows the retiring pc: in a jump-to-self loop the
+        // fetch pc keeps moving (the jump resolves in EX)
+        uint32_t wpc = top->rvfi_valid ? top->rvfi_pc_rdata : watch_pc;
+        if (wpc != watch_pc) {
+            watch_pc = wpc;
+            stuck    = 0;
+        } else if (opt.stuck && stuck++ == opt.stuck) {
+            std::printf("\n[SIM] PC stuck at 0x%08x for %llu cycles - halting\n",
+                        watch_pc, (unsigned long long)opt.stuck);
+            status = 1;
+            cycle++;
+            break;
+        }
+    }
+
+    // Firmware ended the run through sim_ctrl EXIT: its code is the status
+    if (status == 0 && top->sim_exit) {
+        status = int(top->sim_exit_code & 0xFF);
+        if (top->sim_exit_code && !status)
+            status = 1;
+    }
+
+    double secs = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t0).count();
+    if (status == 0 && !top->sim_exit && !saved && !until.met()) {
+        std::printf("\n========================================\n");
+        std::printf("[SIM] Simulation complete (%llu cycles)\n",
+                    (unsigned long long)(cycle - reset_cycles));
+    }
+    std::fflush(stdout);
+    std::fprintf(stderr, "[SIM] %llu cycles in %.2f s (%.2f Mcycles/s)\n",
+                 (unsigned long long)cycle, secs, secs > 0 ? cycle / secs / 1e6 : 0.0);
+    if (cosim)
+        std::fprintf(stderr, "[COSIM] %llu instructions checked against the ISS (%llu interrupts)\n",
+                     (unsigned long long)cosim->checked(),
+                     (unsigned long long)cosim->interrupts());
+
+    if (!opt.signature.empty()) {
+        FILE* f = std::fopen(opt.signature.c_str(), "w");
+        if (!f) {
+            std::perror(opt.signature.c_str());
+            return 2;
+        }
+        for (uint64_t a = opt.sig_begin & ~3ull; a < opt.sig_end; a += 4) {
+            top->peek_addr = uint32_t(a >> 2);
+            top->eval();
+            std::fprintf(f, "%08x\n", top->peek_data);
+        }
+        std::fclose(f);
+    }
+
+#if VM_TRACE
+    if (vcd)
+        vcd->close();
+#endif
+    top->final();
+    return status;
+}
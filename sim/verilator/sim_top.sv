@@ -0,0 +1,156 @@
+`timescale 1ns / 1ps
+
+// Verilator top for full-firmware runs (sim_main.cpp drives it). Same
+// cpu_top configuration as firmware_sim_tb.sv: images from the working
+// directory, QSPI flash model on an internal net, button/switches idle,
+// optionally warm-started from a checkpoint (sim/warm_start.vh) or loaded
+// from an ELF through the sim_mem_write backdoor.
+// The clock and all the checking live in C++; this module only brings the
+// signals the harness watches out to ports, including the core's RVFI
+// retirement trace for lockstep co-simulation against the ISS (--cosim).
+module sim_top (
+    input  wire        clk,
+    input  wire        rst_n,
+    input  wire        uart_rx,
+    input  wire        warm_start,  // load the checkpoint in the run directory during reset
+    output wire        uart_tx,
+    output wire [3:0]  led,
+    output wire [31:0] pc,
+    output wire [19:0] uart_baud,   // TX bit period * 16, follows BAUD writes
+
+    // sim_ctrl.v finisher: the firmware wrote EXIT (the model $finish-es)
+    output wire        sim_exit,
+    output wire [31:0] sim_exit_code,
+    // ...and its CONSOLE writes (printed by the model; the harness watches
+    // them for --until): byte taken on the next rising edge when valid
+    output wire        console_valid,
+    output wire [7:0]  console_byte,
+
+    // CLINT time, for checkpoints taken from this run
+    output wire [63:0] mtime,
+
+    // ITCM backdoor read (word index), for signature dumps after a run
+    input  wire [31:0] peek_addr,
+    output wire [31:0] peek_data,
+
+    // Retirement trace and CSR file for --cosim (cpu_core.v rvfi_* port)
+    output wire        rvfi_valid,
+    output wire [63:0] rvfi_order,
+    output wire [31:0] rvfi_insn,
+    output wire        rvfi_trap,
+    output wire        rvfi_intr,
+    output wire [31:0] rvfi_pc_rdata,
+    output wire [31:0] rvfi_pc_wdata,
+    output wire [4:0]  rvfi_rs1_addr,
+    output wire [4:0]  rvfi_rs2_addr,
+    output wire [31:0] rvfi_rs1_rdata,
+    output wire [31:0] rvfi_rs2_rdata,
+    output wire [4:0]  rvfi_rd_addr,
+    output wire [31:0] rvfi_rd_wdata,
+    output wire [31:0] rvfi_mem_addr,
+    output wire [3:0]  rvfi_mem_rmask,
+    output wire [3:0]  rvfi_mem_wmask,
+    output wire [31:0] rvfi_mem_rdata,
+    output wire [31:0] rvfi_mem_wdata,
+    output wire [31:0] csr_mstatus,
+    output wire [31:0] csr_mie,
+    output wire [31:0] csr_mtvec,
+    output wire [31:0] csr_mscratch,
+    output wire [31:0] csr_mepc,
+    output wire [31:0] csr_mcause,
+    output reg         csr_redirect,    // trap entry / mret on the edge rvfi_* came from
+    output reg  [31:0] irq_cause        // mcause of the last interrupt taken
+);
+    `include "memmap.vh"
+
+    // Model sizes (cpu_top's defaults), and the backdoor index widths
+    localparam integer DDR_SIM_WORDS   = 1 << 20;
+    localparam integer FLASH_SIM_WORDS = 1 << 16;
+    localparam integer DDR_ADDR_BITS   = $clog2(DDR_SIM_WORDS);
+    localparam integer FLASH_ADDR_BITS = $clog2(FLASH_SIM_WORDS);
+
+    wire [3:0] qspi_dq;
+
+    cpu_top #(
+        .DDR_SIM_WORDS(DDR_SIM_WORDS),
+        .DDR_INIT_FILE("ext_mem.vh"),
+        .FLASH_SIM_WORDS(FLASH_SIM_WORDS),
+        .FLASH_INIT_FILE("flash_mem.vh"),
+        .SIM_CTRL(1)
+    ) uut (
+        .clk100(clk),
+        .rst_n(rst_n),
+        .btn0(1'b0),
+        .sw(2'b00),
+        .led(led),
+        .uart_tx(uart_tx),
+        .uart_rx(uart_rx),
+        .qspi_cs_n(),
+        .qspi_sck(),
+        .qspi_dq(qspi_dq)
+    );
+
+    `include "warm_start.vh"
+
+    // ELF loading (sim_main.cpp --elf): one word into the memory behind
+    // addr, after the initial blocks have loaded the images. 0 = no memory
+    export "DPI-C" function sim_mem_write;
+    function automatic int sim_mem_write(input int unsigned addr, input int unsigned data);
+        sim_mem_write = 1;
+        case (addr[31:28])
+            4'h0: if (addr[27:2] < ITCM_WORDS)
+                      uut.u_itcm.mem[addr[ITCM_ADDR_BITS+1:2]] = data;
+                  else sim_mem_write = 0;
+            4'h1: if (addr[27:2] < DTCM_WORDS)
+                      uut.u_dtcm.mem[addr[DTCM_ADDR_BITS+1:2]] = data;
+                  else sim_mem_write = 0;
+            4'h8: uut.u_ddr.mem[addr[DDR_ADDR_BITS+1:2]] = data;                    // wraps
+            4'h2: uut.g_flash_model.u_flash.mem[addr[FLASH_ADDR_BITS+1:2]] = data;  // wraps
+            default: sim_mem_write = 0;
+        endcase
+    endfunction
+
+    assign pc        = uut.pc;
+    assign uart_baud = uut.uart_baud;
+    assign peek_data = uut.u_itcm.mem[peek_addr[ITCM_ADDR_BITS-1:0]];
+    assign mtime     = uut.u_cpu.clint_mtime;
+    assign sim_exit      = uut.g_sim_ctrl.u_sim_ctrl.exit;
+    assign sim_exit_code = uut.g_sim_ctrl.u_sim_ctrl.exit_code;
+    assign console_valid = uut.g_sim_ctrl.u_sim_ctrl.wr &&
+                           uut.g_sim_ctrl.u_sim_ctrl.addr[7:2] == 6'h00;
+    assign console_byte  = uut.g_sim_ctrl.u_sim_ctrl.wdata[7:0];
+
+    assign rvfi_valid     = uut.u_cpu.rvfi_valid;
+    assign rvfi_order     = uut.u_cpu.rvfi_order;
+    assign rvfi_insn      = uut.u_cpu.rvfi_insn;
+    assign rvfi_trap      = uut.u_cpu.rvfi_trap;
+    assign rvfi_intr      = uut.u_cpu.rvfi_intr;
+    assign rvfi_pc_rdata  = uut.u_cpu.rvfi_pc_rdata;
+    assign rvfi_pc_wdata  = uut.u_cpu.rvfi_pc_wdata;
+    assign rvfi_rs1_addr  = uut.u_cpu.rvfi_rs1_addr;
+    assign rvfi_rs2_addr  = uut.u_cpu.rvfi_rs2_addr;
+    assign rvfi_rs1_rdata = uut.u_cpu.rvfi_rs1_rdata;
+    assign rvfi_rs2_rdata = uut.u_cpu.rvfi_rs2_rdata;
+    assign rvfi_rd_addr   = uut.u_cpu.rvfi_rd_addr;
+    assign rvfi_rd_wdata  = uut.u_cpu.rvfi_rd_wdata;
+    assign rvfi_mem_addr  = uut.u_cpu.rvfi_mem_addr;
+    assign rvfi_mem_rmask = uut.u_cpu.rvfi_mem_rmask;
+    assign rvfi_mem_wmask = uut.u_cpu.rvfi_mem_wmask;
+    assign rvfi_mem_rdata = uut.u_cpu.rvfi_mem_rdata;
+    assign rvfi_mem_wdata = uut.u_cpu.rvfi_mem_wdata;
+
+    assign csr_mstatus  = uut.u_cpu.csr_mstatus;
+    assign csr_mie      = uut.u_cpu.csr_mie;
+    assign csr_mtvec    = uut.u_cpu.csr_mtvec;
+    assign csr_mscratch = uut.u_cpu.csr_mscratch;
+    assign csr_mepc     = uut.u_cpu.csr_mepc;
+    assign csr_mcause   = uut.u_cpu.csr_mcause;
+
+    // Trap entry and mret update the CSRs from ID, on the same edge as the
+    // MEM/WB instruction retires: that record sees CSRs one step ahead
+    always @(posedge clk) begin
+        csr_redirect <= uut.u_cpu.trap_take | uut.u_cpu.mret_flush;
+        if (uut.u_cpu.irq_take)
+            irq_cause <= uut.u_cpu.ext_irq_en ? 32'h8000000B : 32'h80000007;
+    end
+endmodule
@@ -0,0 +1,71 @@
+// Warm start of cpu_top from a checkpoint (sim/iss/checkpoint.h): included
+// inside the testbench modules around `cpu_top uut`, which provide clk,
+// rst_n and warm_start (1 = load). instr_mem.vh / ext_mem.vh / flash_mem.vh
+// come from the checkpoint directory through the usual INIT_FILEs; this
+// adds dtcm_mem.vh and warm_core.vh.
+//
+// The state is written through hierarchical references (nonblocking, like
+// the flops' own updates) on every falling clock edge while rst_n is low,
+// so the last write follows the last reset edge and the core leaves reset
+// at the checkpoint pc. Reset must be released on a rising edge after at
+// least one full low cycle (both harnesses do). Word indices are the
+// WARM_* constants of checkpoint.h.
+localparam integer WARM_X             = 'h00;
+localparam integer WARM_PC            = 'h20;
+localparam integer WARM_MSTATUS       = 'h21;
+localparam integer WARM_MIE           = 'h22;
+localparam integer WARM_MTVEC         = 'h23;
+localparam integer WARM_MSCRATCH      = 'h24;
+localparam integer WARM_MEPC          = 'h25;
+localparam integer WARM_MCAUSE        = 'h26;
+localparam integer WARM_MIP           = 'h27;
+localparam integer WARM_MTIME_LO      = 'h28;
+localparam integer WARM_MTIME_HI      = 'h29;
+localparam integer WARM_MTIMECMP_LO   = 'h2A;
+localparam integer WARM_MTIMECMP_HI   = 'h2B;
+localparam integer WARM_UART_CTRL     = 'h30;
+localparam integer WARM_UART_BAUD     = 'h31;
+localparam integer WARM_IRQ_ENABLE    = 'h32;
+localparam integer WARM_UART_TX_COUNT = 'h33;
+localparam integer WARM_UART_TX       = 'h40;
+localparam integer WARM_WORDS         = 'h140;
+
+reg [31:0] warm_core [0:WARM_WORDS-1];
+reg        warm_loaded = 1'b0;
+integer    warm_i;
+
+always @(negedge clk) begin
+    if (warm_start && !rst_n) begin
+        if (!warm_loaded) begin
+            $readmemh("warm_core.vh", warm_core);
+            $readmemh("dtcm_mem.vh", uut.u_dtcm.mem);
+            $display("[SIM] Warm start at PC=0x%08h", warm_core[WARM_PC]);
+            warm_loaded = 1'b1;
+        end
+
+        uut.u_cpu.u_pc.pc <= warm_core[WARM_PC];
+        for (warm_i = 1; warm_i < 32; warm_i = warm_i + 1)
+            uut.u_cpu.u_rf.regs[warm_i] <= warm_core[WARM_X + warm_i];
+        uut.u_cpu.csr_mstatus    <= warm_core[WARM_MSTATUS];
+        uut.u_cpu.csr_mie        <= warm_core[WARM_MIE];
+        uut.u_cpu.csr_mtvec      <= warm_core[WARM_MTVEC];
+        uut.u_cpu.csr_mscratch   <= warm_core[WARM_MSCRATCH];
+        uut.u_cpu.csr_mepc       <= warm_core[WARM_MEPC];
+        uut.u_cpu.csr_mcause     <= warm_core[WARM_MCAUSE];
+        uut.u_cpu.csr_mip        <= warm_core[WARM_MIP] & ~32'h0000_0880;
+        uut.u_cpu.clint_mtime    <= {warm_core[WARM_MTIME_HI], warm_core[WARM_MTIME_LO]};
+        uut.u_cpu.clint_mtimecmp <= {warm_core[WARM_MTIMECMP_HI], warm_core[WARM_MTIMECMP_LO]};
+
+        uut.uart_ctrl     <= warm_core[WARM_UART_CTRL];
+        uut.uart_baud     <= warm_core[WARM_UART_BAUD][19:0];
+        uut.u_irqc.enable <= warm_core[WARM_IRQ_ENABLE];
+        // TX FIFO from slot 0; the counts are 9 bits, the FIFO holds 256
+        for (warm_i = 0; warm_i < warm_core[WARM_UART_TX_COUNT] && warm_i < 256;
+             warm_i = warm_i + 1)
+            uut.uart_fifo[warm_i] <= warm_core[WARM_UART_TX + warm_i][7:0];
+        uut.uart_rd_ptr     <= 8'd0;
+        uut.uart_wr_ptr     <= warm_core[WARM_UART_TX_COUNT][7:0];
+        uut.uart_fifo_count <= (warm_core[WARM_UART_TX_COUNT] > 256) ? 9'd256 :
+                               warm_core[WARM_UART_TX_COUNT][8:0];
+    end
+end
@@ -44,7 +44,7 @@ module uart_test_tb;
     always @(posedge clk) begin
         if (dut.uart_mmio_write)
             $display("PUSH @ %0t: data=0x%02h cnt=%0d busy=%b empty=%b pop=%b", 
-                     $time, dut.d_wdata[7:0], dut.uart_fifo_count, 
+                     $time, dut.io_wdata_q[7:0], dut.uart_fifo_count, 
                      dut.uart_busy, dut.uart_fifo_empty, dut.pop_fifo);
         if (dut.pop_fifo)
             $display("POP  @ %0t: byte=0x%02h cnt=%0d busy=%b", 
@@ -112,8 +112,7 @@ module uart_test_tb;
         integer i;
         begin
             for (i = 0; i < 256; i = i + 1) begin
-                dut.instr_mem[i] = 32'h00000013; // NOP
-                dut.data_mem[i] = 32'h0;
+                dut.u_itcm.mem[i] = 32'h00000013; // NOP
             end
         end
     endtask
@@ -178,10 +177,10 @@ module uart_test_tb;
             // addi x2,x0,-16   -> x2 = 0xFFFFFFF0 (UART_TX)
             // sw x1,0(x2)      -> write to UART
             // jal x0,0         -> halt (infinite loop)
-            dut.instr_mem[8]  = 32'h04100093; // addi x1,x0,0x41
-            dut.instr_mem[9]  = 32'hFF000113; // addi x2,x0,-16  (0xFFFFFFF0)
-            dut.instr_mem[10] = 32'h00112023; // sw x1,0(x2)
-            dut.instr_mem[11] = 32'h0000006F; // jal x0,0 (halt)
+            dut.u_itcm.mem[8]  = 32'h04100093; // addi x1,x0,0x41
+            dut.u_itcm.mem[9]  = 32'hFF000113; // addi x2,x0,-16  (0xFFFFFFF0)
+            dut.u_itcm.mem[10] = 32'h00112023; // sw x1,0(x2)
+            dut.u_itcm.mem[11] = 32'h0000006F; // jal x0,0 (halt)
             
             reset_system();
             run_cycles(100);  // Let program execute
@@ -210,30 +209,30 @@ module uart_test_tb;
             
             // Build UART address: addi x10,x0,-16 -> x10 = 0xFFFFFFF0
             // Program starts at index 8, with NOP padding between writes
-            dut.instr_mem[8]  = 32'hFF000513; // addi x10,x0,-16
-            dut.instr_mem[9]  = 32'h00000013; // nop
+            dut.u_itcm.mem[8]  = 32'hFF000513; // addi x10,x0,-16
+            dut.u_itcm.mem[9]  = 32'h00000013; // nop
             
             // Write 'H' (0x48)
-            dut.instr_mem[10] = 32'h04800093; // addi x1,x0,0x48
-            dut.instr_mem[11] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[12] = 32'h00000013; // nop
+            dut.u_itcm.mem[10] = 32'h04800093; // addi x1,x0,0x48
+            dut.u_itcm.mem[11] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[12] = 32'h00000013; // nop
             // Write 'e' (0x65)
-            dut.instr_mem[13] = 32'h06500093; // addi x1,x0,0x65
-            dut.instr_mem[14] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[15] = 32'h00000013; // nop
+            dut.u_itcm.mem[13] = 32'h06500093; // addi x1,x0,0x65
+            dut.u_itcm.mem[14] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[15] = 32'h00000013; // nop
             // Write 'l' (0x6C)
-            dut.instr_mem[16] = 32'h06C00093; // addi x1,x0,0x6C
-            dut.instr_mem[17] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[18] = 32'h00000013; // nop
+            dut.u_itcm.mem[16] = 32'h06C00093; // addi x1,x0,0x6C
+            dut.u_itcm.mem[17] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[18] = 32'h00000013; // nop
             // Write 'l' (0x6C)
-            dut.instr_mem[19] = 32'h06C00093; // addi x1,x0,0x6C
-            dut.instr_mem[20] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[21] = 32'h00000013; // nop
+            dut.u_itcm.mem[19] = 32'h06C00093; // addi x1,x0,0x6C
+            dut.u_itcm.mem[20] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[21] = 32'h00000013; // nop
             // Write 'o' (0x6F)
-            dut.instr_mem[22] = 32'h06F00093; // addi x1,x0,0x6F
-            dut.instr_mem[23] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[22] = 32'h06F00093; // addi x1,x0,0x6F
+            dut.u_itcm.mem[23] = 32'h00152023; // sw x1,0(x10)
             // Halt
-            dut.instr_mem[24] = 32'h0000006F; // jal x0,0
+            dut.u_itcm.mem[24] = 32'h0000006F; // jal x0,0
             
             reset_system();
             run_cycles(150);  // Let program execute
@@ -272,15 +271,15 @@ module uart_test_tb;
             // x10 = UART_TX (0xFFFFFFF0)
             // x11 = UART_STATUS (0xFFFFFFF4)
             // Program starts at index 8
-            dut.instr_mem[8]  = 32'hFF000513; // addi x10,x0,-16  x10 = 0xFFFFFFF0
-            dut.instr_mem[9]  = 32'h00450593; // addi x11,x10,4   x11 = 0xFFFFFFF4
+            dut.u_itcm.mem[8]  = 32'hFF000513; // addi x10,x0,-16  x10 = 0xFFFFFFF0
+            dut.u_itcm.mem[9]  = 32'h00450593; // addi x11,x10,4   x11 = 0xFFFFFFF4
             
             // Write 'X' to UART
-            dut.instr_mem[10] = 32'h05800093; // addi x1,x0,'X'
-            dut.instr_mem[11] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[10] = 32'h05800093; // addi x1,x0,'X'
+            dut.u_itcm.mem[11] = 32'h00152023; // sw x1,0(x10)
             
             // Halt
-            dut.instr_mem[12] = 32'h0000006F; // jal x0,0
+            dut.u_itcm.mem[12] = 32'h0000006F; // jal x0,0
             
             reset_system();
             run_cycles(80);
@@ -308,30 +307,30 @@ module uart_test_tb;
             bytes_captured = 0;
             
             // Build UART address - program starts at index 8
-            dut.instr_mem[8]  = 32'hFF000513; // addi x10,x0,-16   x10 = UART_TX
+            dut.u_itcm.mem[8]  = 32'hFF000513; // addi x10,x0,-16   x10 = UART_TX
             
             // Write '0' through '9' rapidly (should be buffered in FIFO)
-            dut.instr_mem[9]  = 32'h03000093; // addi x1,x0,'0'
-            dut.instr_mem[10] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[11] = 32'h03100093; // addi x1,x0,'1'
-            dut.instr_mem[12] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[13] = 32'h03200093; // addi x1,x0,'2'
-            dut.instr_mem[14] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[15] = 32'h03300093; // addi x1,x0,'3'
-            dut.instr_mem[16] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[17] = 32'h03400093; // addi x1,x0,'4'
-            dut.instr_mem[18] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[19] = 32'h03500093; // addi x1,x0,'5'
-            dut.instr_mem[20] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[21] = 32'h03600093; // addi x1,x0,'6'
-            dut.instr_mem[22] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[23] = 32'h03700093; // addi x1,x0,'7'
-            dut.instr_mem[24] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[25] = 32'h03800093; // addi x1,x0,'8'
-            dut.instr_mem[26] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[27] = 32'h03900093; // addi x1,x0,'9'
-            dut.instr_mem[28] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[29] = 32'h0000006F; // jal x0,0  halt
+            dut.u_itcm.mem[9]  = 32'h03000093; // addi x1,x0,'0'
+            dut.u_itcm.mem[10] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[11] = 32'h03100093; // addi x1,x0,'1'
+            dut.u_itcm.mem[12] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[13] = 32'h03200093; // addi x1,x0,'2'
+            dut.u_itcm.mem[14] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[15] = 32'h03300093; // addi x1,x0,'3'
+            dut.u_itcm.mem[16] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[17] = 32'h03400093; // addi x1,x0,'4'
+            dut.u_itcm.mem[18] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[19] = 32'h03500093; // addi x1,x0,'5'
+            dut.u_itcm.mem[20] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[21] = 32'h03600093; // addi x1,x0,'6'
+            dut.u_itcm.mem[22] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[23] = 32'h03700093; // addi x1,x0,'7'
+            dut.u_itcm.mem[24] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[25] = 32'h03800093; // addi x1,x0,'8'
+            dut.u_itcm.mem[26] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[27] = 32'h03900093; // addi x1,x0,'9'
+            dut.u_itcm.mem[28] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[29] = 32'h0000006F; // jal x0,0  halt
             
             reset_system();
             run_cycles(300);  // Let program execute quickly
@@ -364,17 +363,17 @@ module uart_test_tb;
             bytes_captured = 0;
             
             // Write "Hi\r\n" - program starts at index 8
-            dut.instr_mem[8]  = 32'hFF000513; // addi x10,x0,-16   x10 = UART_TX
+            dut.u_itcm.mem[8]  = 32'hFF000513; // addi x10,x0,-16   x10 = UART_TX
             
-            dut.instr_mem[9]  = 32'h04800093; // addi x1,x0,'H'
-            dut.instr_mem[10] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[11] = 32'h06900093; // addi x1,x0,'i'
-            dut.instr_mem[12] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[13] = 32'h00D00093; // addi x1,x0,0x0D   CR
-            dut.instr_mem[14] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[15] = 32'h00A00093; // addi x1,x0,0x0A   LF
-            dut.instr_mem[16] = 32'h00152023; // sw x1,0(x10)
-            dut.instr_mem[17] = 32'h0000006F; // jal x0,0  halt
+            dut.u_itcm.mem[9]  = 32'h04800093; // addi x1,x0,'H'
+            dut.u_itcm.mem[10] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[11] = 32'h06900093; // addi x1,x0,'i'
+            dut.u_itcm.mem[12] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[13] = 32'h00D00093; // addi x1,x0,0x0D   CR
+            dut.u_itcm.mem[14] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[15] = 32'h00A00093; // addi x1,x0,0x0A   LF
+            dut.u_itcm.mem[16] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[17] = 32'h0000006F; // jal x0,0  halt
             
             reset_system();
             run_cycles(120);
@@ -407,22 +406,22 @@ module uart_test_tb;
             bytes_captured = 0;
             
             // Write some binary values including 0x00 and 0xFF - program starts at index 8
-            dut.instr_mem[8]  = 32'hFF000513; // addi x10,x0,-16   x10 = UART_TX
+            dut.u_itcm.mem[8]  = 32'hFF000513; // addi x10,x0,-16   x10 = UART_TX
             
             // 0x00
-            dut.instr_mem[9]  = 32'h00000093; // addi x1,x0,0x00
-            dut.instr_mem[10] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[9]  = 32'h00000093; // addi x1,x0,0x00
+            dut.u_itcm.mem[10] = 32'h00152023; // sw x1,0(x10)
             // 0x55 (alternating bits)
-            dut.instr_mem[11] = 32'h05500093; // addi x1,x0,0x55
-            dut.instr_mem[12] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[11] = 32'h05500093; // addi x1,x0,0x55
+            dut.u_itcm.mem[12] = 32'h00152023; // sw x1,0(x10)
             // 0xAA (alternating bits)
-            dut.instr_mem[13] = 32'hFAA00093; // addi x1,x0,-86 (0xFFFFFFAA, only low 8 bits used)
-            dut.instr_mem[14] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[13] = 32'hFAA00093; // addi x1,x0,-86 (0xFFFFFFAA, only low 8 bits used)
+            dut.u_itcm.mem[14] = 32'h00152023; // sw x1,0(x10)
             // 0xFF
-            dut.instr_mem[15] = 32'hFFF00093; // addi x1,x0,-1 (0xFFFFFFFF)
-            dut.instr_mem[16] = 32'h00152023; // sw x1,0(x10)
+            dut.u_itcm.mem[15] = 32'hFFF00093; // addi x1,x0,-1 (0xFFFFFFFF)
+            dut.u_itcm.mem[16] = 32'h00152023; // sw x1,0(x10)
             
-            dut.instr_mem[17] = 32'h0000006F; // jal x0,0  halt
+            dut.u_itcm.mem[17] = 32'h0000006F; // jal x0,0  halt
             
             reset_system();
             run_cycles(100);